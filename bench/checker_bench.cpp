@@ -0,0 +1,102 @@
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "coj/answer_cache.h"
+#include "coj/checker.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr size_t TOKEN_COUNT = 1'000'000;
+
+struct CheckerFiles {
+    fs::path answer_path;
+    fs::path output_path;
+    size_t bytes = 0;
+};
+
+// Output equals the answer, so every token is compared.
+CheckerFiles CreateCheckerFiles(const std::string& name, bool is_float) {
+    auto base = fs::temp_directory_path() / ("coj_checker_bench_" + std::to_string(::getpid()) + "_" + name);
+
+    std::mt19937_64 rng(42);
+    std::string content;
+    content.reserve(TOKEN_COUNT * 12);
+    for (size_t i = 0; i < TOKEN_COUNT; ++i) {
+        if (is_float) {
+            content += std::to_string(std::uniform_real_distribution<double>(-1e6, 1e6)(rng));
+        } else {
+            content += std::to_string(static_cast<int32_t>(rng()));
+        }
+        content += (i % 16 == 15) ? '\n' : ' ';
+    }
+
+    CheckerFiles files{ .answer_path = base.string() + ".ans", .output_path = base.string() + ".out", .bytes = content.size() };
+    std::ofstream(files.answer_path) << content;
+    std::ofstream(files.output_path) << content;
+    return files;
+}
+
+void RemoveCheckerFiles(const CheckerFiles& files) {
+    fs::remove(files.answer_path);
+    fs::remove(files.output_path);
+}
+
+void BM_CheckIntegers(benchmark::State& state) {
+    auto files = CreateCheckerFiles("int", false);
+    CheckConfig config{ .output_path = files.output_path, .answer_path = files.answer_path };
+
+    for (auto _ : state) {
+        auto result = Check(config);
+        benchmark::DoNotOptimize(result);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * files.bytes * 2));
+    state.counters["tokens_per_sec"] = benchmark::Counter(static_cast<double>(state.iterations() * TOKEN_COUNT), benchmark::Counter::kIsRate);
+    RemoveCheckerFiles(files);
+}
+
+BENCHMARK(BM_CheckIntegers)->Unit(benchmark::kMillisecond);
+
+void BM_CheckFloats(benchmark::State& state) {
+    bool use_cache = state.range(0) != 0;
+
+    auto files = CreateCheckerFiles("float", true);
+    AnswerCache cache(1ULL << 30);
+    CheckConfig config{
+        .output_path = files.output_path,
+        .answer_path = files.answer_path,
+        .epsilon = 1e-6,
+        .answer_cache = use_cache ? &cache : nullptr
+    };
+
+    // Load outside the timed loop; the cached variant measures steady-state checks.
+    if (use_cache) {
+        (void)cache.Get(files.answer_path, true);
+    }
+
+    for (auto _ : state) {
+        auto result = Check(config);
+        benchmark::DoNotOptimize(result);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * files.bytes * 2));
+    state.counters["tokens_per_sec"] = benchmark::Counter(static_cast<double>(state.iterations() * TOKEN_COUNT), benchmark::Counter::kIsRate);
+    state.SetLabel(use_cache ? "cached" : "uncached");
+    RemoveCheckerFiles(files);
+}
+
+BENCHMARK(BM_CheckFloats)->ArgName("cache")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "coj/file_descriptor.h"
+#include "coj/file_io.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+fs::path GetBenchFile(const std::string& name) {
+    return fs::temp_directory_path() / ("coj_io_bench_" + std::to_string(::getpid()) + "_" + name);
+}
+
+void BM_ReadAll(benchmark::State& state) {
+    size_t file_bytes = static_cast<size_t>(state.range(0));
+    auto path = GetBenchFile("read_all");
+
+    {
+        auto fd_res = Open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        std::vector<std::byte> content(file_bytes, std::byte{'x'});
+        (void)Write(fd_res->Get(), content);
+    }
+
+    auto fd_res = Open(path, O_RDONLY | O_CLOEXEC);
+    if (!fd_res.has_value()) {
+        state.SkipWithError(fd_res.error().message().c_str());
+        return;
+    }
+
+    for (auto _ : state) {
+        ::lseek(fd_res->Get(), 0, SEEK_SET);
+        auto bytes = ReadAll(fd_res->Get());
+        benchmark::DoNotOptimize(bytes);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file_bytes));
+    fs::remove(path);
+}
+
+BENCHMARK(BM_ReadAll)->RangeMultiplier(16)->Range(4 << 10, 64 << 20);
+
+void BM_Write(benchmark::State& state) {
+    size_t chunk_bytes = static_cast<size_t>(state.range(0));
+    constexpr size_t TOTAL_BYTES = 16 << 20;
+
+    auto path = GetBenchFile("write");
+    auto fd_res = Open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (!fd_res.has_value()) {
+        state.SkipWithError(fd_res.error().message().c_str());
+        return;
+    }
+
+    std::vector<std::byte> chunk(chunk_bytes, std::byte{'y'});
+
+    for (auto _ : state) {
+        ::ftruncate(fd_res->Get(), 0);
+        ::lseek(fd_res->Get(), 0, SEEK_SET);
+        for (size_t written = 0; written < TOTAL_BYTES; written += chunk_bytes) {
+            auto write_res = Write(fd_res->Get(), chunk);
+            benchmark::DoNotOptimize(write_res);
+        }
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * TOTAL_BYTES));
+    fs::remove(path);
+}
+
+BENCHMARK(BM_Write)->RangeMultiplier(8)->Range(512, 1 << 20);
+
+void BM_TransferFile(benchmark::State& state) {
+    size_t file_bytes = static_cast<size_t>(state.range(0));
+    auto path = GetBenchFile("transfer");
+
+    {
+        auto fd_res = Open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        std::vector<std::byte> content(file_bytes, std::byte{'z'});
+        (void)Write(fd_res->Get(), content);
+    }
+
+    // sendfile into /dev/null moves no data, so the copy lands in a memfd, the way captured output does.
+    auto in_res = Open(path, O_RDONLY | O_CLOEXEC);
+    FileDescriptor out_fd(::memfd_create("coj_io_bench_transfer", MFD_CLOEXEC));
+    if (!in_res.has_value() || !out_fd.IsValid()) {
+        state.SkipWithError("failed to open bench files");
+        return;
+    }
+
+    for (auto _ : state) {
+        ::lseek(in_res->Get(), 0, SEEK_SET);
+        ::ftruncate(out_fd.Get(), 0);
+        ::lseek(out_fd.Get(), 0, SEEK_SET);
+        auto transfer_res = Transfer(in_res->Get(), out_fd.Get());
+        benchmark::DoNotOptimize(transfer_res);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file_bytes));
+    fs::remove(path);
+}
+
+BENCHMARK(BM_TransferFile)->Arg(1 << 20)->Arg(64 << 20);
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
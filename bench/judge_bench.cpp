@@ -0,0 +1,66 @@
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "coj/judger.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+// /bin/cat echoes each input, so with answer == input every case is accepted and the measured cost
+// is the judge's own per-test overhead.
+void BM_JudgeBatchEcho(benchmark::State& state) {
+    size_t case_count = static_cast<size_t>(state.range(0));
+    size_t worker_count = static_cast<size_t>(state.range(1));
+
+    auto sandbox_dir = fs::temp_directory_path() / ("coj_judge_bench_" + std::to_string(::getpid()));
+    fs::create_directories(sandbox_dir / "work");
+
+    JudgeConfig config{
+        .exec_path = "/bin/cat",
+        .work_dir = sandbox_dir / "work",
+        .soft_limits = { .cpu_time = 1000ms, .memory_kb = 256 * 1024 },
+        .hard_limits = { .cpu_time_sec = 2 },
+        .worker_count = worker_count
+    };
+
+    for (size_t i = 0; i < case_count; ++i) {
+        auto path = sandbox_dir / (std::to_string(i) + ".txt");
+        std::ofstream(path) << i << "\n";
+        config.test_cases.push_back(TestCase{ .input_path = path, .answer_path = path });
+    }
+
+    for (auto _ : state) {
+        auto result = JudgeBatch(config);
+        if (!result.has_value() || !result->IsAccepted()) {
+            state.SkipWithError("judge batch failed");
+            break;
+        }
+    }
+
+    state.counters["tests_per_sec"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * case_count),
+        benchmark::Counter::kIsRate
+    );
+    fs::remove_all(sandbox_dir);
+}
+
+BENCHMARK(BM_JudgeBatchEcho)
+    ->ArgNames({"cases", "workers"})
+    ->Args({64, 1})
+    ->Args({64, 4})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "coj/executor_pool.h"
+#include "coj/process.h"
+#include "coj/sandbox.h"
+
+namespace coj {
+
+namespace process {
+
+namespace {
+
+void BM_SpawnWait(benchmark::State& state) {
+    auto backend = static_cast<SpawnBackend>(state.range(0));
+    size_t ballast_bytes = static_cast<size_t>(state.range(1)) * 1024 * 1024;
+
+    std::vector<char> ballast(ballast_bytes);
+    std::memset(ballast.data(), 1, ballast.size());
+    benchmark::DoNotOptimize(ballast.data());
+
+    for (auto _ : state) {
+        Command cmd("/bin/true");
+        cmd.Backend(backend);
+
+        auto child_res = cmd.Spawn();
+        if (!child_res.has_value()) {
+            state.SkipWithError(child_res.error().message().c_str());
+            break;
+        }
+
+        auto wait_res = child_res->Wait();
+        benchmark::DoNotOptimize(wait_res);
+    }
+
+    state.counters["parent_rss_mb"] = static_cast<double>(state.range(1));
+    state.SetLabel(backend == SpawnBackend::VFork ? "vfork" : "fork");
+}
+
+BENCHMARK(BM_SpawnWait)
+    ->ArgNames({"backend", "rss_mb"})
+    ->ArgsProduct({
+        {static_cast<int64_t>(SpawnBackend::Fork), static_cast<int64_t>(SpawnBackend::VFork)},
+        {0, 64, 256, 1024}
+    })
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_PreparedSpawnWait(benchmark::State& state) {
+    auto backend = static_cast<SpawnBackend>(state.range(0));
+
+    Command cmd("/bin/true");
+    cmd.Backend(backend);
+    auto prepared = cmd.Prepare();
+
+    for (auto _ : state) {
+        auto child_res = prepared.Spawn();
+        if (!child_res.has_value()) {
+            state.SkipWithError(child_res.error().message().c_str());
+            break;
+        }
+
+        auto wait_res = child_res->Wait();
+        benchmark::DoNotOptimize(wait_res);
+    }
+
+    state.SetLabel(backend == SpawnBackend::VFork ? "vfork" : "fork");
+}
+
+BENCHMARK(BM_PreparedSpawnWait)
+    ->ArgName("backend")
+    ->Arg(static_cast<int64_t>(SpawnBackend::Fork))
+    ->Arg(static_cast<int64_t>(SpawnBackend::VFork))
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_SpawnWaitEnv(benchmark::State& state) {
+    size_t env_count = static_cast<size_t>(state.range(0));
+
+    Command cmd("/bin/true");
+    cmd.Backend(SpawnBackend::VFork).EnvClear();
+    for (size_t i = 0; i < env_count; ++i) {
+        cmd.Env("COJ_BENCH_VAR_" + std::to_string(i), std::string(64, 'v'));
+    }
+
+    for (auto _ : state) {
+        auto child_res = cmd.Spawn();
+        if (!child_res.has_value()) {
+            state.SkipWithError(child_res.error().message().c_str());
+            break;
+        }
+
+        auto wait_res = child_res->Wait();
+        benchmark::DoNotOptimize(wait_res);
+    }
+}
+
+BENCHMARK(BM_SpawnWaitEnv)
+    ->ArgName("env_count")
+    ->Arg(0)->Arg(64)->Arg(1024)->Arg(8192)
+    ->Unit(benchmark::kMicrosecond);
+
+// Time from the child's exit to WaitWithTimeout returning, on top of the spawn itself.
+void BM_WaitWithTimeout(benchmark::State& state) {
+    auto prepared = Command("/bin/true").Backend(SpawnBackend::VFork).Prepare();
+
+    for (auto _ : state) {
+        auto child_res = prepared.Spawn();
+        if (!child_res.has_value()) {
+            state.SkipWithError(child_res.error().message().c_str());
+            break;
+        }
+
+        auto wait_res = child_res->WaitWithTimeout(std::chrono::seconds(5));
+        benchmark::DoNotOptimize(wait_res);
+    }
+}
+
+BENCHMARK(BM_WaitWithTimeout)->Unit(benchmark::kMicrosecond);
+
+// Namespaces without a rootfs, optionally with the default seccomp filter; the filter is compiled once.
+void BM_SandboxedSpawnWait(benchmark::State& state) {
+    SandboxConfig config;
+    if (state.range(0) != 0) {
+        auto filter_res = SeccompFilter::Compile(SeccompPolicy::Default());
+        if (!filter_res.has_value()) {
+            state.SkipWithError(filter_res.error().message().c_str());
+            return;
+        }
+        config.seccomp = filter_res.value();
+    }
+
+    auto plan_res = SandboxPlan::Build(config);
+    if (!plan_res.has_value()) {
+        state.SkipWithError(plan_res.error().message().c_str());
+        return;
+    }
+
+    Command cmd("/bin/true");
+    cmd.Sandbox(plan_res.value());
+    auto prepared = cmd.Prepare();
+
+    for (auto _ : state) {
+        auto child_res = prepared.Spawn();
+        if (!child_res.has_value()) {
+            state.SkipWithError(child_res.error().message().c_str());
+            break;
+        }
+
+        auto wait_res = child_res->Wait();
+        benchmark::DoNotOptimize(wait_res);
+    }
+}
+BENCHMARK(BM_SandboxedSpawnWait)
+    ->ArgName("seccomp")
+    ->Arg(0)->Arg(1)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_ExecutorPoolExecute(benchmark::State& state) {
+    ExecutorPool pool({ .exec_path = "/bin/true" });
+    if (auto res = pool.Start(); !res.has_value()) {
+        state.SkipWithError(res.error().message().c_str());
+        return;
+    }
+
+    auto in_fd = Open("/dev/null", O_RDONLY | O_CLOEXEC);
+    auto out_fd = Open("/dev/null", O_WRONLY | O_CLOEXEC);
+
+    for (auto _ : state) {
+        auto status = pool.Execute(in_fd->Get(), out_fd->Get(), std::chrono::seconds(5));
+        if (!status.has_value()) {
+            state.SkipWithError(status.error().message().c_str());
+            break;
+        }
+        benchmark::DoNotOptimize(status);
+    }
+}
+
+BENCHMARK(BM_ExecutorPoolExecute)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+
+} // namespace process
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "coj/memory_map.h"
+
+namespace coj {
+
+struct FileIdentity {
+    dev_t device = 0;
+    ino_t inode = 0;
+    off_t size = 0;
+    int64_t mtime_ns = 0;
+
+    bool operator==(const FileIdentity& other) const noexcept = default;
+};
+
+[[nodiscard]] std::expected<FileIdentity, std::error_code> GetFileIdentity(const std::filesystem::path& path);
+
+// An answer file mapped once and split into tokens up front. Immutable after Load(), so one instance
+// is safely shared by every checker thread.
+class AnswerFile {
+public:
+    [[nodiscard]] static std::expected<AnswerFile, std::error_code> Load(
+        const std::filesystem::path& path,
+        bool parse_numbers
+    );
+
+    AnswerFile(const AnswerFile& other) = delete;
+    AnswerFile& operator=(const AnswerFile& other) = delete;
+
+    AnswerFile(AnswerFile&& other) noexcept = default;
+    AnswerFile& operator=(AnswerFile&& other) noexcept = default;
+
+    size_t GetTokenCount() const noexcept { return tokens_.size(); }
+
+    std::string_view GetToken(size_t index) const noexcept {
+        auto [offset, length] = tokens_[index];
+        return map_.View().substr(offset, length);
+    }
+
+    bool HasNumbers() const noexcept { return has_numbers_; }
+
+    // Only meaningful when HasNumbers(); nullopt for tokens that are not a complete float.
+    std::optional<double> GetNumber(size_t index) const noexcept {
+        if (!is_number_[index]) {
+            return std::nullopt;
+        }
+        return numbers_[index];
+    }
+
+    const FileIdentity& GetIdentity() const noexcept { return identity_; }
+
+    // Mapped bytes plus the index; what the cache charges against its budget.
+    size_t GetFootprint() const noexcept;
+
+private:
+    AnswerFile() = default;
+
+    MemoryMap map_;
+    FileIdentity identity_;
+
+    std::vector<std::pair<uint32_t, uint32_t>> tokens_;
+    std::vector<double> numbers_;
+    std::vector<bool> is_number_;
+    bool has_numbers_ = false;
+};
+
+struct AnswerCacheStats {
+    size_t hit_count = 0;
+    size_t miss_count = 0;
+    size_t invalidation_count = 0;
+    size_t eviction_count = 0;
+
+    size_t entry_count = 0;
+    size_t total_bytes = 0;
+};
+
+class AnswerCache {
+public:
+    explicit AnswerCache(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+    AnswerCache(const AnswerCache& other) = delete;
+    AnswerCache& operator=(const AnswerCache& other) = delete;
+
+    // Revalidates against the file's inode and mtime on every call and reloads on change. Evicted
+    // entries stay alive for callers still holding them.
+    [[nodiscard]] std::expected<std::shared_ptr<const AnswerFile>, std::error_code> Get(
+        const std::filesystem::path& path,
+        bool parse_numbers
+    );
+
+    AnswerCacheStats GetStats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const AnswerFile> file;
+    };
+
+    void EvictLocked();
+
+    size_t max_bytes_;
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    AnswerCacheStats stats_;
+};
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <expected>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include "coj/file_io.h"
+
+namespace coj {
+
+// Keeps the first and last bytes of an unbounded stream in fixed storage and counts what was dropped
+// in between. The storage may be caller-provided, so a reused buffer never allocates.
+class CaptureBuffer {
+public:
+    explicit CaptureBuffer(size_t capacity)
+        : owned_(std::make_unique<char[]>(capacity)) {
+        Reset(std::span(owned_.get(), capacity), capacity / 2);
+    }
+
+    CaptureBuffer(std::span<char> storage, size_t head_capacity) {
+        Reset(storage, head_capacity);
+    }
+
+    CaptureBuffer(const CaptureBuffer& other) = delete;
+    CaptureBuffer& operator=(const CaptureBuffer& other) = delete;
+
+    void Clear() noexcept {
+        head_size_ = 0;
+        tail_size_ = 0;
+        tail_pos_ = 0;
+        total_bytes_ = 0;
+    }
+
+    void Append(std::string_view chunk) noexcept {
+        total_bytes_ += chunk.size();
+
+        size_t head_take = std::min(chunk.size(), head_capacity_ - head_size_);
+        std::memcpy(storage_.data() + head_size_, chunk.data(), head_take);
+        head_size_ += head_take;
+        chunk.remove_prefix(head_take);
+
+        if (chunk.empty() || tail_capacity_ == 0) {
+            return;
+        }
+
+        char* tail = storage_.data() + head_capacity_;
+
+        if (chunk.size() >= tail_capacity_) {
+            std::memcpy(tail, chunk.data() + chunk.size() - tail_capacity_, tail_capacity_);
+            tail_pos_ = 0;
+            tail_size_ = tail_capacity_;
+            return;
+        }
+
+        size_t first = std::min(chunk.size(), tail_capacity_ - tail_pos_);
+        std::memcpy(tail + tail_pos_, chunk.data(), first);
+        std::memcpy(tail, chunk.data() + first, chunk.size() - first);
+
+        tail_pos_ = (tail_pos_ + chunk.size()) % tail_capacity_;
+        tail_size_ = std::min(tail_capacity_, tail_size_ + chunk.size());
+    }
+
+    std::string_view Head() const noexcept { return { storage_.data(), head_size_ }; }
+
+    // The retained tail in stream order; it wraps around the ring, hence two pieces.
+    std::pair<std::string_view, std::string_view> Tail() const noexcept {
+        const char* tail = storage_.data() + head_capacity_;
+        if (tail_size_ < tail_capacity_) {
+            return { std::string_view(tail, tail_size_), std::string_view() };
+        }
+        return {
+            std::string_view(tail + tail_pos_, tail_capacity_ - tail_pos_),
+            std::string_view(tail, tail_pos_),
+        };
+    }
+
+    size_t GetTotalBytes() const noexcept { return total_bytes_; }
+
+    size_t GetDroppedBytes() const noexcept { return total_bytes_ - head_size_ - tail_size_; }
+
+    bool IsTruncated() const noexcept { return GetDroppedBytes() > 0; }
+
+    void AppendTo(std::string& out) const {
+        auto [older, newer] = Tail();
+
+        out.reserve(out.size() + head_size_ + tail_size_ + 64);
+        out.append(Head());
+        if (IsTruncated()) {
+            out.append("\n... [").append(std::to_string(GetDroppedBytes())).append(" bytes omitted] ...\n");
+        }
+        out.append(older).append(newer);
+    }
+
+    std::string ToString() const {
+        std::string out;
+        AppendTo(out);
+        return out;
+    }
+
+private:
+    void Reset(std::span<char> storage, size_t head_capacity) noexcept {
+        storage_ = storage;
+        head_capacity_ = std::min(head_capacity, storage.size());
+        tail_capacity_ = storage.size() - head_capacity_;
+        Clear();
+    }
+
+    std::unique_ptr<char[]> owned_;
+    std::span<char> storage_;
+
+    size_t head_capacity_ = 0;
+    size_t tail_capacity_ = 0;
+
+    size_t head_size_ = 0;
+    size_t tail_size_ = 0;
+    size_t tail_pos_ = 0;
+    size_t total_bytes_ = 0;
+};
+
+// Drains fd to EOF (or WouldBlock) into the capture. Returns the number of bytes read.
+[[nodiscard]] inline std::expected<size_t, std::error_code> ReadAllInto(int fd, CaptureBuffer& capture) {
+    std::array<std::byte, 16 * 1024> scratch;
+    size_t total_bytes = 0;
+
+    while (true) {
+        auto read_res = Read(fd, scratch);
+        if (!read_res.has_value()) {
+            return std::unexpected(read_res.error());
+        } else if (read_res->status != IoStatus::Success) {
+            return total_bytes;
+        }
+
+        capture.Append(std::string_view(reinterpret_cast<const char*>(scratch.data()), read_res->bytes));
+        total_bytes += read_res->bytes;
+    }
+}
+
+} // namespace coj
\ No newline at end of file
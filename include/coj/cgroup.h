@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "coj/file_descriptor.h"
+
+namespace coj {
+
+struct CgroupLimits {
+    std::optional<size_t> memory_bytes;
+
+    std::optional<size_t> process_count;
+
+    std::optional<double> cpu_cores;
+};
+
+struct CgroupStats {
+    std::optional<size_t> memory_peak_bytes;
+
+    std::chrono::microseconds cpu_usage{};
+    std::chrono::microseconds cpu_user{};
+    std::chrono::microseconds cpu_system{};
+
+    size_t oom_kill_count = 0;
+};
+
+[[nodiscard]] std::expected<std::filesystem::path, std::error_code> FindCgroupMount();
+
+class Cgroup {
+public:
+    static constexpr std::chrono::microseconds CPU_PERIOD = std::chrono::microseconds(100000);
+
+    [[nodiscard]] static std::expected<Cgroup, std::error_code> Create(std::filesystem::path path);
+
+    Cgroup(const Cgroup& other) = delete;
+    Cgroup& operator=(const Cgroup& other) = delete;
+
+    Cgroup(Cgroup&& other) noexcept = default;
+
+    // Removes the directory this cgroup owned before taking over other's.
+    Cgroup& operator=(Cgroup&& other) noexcept;
+
+    ~Cgroup() { (void)Remove(); }
+
+    const std::filesystem::path& GetPath() const noexcept { return path_; }
+
+    int GetProcsFd() const noexcept { return procs_fd_.Get(); }
+
+    bool IsValid() const noexcept { return procs_fd_.IsValid(); }
+
+    [[nodiscard]] bool HasController(std::string_view controller) const;
+
+    [[nodiscard]] std::expected<void, std::error_code> SetLimits(const CgroupLimits& limits);
+
+    [[nodiscard]] std::expected<CgroupStats, std::error_code> ReadStats() const;
+
+    [[nodiscard]] std::expected<void, std::error_code> Kill();
+
+    [[nodiscard]] std::expected<void, std::error_code> Remove();
+
+private:
+    Cgroup(std::filesystem::path path, FileDescriptor procs_fd)
+        : path_(std::move(path)), procs_fd_(std::move(procs_fd)) {}
+
+    std::filesystem::path path_;
+    FileDescriptor procs_fd_;
+};
+
+class CgroupPool {
+public:
+    // cpu_cores is written to cpu.max of every cgroup as it is created, so a run can never use more
+    // than that many cores' worth of time, however many threads it starts.
+    CgroupPool(
+        std::filesystem::path parent_dir,
+        size_t capacity,
+        std::string prefix = "coj",
+        std::optional<double> cpu_cores = std::nullopt
+    ) : parent_dir_(std::move(parent_dir)), prefix_(std::move(prefix)), capacity_(capacity), cpu_cores_(cpu_cores) {}
+
+    CgroupPool(const CgroupPool& other) = delete;
+    CgroupPool& operator=(const CgroupPool& other) = delete;
+
+    ~CgroupPool();
+
+    [[nodiscard]] std::expected<void, std::error_code> Reserve();
+
+    [[nodiscard]] std::expected<Cgroup, std::error_code> Acquire();
+
+    // Kills whatever is left in the cgroup and returns at once. A background thread removes it and
+    // creates a fresh one for the idle list, since a reused cgroup would carry over memory.peak and
+    // the cpu.stat counters.
+    void Release(Cgroup cgroup);
+
+    size_t GetIdleCount() const;
+
+    const std::filesystem::path& GetParentDir() const noexcept { return parent_dir_; }
+
+private:
+    [[nodiscard]] std::expected<Cgroup, std::error_code> CreateCgroup();
+
+    void RefillLoop();
+
+    std::filesystem::path parent_dir_;
+    std::string prefix_;
+    size_t capacity_;
+    std::optional<double> cpu_cores_;
+
+    std::atomic<size_t> next_id_ = 0;
+
+    mutable std::mutex mutex_;
+    std::condition_variable refill_cv_;
+    std::vector<Cgroup> idle_;
+    std::vector<Cgroup> retired_;
+    std::thread refill_thread_;
+    bool is_stopping_ = false;
+};
+
+} // namespace coj
\ No newline at end of file
@@ -3,9 +3,12 @@
 #include <expected>
 #include <filesystem>
 #include <optional>
+#include <string_view>
 
 namespace coj {
 
+class AnswerCache;
+
 enum class CheckResult {
     Accepted,
     WrongAnswer
@@ -15,9 +18,22 @@ struct CheckConfig {
     std::filesystem::path output_path;
     std::filesystem::path answer_path;
 
+    // Read instead of output_path when set, e.g. the mapping of an in-memory output file.
+    std::optional<std::string_view> output_data;
+
     std::optional<double> epsilon;
+
+    // When set, the answer is tokenized once and shared across checks (and threads).
+    AnswerCache* answer_cache = nullptr;
 };
 
+// Succeeds only when the whole token is a floating-point number.
+[[nodiscard]] std::expected<double, std::error_code> ParseFloat(std::string_view str);
+
+[[nodiscard]] bool IsFloatEqual(double a, double b, double epsilon);
+
+[[nodiscard]] bool IsTokenEqual(std::string_view answer, std::string_view output, std::optional<double> epsilon);
+
 [[nodiscard]] std::expected<CheckResult, std::error_code> Check(const CheckConfig& config);
 
 } // namespace coj
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+
+#include "coj/compiler.h"
+
+namespace coj {
+
+struct CompileCacheStats {
+    size_t hit_count = 0;
+    size_t miss_count = 0;
+    size_t store_count = 0;
+    size_t eviction_count = 0;
+
+    size_t entry_count = 0;
+    size_t total_bytes = 0;
+};
+
+class CompileCache {
+public:
+    static constexpr const char* EXEC_FILENAME = "main";
+    static constexpr const char* OUTPUT_FILENAME = "output";
+
+    CompileCache(std::filesystem::path cache_dir, size_t max_bytes)
+        : cache_dir_(std::move(cache_dir)), max_bytes_(max_bytes) {}
+
+    CompileCache(const CompileCache& other) = delete;
+    CompileCache& operator=(const CompileCache& other) = delete;
+
+    // Creates the cache directory and indexes entries left by earlier processes, oldest first.
+    [[nodiscard]] std::expected<void, std::error_code> Load();
+
+    // On a hit the cached binary is hardlinked (or reflinked, or copied) to exec_dir/main.
+    [[nodiscard]] std::expected<std::optional<CompileResult>, std::error_code> Lookup(
+        const std::string& key,
+        const std::filesystem::path& exec_dir
+    );
+
+    [[nodiscard]] std::expected<void, std::error_code> Store(const std::string& key, const CompileResult& result);
+
+    CompileCacheStats GetStats() const;
+
+    const std::filesystem::path& GetCacheDir() const noexcept { return cache_dir_; }
+
+private:
+    struct Entry {
+        std::string key;
+        size_t bytes;
+        bool has_exec;
+    };
+
+    void Touch(std::list<Entry>::iterator it);
+
+    void EvictLocked();
+
+    std::filesystem::path cache_dir_;
+    size_t max_bytes_;
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    CompileCacheStats stats_;
+    size_t next_temp_id_ = 0;
+};
+
+[[nodiscard]] std::expected<void, std::error_code> LinkOrCopyFile(
+    const std::filesystem::path& from,
+    const std::filesystem::path& to
+);
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "coj/compiler.h"
+#include "coj/process.h"
+
+namespace coj {
+
+struct CompileJob {
+    std::filesystem::path source_path;
+    std::filesystem::path exec_dir;
+    std::optional<process::ResourceLimits> limits;
+};
+
+struct CompileJobResult {
+    std::expected<CompileResult, std::error_code> result;
+
+    std::chrono::nanoseconds queue_time{};
+    std::chrono::nanoseconds run_time{};
+};
+
+using CompileCallback = std::function<void(CompileJobResult)>;
+
+struct CompileServiceConfig {
+    size_t worker_count = 1;
+    size_t queue_capacity = 64;
+};
+
+struct CompileServiceStats {
+    size_t submitted_count = 0;
+    size_t rejected_count = 0;
+    size_t completed_count = 0;
+
+    size_t queued_count = 0;
+    size_t running_count = 0;
+
+    std::chrono::nanoseconds total_queue_time{};
+    std::chrono::nanoseconds max_queue_time{};
+    std::chrono::nanoseconds total_run_time{};
+};
+
+// The compiler is shared by all workers, so its Compile() must be safe to call concurrently.
+class CompileService {
+public:
+    CompileService(Compiler& compiler, CompileServiceConfig config);
+
+    CompileService(const CompileService& other) = delete;
+    CompileService& operator=(const CompileService& other) = delete;
+
+    ~CompileService() { Shutdown(); }
+
+    // Blocks while the queue is full.
+    [[nodiscard]] std::future<CompileJobResult> Submit(CompileJob job);
+
+    void Submit(CompileJob job, CompileCallback callback);
+
+    // Fails with resource_unavailable_try_again instead of blocking when the queue is full.
+    [[nodiscard]] std::expected<std::future<CompileJobResult>, std::error_code> TrySubmit(CompileJob job);
+
+    // Runs every job already queued, then joins the workers. Later submissions are cancelled.
+    void Shutdown();
+
+    CompileServiceStats GetStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct PendingJob {
+        CompileJob job;
+        CompileCallback callback;
+        Clock::time_point enqueue_time;
+    };
+
+    [[nodiscard]] std::expected<void, std::error_code> Enqueue(CompileJob& job, CompileCallback& callback, bool should_block);
+
+    void WorkerLoop();
+
+    Compiler& compiler_;
+    CompileServiceConfig config_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<PendingJob> queue_;
+    bool is_shutdown_ = false;
+    CompileServiceStats stats_;
+
+    std::vector<std::thread> workers_;
+};
+
+} // namespace coj
\ No newline at end of file
@@ -2,17 +2,24 @@
 
 #include <expected>
 #include <filesystem>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "coj/process.h"
 
 namespace coj {
 
+class CompileCache;
+class Sha256;
+
 struct CompileResult {
     bool is_successful = false;
     std::optional<std::filesystem::path> exec_path;
     std::string output;
+    size_t dropped_output_bytes = 0;
+    bool is_cached = false;
 };
 
 class Compiler {
@@ -23,24 +30,62 @@ public:
         const std::filesystem::path& source_path,
         const std::filesystem::path& exec_dir 
     ) = 0; 
+
+    [[nodiscard]] virtual std::expected<CompileResult, std::error_code> Compile(
+        const std::filesystem::path& source_path,
+        const std::filesystem::path& exec_dir,
+        const process::ResourceLimits& limits
+    ) {
+        (void)source_path;
+        (void)exec_dir;
+        (void)limits;
+        return std::unexpected(std::make_error_code(std::errc::not_supported));
+    }
 };
 
+// Folds the limits a compile runs under into its cache key. Compilers report running out of memory
+// as an ordinary error, so a failed compile is only worth replaying under the same limits.
+void HashCompileLimits(Sha256& hasher, const process::ResourceLimits& limits);
+
+// Whether a finished compile may be stored. It must have exited on its own, and a failure must not
+// have used half its CPU limit or more, since load on the host rather than the source may have caused it.
+[[nodiscard]] bool IsCacheableCompile(const process::ExitStatus& status, const process::ResourceLimits& limits);
+
 class CppCompiler : public Compiler {
 public:
-    explicit CppCompiler(std::string compiler_path = "/usr/bin/g++") : command_(compiler_path) {}
+    static constexpr size_t DEFAULT_MAX_OUTPUT_BYTES = 64 * 1024;
+
+    explicit CppCompiler(std::string compiler_path = "/usr/bin/g++") : compiler_path_(std::move(compiler_path)) {}
 
     CppCompiler& Arg(std::string arg) {
-        command_.Arg(std::move(arg));
+        args_.push_back(std::move(arg));
         return *this;
     }
 
     CppCompiler& Args(const std::vector<std::string>& args) {
-        command_.Args(args);
+        args_.insert(args_.end(), args.begin(), args.end());
         return *this;
     }
 
     CppCompiler& Limits(const process::ResourceLimits& limits) {
-        command_.Limits(limits);
+        limits_ = limits;
+        return *this;
+    }
+
+    // Diagnostics beyond this are cut from the middle, keeping the first and last errors.
+    CppCompiler& MaxOutputBytes(size_t max_output_bytes) {
+        max_output_bytes_ = max_output_bytes;
+        return *this;
+    }
+
+    CppCompiler& Cache(CompileCache* cache) {
+        cache_ = cache;
+        return *this;
+    }
+
+    CppCompiler& PrecompiledHeader(std::filesystem::path pch_root, std::string header = "bits/stdc++.h") {
+        pch_root_ = std::move(pch_root);
+        pch_header_ = std::move(header);
         return *this;
     }
 
@@ -49,8 +94,53 @@ public:
         const std::filesystem::path& exec_dir 
     ) override;
 
+    [[nodiscard]] virtual std::expected<CompileResult, std::error_code> Compile(
+        const std::filesystem::path& source_path,
+        const std::filesystem::path& exec_dir,
+        const process::ResourceLimits& limits
+    ) override;
+
+    // Hash of the source bytes, compiler path, compiler version, args and the limits the compile runs
+    // under. The one-argument form uses the limits set with Limits().
+    [[nodiscard]] std::expected<std::string, std::error_code> GetCacheKey(const std::filesystem::path& source_path);
+
+    [[nodiscard]] std::expected<std::string, std::error_code> GetCacheKey(
+        const std::filesystem::path& source_path,
+        const process::ResourceLimits& limits
+    );
+
+    [[nodiscard]] std::expected<std::string, std::error_code> GetVersion();
+
+    // Returns the include directory holding the header's .gch for the current compiler and args,
+    // building it on first use.
+    [[nodiscard]] std::expected<std::filesystem::path, std::error_code> PreparePrecompiledHeader();
+
 private:
-    process::Command command_;
+    [[nodiscard]] std::expected<CompileResult, std::error_code> Invoke(
+        const std::filesystem::path& source_path,
+        const std::filesystem::path& exec_dir,
+        const process::ResourceLimits& limits,
+        bool& is_deterministic
+    );
+
+    [[nodiscard]] std::expected<std::string, std::error_code> GetPrecompiledHeaderKey();
+
+    [[nodiscard]] std::expected<void, std::error_code> BuildPrecompiledHeader(const std::filesystem::path& pch_dir);
+
+    std::string compiler_path_;
+    std::vector<std::string> args_;
+    process::ResourceLimits limits_;
+    size_t max_output_bytes_ = DEFAULT_MAX_OUTPUT_BYTES;
+
+    CompileCache* cache_ = nullptr;
+
+    std::mutex version_mutex_;
+    std::optional<std::string> version_;
+
+    std::optional<std::filesystem::path> pch_root_;
+    std::string pch_header_;
+    std::mutex pch_mutex_;
+    size_t next_pch_temp_id_ = 0;
 };
 
 } // namespace coj
\ No newline at end of file
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <chrono>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include "coj/compile_cache.h"
+#include "coj/compiler.h"
+#include "coj/process.h"
+#include "coj/runner.h"
+
+namespace coj {
+
+// A command line split once at load time. Arguments may be quoted and may contain the placeholders
+// {source}, {exec} and {exec_dir}.
+class CommandTemplate {
+public:
+    [[nodiscard]] static std::expected<CommandTemplate, std::error_code> Parse(std::string_view text);
+
+    [[nodiscard]] std::vector<std::string> Render(
+        std::string_view source,
+        std::string_view exec,
+        std::string_view exec_dir
+    ) const;
+
+    const std::vector<std::string>& GetArgv() const noexcept { return argv_; }
+
+private:
+    std::vector<std::string> argv_;
+};
+
+struct LanguageSpec {
+    std::string name;
+
+    // File names inside exec_dir. Compiles run with exec_dir as the working directory, so the compile
+    // command line is the same for every submission.
+    std::string source_name = "main";
+    std::string exec_name = CompileCache::EXEC_FILENAME;
+
+    // Unset for interpreted languages, whose source is run as is. A compile step that only emits byte
+    // code, e.g. py_compile, is cached like any other.
+    std::optional<CommandTemplate> compile;
+    CommandTemplate run;
+
+    process::ResourceLimits compile_limits;
+
+    double time_multiplier = 1.0;
+    size_t memory_extra_kb = 0;
+
+    // Compiled once by Warmup() to pull the toolchain into the page cache.
+    std::string warmup_source;
+};
+
+struct RunCommand {
+    std::filesystem::path exec_path;
+    std::vector<std::string> args;
+};
+
+// Compiles through PreparedCommands rendered from the spec at construction, so a compile only copies
+// the source into place and spawns. Safe to call concurrently.
+class LanguageCompiler : public Compiler {
+public:
+    static constexpr size_t DEFAULT_MAX_OUTPUT_BYTES = 64 * 1024;
+
+    // How long Warmup() lets the warm-up program run before killing it.
+    static constexpr std::chrono::seconds WARMUP_RUN_TIMEOUT{ 10 };
+
+    explicit LanguageCompiler(LanguageSpec spec);
+
+    LanguageCompiler& Cache(CompileCache* cache) {
+        cache_ = cache;
+        return *this;
+    }
+
+    const LanguageSpec& GetSpec() const noexcept { return spec_; }
+
+    bool IsInterpreted() const noexcept { return !spec_.compile.has_value(); }
+
+    [[nodiscard]] virtual std::expected<CompileResult, std::error_code> Compile(
+        const std::filesystem::path& source_path,
+        const std::filesystem::path& exec_dir
+    ) override;
+
+    [[nodiscard]] virtual std::expected<CompileResult, std::error_code> Compile(
+        const std::filesystem::path& source_path,
+        const std::filesystem::path& exec_dir,
+        const process::ResourceLimits& limits
+    ) override;
+
+    // The rendered run command for a program compiled into exec_dir.
+    [[nodiscard]] RunCommand GetRunCommand(const std::filesystem::path& exec_dir) const;
+
+    // Scales the CPU and wall limits by time_multiplier and adds memory_extra_kb.
+    [[nodiscard]] RunLimits GetRunLimits(const RunLimits& limits) const;
+
+    // Fails with timed_out if the warm-up program outlives WARMUP_RUN_TIMEOUT, so a hung runtime
+    // cannot stall startup.
+    [[nodiscard]] std::expected<void, std::error_code> Warmup(const std::filesystem::path& scratch_dir);
+
+private:
+    [[nodiscard]] std::expected<std::string, std::error_code> GetCacheKey(
+        const std::filesystem::path& source_path,
+        const process::ResourceLimits& limits
+    ) const;
+
+    [[nodiscard]] std::expected<CompileResult, std::error_code> Invoke(
+        const std::filesystem::path& exec_dir,
+        const process::ResourceLimits& limits,
+        bool& is_deterministic
+    );
+
+    LanguageSpec spec_;
+    std::optional<process::Command> compile_command_;
+
+    CompileCache* cache_ = nullptr;
+
+    std::mutex mutex_;
+    std::vector<process::PreparedCommand> idle_;
+};
+
+// Language descriptors in an INI-like format:
+//
+//   [java]
+//   source = Main.java
+//   exec = Main.class
+//   compile = /usr/bin/javac -d {exec_dir} {source}
+//   run = /usr/bin/java -cp {exec_dir} Main
+//   compile_cpu_sec = 10
+//   compile_memory_mb = 2048
+//   time_multiplier = 2
+//   memory_extra_mb = 64
+//   warmup = class Main { public static void main(String[] args) {} }
+//
+// Blank lines and lines starting with '#' or ';' are skipped. A section without a `compile` key is an
+// interpreted language; `run` defaults to `{exec}`.
+class CompilerRegistry {
+public:
+    [[nodiscard]] static std::expected<CompilerRegistry, std::error_code> Parse(std::string_view text);
+
+    [[nodiscard]] static std::expected<CompilerRegistry, std::error_code> Load(const std::filesystem::path& path);
+
+    // Null for an unknown language.
+    LanguageCompiler* Get(std::string_view name) const;
+
+    std::vector<std::string> GetLanguageNames() const;
+
+    CompilerRegistry& Cache(CompileCache* cache);
+
+    // Compiles every language's warm-up source in a scratch directory under scratch_root.
+    [[nodiscard]] std::expected<void, std::error_code> Warmup(const std::filesystem::path& scratch_root);
+
+private:
+    std::unordered_map<std::string, std::unique_ptr<LanguageCompiler>> compilers_;
+};
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "coj/checker.h"
+#include "coj/process.h"
+
+namespace coj {
+
+struct CheckRequest {
+    std::filesystem::path input_path;
+    std::filesystem::path output_path;
+    std::filesystem::path answer_path;
+};
+
+struct CheckVerdict {
+    CheckResult result;
+
+    // Whatever the checker reported alongside the verdict; empty for the token checker.
+    std::string message;
+};
+
+// testlib exit codes, shared by both external checker modes.
+enum class CheckerCode : int32_t {
+    Ok = 0,
+    WrongAnswer = 1,
+    PresentationError = 2,
+    Fail = 3,
+    Points = 7
+};
+
+// Maps a testlib exit code to a verdict. Fail and unknown codes mean the checker itself is broken and
+// surface as std::errc::state_not_recoverable.
+[[nodiscard]] std::expected<CheckResult, std::error_code> ToCheckResult(int code);
+
+class Checker {
+public:
+    virtual ~Checker() = default;
+
+    [[nodiscard]] virtual std::expected<CheckVerdict, std::error_code> Check(const CheckRequest& request) = 0;
+};
+
+class TokenChecker : public Checker {
+public:
+    explicit TokenChecker(std::optional<double> epsilon = std::nullopt, AnswerCache* answer_cache = nullptr)
+        : epsilon_(epsilon), answer_cache_(answer_cache) {}
+
+    [[nodiscard]] std::expected<CheckVerdict, std::error_code> Check(const CheckRequest& request) override;
+
+private:
+    std::optional<double> epsilon_;
+    AnswerCache* answer_cache_;
+};
+
+struct ExternalCheckerConfig {
+    static constexpr size_t DEFAULT_MAX_MESSAGE_BYTES = 4096;
+
+    std::filesystem::path exec_path;
+    std::vector<std::string> args;
+
+    process::ResourceLimits limits;
+    std::chrono::nanoseconds timeout = std::chrono::seconds(10);
+
+    size_t max_message_bytes = DEFAULT_MAX_MESSAGE_BYTES;
+
+    // Keep one checker process alive and stream requests to it instead of spawning per check.
+    bool is_persistent = false;
+};
+
+// One-shot mode runs `exec_path args... input output answer` per check, testlib style, and takes the
+// verdict from the exit code and the message from stderr.
+//
+// Persistent mode starts the checker once with piped stdin/stdout and sends, per check, three frames
+// (input, output, answer path), each a native-endian uint32 length followed by that many bytes. The
+// checker replies with an int32 CheckerCode, a uint32 message length and the message. A checker that
+// dies or stalls is killed and restarted on the next check; a request that hit a dead process from an
+// earlier check is retried once on a fresh one. Checks against one instance are serialized.
+class ExternalChecker : public Checker {
+public:
+    explicit ExternalChecker(ExternalCheckerConfig config) : config_(std::move(config)) {}
+
+    ExternalChecker(const ExternalChecker& other) = delete;
+    ExternalChecker& operator=(const ExternalChecker& other) = delete;
+
+    ~ExternalChecker() override {
+        std::lock_guard lock(mutex_);
+        StopLocked();
+    }
+
+    [[nodiscard]] std::expected<CheckVerdict, std::error_code> Check(const CheckRequest& request) override;
+
+    const ExternalCheckerConfig& GetConfig() const noexcept { return config_; }
+
+    // Number of times the persistent process was (re)started.
+    size_t GetStartCount() const;
+
+private:
+    [[nodiscard]] std::expected<CheckVerdict, std::error_code> CheckOnce(const CheckRequest& request);
+
+    [[nodiscard]] std::expected<CheckVerdict, std::error_code> CheckPersistent(const CheckRequest& request);
+
+    [[nodiscard]] std::expected<CheckVerdict, std::error_code> Exchange(const CheckRequest& request);
+
+    [[nodiscard]] std::expected<void, std::error_code> StartLocked();
+
+    void StopLocked();
+
+    ExternalCheckerConfig config_;
+
+    mutable std::mutex mutex_;
+    std::optional<process::Child> child_;
+    size_t start_count_ = 0;
+};
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "coj/file_descriptor.h"
+#include "coj/process.h"
+
+namespace coj {
+
+struct ExecutorConfig {
+    std::filesystem::path exec_path;
+    std::vector<std::string> args;
+    std::optional<std::filesystem::path> work_dir;
+
+    process::ResourceLimits limits;
+    process::PlacementOptions placement;
+
+    size_t server_count = 1;
+};
+
+// Keeps forkservers that hold a fully prepared command for one binary. Each Execute() hands
+// stdin/stdout to an idle server over a unix socket (SCM_RIGHTS); the server spawns a fresh
+// child, reports its pidfd, and returns the wait status once it exits.
+class ExecutorPool {
+public:
+    explicit ExecutorPool(ExecutorConfig config) : config_(std::move(config)) {}
+
+    ExecutorPool(const ExecutorPool& other) = delete;
+    ExecutorPool& operator=(const ExecutorPool& other) = delete;
+
+    ~ExecutorPool() { Stop(); }
+
+    [[nodiscard]] std::expected<void, std::error_code> Start();
+
+    // Blocks until a server is idle. On timeout the child is killed and its status is still returned.
+    [[nodiscard]] std::expected<process::ExitStatus, std::error_code> Execute(
+        int stdin_fd,
+        int stdout_fd,
+        std::chrono::nanoseconds timeout
+    );
+
+    void Stop();
+
+    size_t GetLiveServerCount() const;
+
+    const ExecutorConfig& GetConfig() const noexcept { return config_; }
+
+private:
+    struct Server {
+        std::optional<process::Child> process;
+        FileDescriptor socket;
+    };
+
+    [[nodiscard]] std::expected<void, std::error_code> StartServer(Server& server);
+
+    void StopServer(Server& server);
+
+    [[nodiscard]] std::expected<process::ExitStatus, std::error_code> ExecuteOn(
+        Server& server,
+        int stdin_fd,
+        int stdout_fd,
+        std::chrono::nanoseconds timeout,
+        bool& is_server_broken
+    );
+
+    ExecutorConfig config_;
+    std::optional<process::PreparedCommand> prepared_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable idle_cv_;
+    std::vector<Server> servers_;
+    std::vector<size_t> idle_;
+    bool is_started_ = false;
+};
+
+} // namespace coj
\ No newline at end of file
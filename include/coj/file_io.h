@@ -1,10 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <expected>
 #include <span>
 #include <system_error>
 #include <vector>
 
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
 
 namespace coj {
@@ -26,6 +35,11 @@ struct [[nodiscard]] WriteResult {
     size_t bytes;
 };
 
+struct [[nodiscard]] TransferResult {
+    IoStatus status;
+    size_t bytes;
+};
+
 static constexpr int MAX_INTERRUPT_RETRY = 10;
 
 [[nodiscard]] inline std::expected<ReadResult, std::error_code> Read(int fd, std::span<std::byte> buffer) {
@@ -69,24 +83,33 @@ static constexpr int MAX_INTERRUPT_RETRY = 10;
     }
 }
 
+static constexpr size_t READ_ALL_INITIAL_CHUNK = 4096;
+static constexpr size_t READ_ALL_MAX_CHUNK = 1024 * 1024;
+
 inline std::expected<std::vector<std::byte>, std::error_code> ReadAll(int fd) {
     std::vector<std::byte> total_buf;
-    std::vector<std::byte> chunk_buf(4096);
+    size_t chunk_size = READ_ALL_INITIAL_CHUNK;
 
     while (true) {
-        auto read_result = Read(fd, chunk_buf);
-
-        if (read_result.has_value()) {
-            if (read_result->status == IoStatus::Success) {
-                total_buf.insert(total_buf.end(), chunk_buf.begin(), chunk_buf.begin() + read_result->bytes);
-            } else if (read_result->status == IoStatus::EoF) {
-                break;
-            } else if (read_result->status == IoStatus::WouldBlock) {
-                break;
-            }
-        } else {
+        size_t used = total_buf.size();
+        total_buf.resize(used + chunk_size);
+
+        auto read_result = Read(fd, std::span(total_buf).subspan(used));
+
+        if (!read_result.has_value()) {
+            total_buf.resize(used);
             return std::unexpected(read_result.error());
         }
+
+        total_buf.resize(used + read_result->bytes);
+
+        if (read_result->status != IoStatus::Success) {
+            break;
+        }
+
+        if (read_result->bytes == chunk_size && chunk_size < READ_ALL_MAX_CHUNK) {
+            chunk_size *= 2;
+        }
     }
 
     return total_buf;
@@ -161,4 +184,123 @@ inline std::expected<std::string, std::error_code> ReadAllAsString(int fd) {
     };
 }
 
+// Blocks SIGPIPE on the calling thread so that writing to a pipe without readers fails with EPIPE.
+class SigPipeGuard {
+public:
+    SigPipeGuard() noexcept {
+        sigset_t pending;
+        ::sigpending(&pending);
+        was_pending_ = ::sigismember(&pending, SIGPIPE) == 1;
+
+        sigset_t pipe_set = GetPipeSet();
+        ::pthread_sigmask(SIG_BLOCK, &pipe_set, &old_mask_);
+    }
+
+    SigPipeGuard(const SigPipeGuard& other) = delete;
+    SigPipeGuard& operator=(const SigPipeGuard& other) = delete;
+
+    ~SigPipeGuard() {
+        if (!was_pending_) {
+            sigset_t pipe_set = GetPipeSet();
+            ::timespec zero = {};
+            while (::sigtimedwait(&pipe_set, nullptr, &zero) == -1 && errno == EINTR) {}
+        }
+        ::pthread_sigmask(SIG_SETMASK, &old_mask_, nullptr);
+    }
+
+private:
+    static sigset_t GetPipeSet() noexcept {
+        sigset_t pipe_set;
+        ::sigemptyset(&pipe_set);
+        ::sigaddset(&pipe_set, SIGPIPE);
+        return pipe_set;
+    }
+
+    sigset_t old_mask_;
+    bool was_pending_ = false;
+};
+
+static constexpr size_t TRANSFER_CHUNK_SIZE = 1024 * 1024;
+
+// Moves up to max_bytes from in_fd to out_fd without a user-space copy: splice(2) when either side
+// is a pipe, sendfile(2) from regular files, and a read/write loop otherwise.
+[[nodiscard]] inline std::expected<TransferResult, std::error_code> Transfer(int in_fd, int out_fd, size_t max_bytes = SIZE_MAX) {
+    struct stat in_stat;
+    struct stat out_stat;
+    if (::fstat(in_fd, &in_stat) == -1 || ::fstat(out_fd, &out_stat) == -1) {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    }
+
+    enum class Method { Splice, SendFile, Copy };
+    Method method = Method::Copy;
+    if (S_ISFIFO(in_stat.st_mode) || S_ISFIFO(out_stat.st_mode)) {
+        method = Method::Splice;
+    } else if (S_ISREG(in_stat.st_mode)) {
+        method = Method::SendFile;
+    }
+
+    std::vector<std::byte> copy_buffer;
+    int interrupt_count = 0;
+    size_t total_bytes = 0;
+
+    while (total_bytes < max_bytes) {
+        size_t chunk = std::min(max_bytes - total_bytes, TRANSFER_CHUNK_SIZE);
+        ssize_t moved = -1;
+
+        if (method == Method::Splice) {
+            moved = ::splice(in_fd, nullptr, out_fd, nullptr, chunk, SPLICE_F_MOVE);
+        } else if (method == Method::SendFile) {
+            moved = ::sendfile(out_fd, in_fd, nullptr, chunk);
+        } else {
+            copy_buffer.resize(std::min(chunk, READ_ALL_MAX_CHUNK));
+
+            auto read_res = Read(in_fd, copy_buffer);
+            if (!read_res.has_value()) {
+                return std::unexpected(read_res.error());
+            } else if (read_res->status != IoStatus::Success) {
+                return TransferResult {
+                    .status { read_res->status },
+                    .bytes  { total_bytes },
+                };
+            }
+
+            auto write_res = Write(out_fd, std::span(copy_buffer).first(read_res->bytes));
+            if (!write_res.has_value()) {
+                return std::unexpected(write_res.error());
+            } else if (write_res->bytes != read_res->bytes) {
+                return std::unexpected(std::make_error_code(std::errc::io_error));
+            }
+
+            total_bytes += write_res->bytes;
+            continue;
+        }
+
+        if (moved > 0) {
+            total_bytes += static_cast<size_t>(moved);
+            interrupt_count = 0;
+        } else if (moved == 0) {
+            return TransferResult {
+                .status { IoStatus::EoF },
+                .bytes  { total_bytes },
+            };
+        } else if (errno == EINTR && ++interrupt_count < MAX_INTERRUPT_RETRY) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return TransferResult {
+                .status { IoStatus::WouldBlock },
+                .bytes  { total_bytes },
+            };
+        } else if (errno == EINVAL || errno == ENOSYS) {
+            method = Method::Copy;
+        } else {
+            return std::unexpected(std::error_code(errno, std::generic_category()));
+        }
+    }
+
+    return TransferResult {
+        .status { IoStatus::Success },
+        .bytes  { total_bytes },
+    };
+}
+
 } // namespace coj
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace coj {
+
+// Index of the first pair failing IsFloatEqual(answer[i], output[i], epsilon), or answer.size() if all
+// pass. Both spans must be the same length. Dispatches to the widest kernel the CPU supports; every
+// kernel performs the same IEEE operations as the scalar test, so results are bit-for-bit identical.
+[[nodiscard]] size_t FindFloatMismatch(
+    std::span<const double> answer,
+    std::span<const double> output,
+    double epsilon
+) noexcept;
+
+[[nodiscard]] size_t FindFloatMismatchScalar(
+    std::span<const double> answer,
+    std::span<const double> output,
+    double epsilon
+) noexcept;
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace coj {
+
+class Sha256 {
+public:
+    static constexpr size_t DIGEST_SIZE = 32;
+    static constexpr size_t BLOCK_SIZE = 64;
+
+    using Digest = std::array<std::uint8_t, DIGEST_SIZE>;
+
+    Sha256() noexcept { Reset(); }
+
+    void Reset() noexcept;
+
+    Sha256& Update(std::span<const std::byte> data) noexcept;
+
+    Sha256& Update(std::string_view data) noexcept {
+        return Update(std::as_bytes(std::span(data.data(), data.size())));
+    }
+
+    // Length-prefixed so that ("ab", "c") and ("a", "bc") hash differently.
+    Sha256& UpdateField(std::string_view data) noexcept;
+
+    [[nodiscard]] Digest Final() noexcept;
+
+    [[nodiscard]] std::string FinalHex();
+
+    [[nodiscard]] static std::string ToHex(const Digest& digest);
+
+private:
+    void Compress(const std::uint8_t* block) noexcept;
+
+    std::array<std::uint32_t, 8> state_;
+    std::array<std::uint8_t, BLOCK_SIZE> buffer_;
+    size_t buffer_size_;
+    std::uint64_t total_bytes_;
+};
+
+} // namespace coj
\ No newline at end of file
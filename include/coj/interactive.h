@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "coj/checker.h"
+#include "coj/process.h"
+#include "coj/runner.h"
+
+namespace coj {
+
+struct InteractiveConfig {
+    static constexpr size_t DEFAULT_TRANSCRIPT_BUFFER_BYTES = 1024 * 1024;
+    static constexpr std::chrono::milliseconds INTERACTOR_GRACE = std::chrono::milliseconds(1000);
+
+    std::filesystem::path exec_path;
+    std::filesystem::path work_dir;
+
+    RunLimits soft_limits;
+    process::ResourceLimits hard_limits;
+
+    // Applies to the solution only, as in RunConfig.
+    CgroupPool* cgroup_pool = nullptr;
+
+    // Started testlib style as `interactor input output [answer] args...`; the verdict is its exit code.
+    std::filesystem::path interactor_path;
+    std::vector<std::string> interactor_args;
+    process::ResourceLimits interactor_limits;
+
+    std::filesystem::path input_path;
+    std::filesystem::path output_path;
+    std::optional<std::filesystem::path> answer_path;
+
+    // When set, both directions are relayed through tee(2) so the peers still exchange bytes in the
+    // kernel while a copy is logged. Lines are prefixed "> " (solution) and "< " (interactor).
+    std::optional<std::filesystem::path> transcript_path;
+    size_t transcript_buffer_bytes = DEFAULT_TRANSCRIPT_BUFFER_BYTES;
+};
+
+struct InteractiveResult {
+    RunResult run_result;
+    process::ExitStatus interactor_status;
+
+    // Empty when the interactor crashed, timed out or reported Fail. The solution's run_result is
+    // still filled in, but the test cannot be judged.
+    std::optional<CheckResult> check_result;
+
+    // The interactor rejected before the solution ended; the solution's status is then usually a
+    // consequence (SIGPIPE, EOF) and the rejection is what should be reported.
+    bool is_rejected_first = false;
+
+    [[nodiscard]] bool IsAccepted() const noexcept {
+        return run_result.status == RunStatus::Success && check_result == CheckResult::Accepted;
+    }
+};
+
+// Runs the solution and the interactor with each one's stdout wired to the other's stdin. Both share
+// the solution's wall deadline; the interactor gets INTERACTOR_GRACE past it to deliver a verdict.
+// Errors are reserved for failures to set up or wait; a failed interactor leaves check_result empty.
+[[nodiscard]] std::expected<InteractiveResult, std::error_code> RunInteractive(const InteractiveConfig& config);
+
+} // namespace coj
\ No newline at end of file
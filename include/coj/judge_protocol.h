@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace coj {
+
+// Frames on the judge daemon's stream socket are a little-endian u32 payload length, a u8 type and
+// the payload. Strings are a u32 length and raw bytes, so sources and compiler output pass through
+// unescaped.
+enum class FrameType : uint8_t {
+    Batch = 1,
+    Compiled = 2,
+    Verdict = 3,
+    Done = 4,
+    Error = 5
+};
+
+enum class Verdict : uint8_t {
+    Accepted,
+    WrongAnswer,
+    TimeLimit,
+    MemoryLimit,
+    OutputLimit,
+    RuntimeError,
+    Skipped
+};
+
+struct SubmissionTest {
+    // Paths on the daemon's host, so answer files stay in its cache between jobs.
+    std::string input_path;
+    std::string answer_path;
+};
+
+struct Submission {
+    uint64_t id = 0;
+    std::string language;
+    std::string source;
+
+    uint32_t cpu_time_ms = 1000;
+    uint32_t memory_kb = 256 * 1024;
+    // Zero for no output limit.
+    uint64_t output_bytes = 0;
+
+    bool is_stopped_on_first_failure = false;
+
+    std::vector<SubmissionTest> tests;
+};
+
+struct CompiledMessage {
+    uint64_t id = 0;
+    bool is_successful = false;
+    bool is_cached = false;
+    std::string output;
+};
+
+struct VerdictMessage {
+    uint64_t id = 0;
+    uint32_t test_index = 0;
+    Verdict verdict = Verdict::Skipped;
+    uint32_t cpu_time_ms = 0;
+    uint64_t memory_kb = 0;
+    uint64_t wall_time_us = 0;
+};
+
+struct DoneMessage {
+    uint64_t id = 0;
+    uint32_t accepted_count = 0;
+    uint32_t test_count = 0;
+};
+
+struct ErrorMessage {
+    uint64_t id = 0;
+    int32_t code = 0;
+    std::string message;
+};
+
+struct Frame {
+    FrameType type;
+    std::string payload;
+};
+
+inline constexpr size_t MAX_FRAME_PAYLOAD_BYTES = 64 * 1024 * 1024;
+
+[[nodiscard]] std::string EncodeBatch(const std::vector<Submission>& submissions);
+[[nodiscard]] std::string EncodeCompiled(const CompiledMessage& message);
+[[nodiscard]] std::string EncodeVerdict(const VerdictMessage& message);
+[[nodiscard]] std::string EncodeDone(const DoneMessage& message);
+[[nodiscard]] std::string EncodeError(const ErrorMessage& message);
+
+// Payload decoders; a truncated or oversized payload fails with bad_message.
+[[nodiscard]] std::expected<std::vector<Submission>, std::error_code> DecodeBatch(std::string_view payload);
+[[nodiscard]] std::expected<CompiledMessage, std::error_code> DecodeCompiled(std::string_view payload);
+[[nodiscard]] std::expected<VerdictMessage, std::error_code> DecodeVerdict(std::string_view payload);
+[[nodiscard]] std::expected<DoneMessage, std::error_code> DecodeDone(std::string_view payload);
+[[nodiscard]] std::expected<ErrorMessage, std::error_code> DecodeError(std::string_view payload);
+
+// Blocks until a whole frame arrives. A clean end of stream before the header fails with
+// connection_aborted; a payload over MAX_FRAME_PAYLOAD_BYTES fails with message_size.
+[[nodiscard]] std::expected<Frame, std::error_code> ReadFrame(int fd);
+
+// Sends an encoded frame in full without raising SIGPIPE.
+[[nodiscard]] std::expected<void, std::error_code> WriteFrame(int fd, std::string_view frame);
+
+} // namespace coj
\ No newline at end of file
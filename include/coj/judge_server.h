@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#include "coj/file_descriptor.h"
+#include "coj/judge_protocol.h"
+
+namespace coj {
+
+class AnswerCache;
+class CgroupPool;
+class CompilerRegistry;
+class ResultStore;
+class WorkAreaPool;
+
+struct JudgeServerConfig {
+    std::filesystem::path socket_path;
+
+    // Parent of the per-submission build directories.
+    std::filesystem::path work_root;
+
+    CompilerRegistry* registry = nullptr;
+
+    // Outlive every job, so answers stay mapped and cgroups and work areas stay warm between them.
+    AnswerCache* answer_cache = nullptr;
+    CgroupPool* cgroup_pool = nullptr;
+    WorkAreaPool* work_area_pool = nullptr;
+
+    // Lets a rejudge replay every case whose binary, input and answer are unchanged.
+    ResultStore* result_store = nullptr;
+
+    // Workers per submission; connections are served concurrently on top of this.
+    size_t worker_count = 1;
+};
+
+struct JudgeServerStats {
+    size_t connection_count = 0;
+    size_t submission_count = 0;
+    size_t verdict_count = 0;
+};
+
+// Serves coj_judged over a unix stream socket. Each connection sends Batch frames and gets back, per
+// submission, one Compiled frame, a Verdict frame for every test as soon as it is judged, and a Done
+// frame, or an Error frame when the submission could not be judged at all.
+class JudgeServer {
+public:
+    explicit JudgeServer(JudgeServerConfig config) : config_(std::move(config)) {}
+
+    JudgeServer(const JudgeServer& other) = delete;
+    JudgeServer& operator=(const JudgeServer& other) = delete;
+
+    ~JudgeServer() { Stop(); }
+
+    // Replaces a stale socket file and starts accepting on a background thread.
+    [[nodiscard]] std::expected<void, std::error_code> Start();
+
+    // Stops accepting, cuts every connection and waits for jobs in flight to wind down.
+    void Stop();
+
+    JudgeServerStats GetStats() const;
+
+    const JudgeServerConfig& GetConfig() const noexcept { return config_; }
+
+private:
+    struct Connection {
+        FileDescriptor socket;
+        std::thread thread;
+        bool is_done = false;
+    };
+
+    void AcceptLoop();
+
+    void Serve(Connection& connection);
+
+    // Fails only when the client can no longer be written to.
+    [[nodiscard]] std::expected<void, std::error_code> JudgeSubmission(int fd, const Submission& submission);
+
+    void ReapConnectionsLocked();
+
+    JudgeServerConfig config_;
+
+    FileDescriptor listen_socket_;
+    FileDescriptor wake_fd_;
+    std::thread accept_thread_;
+
+    std::mutex mutex_;
+    std::list<Connection> connections_;
+    bool is_stopping_ = false;
+
+    std::atomic<size_t> next_job_id_ = 0;
+
+    std::atomic<size_t> connection_count_ = 0;
+    std::atomic<size_t> submission_count_ = 0;
+    std::atomic<size_t> verdict_count_ = 0;
+};
+
+} // namespace coj
\ No newline at end of file
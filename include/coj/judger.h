@@ -0,0 +1,131 @@
+#pragma once
+
+#include <chrono>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "coj/checker.h"
+#include "coj/custom_checker.h"
+#include "coj/runner.h"
+
+namespace coj {
+
+class MemoryFile;
+class ResultStore;
+class TestHistory;
+class WorkAreaPool;
+
+enum class EarlyExitPolicy {
+    RunAll,
+    StopOnFirstFailure
+};
+
+struct TestCase {
+    std::filesystem::path input_path;
+    std::filesystem::path answer_path;
+
+    // Replaces input_path when set; see RunConfig::input_memory.
+    const MemoryFile* input_memory = nullptr;
+
+    // Identifies the test in a TestHistory; defaults to input_path.
+    std::string key;
+};
+
+struct CaseResult;
+
+using CaseCallback = std::function<void(size_t index, const CaseResult& result)>;
+
+struct JudgeConfig {
+    std::filesystem::path exec_path;
+    std::vector<std::string> args;
+    std::vector<TestCase> test_cases;
+    std::filesystem::path work_dir;
+
+    RunLimits soft_limits;
+    process::ResourceLimits hard_limits;
+
+    // Applied to every case; placement.cpus overrides the CPU a pinned worker's children inherit.
+    process::PlacementOptions placement;
+
+    CgroupPool* cgroup_pool = nullptr;
+
+    // When set, each case runs in its own leased area, which also holds its output, instead of work_dir.
+    WorkAreaPool* work_area_pool = nullptr;
+
+    // Each worker captures output into its own memfd and checks the mapping, so outputs never reach a
+    // filesystem. Ignored with a custom checker, which needs a path.
+    bool is_output_in_memory = false;
+
+    std::optional<double> epsilon;
+    bool streaming_check = false;
+
+    // Shared by every worker; ignored by the streaming checker.
+    AnswerCache* answer_cache = nullptr;
+
+    // Replaces the token comparison (and streaming_check) when set. Must be safe to call from every worker.
+    Checker* checker = nullptr;
+
+    // Identifies the checker in result_store keys, e.g. a hash of its binary. Cases judged by a
+    // checker without one are never memoized.
+    std::string checker_key;
+
+    size_t worker_count = 1;
+    bool pin_workers = false;
+    EarlyExitPolicy early_exit = EarlyExitPolicy::RunAll;
+
+    // When set, cases run in the order ScheduleTests() picks from past results, and every judged case
+    // is recorded back. Without it cases run in file order.
+    TestHistory* history = nullptr;
+
+    // Makes early exit report what a file-order run would: cases before the first failing one by index
+    // always run, and anything judged after it is cleared from the result.
+    bool is_deterministic = false;
+
+    // When set, a case whose program, input, answer, limits and checker match a stored one takes the
+    // stored result instead of running, and every case that does run is stored.
+    ResultStore* result_store = nullptr;
+
+    // Called on a worker thread as each case finishes, before the batch completes. With deterministic
+    // StopOnFirstFailure a result could still be cleared by an earlier failure, so calls are held back
+    // and made in index order, stopping after the first failure; cleared cases are never reported.
+    CaseCallback on_case_result;
+};
+
+struct CaseResult {
+    std::optional<RunResult> run_result;
+    std::optional<CheckResult> check_result;
+    std::string checker_message;
+    std::chrono::nanoseconds wall_time{};
+
+    // Taken from a ResultStore instead of being run; wall_time is that of the original run.
+    bool is_cached = false;
+
+    [[nodiscard]] bool IsSkipped() const noexcept { return !run_result.has_value(); }
+
+    [[nodiscard]] bool IsAccepted() const noexcept {
+        return run_result.has_value() && run_result->status == RunStatus::Success &&
+               check_result == CheckResult::Accepted;
+    }
+};
+
+struct JudgeResult {
+    std::vector<CaseResult> cases;
+
+    size_t accepted_count = 0;
+    std::optional<size_t> first_failure;
+
+    std::chrono::milliseconds total_cpu_time{};
+    std::chrono::milliseconds max_cpu_time{};
+    size_t max_memory_kb = 0;
+    std::chrono::nanoseconds wall_time{};
+
+    [[nodiscard]] bool IsAccepted() const noexcept { return accepted_count == cases.size(); }
+};
+
+[[nodiscard]] std::expected<JudgeResult, std::error_code> JudgeBatch(const JudgeConfig& config);
+
+} // namespace coj
\ No newline at end of file
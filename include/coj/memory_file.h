@@ -0,0 +1,49 @@
+#pragma once
+
+#include <expected>
+#include <string_view>
+#include <system_error>
+
+#include "coj/file_descriptor.h"
+#include "coj/memory_map.h"
+
+namespace coj {
+
+// An anonymous in-memory file from memfd_create(2) that can stand in for a path as a child's stdin or
+// stdout without touching any filesystem.
+class MemoryFile {
+public:
+    // Writes data once, then seals the file against writes, growth, shrinking and further sealing, so
+    // the same file can feed any number of concurrent runs.
+    [[nodiscard]] static std::expected<MemoryFile, std::error_code> FromData(std::string_view name, std::string_view data);
+
+    // An empty, unsealed file for capturing output.
+    [[nodiscard]] static std::expected<MemoryFile, std::error_code> Create(std::string_view name);
+
+    MemoryFile(const MemoryFile& other) = delete;
+    MemoryFile& operator=(const MemoryFile& other) = delete;
+
+    MemoryFile(MemoryFile&& other) noexcept = default;
+    MemoryFile& operator=(MemoryFile&& other) noexcept = default;
+
+    int GetFd() const noexcept { return fd_.Get(); }
+
+    bool IsValid() const noexcept { return fd_.IsValid(); }
+
+    [[nodiscard]] bool IsSealed() const noexcept;
+
+    [[nodiscard]] std::expected<size_t, std::error_code> GetSize() const;
+
+    // Opens a new file description through /proc/self/fd, so every reader gets its own offset.
+    [[nodiscard]] std::expected<FileDescriptor, std::error_code> Reopen(int flags) const;
+
+    // The current contents; an empty file maps to an empty view.
+    [[nodiscard]] std::expected<MemoryMap, std::error_code> Map() const;
+
+private:
+    explicit MemoryFile(FileDescriptor fd) : fd_(std::move(fd)) {}
+
+    FileDescriptor fd_;
+};
+
+} // namespace coj
\ No newline at end of file
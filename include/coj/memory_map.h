@@ -0,0 +1,92 @@
+#pragma once
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace coj {
+
+class MemoryMap {
+public:
+    constexpr MemoryMap() noexcept = default;
+
+    MemoryMap(const MemoryMap& other) = delete;
+    MemoryMap& operator=(const MemoryMap& other) = delete;
+
+    MemoryMap(MemoryMap&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)) {}
+
+    MemoryMap& operator=(MemoryMap&& other) noexcept {
+        if (this != &other) {
+            Unmap();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~MemoryMap() { Unmap(); }
+
+    [[nodiscard]] static std::expected<MemoryMap, std::error_code> Map(int fd) {
+        struct stat st;
+        if (::fstat(fd, &st) == -1) {
+            return std::unexpected(std::error_code(errno, std::generic_category()));
+        }
+
+        if (!S_ISREG(st.st_mode)) {
+            return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+        }
+
+        return Map(fd, static_cast<size_t>(st.st_size));
+    }
+
+    [[nodiscard]] static std::expected<MemoryMap, std::error_code> Map(int fd, size_t size) {
+        MemoryMap map;
+
+        if (size == 0) {
+            return map;
+        }
+
+        void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            return std::unexpected(std::error_code(errno, std::generic_category()));
+        }
+
+        ::madvise(data, size, MADV_SEQUENTIAL);
+
+        map.data_ = data;
+        map.size_ = size;
+        return map;
+    }
+
+    void Unmap() noexcept {
+        if (data_ != nullptr) {
+            ::munmap(data_, size_);
+            data_ = nullptr;
+            size_ = 0;
+        }
+    }
+
+    std::span<const std::byte> Bytes() const noexcept {
+        return { static_cast<const std::byte*>(data_), size_ };
+    }
+
+    std::string_view View() const noexcept {
+        return { static_cast<const char*>(data_), size_ };
+    }
+
+    size_t Size() const noexcept { return size_; }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace coj
\ No newline at end of file
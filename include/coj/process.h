@@ -4,14 +4,15 @@
 
 #include <chrono>
 #include <filesystem>
+#include <memory>
 #include <optional>
 #include <string>
-#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include <sched.h>
 #include <sys/resource.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -57,6 +58,18 @@ class ExitStatus {
 public:
     friend class Child;
 
+    [[nodiscard]] static ExitStatus FromRaw(
+        int status,
+        const ::rusage& usage,
+        std::chrono::nanoseconds wall_time = std::chrono::nanoseconds::zero()
+    ) noexcept {
+        return ExitStatus(status, usage, wall_time);
+    }
+
+    [[nodiscard]] int GetRaw() const noexcept { return status_; }
+
+    [[nodiscard]] const ::rusage& GetUsage() const noexcept { return usage_; }
+
     [[nodiscard]] bool Success() const noexcept {
         return WIFEXITED(status_) && WEXITSTATUS(status_) == 0;
     }
@@ -81,35 +94,82 @@ public:
         return std::chrono::milliseconds(utime + stime);
     }
 
+    [[nodiscard]] std::chrono::microseconds GetUserTime() const noexcept {
+        return ToMicroseconds(usage_.ru_utime);
+    }
+
+    [[nodiscard]] std::chrono::microseconds GetSystemTime() const noexcept {
+        return ToMicroseconds(usage_.ru_stime);
+    }
+
+    // rusage is kept by the kernel at microsecond resolution; nothing is truncated to milliseconds.
+    [[nodiscard]] std::chrono::nanoseconds GetPreciseCpuTime() const noexcept {
+        return GetUserTime() + GetSystemTime();
+    }
+
+    // Measured from spawn to reap on a monotonic clock.
+    [[nodiscard]] std::chrono::nanoseconds GetWallTime() const noexcept { return wall_time_; }
+
     [[nodiscard]] size_t GetMaxMemoryKb() const noexcept {
         return static_cast<size_t>(usage_.ru_maxrss);
     }
 
+    [[nodiscard]] size_t GetVoluntaryContextSwitches() const noexcept {
+        return static_cast<size_t>(usage_.ru_nvcsw);
+    }
+
+    [[nodiscard]] size_t GetInvoluntaryContextSwitches() const noexcept {
+        return static_cast<size_t>(usage_.ru_nivcsw);
+    }
+
+    [[nodiscard]] size_t GetMinorPageFaults() const noexcept {
+        return static_cast<size_t>(usage_.ru_minflt);
+    }
+
+    [[nodiscard]] size_t GetMajorPageFaults() const noexcept {
+        return static_cast<size_t>(usage_.ru_majflt);
+    }
+
 private:
-    ExitStatus(int status, ::rusage usage) : status_(status), usage_(usage) {}
+    ExitStatus(int status, ::rusage usage, std::chrono::nanoseconds wall_time)
+        : status_(status), usage_(usage), wall_time_(wall_time) {}
+
+    static std::chrono::microseconds ToMicroseconds(const ::timeval& tv) noexcept {
+        return std::chrono::seconds(tv.tv_sec) + std::chrono::microseconds(tv.tv_usec);
+    }
 
     int status_ = 0;
     ::rusage usage_ = {};
+    std::chrono::nanoseconds wall_time_{};
 };
 
 class Child {
 public:
+    friend class PreparedCommand;
+
     static constexpr pid_t INVALID_PID = -1;
 
-    explicit Child(pid_t pid) : pid_(pid) {}
+    explicit Child(pid_t pid)
+        : pid_(pid), pidfd_(OpenPidFd(pid)), start_time_(std::chrono::steady_clock::now()) {}
 
     Child(const Child& other) = delete;
     Child& operator=(const Child& other) = delete;
 
     Child(Child&& other) noexcept
-        : pid_(std::exchange(other.pid_, INVALID_PID)),
-          stdin_pipe(std::move(other.stdin_pipe)),
+        : stdin_pipe(std::move(other.stdin_pipe)),
           stdout_pipe(std::move(other.stdout_pipe)),
-          stderr_pipe(std::move(other.stderr_pipe)) {}
+          stderr_pipe(std::move(other.stderr_pipe)),
+          pid_(std::exchange(other.pid_, INVALID_PID)),
+          pidfd_(std::move(other.pidfd_)),
+          init_status_(std::move(other.init_status_)),
+          start_time_(other.start_time_) {}
 
     Child& operator=(Child&& other) noexcept {
         if (this != &other) {
             pid_ = std::exchange(other.pid_, INVALID_PID);
+            pidfd_ = std::move(other.pidfd_);
+            init_status_ = std::move(other.init_status_);
+            start_time_ = other.start_time_;
             stdin_pipe = std::move(other.stdin_pipe);
             stdout_pipe = std::move(other.stdout_pipe);
             stderr_pipe = std::move(other.stderr_pipe);
@@ -136,40 +196,50 @@ public:
 
     template <typename Rep, typename Period>
     [[nodiscard]] std::expected<ExitStatus, std::error_code> WaitWithTimeout(std::chrono::duration<Rep, Period> timeout) {
-        auto start_time = std::chrono::steady_clock::now();
-
-        while (true) {
-            auto result = TryWait();
-
-            if (!result.has_value()) {
-                return std::unexpected(result.error());
-            } else if (result.value().has_value()) {
-                return result.value().value();
-            }
-
-            auto now = std::chrono::steady_clock::now();
+        return WaitFor(std::chrono::duration_cast<std::chrono::nanoseconds>(timeout));
+    }
 
-            if (now - start_time > timeout) {
-                Kill();
-                return Wait();
-            }
+    // Splices in_fd into the piped stdin until EOF or until the child stops reading, then closes the pipe.
+    [[nodiscard]] std::expected<size_t, std::error_code> FeedStdin(int in_fd);
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        }
-    }
+    // Splices the piped stdout into out_fd until the child closes it.
+    [[nodiscard]] std::expected<size_t, std::error_code> DrainStdout(int out_fd);
 
     bool IsValid() const noexcept { return pid_ > 0; }
 
     pid_t GetPid() const noexcept { return pid_; }
 
+    int GetPidFd() const noexcept { return pidfd_.Get(); }
+
+    std::chrono::steady_clock::time_point GetStartTime() const noexcept { return start_time_; }
+
     std::optional<FileDescriptor> stdin_pipe;
     std::optional<FileDescriptor> stdout_pipe;
     std::optional<FileDescriptor> stderr_pipe;
 
 private:
+    static FileDescriptor OpenPidFd(pid_t pid) noexcept;
+
+    [[nodiscard]] std::expected<ExitStatus, std::error_code> WaitBlocking();
+
+    [[nodiscard]] std::expected<ExitStatus, std::error_code> WaitFor(std::chrono::nanoseconds timeout);
+
+    [[nodiscard]] std::expected<ExitStatus, std::error_code> PollWaitFor(std::chrono::nanoseconds timeout);
+
+    // The status the init of a pid namespace forwarded for the program it ran, or the init's own.
+    int ResolveStatus(int status) const noexcept;
+
     pid_t pid_;
+    FileDescriptor pidfd_;
+
+    // Read end of the pipe the namespace init reports the program's wait status on.
+    FileDescriptor init_status_;
+
+    std::chrono::steady_clock::time_point start_time_;
 };
 
+class SandboxPlan;
+
 struct ResourceLimits {
     std::optional<rlim_t> cpu_time_sec;
 
@@ -178,6 +248,101 @@ struct ResourceLimits {
     std::optional<rlim_t> file_size_bytes;
 
     std::optional<rlim_t> process_count;
+
+    bool operator==(const ResourceLimits& other) const = default;
+};
+
+enum class HugePagePolicy {
+    Inherit,
+    Disabled
+};
+
+// Where the child runs and allocates. Each setting is kept across execve; unset ones inherit the
+// parent's.
+struct PlacementOptions {
+    // Disabled sets PR_SET_THP_DISABLE, so faults cost the same whether or not huge pages are free.
+    HugePagePolicy huge_pages = HugePagePolicy::Inherit;
+
+    // CPUs the child may run on. Ids outside the affinity mask range are dropped.
+    std::vector<int> cpus;
+
+    // Binds every allocation of the child to this node (MPOL_BIND).
+    std::optional<int> numa_node;
+
+    bool operator==(const PlacementOptions& other) const = default;
+};
+
+enum class SpawnBackend {
+    Fork,
+    VFork
+};
+
+class PreparedCommand {
+public:
+    friend class Command;
+
+    PreparedCommand(const PreparedCommand& other) = delete;
+    PreparedCommand& operator=(const PreparedCommand& other) = delete;
+
+    PreparedCommand(PreparedCommand&& other) noexcept = default;
+    PreparedCommand& operator=(PreparedCommand&& other) noexcept = default;
+
+    PreparedCommand& CurrentDir(std::filesystem::path dir) {
+        cwd_ = std::move(dir);
+        return *this;
+    }
+
+    PreparedCommand& Stdin(Stdio cfg) {
+        stdin_cfg_ = std::move(cfg);
+        return *this;
+    }
+
+    PreparedCommand& Stdout(Stdio cfg) {
+        stdout_cfg_ = std::move(cfg);
+        return *this;
+    }
+
+    PreparedCommand& Stderr(Stdio cfg) {
+        stderr_cfg_ = std::move(cfg);
+        return *this;
+    }
+
+    PreparedCommand& Limits(const ResourceLimits& limits) {
+        limits_ = limits;
+        return *this;
+    }
+
+    PreparedCommand& JoinCgroup(int cgroup_procs_fd) {
+        cgroup_procs_fd_ = cgroup_procs_fd;
+        return *this;
+    }
+
+    std::expected<Child, std::error_code> Spawn();
+
+private:
+    PreparedCommand() = default;
+
+    std::unique_ptr<char[]> arena_;
+    std::vector<char*> argv_;
+    std::vector<char*> envp_;
+
+    std::optional<std::filesystem::path> cwd_;
+
+    Stdio stdin_cfg_ = Stdio::Inherit();
+    Stdio stdout_cfg_ = Stdio::Inherit();
+    Stdio stderr_cfg_ = Stdio::Inherit();
+
+    ResourceLimits limits_;
+
+    SpawnBackend backend_ = SpawnBackend::Fork;
+
+    int cgroup_procs_fd_ = FileDescriptor::INVALID_FILE_DESCRIPTOR;
+
+    std::shared_ptr<const SandboxPlan> sandbox_;
+
+    HugePagePolicy huge_pages_ = HugePagePolicy::Inherit;
+    std::optional<cpu_set_t> cpu_set_;
+    std::optional<int> numa_node_;
 };
 
 class Command {
@@ -238,6 +403,30 @@ public:
         return *this;
     }
 
+    Command& Backend(SpawnBackend backend) {
+        backend_ = backend;
+        return *this;
+    }
+
+    Command& JoinCgroup(int cgroup_procs_fd) {
+        cgroup_procs_fd_ = cgroup_procs_fd;
+        return *this;
+    }
+
+    Command& Placement(const PlacementOptions& placement) {
+        placement_ = placement;
+        return *this;
+    }
+
+    // Runs the child in the namespaces, root and seccomp filter of a prebuilt plan. Implies the clone
+    // backend regardless of Backend().
+    Command& Sandbox(std::shared_ptr<const SandboxPlan> sandbox) {
+        sandbox_ = std::move(sandbox);
+        return *this;
+    }
+
+    [[nodiscard]] PreparedCommand Prepare() const;
+
     std::expected<Child, std::error_code> Spawn();
 
 private:
@@ -255,6 +444,14 @@ private:
     Stdio stderr_cfg_ = Stdio::Inherit();
 
     ResourceLimits limits_;
+
+    SpawnBackend backend_ = SpawnBackend::Fork;
+
+    int cgroup_procs_fd_ = FileDescriptor::INVALID_FILE_DESCRIPTOR;
+
+    std::shared_ptr<const SandboxPlan> sandbox_;
+
+    PlacementOptions placement_;
 };
 
 } // namespace process
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <sys/epoll.h>
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+
+#include "coj/capture_buffer.h"
+#include "coj/file_descriptor.h"
+#include "coj/process.h"
+
+namespace coj {
+
+class Reactor {
+public:
+    using Handler = std::function<void(std::uint32_t events)>;
+
+    static constexpr int MAX_EVENTS = 16;
+
+    [[nodiscard]] static std::expected<Reactor, std::error_code> Create();
+
+    Reactor(const Reactor& other) = delete;
+    Reactor& operator=(const Reactor& other) = delete;
+
+    Reactor(Reactor&& other) noexcept = default;
+    Reactor& operator=(Reactor&& other) noexcept = default;
+
+    [[nodiscard]] std::expected<void, std::error_code> Add(int fd, std::uint32_t events, Handler handler);
+
+    [[nodiscard]] std::expected<void, std::error_code> Modify(int fd, std::uint32_t events);
+
+    // Safe to call from inside a handler, including the handler being removed.
+    void Remove(int fd);
+
+    // Waits for one batch of events and dispatches them. Returns the number of handlers run.
+    [[nodiscard]] std::expected<size_t, std::error_code> RunOnce(std::optional<std::chrono::nanoseconds> timeout);
+
+    bool IsEmpty() const noexcept { return handlers_.empty(); }
+
+private:
+    explicit Reactor(FileDescriptor epoll_fd) : epoll_fd_(std::move(epoll_fd)) {}
+
+    FileDescriptor epoll_fd_;
+    std::unordered_map<int, std::shared_ptr<Handler>> handlers_;
+};
+
+struct CommunicateOptions {
+    static constexpr size_t UNLIMITED = std::numeric_limits<size_t>::max();
+
+    std::string_view stdin_data;
+
+    // Output past the cap is still drained, so the child never blocks on a full pipe, but is dropped.
+    size_t stdout_limit = UNLIMITED;
+    size_t stderr_limit = UNLIMITED;
+
+    // When set, the stream is kept head-and-tail in the capture instead of the result string.
+    CaptureBuffer* stdout_capture = nullptr;
+    CaptureBuffer* stderr_capture = nullptr;
+
+    std::optional<std::chrono::nanoseconds> timeout;
+};
+
+struct CommunicateResult {
+    process::ExitStatus exit_status;
+
+    std::string stdout_data;
+    std::string stderr_data;
+
+    bool is_stdout_truncated = false;
+    bool is_stderr_truncated = false;
+    bool is_timed_out = false;
+};
+
+// Feeds stdin and drains stdout/stderr of a piped child on one thread, then reaps it.
+[[nodiscard]] std::expected<CommunicateResult, std::error_code> Communicate(
+    process::Child& child,
+    const CommunicateOptions& options = {}
+);
+
+} // namespace coj
\ No newline at end of file
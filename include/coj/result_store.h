@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+
+#include "coj/answer_cache.h"
+#include "coj/judger.h"
+
+namespace coj {
+
+struct ResultStoreStats {
+    size_t hit_count = 0;
+    size_t miss_count = 0;
+    size_t store_count = 0;
+    size_t eviction_count = 0;
+
+    // Hits handed back as misses so the case is run again and compared.
+    size_t verification_count = 0;
+    size_t mismatch_count = 0;
+
+    size_t entry_count = 0;
+};
+
+// Judged cases keyed by everything that decides their verdict: the program, the input, the answer,
+// the limits and the checker. A rejudge then only runs the cases whose key changed. Safe to share
+// between concurrent batches.
+class ResultStore {
+public:
+    // verify_every > 0 turns every Nth hit into a miss, so the case runs again and the new result is
+    // compared in Store(). A key whose verdicts disagree is never served again.
+    explicit ResultStore(size_t max_entries, size_t verify_every = 0)
+        : max_entries_(max_entries), verify_every_(verify_every) {}
+
+    ResultStore(const ResultStore& other) = delete;
+    ResultStore& operator=(const ResultStore& other) = delete;
+
+    // Returned results have is_cached set.
+    [[nodiscard]] std::optional<CaseResult> Lookup(const std::string& key);
+
+    // Skipped results are ignored.
+    void Store(const std::string& key, const CaseResult& result);
+
+    // Hex SHA-256 of a file's contents, rehashed only when its inode, size or mtime change.
+    [[nodiscard]] std::expected<std::string, std::error_code> HashFile(const std::filesystem::path& path);
+
+    ResultStoreStats GetStats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        CaseResult result;
+        bool is_nondeterministic = false;
+    };
+
+    struct FileHash {
+        FileIdentity identity;
+        std::string digest;
+    };
+
+    void EvictLocked();
+
+    size_t max_entries_;
+    size_t verify_every_;
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    std::unordered_map<std::string, FileHash> file_hashes_;
+    ResultStoreStats stats_;
+};
+
+// Covers the program, its arguments (with work_dir masked, plus the contents of any file or
+// directory they name), the limits, how they are enforced and the checker.
+[[nodiscard]] std::expected<std::string, std::error_code> GetExecutableKey(ResultStore& store, const JudgeConfig& config);
+
+// The key of one case of a batch, or an error when a file it depends on cannot be hashed. exec_key
+// comes from GetExecutableKey() and is shared by every case of the batch.
+[[nodiscard]] std::expected<std::string, std::error_code> GetCaseKey(
+    ResultStore& store,
+    const JudgeConfig& config,
+    const std::string& exec_key,
+    size_t index
+);
+
+} // namespace coj
\ No newline at end of file
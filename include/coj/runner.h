@@ -1,9 +1,16 @@
 #pragma once
 
+#include <functional>
+#include <string_view>
+
+#include "coj/cgroup.h"
+#include "coj/executor_pool.h"
 #include "coj/process.h"
 
 namespace coj {
 
+class MemoryFile;
+
 enum class RunStatus {
     Success,
     RuntimeError,
@@ -12,26 +19,114 @@ enum class RunStatus {
     OutputLimit
 };
 
+// Slack on top of the CPU limit for startup and scheduling delays, used when no wall_time is set.
+inline constexpr std::chrono::milliseconds DEFAULT_WALL_TIME_MARGIN{ 1000 };
+
 struct RunLimits {
     std::chrono::milliseconds cpu_time;
     size_t memory_kb;
+
+    // Wall-clock deadline enforced independently of the CPU limit. Defaults to cpu_time plus
+    // DEFAULT_WALL_TIME_MARGIN.
+    std::optional<std::chrono::milliseconds> wall_time;
+
+    // Bytes of stdout allowed before the child is killed with an OutputLimit verdict. File outputs get
+    // RLIMIT_FSIZE, piped outputs are counted as they are read.
+    std::optional<size_t> output_bytes;
 };
 
+using OutputObserver = std::function<std::expected<bool, std::error_code>(std::string_view chunk)>;
+
 struct RunConfig {
     std::filesystem::path exec_path;
+
+    // Passed after exec_path, e.g. a LanguageCompiler's rendered run command.
+    std::vector<std::string> args;
+
     std::filesystem::path input_path;
     std::filesystem::path output_path;
+
+    // The child's working directory when set, e.g. a WorkArea from a WorkAreaPool.
     std::filesystem::path work_dir;
 
+    // Replace input_path and output_path when set. A sealed input can be shared by concurrent runs;
+    // the output file is truncated at the start of every run.
+    const MemoryFile* input_memory = nullptr;
+    MemoryFile* output_memory = nullptr;
+
     RunLimits soft_limits;
     process::ResourceLimits hard_limits;
+
+    process::PlacementOptions placement;
+
+    CgroupPool* cgroup_pool = nullptr;
+
+    // Used when neither cgroup_pool nor output_observer is set. Its servers are prepared in advance, so
+    // exec_path, args, work_dir and placement must match its ExecutorConfig, or Run() fails with
+    // invalid_argument. So must hard_limits, with file_size_bytes capped at output_bytes + 1 when
+    // output_bytes is set.
+    ExecutorPool* executor_pool = nullptr;
+
+    OutputObserver output_observer;
 };
 
 struct RunResult {
     RunStatus status;
     process::ExitStatus exit_status;
+
+    std::optional<CgroupStats> cgroup_stats;
+
+    // The observer asked to stop and the child was killed. exit_status is left as reaped; the SIGKILL
+    // this sends is not held against the run by ClassifyRun.
+    bool is_stopped_by_observer = false;
+    bool is_wall_time_exceeded = false;
+    bool is_output_limit_exceeded = false;
+
+    // Stdout bytes produced; at most one read chunk past the budget when the limit was exceeded.
+    size_t output_bytes = 0;
+
+    [[nodiscard]] std::chrono::nanoseconds GetPreciseCpuTime() const noexcept {
+        if (cgroup_stats.has_value()) {
+            return cgroup_stats->cpu_usage;
+        }
+        return exit_status.GetPreciseCpuTime();
+    }
+
+    [[nodiscard]] std::chrono::milliseconds GetCpuTime() const noexcept {
+        if (cgroup_stats.has_value()) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(cgroup_stats->cpu_usage);
+        }
+        return exit_status.GetCpuTime();
+    }
+
+    // Faults taken by the child itself; a high count against the CPU time points at allocation rather
+    // than the algorithm.
+    [[nodiscard]] size_t GetMinorPageFaults() const noexcept { return exit_status.GetMinorPageFaults(); }
+
+    [[nodiscard]] size_t GetMajorPageFaults() const noexcept { return exit_status.GetMajorPageFaults(); }
+
+    [[nodiscard]] size_t GetMaxMemoryKb() const noexcept {
+        if (cgroup_stats.has_value() && cgroup_stats->memory_peak_bytes.has_value()) {
+            return cgroup_stats->memory_peak_bytes.value() / 1024;
+        }
+        return exit_status.GetMaxMemoryKb();
+    }
 };
 
+[[nodiscard]] std::chrono::nanoseconds GetWallTimeout(const RunConfig& config);
+
+[[nodiscard]] RunStatus ClassifyRun(const RunResult& result, const RunConfig& config);
+
+// Applies hard_limits to command. With a cgroup_pool, the memory and process limits go to a cgroup
+// from the pool, which the child joins, instead of to rlimits.
+[[nodiscard]] std::expected<std::optional<Cgroup>, std::error_code> AttachCgroup(
+    process::Command& command,
+    const RunConfig& config
+);
+
+// Kills whatever is left in the cgroup, reads its accounting and hands it back to the pool.
+std::optional<CgroupStats> ReleaseCgroup(std::optional<Cgroup>& cgroup, const RunConfig& config);
+
 [[nodiscard]] std::expected<RunResult, std::error_code> Run(const RunConfig& config); 
 
 } // namespace coj
\ No newline at end of file
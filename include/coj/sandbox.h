@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cerrno>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <linux/filter.h>
+#include <sys/types.h>
+
+namespace coj {
+
+namespace process {
+
+enum class SeccompAction {
+    Kill,
+    Errno
+};
+
+struct SeccompPolicy {
+    // Tested in order, so the hottest syscalls should come first.
+    std::vector<int> allowed_syscalls;
+
+    SeccompAction default_action = SeccompAction::Kill;
+
+    int errno_value = EPERM;
+
+    // Enough for a statically or dynamically linked single-threaded C++ solution reading stdin and
+    // writing stdout. execve is included because the filter is installed before the exec.
+    [[nodiscard]] static SeccompPolicy Default();
+};
+
+// A seccomp-bpf program compiled once from a policy; the child only hands the prebuilt program to
+// the kernel, so installing it costs a single syscall per spawn.
+class SeccompFilter {
+public:
+    [[nodiscard]] static std::expected<std::shared_ptr<const SeccompFilter>, std::error_code> Compile(const SeccompPolicy& policy);
+
+    SeccompFilter(const SeccompFilter& other) = delete;
+    SeccompFilter& operator=(const SeccompFilter& other) = delete;
+
+    const ::sock_fprog* GetProgram() const noexcept { return &program_; }
+
+    size_t GetInstructionCount() const noexcept { return instructions_.size(); }
+
+private:
+    explicit SeccompFilter(std::vector<::sock_filter> instructions);
+
+    std::vector<::sock_filter> instructions_;
+    ::sock_fprog program_;
+};
+
+struct BindMount {
+    std::filesystem::path source;
+
+    // Relative to the sandbox root.
+    std::filesystem::path target;
+
+    bool is_read_only = true;
+};
+
+struct SandboxConfig {
+    bool is_user_ns = true;
+    bool is_mount_ns = true;
+
+    // The program runs as pid 2 under a small reaper, since a namespace init ignores default-action
+    // signals such as SIGXCPU and SIGABRT. Its wait status is forwarded to Child::Wait().
+    bool is_pid_ns = true;
+    bool is_net_ns = true;
+
+    // Ids the child sees inside its user namespace; its own uid and gid map onto them.
+    uid_t inside_uid = 65534;
+    gid_t inside_gid = 65534;
+
+    // Becomes "/" for the child and is remounted read-only. Requires a mount namespace.
+    std::optional<std::filesystem::path> rootfs;
+
+    // Mounted under rootfs before the pivot. Targets must already exist there.
+    std::vector<BindMount> binds;
+
+    // Mounts a fresh procfs at rootfs/proc, which needs a pid namespace.
+    bool is_proc_mounted = false;
+
+    std::shared_ptr<const SeccompFilter> seccomp;
+};
+
+// Everything the child needs for isolation, rendered up front so applying it between clone and exec
+// neither allocates nor formats. Build one per configuration and share it across commands.
+class SandboxPlan {
+public:
+    [[nodiscard]] static std::expected<std::shared_ptr<const SandboxPlan>, std::error_code> Build(const SandboxConfig& config);
+
+    SandboxPlan(const SandboxPlan& other) = delete;
+    SandboxPlan& operator=(const SandboxPlan& other) = delete;
+
+    int GetCloneFlags() const noexcept { return clone_flags_; }
+
+    // Called in the child only; uses async-signal-safe syscalls. Returns 0 or an errno value.
+    int Enter() const noexcept;
+
+    // Called in the child right before exec, after any syscall the launcher itself still needs.
+    int Lock() const noexcept;
+
+private:
+    struct Mount {
+        std::string source;
+        std::string target;
+        bool is_read_only;
+    };
+
+    SandboxPlan() = default;
+
+    int clone_flags_ = 0;
+
+    std::string uid_map_;
+    std::string gid_map_;
+
+    std::optional<std::string> rootfs_;
+    std::vector<Mount> mounts_;
+    std::optional<std::string> proc_target_;
+
+    std::shared_ptr<const SeccompFilter> seccomp_;
+};
+
+} // namespace process
+
+} // namespace coj
\ No newline at end of file
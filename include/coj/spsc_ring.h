@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <span>
+
+namespace coj {
+
+// Lock-free byte ring for exactly one producer thread and one consumer thread. Capacity is rounded up
+// to a power of two; indices run freely and are masked on access.
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity)
+        : capacity_(std::bit_ceil(std::max<size_t>(capacity, 2))),
+          mask_(capacity_ - 1),
+          data_(std::make_unique<char[]>(capacity_)) {}
+
+    SpscRing(const SpscRing& other) = delete;
+    SpscRing& operator=(const SpscRing& other) = delete;
+
+    // Producer side. Returns how many bytes fit; the rest must be retried.
+    size_t TryPush(std::span<const char> bytes) noexcept {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t tail = tail_.load(std::memory_order_acquire);
+
+        size_t count = std::min(bytes.size(), capacity_ - (head - tail));
+        size_t offset = head & mask_;
+        size_t first = std::min(count, capacity_ - offset);
+        std::memcpy(data_.get() + offset, bytes.data(), first);
+        std::memcpy(data_.get(), bytes.data() + first, count - first);
+
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side.
+    size_t TryPop(std::span<char> out) noexcept {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+
+        size_t count = std::min(out.size(), head - tail);
+        size_t offset = tail & mask_;
+        size_t first = std::min(count, capacity_ - offset);
+        std::memcpy(out.data(), data_.get() + offset, first);
+        std::memcpy(out.data() + first, data_.get(), count - first);
+
+        tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Set by the producer after its final push.
+    void Close() noexcept { is_closed_.store(true, std::memory_order_release); }
+
+    bool IsClosed() const noexcept { return is_closed_.load(std::memory_order_acquire); }
+
+    bool IsEmpty() const noexcept {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    size_t GetCapacity() const noexcept { return capacity_; }
+
+private:
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<char[]> data_;
+
+    alignas(64) std::atomic<size_t> head_ = 0;
+    alignas(64) std::atomic<size_t> tail_ = 0;
+    alignas(64) std::atomic<bool> is_closed_ = false;
+};
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "coj/checker.h"
+#include "coj/runner.h"
+#include "coj/tokenizer.h"
+
+namespace coj {
+
+class StreamingChecker {
+public:
+    static constexpr size_t OUTPUT_SLACK_BYTES = 1024 * 1024;
+
+    [[nodiscard]] static std::expected<StreamingChecker, std::error_code> Create(
+        const std::filesystem::path& answer_path,
+        std::optional<double> epsilon
+    );
+
+    [[nodiscard]] std::expected<bool, std::error_code> Feed(std::string_view chunk);
+
+    [[nodiscard]] std::expected<CheckResult, std::error_code> Finish();
+
+    size_t GetOutputBytes() const noexcept { return output_bytes_; }
+
+    size_t GetOutputLimit() const noexcept { return output_limit_; }
+
+private:
+    StreamingChecker(TokenReader answer_reader, std::optional<double> epsilon, size_t output_limit)
+        : answer_reader_(std::move(answer_reader)), epsilon_(epsilon), output_limit_(output_limit) {}
+
+    [[nodiscard]] std::expected<bool, std::error_code> MatchToken(std::string_view token);
+
+    TokenReader answer_reader_;
+    std::optional<double> epsilon_;
+
+    std::string partial_token_;
+    size_t output_bytes_ = 0;
+    size_t output_limit_;
+    bool is_mismatched_ = false;
+};
+
+struct StreamingRunResult {
+    RunResult run_result;
+    std::optional<CheckResult> check_result;
+    bool is_terminated_early = false;
+};
+
+[[nodiscard]] std::expected<StreamingRunResult, std::error_code> RunAndCheck(
+    const RunConfig& run_config,
+    const CheckConfig& check_config
+);
+
+} // namespace coj
\ No newline at end of file
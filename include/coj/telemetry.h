@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef COJ_ENABLE_TELEMETRY
+#define COJ_ENABLE_TELEMETRY 0
+#endif
+
+namespace coj {
+
+namespace telemetry {
+
+enum class Phase : uint8_t {
+    Compile,
+    Fork,
+    Exec,
+    Wait,
+    FirstOutput,
+    Run,
+    Check
+};
+
+inline constexpr size_t PHASE_COUNT = 7;
+
+inline constexpr size_t THREAD_BUFFER_CAPACITY = 4096;
+
+// Rings allocated when recording is first enabled. A ring goes back to the pool when its thread exits,
+// so this caps live recording threads, not the threads ever seen.
+inline constexpr size_t MAX_THREAD_BUFFERS = 64;
+
+// Upper bounds of the duration histogram, in seconds; an implicit +Inf bucket follows.
+inline constexpr std::array<double, 12> HISTOGRAM_BUCKETS = {
+    10e-6, 50e-6, 100e-6, 500e-6, 1e-3, 5e-3, 10e-3, 50e-3, 100e-3, 500e-3, 1.0, 10.0
+};
+
+[[nodiscard]] std::string_view ToString(Phase phase) noexcept;
+
+struct Span {
+    Phase phase;
+    uint32_t thread_id;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::nanoseconds duration;
+};
+
+// Recording is off until enabled; while off, every probe is a single relaxed load. The first enable
+// allocates the ring pool, which may throw std::bad_alloc.
+void SetEnabled(bool is_enabled);
+
+[[nodiscard]] bool IsEnabled() noexcept;
+
+// Turns every probe on the calling thread into a no-op for the rest of its life. For processes forked
+// from a multithreaded parent, where reaching the registry lock could deadlock and nothing would ever
+// drain the spans.
+void SuppressCurrentThread() noexcept;
+
+// The epoch when recording is off, which Record() ignores, so a disabled probe never reads the clock.
+[[nodiscard]] std::chrono::steady_clock::time_point Now() noexcept;
+
+// Appends to the calling thread's ring and updates the global histograms. Never allocates, and never
+// blocks after the thread's first span, which takes a ring from the pool. Spans that find the ring
+// full, or that come from a thread which found the pool empty, are dropped and counted.
+void Record(Phase phase, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) noexcept;
+
+// Moves every buffered span out of all thread rings, including those of threads that have exited.
+[[nodiscard]] std::vector<Span> Drain();
+
+[[nodiscard]] size_t GetDroppedCount() noexcept;
+
+// Chrome trace event format ("X" events); loads in chrome://tracing and Perfetto.
+[[nodiscard]] std::string ToChromeTrace(std::span<const Span> spans);
+
+// Prometheus text exposition of the cumulative per-phase histograms.
+[[nodiscard]] std::string ToPrometheus();
+
+// Clears histograms and drops buffered spans.
+void Reset();
+
+class ScopedSpan {
+public:
+    explicit ScopedSpan(Phase phase) noexcept : phase_(phase), start_(Now()) {}
+
+    ScopedSpan(const ScopedSpan& other) = delete;
+    ScopedSpan& operator=(const ScopedSpan& other) = delete;
+
+    ~ScopedSpan() { Record(phase_, start_, Now()); }
+
+private:
+    Phase phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace telemetry
+
+} // namespace coj
+
+#define COJ_TRACE_CONCAT_IMPL(a, b) a##b
+#define COJ_TRACE_CONCAT(a, b) COJ_TRACE_CONCAT_IMPL(a, b)
+
+#if COJ_ENABLE_TELEMETRY
+#define COJ_TRACE_SCOPE(phase) \
+    ::coj::telemetry::ScopedSpan COJ_TRACE_CONCAT(coj_trace_span_, __LINE__)(::coj::telemetry::Phase::phase)
+#define COJ_TRACE_BEGIN(name) const auto name = ::coj::telemetry::Now()
+#define COJ_TRACE_END(phase, start) \
+    ::coj::telemetry::Record(::coj::telemetry::Phase::phase, start, ::coj::telemetry::Now())
+#define COJ_TRACE_RECORD(phase, start, end) ::coj::telemetry::Record(::coj::telemetry::Phase::phase, start, end)
+#else
+#define COJ_TRACE_SCOPE(phase) static_cast<void>(0)
+#define COJ_TRACE_BEGIN(name) static_cast<void>(0)
+#define COJ_TRACE_END(phase, start) static_cast<void>(0)
+#define COJ_TRACE_RECORD(phase, start, end) static_cast<void>(0)
+#endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace coj {
+
+struct CaseResult;
+
+struct TestEstimate {
+    double failure_probability = 0.5;
+    std::chrono::nanoseconds cost{ 1 };
+};
+
+// Orders tests so the ones most likely to fail per unit of cost run first, while every test is
+// started early enough that it alone does not stretch the batch past its per-worker share. With one
+// worker this is plain fail-fast order; equal estimates keep file order.
+[[nodiscard]] std::vector<size_t> ScheduleTests(std::span<const TestEstimate> estimates, size_t worker_count);
+
+struct TestStats {
+    size_t run_count = 0;
+    size_t failure_count = 0;
+
+    // Exponentially weighted, so a test whose cost changes is relearned within a few runs.
+    std::chrono::nanoseconds mean_wall_time{};
+};
+
+// Failure rates and run times of tests across submissions, keyed by a caller-chosen test id.
+// Safe to share between concurrent batches.
+class TestHistory {
+public:
+    static constexpr double COST_WEIGHT = 0.3;
+
+    void Record(std::string_view key, const CaseResult& result);
+
+    [[nodiscard]] std::optional<TestStats> Get(std::string_view key) const;
+
+    // Laplace-smoothed failure rate. A test never seen before costs the mean of the known ones.
+    [[nodiscard]] std::vector<TestEstimate> Estimate(std::span<const std::string> keys) const;
+
+    [[nodiscard]] std::vector<size_t> Schedule(std::span<const std::string> keys, size_t worker_count) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, TestStats> stats_;
+};
+
+} // namespace coj
\ No newline at end of file
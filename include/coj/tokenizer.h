@@ -0,0 +1,52 @@
+#pragma once
+
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "coj/file_descriptor.h"
+#include "coj/memory_map.h"
+
+namespace coj {
+
+[[nodiscard]] constexpr bool IsWhitespace(char c) noexcept {
+    return c == ' ' || (static_cast<unsigned char>(c) - 9u) <= 4u;
+}
+
+[[nodiscard]] const char* SkipWhitespace(const char* first, const char* last) noexcept;
+
+[[nodiscard]] const char* FindWhitespace(const char* first, const char* last) noexcept;
+
+class TokenReader {
+public:
+    static constexpr size_t STREAM_BUFFER_SIZE = 64 * 1024;
+
+    [[nodiscard]] static std::expected<TokenReader, std::error_code> Open(const std::filesystem::path& path);
+
+    [[nodiscard]] static std::expected<TokenReader, std::error_code> FromFd(FileDescriptor fd);
+
+    [[nodiscard]] static TokenReader FromView(std::string_view view);
+
+    // The returned view stays valid until the next call to Next().
+    [[nodiscard]] std::expected<std::optional<std::string_view>, std::error_code> Next();
+
+    bool IsStreaming() const noexcept { return fd_.IsValid(); }
+
+private:
+    TokenReader() = default;
+
+    [[nodiscard]] std::expected<void, std::error_code> Refill();
+
+    FileDescriptor fd_;
+    MemoryMap map_;
+
+    std::vector<char> buffer_;
+    const char* cursor_ = nullptr;
+    const char* end_ = nullptr;
+    bool is_eof_ = false;
+};
+
+} // namespace coj
\ No newline at end of file
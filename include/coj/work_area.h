@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "coj/file_descriptor.h"
+
+namespace coj {
+
+// Mounts a tmpfs capped at size_bytes on dir. Needs CAP_SYS_ADMIN in the current mount namespace.
+[[nodiscard]] std::expected<void, std::error_code> MountTmpfs(const std::filesystem::path& dir, size_t size_bytes);
+
+// A scratch directory leased to one run. The directory fd is held open so resets never resolve the
+// path again.
+class WorkArea {
+public:
+    [[nodiscard]] static std::expected<WorkArea, std::error_code> Create(std::filesystem::path path);
+
+    WorkArea(const WorkArea& other) = delete;
+    WorkArea& operator=(const WorkArea& other) = delete;
+
+    WorkArea(WorkArea&& other) noexcept = default;
+
+    // Removes the directory this area owned before taking over other's.
+    WorkArea& operator=(WorkArea&& other) noexcept;
+
+    ~WorkArea() { (void)Remove(); }
+
+    const std::filesystem::path& GetPath() const noexcept { return path_; }
+
+    int GetFd() const noexcept { return dir_fd_.Get(); }
+
+    bool IsValid() const noexcept { return dir_fd_.IsValid(); }
+
+    // Empties the directory in place: entries are unlinked relative to their parent fd, and only
+    // subdirectories are opened.
+    [[nodiscard]] std::expected<void, std::error_code> Reset();
+
+    [[nodiscard]] std::expected<void, std::error_code> Remove();
+
+private:
+    WorkArea(std::filesystem::path path, FileDescriptor dir_fd)
+        : path_(std::move(path)), dir_fd_(std::move(dir_fd)) {}
+
+    std::filesystem::path path_;
+    FileDescriptor dir_fd_;
+};
+
+class WorkAreaPool {
+public:
+    WorkAreaPool(std::filesystem::path parent_dir, size_t capacity, std::string prefix = "coj")
+        : parent_dir_(std::move(parent_dir)), prefix_(std::move(prefix)), capacity_(capacity) {}
+
+    WorkAreaPool(const WorkAreaPool& other) = delete;
+    WorkAreaPool& operator=(const WorkAreaPool& other) = delete;
+
+    ~WorkAreaPool();
+
+    // Backs every area with a size-capped tmpfs on parent_dir, which is unmounted with the pool.
+    // Must be called before Reserve().
+    [[nodiscard]] std::expected<void, std::error_code> MountTmpfs(size_t quota_bytes);
+
+    [[nodiscard]] std::expected<void, std::error_code> Reserve();
+
+    [[nodiscard]] std::expected<WorkArea, std::error_code> Acquire();
+
+    // Resets the area and keeps it for the next run; an area that cannot be emptied is dropped.
+    void Release(WorkArea area);
+
+    size_t GetIdleCount() const;
+
+    bool IsTmpfsMounted() const noexcept { return is_tmpfs_mounted_; }
+
+    const std::filesystem::path& GetParentDir() const noexcept { return parent_dir_; }
+
+private:
+    [[nodiscard]] std::expected<WorkArea, std::error_code> CreateArea();
+
+    std::filesystem::path parent_dir_;
+    std::string prefix_;
+    size_t capacity_;
+    bool is_tmpfs_mounted_ = false;
+
+    mutable std::mutex mutex_;
+    std::vector<WorkArea> idle_;
+    size_t next_id_ = 0;
+};
+
+} // namespace coj
\ No newline at end of file
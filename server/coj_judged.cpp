@@ -0,0 +1,213 @@
+#include <signal.h>
+
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "coj/answer_cache.h"
+#include "coj/cgroup.h"
+#include "coj/compile_cache.h"
+#include "coj/compiler_registry.h"
+#include "coj/judge_server.h"
+#include "coj/result_store.h"
+#include "coj/work_area.h"
+
+namespace {
+
+constexpr const char* USAGE =
+    "usage: coj_judged --socket PATH --languages FILE --work-root DIR\n"
+    "                  [--workers N] [--compile-cache DIR] [--compile-cache-mb N]\n"
+    "                  [--answer-cache-mb N] [--work-areas N]\n"
+    "                  [--cgroup-parent DIR] [--cgroups N] [--cpu-cores N]\n"
+    "                  [--result-store N] [--verify-every N]\n";
+
+struct Options {
+    std::filesystem::path socket_path;
+    std::filesystem::path languages_path;
+    std::filesystem::path work_root;
+
+    size_t worker_count = 1;
+
+    std::optional<std::filesystem::path> compile_cache_dir;
+    size_t compile_cache_mb = 1024;
+
+    size_t answer_cache_mb = 512;
+
+    size_t work_area_count = 0;
+
+    std::optional<std::filesystem::path> cgroup_parent;
+    // Defaults to one per worker, the most runs a batch has in flight.
+    std::optional<size_t> cgroup_count;
+
+    // 0 leaves cpu.max unlimited.
+    size_t cpu_cores = 0;
+
+    size_t result_store_entries = 0;
+    size_t verify_every = 0;
+};
+
+bool ParseSize(std::string_view value, size_t& out) {
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), out);
+    return ec == std::errc() && ptr == value.data() + value.size();
+}
+
+std::optional<Options> ParseOptions(int argc, char** argv) {
+    Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view flag = argv[i];
+        if (i + 1 >= argc) {
+            return std::nullopt;
+        }
+        std::string_view value = argv[++i];
+
+        bool is_valid = true;
+        if (flag == "--socket") {
+            options.socket_path = value;
+        } else if (flag == "--languages") {
+            options.languages_path = value;
+        } else if (flag == "--work-root") {
+            options.work_root = value;
+        } else if (flag == "--workers") {
+            is_valid = ParseSize(value, options.worker_count);
+        } else if (flag == "--compile-cache") {
+            options.compile_cache_dir = value;
+        } else if (flag == "--compile-cache-mb") {
+            is_valid = ParseSize(value, options.compile_cache_mb);
+        } else if (flag == "--answer-cache-mb") {
+            is_valid = ParseSize(value, options.answer_cache_mb);
+        } else if (flag == "--work-areas") {
+            is_valid = ParseSize(value, options.work_area_count);
+        } else if (flag == "--cgroup-parent") {
+            options.cgroup_parent = value;
+        } else if (flag == "--cgroups") {
+            is_valid = ParseSize(value, options.cgroup_count.emplace());
+        } else if (flag == "--cpu-cores") {
+            is_valid = ParseSize(value, options.cpu_cores);
+        } else if (flag == "--result-store") {
+            is_valid = ParseSize(value, options.result_store_entries);
+        } else if (flag == "--verify-every") {
+            is_valid = ParseSize(value, options.verify_every);
+        } else {
+            is_valid = false;
+        }
+
+        if (!is_valid) {
+            return std::nullopt;
+        }
+    }
+
+    if (options.socket_path.empty() || options.languages_path.empty() || options.work_root.empty()) {
+        return std::nullopt;
+    }
+    return options;
+}
+
+int Fail(const char* what, std::error_code ec) {
+    std::fprintf(stderr, "coj_judged: %s: %s\n", what, ec.message().c_str());
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    constexpr size_t MB = 1024 * 1024;
+
+    auto options = ParseOptions(argc, argv);
+    if (!options.has_value()) {
+        std::fputs(USAGE, stderr);
+        return 2;
+    }
+
+    // Blocked before any thread starts, so only the sigwait below ever sees them.
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    ::pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+
+    auto registry = coj::CompilerRegistry::Load(options->languages_path);
+    if (!registry.has_value()) {
+        return Fail("loading languages", registry.error());
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(options->work_root, ec);
+    if (ec) {
+        return Fail("creating work root", ec);
+    }
+
+    std::unique_ptr<coj::CompileCache> compile_cache;
+    if (options->compile_cache_dir.has_value()) {
+        compile_cache = std::make_unique<coj::CompileCache>(*options->compile_cache_dir, options->compile_cache_mb * MB);
+        if (auto res = compile_cache->Load(); !res.has_value()) {
+            return Fail("loading compile cache", res.error());
+        }
+        registry->Cache(compile_cache.get());
+    }
+
+    if (auto res = registry->Warmup(options->work_root); !res.has_value()) {
+        return Fail("warming up compilers", res.error());
+    }
+
+    coj::AnswerCache answer_cache(options->answer_cache_mb * MB);
+
+    std::unique_ptr<coj::WorkAreaPool> work_area_pool;
+    if (options->work_area_count > 0) {
+        auto areas_dir = options->work_root / "areas";
+        std::filesystem::create_directories(areas_dir, ec);
+        work_area_pool = std::make_unique<coj::WorkAreaPool>(areas_dir, options->work_area_count, "coj-judged");
+        if (auto res = work_area_pool->Reserve(); !res.has_value()) {
+            return Fail("reserving work areas", res.error());
+        }
+    }
+
+    std::unique_ptr<coj::CgroupPool> cgroup_pool;
+    if (options->cgroup_parent.has_value()) {
+        auto cpu_cores = options->cpu_cores > 0 ? std::optional(static_cast<double>(options->cpu_cores)) : std::nullopt;
+        cgroup_pool = std::make_unique<coj::CgroupPool>(
+            *options->cgroup_parent,
+            options->cgroup_count.value_or(options->worker_count),
+            "coj-judged",
+            cpu_cores
+        );
+        if (auto res = cgroup_pool->Reserve(); !res.has_value()) {
+            return Fail("reserving cgroups", res.error());
+        }
+    }
+
+    std::unique_ptr<coj::ResultStore> result_store;
+    if (options->result_store_entries > 0) {
+        result_store = std::make_unique<coj::ResultStore>(options->result_store_entries, options->verify_every);
+    }
+
+    coj::JudgeServer server(coj::JudgeServerConfig{
+        .socket_path = options->socket_path,
+        .work_root = options->work_root / "jobs",
+        .registry = &*registry,
+        .answer_cache = &answer_cache,
+        .cgroup_pool = cgroup_pool.get(),
+        .work_area_pool = work_area_pool.get(),
+        .result_store = result_store.get(),
+        .worker_count = options->worker_count
+    });
+
+    if (auto res = server.Start(); !res.has_value()) {
+        return Fail("starting server", res.error());
+    }
+
+    int signal = 0;
+    ::sigwait(&stop_signals, &signal);
+
+    server.Stop();
+
+    auto stats = server.GetStats();
+    std::fprintf(stderr, "coj_judged: served %zu connections, %zu submissions, %zu verdicts\n",
+        stats.connection_count, stats.submission_count, stats.verdict_count);
+
+    return 0;
+}
\ No newline at end of file
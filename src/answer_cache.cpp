@@ -0,0 +1,169 @@
+#include <sys/stat.h>
+
+#include <limits>
+
+#include "coj/answer_cache.h"
+#include "coj/checker.h"
+#include "coj/file_io.h"
+#include "coj/tokenizer.h"
+
+namespace coj {
+
+namespace {
+
+FileIdentity ToFileIdentity(const struct stat& st) noexcept {
+    return FileIdentity{
+        .device = st.st_dev,
+        .inode = st.st_ino,
+        .size = st.st_size,
+        .mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec
+    };
+}
+
+} // namespace
+
+std::expected<FileIdentity, std::error_code> GetFileIdentity(const std::filesystem::path& path) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) == -1) {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    }
+    return ToFileIdentity(st);
+}
+
+std::expected<AnswerFile, std::error_code> AnswerFile::Load(const std::filesystem::path& path, bool parse_numbers) {
+    auto fd_res = Open(path, O_RDONLY | O_CLOEXEC);
+    if (!fd_res.has_value()) {
+        return std::unexpected(fd_res.error());
+    }
+
+    struct stat st;
+    if (::fstat(fd_res->Get(), &st) == -1) {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    } else if (!S_ISREG(st.st_mode)) {
+        return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    } else if (static_cast<uint64_t>(st.st_size) > std::numeric_limits<uint32_t>::max()) {
+        return std::unexpected(std::make_error_code(std::errc::file_too_large));
+    }
+
+    auto map_res = MemoryMap::Map(fd_res->Get(), static_cast<size_t>(st.st_size));
+    if (!map_res.has_value()) {
+        return std::unexpected(map_res.error());
+    }
+
+    AnswerFile file;
+    file.map_ = std::move(*map_res);
+    file.identity_ = ToFileIdentity(st);
+    file.has_numbers_ = parse_numbers;
+
+    const char* base = file.map_.View().data();
+    const char* cursor = base;
+    const char* end = base + file.map_.Size();
+
+    while ((cursor = SkipWhitespace(cursor, end)) != end) {
+        const char* token_end = FindWhitespace(cursor, end);
+        file.tokens_.emplace_back(static_cast<uint32_t>(cursor - base), static_cast<uint32_t>(token_end - cursor));
+        cursor = token_end;
+    }
+    file.tokens_.shrink_to_fit();
+
+    if (parse_numbers) {
+        file.numbers_.resize(file.tokens_.size());
+        file.is_number_.resize(file.tokens_.size());
+
+        for (size_t i = 0; i < file.tokens_.size(); ++i) {
+            if (auto value = ParseFloat(file.GetToken(i)); value.has_value()) {
+                file.numbers_[i] = value.value();
+                file.is_number_[i] = true;
+            }
+        }
+    }
+
+    return file;
+}
+
+size_t AnswerFile::GetFootprint() const noexcept {
+    return map_.Size() +
+           tokens_.capacity() * sizeof(tokens_[0]) +
+           numbers_.capacity() * sizeof(double) +
+           is_number_.capacity() / 8;
+}
+
+std::expected<std::shared_ptr<const AnswerFile>, std::error_code> AnswerCache::Get(
+    const std::filesystem::path& path,
+    bool parse_numbers
+) {
+    auto identity_res = GetFileIdentity(path);
+    if (!identity_res.has_value()) {
+        return std::unexpected(identity_res.error());
+    }
+
+    std::string key = path.string();
+
+    {
+        std::lock_guard lock(mutex_);
+
+        if (auto it = index_.find(key); it != index_.end()) {
+            const auto& file = it->second->file;
+
+            if (file->GetIdentity() != identity_res.value()) {
+                ++stats_.invalidation_count;
+                stats_.total_bytes -= file->GetFootprint();
+                lru_.erase(it->second);
+                index_.erase(it);
+            } else if (!parse_numbers || file->HasNumbers()) {
+                ++stats_.hit_count;
+                lru_.splice(lru_.begin(), lru_, it->second);
+                return file;
+            }
+        }
+
+        ++stats_.miss_count;
+    }
+
+    // Loaded without the lock so a large file does not stall checks against other answers.
+    auto load_res = AnswerFile::Load(path, parse_numbers);
+    if (!load_res.has_value()) {
+        return std::unexpected(load_res.error());
+    }
+    auto file = std::make_shared<const AnswerFile>(std::move(*load_res));
+
+    if (file->GetFootprint() > max_bytes_) {
+        return file;
+    }
+
+    std::lock_guard lock(mutex_);
+
+    if (auto it = index_.find(key); it != index_.end()) {
+        stats_.total_bytes -= it->second->file->GetFootprint();
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    lru_.push_front(Entry{ .key = key, .file = file });
+    index_.emplace(std::move(key), lru_.begin());
+    stats_.total_bytes += file->GetFootprint();
+
+    EvictLocked();
+
+    return file;
+}
+
+AnswerCacheStats AnswerCache::GetStats() const {
+    std::lock_guard lock(mutex_);
+
+    AnswerCacheStats stats = stats_;
+    stats.entry_count = lru_.size();
+    return stats;
+}
+
+void AnswerCache::EvictLocked() {
+    while (stats_.total_bytes > max_bytes_ && !lru_.empty()) {
+        auto& victim = lru_.back();
+        stats_.total_bytes -= victim.file->GetFootprint();
+        index_.erase(victim.key);
+        lru_.pop_back();
+        ++stats_.eviction_count;
+    }
+}
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,356 @@
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+#include "coj/cgroup.h"
+#include "coj/file_io.h"
+
+namespace coj {
+
+namespace {
+
+constexpr int MAX_REMOVE_RETRY = 1000;
+
+std::expected<std::string, std::error_code> ReadSmallFile(const std::filesystem::path& path) {
+    auto fd_res = Open(path, O_RDONLY | O_CLOEXEC);
+    if (!fd_res.has_value()) {
+        return std::unexpected(fd_res.error());
+    }
+
+    std::string content;
+    std::array<char, 4096> buffer;
+
+    while (true) {
+        auto read_res = Read(fd_res->Get(), std::as_writable_bytes(std::span(buffer)));
+        if (!read_res.has_value()) {
+            return std::unexpected(read_res.error());
+        } else if (read_res->status != IoStatus::Success) {
+            break;
+        }
+        content.append(buffer.data(), read_res->bytes);
+    }
+
+    return content;
+}
+
+std::expected<void, std::error_code> WriteSmallFile(const std::filesystem::path& path, std::string_view content) {
+    auto fd_res = Open(path, O_WRONLY | O_CLOEXEC);
+    if (!fd_res.has_value()) {
+        return std::unexpected(fd_res.error());
+    }
+
+    auto write_res = Write(fd_res->Get(), std::as_bytes(std::span(content)));
+    if (!write_res.has_value()) {
+        return std::unexpected(write_res.error());
+    }
+
+    return {};
+}
+
+std::optional<size_t> ParseNumber(std::string_view str) {
+    size_t value = 0;
+    auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec != std::errc()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<size_t> FindKeyedValue(std::string_view content, std::string_view key) {
+    size_t pos = 0;
+    while (pos < content.size()) {
+        size_t line_end = content.find('\n', pos);
+        if (line_end == std::string_view::npos) {
+            line_end = content.size();
+        }
+
+        std::string_view line = content.substr(pos, line_end - pos);
+        if (line.size() > key.size() && line.starts_with(key) && line[key.size()] == ' ') {
+            return ParseNumber(line.substr(key.size() + 1));
+        }
+
+        pos = line_end + 1;
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+std::expected<std::filesystem::path, std::error_code> FindCgroupMount() {
+    std::ifstream mounts("/proc/self/mounts");
+    if (!mounts.is_open()) {
+        return std::unexpected(std::make_error_code(std::errc::no_such_file_or_directory));
+    }
+
+    std::string device, mount_point, fs_type, rest;
+    while (mounts >> device >> mount_point >> fs_type && std::getline(mounts, rest)) {
+        if (fs_type == "cgroup2") {
+            return std::filesystem::path(mount_point);
+        }
+    }
+
+    return std::unexpected(std::make_error_code(std::errc::no_such_file_or_directory));
+}
+
+std::expected<Cgroup, std::error_code> Cgroup::Create(std::filesystem::path path) {
+    if (::mkdir(path.c_str(), 0755) == -1 && errno != EEXIST) {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    }
+
+    auto fd_res = Open(path / "cgroup.procs", O_WRONLY | O_CLOEXEC);
+    if (!fd_res.has_value()) {
+        ::rmdir(path.c_str());
+        return std::unexpected(fd_res.error());
+    }
+
+    return Cgroup(std::move(path), std::move(*fd_res));
+}
+
+Cgroup& Cgroup::operator=(Cgroup&& other) noexcept {
+    if (this != &other) {
+        (void)Remove();
+        path_ = std::move(other.path_);
+        procs_fd_ = std::move(other.procs_fd_);
+    }
+    return *this;
+}
+
+bool Cgroup::HasController(std::string_view controller) const {
+    auto content = ReadSmallFile(path_ / "cgroup.controllers");
+    if (!content.has_value()) {
+        return false;
+    }
+
+    std::string_view view = content.value();
+    size_t pos = 0;
+    while (pos < view.size()) {
+        size_t end = view.find_first_of(" \n", pos);
+        if (end == std::string_view::npos) {
+            end = view.size();
+        }
+        if (view.substr(pos, end - pos) == controller) {
+            return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+std::expected<void, std::error_code> Cgroup::SetLimits(const CgroupLimits& limits) {
+    if (limits.memory_bytes.has_value()) {
+        auto value = std::to_string(limits.memory_bytes.value());
+        if (auto res = WriteSmallFile(path_ / "memory.max", value); !res.has_value()) {
+            return res;
+        }
+        (void)WriteSmallFile(path_ / "memory.swap.max", "0");
+    }
+
+    if (limits.process_count.has_value()) {
+        auto value = std::to_string(limits.process_count.value());
+        if (auto res = WriteSmallFile(path_ / "pids.max", value); !res.has_value()) {
+            return res;
+        }
+    }
+
+    if (limits.cpu_cores.has_value()) {
+        auto quota = static_cast<long long>(std::ceil(limits.cpu_cores.value() * static_cast<double>(CPU_PERIOD.count())));
+        auto value = std::to_string(quota) + " " + std::to_string(CPU_PERIOD.count());
+        if (auto res = WriteSmallFile(path_ / "cpu.max", value); !res.has_value()) {
+            return res;
+        }
+    }
+
+    return {};
+}
+
+std::expected<CgroupStats, std::error_code> Cgroup::ReadStats() const {
+    CgroupStats stats;
+
+    auto cpu_stat = ReadSmallFile(path_ / "cpu.stat");
+    if (!cpu_stat.has_value()) {
+        return std::unexpected(cpu_stat.error());
+    }
+
+    stats.cpu_usage = std::chrono::microseconds(FindKeyedValue(*cpu_stat, "usage_usec").value_or(0));
+    stats.cpu_user = std::chrono::microseconds(FindKeyedValue(*cpu_stat, "user_usec").value_or(0));
+    stats.cpu_system = std::chrono::microseconds(FindKeyedValue(*cpu_stat, "system_usec").value_or(0));
+
+    if (auto peak = ReadSmallFile(path_ / "memory.peak"); peak.has_value()) {
+        auto end = peak->find_first_of(" \n");
+        stats.memory_peak_bytes = ParseNumber(std::string_view(*peak).substr(0, end));
+    }
+
+    if (auto events = ReadSmallFile(path_ / "memory.events"); events.has_value()) {
+        stats.oom_kill_count = FindKeyedValue(*events, "oom_kill").value_or(0);
+    }
+
+    return stats;
+}
+
+std::expected<void, std::error_code> Cgroup::Kill() {
+    auto kill_res = WriteSmallFile(path_ / "cgroup.kill", "1");
+    if (kill_res.has_value()) {
+        return {};
+    }
+
+    auto procs = ReadSmallFile(path_ / "cgroup.procs");
+    if (!procs.has_value()) {
+        return std::unexpected(procs.error());
+    }
+
+    std::string_view view = procs.value();
+    size_t pos = 0;
+    while (pos < view.size()) {
+        size_t end = view.find('\n', pos);
+        if (end == std::string_view::npos) {
+            end = view.size();
+        }
+        if (auto pid = ParseNumber(view.substr(pos, end - pos)); pid.has_value()) {
+            ::kill(static_cast<pid_t>(pid.value()), SIGKILL);
+        }
+        pos = end + 1;
+    }
+
+    return {};
+}
+
+std::expected<void, std::error_code> Cgroup::Remove() {
+    if (!IsValid()) {
+        return {};
+    }
+
+    procs_fd_.Close();
+
+    for (int retry = 0; ::rmdir(path_.c_str()) == -1; ++retry) {
+        if (errno != EBUSY || retry >= MAX_REMOVE_RETRY) {
+            return std::unexpected(std::error_code(errno, std::generic_category()));
+        }
+        if (retry == 0) {
+            (void)Kill();
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    return {};
+}
+
+CgroupPool::~CgroupPool() {
+    {
+        std::lock_guard lock(mutex_);
+        is_stopping_ = true;
+    }
+    refill_cv_.notify_all();
+
+    if (refill_thread_.joinable()) {
+        refill_thread_.join();
+    }
+}
+
+std::expected<void, std::error_code> CgroupPool::Reserve() {
+    for (std::string_view controller : {"+memory", "+pids", "+cpu"}) {
+        (void)WriteSmallFile(parent_dir_ / "cgroup.subtree_control", controller);
+    }
+
+    while (GetIdleCount() < capacity_) {
+        auto cgroup_res = CreateCgroup();
+        if (!cgroup_res.has_value()) {
+            return std::unexpected(cgroup_res.error());
+        }
+
+        std::lock_guard lock(mutex_);
+        idle_.push_back(std::move(*cgroup_res));
+    }
+
+    return {};
+}
+
+std::expected<Cgroup, std::error_code> CgroupPool::Acquire() {
+    {
+        std::lock_guard lock(mutex_);
+        if (!idle_.empty()) {
+            Cgroup cgroup = std::move(idle_.back());
+            idle_.pop_back();
+            return cgroup;
+        }
+    }
+
+    return CreateCgroup();
+}
+
+void CgroupPool::Release(Cgroup cgroup) {
+    (void)cgroup.Kill();
+
+    std::lock_guard lock(mutex_);
+
+    retired_.push_back(std::move(cgroup));
+    if (!refill_thread_.joinable()) {
+        refill_thread_ = std::thread(&CgroupPool::RefillLoop, this);
+    }
+    refill_cv_.notify_one();
+}
+
+size_t CgroupPool::GetIdleCount() const {
+    std::lock_guard lock(mutex_);
+    return idle_.size();
+}
+
+std::expected<Cgroup, std::error_code> CgroupPool::CreateCgroup() {
+    auto name = prefix_ + "-" + std::to_string(::getpid()) + "-" + std::to_string(next_id_.fetch_add(1));
+    auto cgroup_res = Cgroup::Create(parent_dir_ / name);
+    if (!cgroup_res.has_value() || !cpu_cores_.has_value()) {
+        return cgroup_res;
+    }
+
+    if (!cgroup_res->HasController("cpu")) {
+        return std::unexpected(std::make_error_code(std::errc::not_supported));
+    }
+    if (auto res = cgroup_res->SetLimits(CgroupLimits{ .cpu_cores = cpu_cores_ }); !res.has_value()) {
+        return std::unexpected(res.error());
+    }
+
+    return cgroup_res;
+}
+
+void CgroupPool::RefillLoop() {
+    std::unique_lock lock(mutex_);
+
+    while (true) {
+        refill_cv_.wait(lock, [this] { return is_stopping_ || !retired_.empty(); });
+        if (is_stopping_) {
+            return;
+        }
+
+        // Removal waits for the killed tasks to leave, so none of it happens under the lock.
+        std::vector<Cgroup> retired = std::move(retired_);
+        retired_.clear();
+        lock.unlock();
+
+        retired.clear();
+
+        lock.lock();
+        size_t refill_count = capacity_ - std::min(idle_.size(), capacity_);
+        lock.unlock();
+
+        for (; refill_count > 0; --refill_count) {
+            auto cgroup_res = CreateCgroup();
+            if (!cgroup_res.has_value()) {
+                break;
+            }
+
+            lock.lock();
+            idle_.push_back(std::move(*cgroup_res));
+            lock.unlock();
+        }
+
+        lock.lock();
+    }
+}
+
+} // namespace coj
@@ -1,13 +1,19 @@
+#include <array>
 #include <charconv>
-#include <fstream>
+#include <cmath>
+#include <span>
+#include <string_view>
+#include <utility>
 
+#include "coj/answer_cache.h"
 #include "coj/checker.h"
+#include "coj/float_compare.h"
+#include "coj/telemetry.h"
+#include "coj/tokenizer.h"
 
 namespace coj {
 
-namespace {
-
-std::expected<double, std::error_code> ParseFloat(const std::string& str) {
+std::expected<double, std::error_code> ParseFloat(std::string_view str) {
     auto first = str.data();
     auto last = str.data() + str.size();
     double result;
@@ -31,49 +37,175 @@ bool IsFloatEqual(double a, double b, double epsilon) {
     return diff <= epsilon * max_abs;
 }
 
+namespace {
+
+constexpr size_t FLOAT_BATCH_SIZE = 1024;
+
+// Defers epsilon comparisons so runs of numeric tokens are tested with the vector kernels. Any pending
+// pair must be settled before a verdict is returned, so the outcome matches a pair-at-a-time check.
+class FloatBatch {
+public:
+    explicit FloatBatch(std::optional<double> epsilon) : epsilon_(epsilon) {}
+
+    bool IsEnabled() const noexcept { return epsilon_.has_value(); }
+
+    // Returns false once a mismatch is known.
+    bool Push(double answer, double output) noexcept {
+        answer_[size_] = answer;
+        output_[size_] = output;
+        return ++size_ < FLOAT_BATCH_SIZE || Flush();
+    }
+
+    bool Flush() noexcept {
+        size_t size = std::exchange(size_, 0);
+        return FindFloatMismatch(std::span(answer_.data(), size), std::span(output_.data(), size), *epsilon_) == size;
+    }
+
+    CheckResult Settle(CheckResult result) noexcept {
+        return Flush() ? result : CheckResult::WrongAnswer;
+    }
+
+private:
+    std::optional<double> epsilon_;
+
+    std::array<double, FLOAT_BATCH_SIZE> answer_;
+    std::array<double, FLOAT_BATCH_SIZE> output_;
+    size_t size_ = 0;
+};
+
+std::expected<TokenReader, std::error_code> OpenOutput(const CheckConfig& config) {
+    if (config.output_data.has_value()) {
+        return TokenReader::FromView(config.output_data.value());
+    }
+    return TokenReader::Open(config.output_path);
+}
+
+std::expected<CheckResult, std::error_code> CheckCached(const CheckConfig& config) {
+    auto answer_res = config.answer_cache->Get(config.answer_path, config.epsilon.has_value());
+    if (!answer_res.has_value()) {
+        return std::unexpected(answer_res.error());
+    }
+    const auto& answer = *answer_res.value();
+
+    auto output_res = OpenOutput(config);
+    if (!output_res.has_value()) {
+        return CheckResult::WrongAnswer;
+    }
+    auto& output_reader = output_res.value();
+
+    FloatBatch batch(config.epsilon);
+
+    for (size_t i = 0;; ++i) {
+        auto o_res = output_reader.Next();
+        if (!o_res.has_value()) {
+            if (batch.IsEnabled() && !batch.Flush()) {
+                return CheckResult::WrongAnswer;
+            }
+            return std::unexpected(o_res.error());
+        }
+        const auto& o_tok = o_res.value();
+
+        if (i == answer.GetTokenCount()) {
+            auto result = o_tok.has_value() ? CheckResult::WrongAnswer : CheckResult::Accepted;
+            return batch.IsEnabled() ? batch.Settle(result) : result;
+        } else if (!o_tok.has_value()) {
+            return CheckResult::WrongAnswer;
+        }
+
+        if (batch.IsEnabled()) {
+            if (auto a_val = answer.GetNumber(i); a_val.has_value()) {
+                if (auto o_val = ParseFloat(*o_tok); o_val.has_value()) {
+                    if (!batch.Push(a_val.value(), o_val.value())) {
+                        return CheckResult::WrongAnswer;
+                    }
+                    continue;
+                }
+            }
+        }
+
+        if (answer.GetToken(i) != *o_tok) {
+            return CheckResult::WrongAnswer;
+        }
+    }
+}
+
 } // namespace
 
+bool IsTokenEqual(std::string_view answer, std::string_view output, std::optional<double> epsilon) {
+    if (epsilon.has_value()) {
+        auto a_val = ParseFloat(answer);
+        auto o_val = ParseFloat(output);
+
+        if (a_val.has_value() && o_val.has_value()) {
+            return IsFloatEqual(a_val.value(), o_val.value(), epsilon.value());
+        }
+    }
+
+    return answer == output;
+}
+
 std::expected<CheckResult, std::error_code> Check(const CheckConfig &config) {
-    std::ifstream answer_file(config.answer_path);
-    if (!answer_file.is_open()) {
-        return std::unexpected(std::make_error_code(std::errc::no_such_file_or_directory));
+    COJ_TRACE_SCOPE(Check);
+
+    if (config.answer_cache != nullptr) {
+        return CheckCached(config);
+    }
+
+    auto answer_res = TokenReader::Open(config.answer_path);
+    if (!answer_res.has_value()) {
+        return std::unexpected(answer_res.error());
     }
 
-    std::ifstream output_file(config.output_path);
-    if (!output_file.is_open()) {
+    auto output_res = OpenOutput(config);
+    if (!output_res.has_value()) {
         return CheckResult::WrongAnswer;
     }
 
-    std::string a_tok;
-    std::string o_tok;
+    auto& answer_reader = answer_res.value();
+    auto& output_reader = output_res.value();
+
+    FloatBatch batch(config.epsilon);
+
+    while (true) {
+        auto a_res = answer_reader.Next();
+        if (!a_res.has_value()) {
+            return std::unexpected(a_res.error());
+        }
+
+        auto o_res = output_reader.Next();
+        if (!o_res.has_value()) {
+            if (batch.IsEnabled() && !batch.Flush()) {
+                return CheckResult::WrongAnswer;
+            }
+            return std::unexpected(o_res.error());
+        }
+
+        const auto& a_tok = a_res.value();
+        const auto& o_tok = o_res.value();
 
-    while (answer_file >> a_tok) {
-        if (!(output_file >> o_tok)) {
+        if (!a_tok.has_value()) {
+            auto result = o_tok.has_value() ? CheckResult::WrongAnswer : CheckResult::Accepted;
+            return batch.IsEnabled() ? batch.Settle(result) : result;
+        } else if (!o_tok.has_value()) {
             return CheckResult::WrongAnswer;
         }
 
-        if (config.epsilon.has_value()) {
-            auto a_res = ParseFloat(a_tok);
-            auto o_res = ParseFloat(o_tok);
+        if (batch.IsEnabled()) {
+            auto a_val = ParseFloat(*a_tok);
+            auto o_val = ParseFloat(*o_tok);
 
-            if (a_res.has_value() && o_res.has_value()) {
-                if (!IsFloatEqual(a_res.value(), o_res.value(), config.epsilon.value())) {
+            if (a_val.has_value() && o_val.has_value()) {
+                if (!batch.Push(a_val.value(), o_val.value())) {
                     return CheckResult::WrongAnswer;
                 }
                 continue;
             }
         }
 
-        if (a_tok != o_tok) {
+        if (*a_tok != *o_tok) {
             return CheckResult::WrongAnswer;
         }
     }
-
-    if (output_file >> o_tok) {
-        return CheckResult::WrongAnswer;
-    }
-    
-    return CheckResult::Accepted;
 }
 
 } // namespace coj
\ No newline at end of file
@@ -0,0 +1,273 @@
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "coj/compile_cache.h"
+#include "coj/file_descriptor.h"
+#include "coj/file_io.h"
+
+namespace coj {
+
+namespace {
+
+constexpr const char* TEMP_PREFIX = ".tmp-";
+
+size_t GetEntryBytes(const std::filesystem::path& entry_dir) {
+    size_t bytes = 0;
+    std::error_code ec;
+    for (const char* name : { CompileCache::EXEC_FILENAME, CompileCache::OUTPUT_FILENAME }) {
+        auto size = std::filesystem::file_size(entry_dir / name, ec);
+        if (!ec) {
+            bytes += static_cast<size_t>(size);
+        }
+    }
+    return bytes;
+}
+
+std::expected<void, std::error_code> WriteWholeFile(const std::filesystem::path& path, std::string_view content) {
+    auto fd_res = Open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (!fd_res.has_value()) {
+        return std::unexpected(fd_res.error());
+    }
+
+    auto write_res = Write(fd_res->Get(), std::as_bytes(std::span(content.data(), content.size())));
+    if (!write_res.has_value()) {
+        return std::unexpected(write_res.error());
+    } else if (write_res->bytes != content.size()) {
+        return std::unexpected(std::make_error_code(std::errc::io_error));
+    }
+
+    return {};
+}
+
+} // namespace
+
+std::expected<void, std::error_code> LinkOrCopyFile(const std::filesystem::path& from, const std::filesystem::path& to) {
+    std::error_code ec;
+    std::filesystem::remove(to, ec);
+
+    if (::link(from.c_str(), to.c_str()) == 0) {
+        return {};
+    }
+
+    {
+        auto src_res = Open(from, O_RDONLY | O_CLOEXEC);
+        if (!src_res.has_value()) {
+            return std::unexpected(src_res.error());
+        }
+
+        auto dst_res = Open(to, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0755);
+        if (!dst_res.has_value()) {
+            return std::unexpected(dst_res.error());
+        }
+
+        if (::ioctl(dst_res->Get(), FICLONE, src_res->Get()) == 0) {
+            return {};
+        }
+    }
+
+    std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing, ec);
+    if (ec) {
+        return std::unexpected(ec);
+    }
+
+    return {};
+}
+
+std::expected<void, std::error_code> CompileCache::Load() {
+    std::error_code ec;
+    std::filesystem::create_directories(cache_dir_, ec);
+    if (ec) {
+        return std::unexpected(ec);
+    }
+
+    struct ScannedEntry {
+        Entry entry;
+        std::filesystem::file_time_type mtime;
+    };
+    std::vector<ScannedEntry> scanned;
+
+    for (const auto& dirent : std::filesystem::directory_iterator(cache_dir_, ec)) {
+        std::string name = dirent.path().filename().string();
+
+        if (name.starts_with(TEMP_PREFIX)) {
+            std::filesystem::remove_all(dirent.path(), ec);
+            continue;
+        } else if (!dirent.is_directory(ec) || !std::filesystem::exists(dirent.path() / OUTPUT_FILENAME, ec)) {
+            continue;
+        }
+
+        scanned.push_back(ScannedEntry{
+            .entry = Entry{
+                .key = name,
+                .bytes = GetEntryBytes(dirent.path()),
+                .has_exec = std::filesystem::exists(dirent.path() / EXEC_FILENAME, ec),
+            },
+            .mtime = dirent.last_write_time(ec),
+        });
+    }
+    if (ec) {
+        return std::unexpected(ec);
+    }
+
+    std::sort(scanned.begin(), scanned.end(), [](const ScannedEntry& lhs, const ScannedEntry& rhs) {
+        return lhs.mtime < rhs.mtime;
+    });
+
+    std::lock_guard lock(mutex_);
+
+    for (auto& item : scanned) {
+        if (index_.contains(item.entry.key)) {
+            continue;
+        }
+        stats_.total_bytes += item.entry.bytes;
+        lru_.push_front(std::move(item.entry));
+        index_.emplace(lru_.front().key, lru_.begin());
+    }
+    stats_.entry_count = lru_.size();
+
+    EvictLocked();
+
+    return {};
+}
+
+std::expected<std::optional<CompileResult>, std::error_code> CompileCache::Lookup(
+    const std::string& key,
+    const std::filesystem::path& exec_dir
+) {
+    std::lock_guard lock(mutex_);
+
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++stats_.miss_count;
+        return std::nullopt;
+    }
+
+    std::filesystem::path entry_dir = cache_dir_ / key;
+
+    auto output_fd = Open(entry_dir / OUTPUT_FILENAME, O_RDONLY | O_CLOEXEC);
+    if (!output_fd.has_value()) {
+        stats_.total_bytes -= it->second->bytes;
+        lru_.erase(it->second);
+        index_.erase(it);
+        stats_.entry_count = lru_.size();
+        ++stats_.miss_count;
+        return std::nullopt;
+    }
+
+    auto output_res = ReadAllAsString(output_fd->Get());
+    if (!output_res.has_value()) {
+        return std::unexpected(output_res.error());
+    }
+
+    CompileResult result;
+    result.output = std::move(*output_res);
+
+    if (it->second->has_exec) {
+        std::filesystem::path exec_path = exec_dir / EXEC_FILENAME;
+        if (auto link_res = LinkOrCopyFile(entry_dir / EXEC_FILENAME, exec_path); !link_res.has_value()) {
+            return std::unexpected(link_res.error());
+        }
+        result.is_successful = true;
+        result.exec_path = std::move(exec_path);
+    }
+
+    Touch(it->second);
+    ++stats_.hit_count;
+
+    return result;
+}
+
+std::expected<void, std::error_code> CompileCache::Store(const std::string& key, const CompileResult& result) {
+    std::filesystem::path temp_dir;
+    {
+        std::lock_guard lock(mutex_);
+        if (index_.contains(key)) {
+            return {};
+        }
+        temp_dir = cache_dir_ / (TEMP_PREFIX + std::to_string(::getpid()) + "-" + std::to_string(next_temp_id_++));
+    }
+
+    if (::mkdir(temp_dir.c_str(), 0755) == -1) {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    }
+
+    auto fill_res = [&]() -> std::expected<void, std::error_code> {
+        if (result.is_successful && result.exec_path.has_value()) {
+            if (auto res = LinkOrCopyFile(result.exec_path.value(), temp_dir / EXEC_FILENAME); !res.has_value()) {
+                return res;
+            }
+        }
+        return WriteWholeFile(temp_dir / OUTPUT_FILENAME, result.output);
+    }();
+
+    std::error_code ec;
+    if (!fill_res.has_value()) {
+        std::filesystem::remove_all(temp_dir, ec);
+        return fill_res;
+    }
+
+    std::filesystem::path entry_dir = cache_dir_ / key;
+    if (::rename(temp_dir.c_str(), entry_dir.c_str()) == -1) {
+        int saved_errno = errno;
+        std::filesystem::remove_all(temp_dir, ec);
+        if (saved_errno == EEXIST || saved_errno == ENOTEMPTY) {
+            return {};
+        }
+        return std::unexpected(std::error_code(saved_errno, std::generic_category()));
+    }
+
+    std::lock_guard lock(mutex_);
+
+    if (index_.contains(key)) {
+        return {};
+    }
+
+    lru_.push_front(Entry{
+        .key = key,
+        .bytes = GetEntryBytes(entry_dir),
+        .has_exec = result.is_successful && result.exec_path.has_value(),
+    });
+    index_.emplace(key, lru_.begin());
+
+    stats_.total_bytes += lru_.front().bytes;
+    stats_.entry_count = lru_.size();
+    ++stats_.store_count;
+
+    EvictLocked();
+
+    return {};
+}
+
+CompileCacheStats CompileCache::GetStats() const {
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+void CompileCache::Touch(std::list<Entry>::iterator it) {
+    lru_.splice(lru_.begin(), lru_, it);
+    ::utimensat(AT_FDCWD, (cache_dir_ / it->key).c_str(), nullptr, 0);
+}
+
+void CompileCache::EvictLocked() {
+    std::error_code ec;
+
+    while (stats_.total_bytes > max_bytes_ && lru_.size() > 1) {
+        Entry& victim = lru_.back();
+        std::filesystem::remove_all(cache_dir_ / victim.key, ec);
+
+        stats_.total_bytes -= victim.bytes;
+        ++stats_.eviction_count;
+
+        index_.erase(victim.key);
+        lru_.pop_back();
+    }
+
+    stats_.entry_count = lru_.size();
+}
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <memory>
+
+#include "coj/compile_service.h"
+
+namespace coj {
+
+CompileService::CompileService(Compiler& compiler, CompileServiceConfig config)
+    : compiler_(compiler), config_(config) {
+    config_.worker_count = std::max<size_t>(config_.worker_count, 1);
+    config_.queue_capacity = std::max<size_t>(config_.queue_capacity, 1);
+
+    workers_.reserve(config_.worker_count);
+    for (size_t i = 0; i < config_.worker_count; ++i) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+std::future<CompileJobResult> CompileService::Submit(CompileJob job) {
+    auto promise = std::make_shared<std::promise<CompileJobResult>>();
+    auto future = promise->get_future();
+
+    Submit(std::move(job), [promise](CompileJobResult result) {
+        promise->set_value(std::move(result));
+    });
+
+    return future;
+}
+
+void CompileService::Submit(CompileJob job, CompileCallback callback) {
+    if (auto enqueue_res = Enqueue(job, callback, true); !enqueue_res.has_value()) {
+        callback(CompileJobResult{ .result = std::unexpected(enqueue_res.error()) });
+    }
+}
+
+std::expected<std::future<CompileJobResult>, std::error_code> CompileService::TrySubmit(CompileJob job) {
+    auto promise = std::make_shared<std::promise<CompileJobResult>>();
+    auto future = promise->get_future();
+
+    CompileCallback callback = [promise](CompileJobResult result) {
+        promise->set_value(std::move(result));
+    };
+
+    if (auto enqueue_res = Enqueue(job, callback, false); !enqueue_res.has_value()) {
+        return std::unexpected(enqueue_res.error());
+    }
+
+    return future;
+}
+
+void CompileService::Shutdown() {
+    {
+        std::lock_guard lock(mutex_);
+        if (is_shutdown_) {
+            return;
+        }
+        is_shutdown_ = true;
+    }
+
+    not_empty_.notify_all();
+    not_full_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+CompileServiceStats CompileService::GetStats() const {
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+std::expected<void, std::error_code> CompileService::Enqueue(CompileJob& job, CompileCallback& callback, bool should_block) {
+    std::unique_lock lock(mutex_);
+
+    if (should_block) {
+        not_full_.wait(lock, [this] { return is_shutdown_ || queue_.size() < config_.queue_capacity; });
+    }
+
+    if (is_shutdown_) {
+        ++stats_.rejected_count;
+        return std::unexpected(std::make_error_code(std::errc::operation_canceled));
+    } else if (queue_.size() >= config_.queue_capacity) {
+        ++stats_.rejected_count;
+        return std::unexpected(std::make_error_code(std::errc::resource_unavailable_try_again));
+    }
+
+    queue_.push_back(PendingJob{
+        .job = std::move(job),
+        .callback = std::move(callback),
+        .enqueue_time = Clock::now(),
+    });
+    ++stats_.submitted_count;
+    stats_.queued_count = queue_.size();
+
+    lock.unlock();
+    not_empty_.notify_one();
+
+    return {};
+}
+
+void CompileService::WorkerLoop() {
+    while (true) {
+        std::unique_lock lock(mutex_);
+        not_empty_.wait(lock, [this] { return is_shutdown_ || !queue_.empty(); });
+
+        if (queue_.empty()) {
+            return;
+        }
+
+        PendingJob pending = std::move(queue_.front());
+        queue_.pop_front();
+
+        auto start_time = Clock::now();
+        auto queue_time = std::chrono::duration_cast<std::chrono::nanoseconds>(start_time - pending.enqueue_time);
+
+        stats_.queued_count = queue_.size();
+        ++stats_.running_count;
+        stats_.total_queue_time += queue_time;
+        stats_.max_queue_time = std::max(stats_.max_queue_time, queue_time);
+
+        lock.unlock();
+        not_full_.notify_one();
+
+        const CompileJob& job = pending.job;
+        auto result = job.limits.has_value()
+            ? compiler_.Compile(job.source_path, job.exec_dir, job.limits.value())
+            : compiler_.Compile(job.source_path, job.exec_dir);
+
+        auto run_time = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_time);
+
+        lock.lock();
+        --stats_.running_count;
+        ++stats_.completed_count;
+        stats_.total_run_time += run_time;
+        lock.unlock();
+
+        pending.callback(CompileJobResult{
+            .result = std::move(result),
+            .queue_time = queue_time,
+            .run_time = run_time,
+        });
+    }
+}
+
+} // namespace coj
\ No newline at end of file
@@ -1,39 +1,297 @@
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "coj/capture_buffer.h"
+#include "coj/compile_cache.h"
 #include "coj/compiler.h"
 #include "coj/file_io.h"
+#include "coj/hash.h"
+#include "coj/memory_map.h"
+#include "coj/reactor.h"
+#include "coj/telemetry.h"
 
 namespace coj {
 
+void HashCompileLimits(Sha256& hasher, const process::ResourceLimits& limits) {
+    for (const auto& limit : { limits.cpu_time_sec, limits.memory_bytes, limits.file_size_bytes, limits.process_count }) {
+        hasher.UpdateField(limit.has_value() ? std::to_string(*limit) : "-");
+    }
+}
+
+bool IsCacheableCompile(const process::ExitStatus& status, const process::ResourceLimits& limits) {
+    if (!status.Code().has_value()) {
+        return false;
+    } else if (status.Success() || !limits.cpu_time_sec.has_value()) {
+        return true;
+    }
+
+    return status.GetCpuTime() * 2 < std::chrono::seconds(*limits.cpu_time_sec);
+}
+
 std::expected<CompileResult, std::error_code> CppCompiler::Compile(const std::filesystem::path &source_path, const std::filesystem::path &exec_dir) {
-    std::filesystem::path exec_path = exec_dir / "main";
+    return Compile(source_path, exec_dir, limits_);
+}
 
-    command_.Arg(source_path.string())
-        .Arg("-o")
-        .Arg(exec_path.string())
-        .Stdout(process::Stdio::Null())
-        .Stderr(process::Stdio::Piped());
+std::expected<CompileResult, std::error_code> CppCompiler::Compile(
+    const std::filesystem::path& source_path,
+    const std::filesystem::path& exec_dir,
+    const process::ResourceLimits& limits
+) {
+    COJ_TRACE_SCOPE(Compile);
+
+    std::optional<std::string> cache_key;
+
+    if (cache_ != nullptr) {
+        if (auto key_res = GetCacheKey(source_path, limits); key_res.has_value()) {
+            auto lookup_res = cache_->Lookup(*key_res, exec_dir);
+            if (lookup_res.has_value() && lookup_res->has_value()) {
+                CompileResult result = std::move(**lookup_res);
+                result.is_cached = true;
+                return result;
+            }
+            cache_key = std::move(*key_res);
+        }
+    }
+
+    bool is_deterministic = false;
+    auto result = Invoke(source_path, exec_dir, limits, is_deterministic);
+
+    if (result.has_value() && cache_key.has_value() && is_deterministic) {
+        (void)cache_->Store(*cache_key, *result);
+    }
+
+    return result;
+}
+
+std::expected<std::string, std::error_code> CppCompiler::GetCacheKey(const std::filesystem::path& source_path) {
+    return GetCacheKey(source_path, limits_);
+}
+
+std::expected<std::string, std::error_code> CppCompiler::GetCacheKey(
+    const std::filesystem::path& source_path,
+    const process::ResourceLimits& limits
+) {
+    auto version_res = GetVersion();
+    if (!version_res.has_value()) {
+        return std::unexpected(version_res.error());
+    }
+
+    auto fd_res = Open(source_path, O_RDONLY | O_CLOEXEC);
+    if (!fd_res.has_value()) {
+        return std::unexpected(fd_res.error());
+    }
+
+    auto map_res = MemoryMap::Map(fd_res->Get());
+    if (!map_res.has_value()) {
+        return std::unexpected(map_res.error());
+    }
+
+    Sha256 hasher;
+    hasher.UpdateField(compiler_path_).UpdateField(*version_res);
+    for (const auto& arg : args_) {
+        hasher.UpdateField(arg);
+    }
+    HashCompileLimits(hasher, limits);
+    hasher.UpdateField(map_res->View());
 
-    auto child_res = command_.Spawn();
+    return hasher.FinalHex();
+}
+
+std::expected<std::string, std::error_code> CppCompiler::GetVersion() {
+    std::lock_guard lock(version_mutex_);
+
+    if (version_.has_value()) {
+        return version_.value();
+    }
+
+    process::Command command(compiler_path_);
+    command.Arg("--version")
+        .Stdin(process::Stdio::Null())
+        .Stdout(process::Stdio::Piped())
+        .Stderr(process::Stdio::Null());
+
+    auto child_res = command.Spawn();
     if (!child_res.has_value()) {
         return std::unexpected(child_res.error());
     }
 
-    CompileResult result;
+    auto output = ReadAllAsString(child_res->stdout_pipe->Get());
+    if (!output.has_value()) {
+        return std::unexpected(output.error());
+    }
+
+    auto wait_res = child_res->Wait();
+    if (!wait_res.has_value()) {
+        return std::unexpected(wait_res.error());
+    } else if (!wait_res->Success()) {
+        return std::unexpected(std::make_error_code(std::errc::executable_format_error));
+    }
+
+    version_ = std::move(*output);
+    return version_.value();
+}
+
+std::expected<std::filesystem::path, std::error_code> CppCompiler::PreparePrecompiledHeader() {
+    if (!pch_root_.has_value()) {
+        return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    }
+
+    auto key_res = GetPrecompiledHeaderKey();
+    if (!key_res.has_value()) {
+        return std::unexpected(key_res.error());
+    }
+
+    std::filesystem::path pch_dir = pch_root_.value() / *key_res;
+    std::filesystem::path gch_path = pch_dir / (pch_header_ + ".gch");
 
-    if (child_res->stderr_pipe.has_value()) {
-        auto output = ReadAllAsString(child_res->stderr_pipe->Get());
-        if (output.has_value()) {
-            result.output = std::move(*output);
-        } else {
-            return std::unexpected(output.error());
+    std::lock_guard lock(pch_mutex_);
+
+    std::error_code ec;
+    if (std::filesystem::exists(gch_path, ec)) {
+        return pch_dir;
+    }
+
+    std::filesystem::path temp_dir = pch_root_.value() /
+        (".tmp-" + std::to_string(::getpid()) + "-" + std::to_string(next_pch_temp_id_++));
+
+    auto build_res = BuildPrecompiledHeader(temp_dir);
+    if (!build_res.has_value()) {
+        std::filesystem::remove_all(temp_dir, ec);
+        return std::unexpected(build_res.error());
+    }
+
+    if (::rename(temp_dir.c_str(), pch_dir.c_str()) == -1) {
+        int saved_errno = errno;
+        std::filesystem::remove_all(temp_dir, ec);
+        if (saved_errno != EEXIST && saved_errno != ENOTEMPTY) {
+            return std::unexpected(std::error_code(saved_errno, std::generic_category()));
         }
     }
 
+    return pch_dir;
+}
+
+std::expected<std::string, std::error_code> CppCompiler::GetPrecompiledHeaderKey() {
+    auto version_res = GetVersion();
+    if (!version_res.has_value()) {
+        return std::unexpected(version_res.error());
+    }
+
+    Sha256 hasher;
+    hasher.UpdateField(compiler_path_).UpdateField(*version_res).UpdateField(pch_header_);
+
+    struct stat st;
+    if (::stat(compiler_path_.c_str(), &st) == 0) {
+        hasher.UpdateField(std::to_string(st.st_ino))
+            .UpdateField(std::to_string(st.st_size))
+            .UpdateField(std::to_string(st.st_mtim.tv_sec) + "." + std::to_string(st.st_mtim.tv_nsec));
+    }
+
+    for (const auto& arg : args_) {
+        hasher.UpdateField(arg);
+    }
+
+    return hasher.FinalHex();
+}
+
+std::expected<void, std::error_code> CppCompiler::BuildPrecompiledHeader(const std::filesystem::path& pch_dir) {
+    std::filesystem::path header_path = pch_dir / pch_header_;
+
+    std::error_code ec;
+    std::filesystem::create_directories(header_path.parent_path(), ec);
+    if (ec) {
+        return std::unexpected(ec);
+    }
+
+    // When the .gch is rejected, g++ falls back to this wrapper, which resumes the search past -I.
+    std::string wrapper = "#include_next <" + pch_header_ + ">\n";
+    {
+        auto fd_res = Open(header_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (!fd_res.has_value()) {
+            return std::unexpected(fd_res.error());
+        }
+        auto write_res = Write(fd_res->Get(), std::as_bytes(std::span(wrapper.data(), wrapper.size())));
+        if (!write_res.has_value()) {
+            return std::unexpected(write_res.error());
+        }
+    }
+
+    process::Command command(compiler_path_);
+    command.Args(args_)
+        .Arg("-x")
+        .Arg("c++-header")
+        .Arg(header_path.string())
+        .Arg("-o")
+        .Arg(header_path.string() + ".gch")
+        .Limits(limits_)
+        .Stdin(process::Stdio::Null())
+        .Stdout(process::Stdio::Null())
+        .Stderr(process::Stdio::Null());
+
+    auto child_res = command.Spawn();
+    if (!child_res.has_value()) {
+        return std::unexpected(child_res.error());
+    }
+
     auto wait_res = child_res->Wait();
     if (!wait_res.has_value()) {
         return std::unexpected(wait_res.error());
+    } else if (!wait_res->Success()) {
+        return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    }
+
+    return {};
+}
+
+std::expected<CompileResult, std::error_code> CppCompiler::Invoke(
+    const std::filesystem::path& source_path,
+    const std::filesystem::path& exec_dir,
+    const process::ResourceLimits& limits,
+    bool& is_deterministic
+) {
+    std::filesystem::path exec_path = exec_dir / "main";
+
+    // The previous binary may be a hardlink into the cache; never let the linker write through it.
+    std::error_code ec;
+    std::filesystem::remove(exec_path, ec);
+
+    process::Command command(compiler_path_);
+
+    if (pch_root_.has_value()) {
+        if (auto pch_res = PreparePrecompiledHeader(); pch_res.has_value()) {
+            command.Arg("-I").Arg(pch_res->string());
+        }
     }
 
-    result.is_successful = wait_res->Success();
+    command.Args(args_)
+        .Arg(source_path.string())
+        .Arg("-o")
+        .Arg(exec_path.string())
+        .Limits(limits)
+        .Stdout(process::Stdio::Null())
+        .Stderr(process::Stdio::Piped());
+
+    auto child_res = command.Spawn();
+    if (!child_res.has_value()) {
+        return std::unexpected(child_res.error());
+    }
+
+    thread_local std::vector<char> capture_storage;
+    capture_storage.resize(max_output_bytes_);
+    CaptureBuffer capture(capture_storage, max_output_bytes_ / 2);
+
+    auto communicate_res = Communicate(child_res.value(), { .stderr_capture = &capture });
+    if (!communicate_res.has_value()) {
+        return std::unexpected(communicate_res.error());
+    }
+
+    CompileResult result;
+    result.output = capture.ToString();
+    result.dropped_output_bytes = capture.GetDroppedBytes();
+
+    const auto& exit_status = communicate_res->exit_status;
+    result.is_successful = exit_status.Success();
+    is_deterministic = IsCacheableCompile(exit_status, limits);
 
     if (result.is_successful) {
         result.exec_path = exec_path;
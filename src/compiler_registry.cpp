@@ -0,0 +1,513 @@
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+#include "coj/capture_buffer.h"
+#include "coj/compiler_registry.h"
+#include "coj/file_io.h"
+#include "coj/hash.h"
+#include "coj/memory_map.h"
+#include "coj/reactor.h"
+#include "coj/telemetry.h"
+
+namespace coj {
+
+namespace {
+
+std::error_code InvalidArgument() {
+    return std::make_error_code(std::errc::invalid_argument);
+}
+
+std::string_view Trim(std::string_view str) {
+    constexpr std::string_view WHITESPACE = " \t\r\n";
+    auto begin = str.find_first_not_of(WHITESPACE);
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    auto end = str.find_last_not_of(WHITESPACE);
+    return str.substr(begin, end - begin + 1);
+}
+
+void ReplaceAll(std::string& str, std::string_view from, std::string_view to) {
+    for (size_t pos = str.find(from); pos != std::string::npos; pos = str.find(from, pos + to.size())) {
+        str.replace(pos, from.size(), to);
+    }
+}
+
+template <typename T>
+std::expected<T, std::error_code> ParseNumber(std::string_view value) {
+    T number{};
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), number);
+    if (ec != std::errc() || ptr != value.data() + value.size()) {
+        return std::unexpected(InvalidArgument());
+    }
+    return number;
+}
+
+std::expected<void, std::error_code> ApplyKey(LanguageSpec& spec, std::string_view key, std::string_view value) {
+    constexpr rlim_t MB = 1024 * 1024;
+
+    if (key == "source") {
+        spec.source_name = value;
+    } else if (key == "exec") {
+        spec.exec_name = value;
+    } else if (key == "compile" || key == "run") {
+        auto template_res = CommandTemplate::Parse(value);
+        if (!template_res.has_value()) {
+            return std::unexpected(template_res.error());
+        }
+        (key == "compile" ? spec.compile.emplace() : spec.run) = std::move(*template_res);
+    } else if (key == "compile_cpu_sec") {
+        auto number_res = ParseNumber<rlim_t>(value);
+        if (!number_res.has_value()) {
+            return std::unexpected(number_res.error());
+        }
+        spec.compile_limits.cpu_time_sec = *number_res;
+    } else if (key == "compile_memory_mb") {
+        auto number_res = ParseNumber<rlim_t>(value);
+        if (!number_res.has_value()) {
+            return std::unexpected(number_res.error());
+        }
+        spec.compile_limits.memory_bytes = *number_res * MB;
+    } else if (key == "compile_file_size_mb") {
+        auto number_res = ParseNumber<rlim_t>(value);
+        if (!number_res.has_value()) {
+            return std::unexpected(number_res.error());
+        }
+        spec.compile_limits.file_size_bytes = *number_res * MB;
+    } else if (key == "time_multiplier") {
+        auto number_res = ParseNumber<double>(value);
+        if (!number_res.has_value() || !(*number_res > 0)) {
+            return std::unexpected(InvalidArgument());
+        }
+        spec.time_multiplier = *number_res;
+    } else if (key == "memory_extra_mb") {
+        auto number_res = ParseNumber<size_t>(value);
+        if (!number_res.has_value()) {
+            return std::unexpected(number_res.error());
+        }
+        spec.memory_extra_kb = *number_res * 1024;
+    } else if (key == "warmup") {
+        spec.warmup_source = value;
+    } else {
+        return std::unexpected(InvalidArgument());
+    }
+
+    return {};
+}
+
+std::expected<void, std::error_code> WriteTextFile(const std::filesystem::path& path, std::string_view text) {
+    auto fd_res = Open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (!fd_res.has_value()) {
+        return std::unexpected(fd_res.error());
+    }
+
+    auto write_res = Write(fd_res->Get(), std::as_bytes(std::span(text.data(), text.size())));
+    if (!write_res.has_value()) {
+        return std::unexpected(write_res.error());
+    } else if (write_res->bytes != text.size()) {
+        return std::unexpected(std::make_error_code(std::errc::io_error));
+    }
+    return {};
+}
+
+} // namespace
+
+std::expected<CommandTemplate, std::error_code> CommandTemplate::Parse(std::string_view text) {
+    CommandTemplate result;
+
+    std::string current;
+    bool is_in_token = false;
+    char quote = '\0';
+
+    for (char c : text) {
+        if (quote != '\0') {
+            if (c == quote) {
+                quote = '\0';
+            } else {
+                current.push_back(c);
+            }
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+            is_in_token = true;
+        } else if (c == ' ' || c == '\t') {
+            if (is_in_token) {
+                result.argv_.push_back(std::move(current));
+                current.clear();
+                is_in_token = false;
+            }
+        } else {
+            current.push_back(c);
+            is_in_token = true;
+        }
+    }
+
+    if (quote != '\0') {
+        return std::unexpected(InvalidArgument());
+    } else if (is_in_token) {
+        result.argv_.push_back(std::move(current));
+    }
+
+    if (result.argv_.empty()) {
+        return std::unexpected(InvalidArgument());
+    }
+    return result;
+}
+
+std::vector<std::string> CommandTemplate::Render(
+    std::string_view source,
+    std::string_view exec,
+    std::string_view exec_dir
+) const {
+    std::vector<std::string> argv = argv_;
+    for (auto& arg : argv) {
+        ReplaceAll(arg, "{source}", source);
+        ReplaceAll(arg, "{exec}", exec);
+        ReplaceAll(arg, "{exec_dir}", exec_dir);
+    }
+    return argv;
+}
+
+LanguageCompiler::LanguageCompiler(LanguageSpec spec) : spec_(std::move(spec)) {
+    if (spec_.run.GetArgv().empty()) {
+        spec_.run = CommandTemplate::Parse("{exec}").value();
+    }
+
+    if (spec_.compile.has_value()) {
+        auto argv = spec_.compile->Render(spec_.source_name, spec_.exec_name, ".");
+
+        compile_command_.emplace(argv.front());
+        compile_command_->Args(std::vector<std::string>(argv.begin() + 1, argv.end()))
+            .Limits(spec_.compile_limits);
+    }
+}
+
+std::expected<CompileResult, std::error_code> LanguageCompiler::Compile(
+    const std::filesystem::path& source_path,
+    const std::filesystem::path& exec_dir
+) {
+    return Compile(source_path, exec_dir, spec_.compile_limits);
+}
+
+std::expected<CompileResult, std::error_code> LanguageCompiler::Compile(
+    const std::filesystem::path& source_path,
+    const std::filesystem::path& exec_dir,
+    const process::ResourceLimits& limits
+) {
+    COJ_TRACE_SCOPE(Compile);
+
+    std::filesystem::path placed_path = exec_dir / spec_.source_name;
+
+    std::error_code ec;
+    if (!std::filesystem::equivalent(source_path, placed_path, ec)) {
+        if (auto link_res = LinkOrCopyFile(source_path, placed_path); !link_res.has_value()) {
+            return std::unexpected(link_res.error());
+        }
+    }
+
+    if (IsInterpreted()) {
+        CompileResult result;
+        result.is_successful = true;
+        result.exec_path = std::move(placed_path);
+        return result;
+    }
+
+    // The cache restores a single file under its own name, so specs with another artifact name, e.g.
+    // Java class files, always compile.
+    std::optional<std::string> cache_key;
+
+    if (cache_ != nullptr && spec_.exec_name == CompileCache::EXEC_FILENAME) {
+        if (auto key_res = GetCacheKey(source_path, limits); key_res.has_value()) {
+            auto lookup_res = cache_->Lookup(*key_res, exec_dir);
+            if (lookup_res.has_value() && lookup_res->has_value()) {
+                CompileResult result = std::move(**lookup_res);
+                result.is_cached = true;
+                return result;
+            }
+            cache_key = std::move(*key_res);
+        }
+    }
+
+    bool is_deterministic = false;
+    auto result = Invoke(exec_dir, limits, is_deterministic);
+
+    if (result.has_value() && cache_key.has_value() && is_deterministic) {
+        (void)cache_->Store(*cache_key, *result);
+    }
+
+    return result;
+}
+
+RunCommand LanguageCompiler::GetRunCommand(const std::filesystem::path& exec_dir) const {
+    auto argv = spec_.run.Render(
+        (exec_dir / spec_.source_name).native(),
+        (exec_dir / (IsInterpreted() ? spec_.source_name : spec_.exec_name)).native(),
+        exec_dir.native()
+    );
+
+    RunCommand command;
+    command.exec_path = std::move(argv.front());
+    command.args.assign(std::make_move_iterator(argv.begin() + 1), std::make_move_iterator(argv.end()));
+    return command;
+}
+
+RunLimits LanguageCompiler::GetRunLimits(const RunLimits& limits) const {
+    auto scale = [this](std::chrono::milliseconds time) {
+        return std::chrono::milliseconds(static_cast<int64_t>(std::ceil(time.count() * spec_.time_multiplier)));
+    };
+
+    RunLimits result = limits;
+    result.cpu_time = scale(limits.cpu_time);
+    if (limits.wall_time.has_value()) {
+        result.wall_time = scale(limits.wall_time.value());
+    }
+    result.memory_kb += spec_.memory_extra_kb;
+    return result;
+}
+
+std::expected<void, std::error_code> LanguageCompiler::Warmup(const std::filesystem::path& scratch_dir) {
+    if (spec_.warmup_source.empty()) {
+        return {};
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(scratch_dir, ec);
+    if (ec) {
+        return std::unexpected(ec);
+    }
+
+    auto warmup = [&]() -> std::expected<void, std::error_code> {
+        std::filesystem::path source_path = scratch_dir / spec_.source_name;
+        if (auto res = WriteTextFile(source_path, spec_.warmup_source); !res.has_value()) {
+            return res;
+        }
+
+        auto compile_res = Compile(source_path, scratch_dir);
+        if (!compile_res.has_value()) {
+            return std::unexpected(compile_res.error());
+        } else if (!compile_res->is_successful) {
+            return std::unexpected(std::make_error_code(std::errc::executable_format_error));
+        }
+
+        // Runs the program once too, so interpreters and runtimes are paged in as well.
+        auto run_command = GetRunCommand(scratch_dir);
+        process::Command command(run_command.exec_path);
+        command.Args(run_command.args)
+            .CurrentDir(scratch_dir)
+            .Limits(spec_.compile_limits)
+            .Stdin(process::Stdio::Null())
+            .Stdout(process::Stdio::Null())
+            .Stderr(process::Stdio::Null());
+
+        auto child_res = command.Spawn();
+        if (!child_res.has_value()) {
+            return std::unexpected(child_res.error());
+        }
+        auto wait_res = child_res->WaitWithTimeout(WARMUP_RUN_TIMEOUT);
+        if (!wait_res.has_value()) {
+            return std::unexpected(wait_res.error());
+        } else if (wait_res->GetWallTime() >= WARMUP_RUN_TIMEOUT) {
+            return std::unexpected(std::make_error_code(std::errc::timed_out));
+        }
+        return {};
+    };
+
+    auto result = warmup();
+    std::filesystem::remove_all(scratch_dir, ec);
+    return result;
+}
+
+std::expected<std::string, std::error_code> LanguageCompiler::GetCacheKey(
+    const std::filesystem::path& source_path,
+    const process::ResourceLimits& limits
+) const {
+    auto fd_res = Open(source_path, O_RDONLY | O_CLOEXEC);
+    if (!fd_res.has_value()) {
+        return std::unexpected(fd_res.error());
+    }
+
+    auto map_res = MemoryMap::Map(fd_res->Get());
+    if (!map_res.has_value()) {
+        return std::unexpected(map_res.error());
+    }
+
+    Sha256 hasher;
+    hasher.UpdateField(spec_.name).UpdateField(spec_.source_name);
+    for (const auto& arg : spec_.compile->GetArgv()) {
+        hasher.UpdateField(arg);
+    }
+
+    // Stands in for a version query: a reinstalled toolchain gets a new inode or mtime.
+    struct stat st;
+    const auto& program = spec_.compile->GetArgv().front();
+    if (::stat(program.c_str(), &st) == 0) {
+        hasher.UpdateField(std::to_string(st.st_ino))
+            .UpdateField(std::to_string(st.st_size))
+            .UpdateField(std::to_string(st.st_mtim.tv_sec) + "." + std::to_string(st.st_mtim.tv_nsec));
+    }
+
+    HashCompileLimits(hasher, limits);
+    hasher.UpdateField(map_res->View());
+
+    return hasher.FinalHex();
+}
+
+std::expected<CompileResult, std::error_code> LanguageCompiler::Invoke(
+    const std::filesystem::path& exec_dir,
+    const process::ResourceLimits& limits,
+    bool& is_deterministic
+) {
+    std::filesystem::path exec_path = exec_dir / spec_.exec_name;
+
+    // The previous artifact may be a hardlink into the cache; never let the compiler write through it.
+    std::error_code ec;
+    std::filesystem::remove(exec_path, ec);
+
+    std::optional<process::PreparedCommand> prepared;
+    {
+        std::lock_guard lock(mutex_);
+        if (!idle_.empty()) {
+            prepared = std::move(idle_.back());
+            idle_.pop_back();
+        }
+    }
+    if (!prepared.has_value()) {
+        prepared = compile_command_->Prepare();
+    }
+
+    prepared->CurrentDir(exec_dir)
+        .Limits(limits)
+        .Stdin(process::Stdio::Null())
+        .Stdout(process::Stdio::Null())
+        .Stderr(process::Stdio::Piped());
+
+    auto child_res = prepared->Spawn();
+
+    {
+        std::lock_guard lock(mutex_);
+        idle_.push_back(std::move(*prepared));
+    }
+
+    if (!child_res.has_value()) {
+        return std::unexpected(child_res.error());
+    }
+
+    thread_local std::vector<char> capture_storage;
+    capture_storage.resize(DEFAULT_MAX_OUTPUT_BYTES);
+    CaptureBuffer capture(capture_storage, DEFAULT_MAX_OUTPUT_BYTES / 2);
+
+    auto communicate_res = Communicate(child_res.value(), { .stderr_capture = &capture });
+    if (!communicate_res.has_value()) {
+        return std::unexpected(communicate_res.error());
+    }
+
+    CompileResult result;
+    result.output = capture.ToString();
+    result.dropped_output_bytes = capture.GetDroppedBytes();
+
+    const auto& exit_status = communicate_res->exit_status;
+    result.is_successful = exit_status.Success() && std::filesystem::exists(exec_path, ec);
+    is_deterministic = IsCacheableCompile(exit_status, limits);
+
+    if (result.is_successful) {
+        result.exec_path = exec_path;
+    }
+
+    return result;
+}
+
+std::expected<CompilerRegistry, std::error_code> CompilerRegistry::Parse(std::string_view text) {
+    std::vector<LanguageSpec> specs;
+
+    while (!text.empty()) {
+        auto newline = text.find('\n');
+        std::string_view line = Trim(text.substr(0, newline));
+        text = newline == std::string_view::npos ? std::string_view() : text.substr(newline + 1);
+
+        if (line.empty() || line.front() == '#' || line.front() == ';') {
+            continue;
+        }
+
+        if (line.front() == '[') {
+            if (line.back() != ']') {
+                return std::unexpected(InvalidArgument());
+            }
+            auto name = Trim(line.substr(1, line.size() - 2));
+            if (name.empty()) {
+                return std::unexpected(InvalidArgument());
+            }
+            specs.emplace_back().name = name;
+            continue;
+        }
+
+        auto equals = line.find('=');
+        if (specs.empty() || equals == std::string_view::npos) {
+            return std::unexpected(InvalidArgument());
+        }
+
+        auto res = ApplyKey(specs.back(), Trim(line.substr(0, equals)), Trim(line.substr(equals + 1)));
+        if (!res.has_value()) {
+            return std::unexpected(res.error());
+        }
+    }
+
+    CompilerRegistry registry;
+    for (auto& spec : specs) {
+        std::string name = spec.name;
+        auto compiler = std::make_unique<LanguageCompiler>(std::move(spec));
+        if (!registry.compilers_.emplace(std::move(name), std::move(compiler)).second) {
+            return std::unexpected(InvalidArgument());
+        }
+    }
+    return registry;
+}
+
+std::expected<CompilerRegistry, std::error_code> CompilerRegistry::Load(const std::filesystem::path& path) {
+    auto fd_res = Open(path, O_RDONLY | O_CLOEXEC);
+    if (!fd_res.has_value()) {
+        return std::unexpected(fd_res.error());
+    }
+
+    auto text_res = ReadAllAsString(fd_res->Get());
+    if (!text_res.has_value()) {
+        return std::unexpected(text_res.error());
+    }
+
+    return Parse(*text_res);
+}
+
+LanguageCompiler* CompilerRegistry::Get(std::string_view name) const {
+    auto it = compilers_.find(std::string(name));
+    return it == compilers_.end() ? nullptr : it->second.get();
+}
+
+std::vector<std::string> CompilerRegistry::GetLanguageNames() const {
+    std::vector<std::string> names;
+    names.reserve(compilers_.size());
+    for (const auto& [name, compiler] : compilers_) {
+        names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+CompilerRegistry& CompilerRegistry::Cache(CompileCache* cache) {
+    for (auto& [name, compiler] : compilers_) {
+        compiler->Cache(cache);
+    }
+    return *this;
+}
+
+std::expected<void, std::error_code> CompilerRegistry::Warmup(const std::filesystem::path& scratch_root) {
+    for (const auto& name : GetLanguageNames()) {
+        auto res = compilers_.at(name)->Warmup(scratch_root / ("warmup-" + name));
+        if (!res.has_value()) {
+            return res;
+        }
+    }
+    return {};
+}
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include <poll.h>
+
+#include <utility>
+
+#include "coj/capture_buffer.h"
+#include "coj/custom_checker.h"
+#include "coj/file_io.h"
+#include "coj/reactor.h"
+
+namespace coj {
+
+namespace {
+
+using namespace std::chrono;
+
+constexpr uint32_t MAX_REPLY_MESSAGE_BYTES = 16 * 1024 * 1024;
+
+void AppendFrame(std::string& buffer, std::string_view payload) {
+    auto length = static_cast<uint32_t>(payload.size());
+    buffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    buffer.append(payload);
+}
+
+std::expected<void, std::error_code> ReadExact(int fd, std::span<std::byte> buffer, steady_clock::time_point deadline) {
+    size_t filled = 0;
+
+    while (filled < buffer.size()) {
+        auto remaining = ceil<milliseconds>(deadline - steady_clock::now());
+        if (remaining <= milliseconds::zero()) {
+            return std::unexpected(std::make_error_code(std::errc::timed_out));
+        }
+
+        ::pollfd pfd = { .fd = fd, .events = POLLIN, .revents = 0 };
+        int ready = ::poll(&pfd, 1, static_cast<int>(remaining.count()));
+        if (ready == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return std::unexpected(std::error_code(errno, std::generic_category()));
+        } else if (ready == 0) {
+            continue;
+        }
+
+        auto read_res = Read(fd, buffer.subspan(filled));
+        if (!read_res.has_value()) {
+            return std::unexpected(read_res.error());
+        } else if (read_res->status == IoStatus::EoF) {
+            return std::unexpected(std::make_error_code(std::errc::broken_pipe));
+        }
+        filled += read_res->bytes;
+    }
+
+    return {};
+}
+
+} // namespace
+
+std::expected<CheckResult, std::error_code> ToCheckResult(int code) {
+    switch (static_cast<CheckerCode>(code)) {
+        case CheckerCode::Ok:
+            return CheckResult::Accepted;
+        case CheckerCode::WrongAnswer:
+        case CheckerCode::PresentationError:
+        case CheckerCode::Points:
+            return CheckResult::WrongAnswer;
+        default:
+            return std::unexpected(std::make_error_code(std::errc::state_not_recoverable));
+    }
+}
+
+std::expected<CheckVerdict, std::error_code> TokenChecker::Check(const CheckRequest& request) {
+    CheckConfig config{
+        .output_path = request.output_path,
+        .answer_path = request.answer_path,
+        .epsilon = epsilon_,
+        .answer_cache = answer_cache_
+    };
+
+    auto check_res = coj::Check(config);
+    if (!check_res.has_value()) {
+        return std::unexpected(check_res.error());
+    }
+
+    return CheckVerdict{ .result = check_res.value(), .message = {} };
+}
+
+std::expected<CheckVerdict, std::error_code> ExternalChecker::Check(const CheckRequest& request) {
+    if (config_.is_persistent) {
+        return CheckPersistent(request);
+    }
+    return CheckOnce(request);
+}
+
+size_t ExternalChecker::GetStartCount() const {
+    std::lock_guard lock(mutex_);
+    return start_count_;
+}
+
+std::expected<CheckVerdict, std::error_code> ExternalChecker::CheckOnce(const CheckRequest& request) {
+    process::Command command(config_.exec_path);
+    command.Args(config_.args)
+        .Arg(request.input_path.string())
+        .Arg(request.output_path.string())
+        .Arg(request.answer_path.string())
+        .Stdin(process::Stdio::Null())
+        .Stdout(process::Stdio::Null())
+        .Stderr(process::Stdio::Piped())
+        .Limits(config_.limits);
+
+    auto child_res = command.Spawn();
+    if (!child_res.has_value()) {
+        return std::unexpected(child_res.error());
+    }
+
+    CaptureBuffer capture(config_.max_message_bytes);
+
+    auto communicate_res = Communicate(child_res.value(), { .stderr_capture = &capture, .timeout = config_.timeout });
+    if (!communicate_res.has_value()) {
+        return std::unexpected(communicate_res.error());
+    } else if (communicate_res->is_timed_out) {
+        return std::unexpected(std::make_error_code(std::errc::timed_out));
+    }
+
+    auto code = communicate_res->exit_status.Code();
+    if (!code.has_value()) {
+        return std::unexpected(std::make_error_code(std::errc::state_not_recoverable));
+    }
+
+    auto result_res = ToCheckResult(code.value());
+    if (!result_res.has_value()) {
+        return std::unexpected(result_res.error());
+    }
+
+    return CheckVerdict{ .result = result_res.value(), .message = capture.ToString() };
+}
+
+std::expected<CheckVerdict, std::error_code> ExternalChecker::CheckPersistent(const CheckRequest& request) {
+    std::lock_guard lock(mutex_);
+
+    bool is_reused = child_.has_value();
+    if (!is_reused) {
+        if (auto res = StartLocked(); !res.has_value()) {
+            return std::unexpected(res.error());
+        }
+    }
+
+    auto verdict_res = Exchange(request);
+
+    // The process may have exited after the previous reply; that is not this request's fault.
+    if (!verdict_res.has_value() && verdict_res.error() == std::errc::broken_pipe && is_reused) {
+        StopLocked();
+        if (auto res = StartLocked(); !res.has_value()) {
+            return std::unexpected(res.error());
+        }
+        verdict_res = Exchange(request);
+    }
+
+    if (!verdict_res.has_value() && verdict_res.error() != std::errc::state_not_recoverable) {
+        StopLocked();
+    }
+
+    return verdict_res;
+}
+
+std::expected<CheckVerdict, std::error_code> ExternalChecker::Exchange(const CheckRequest& request) {
+    auto deadline = steady_clock::now() + config_.timeout;
+
+    std::string frames;
+    AppendFrame(frames, request.input_path.native());
+    AppendFrame(frames, request.output_path.native());
+    AppendFrame(frames, request.answer_path.native());
+
+    {
+        SigPipeGuard guard;
+        auto write_res = Write(child_->stdin_pipe->Get(), std::as_bytes(std::span(frames.data(), frames.size())));
+        if (!write_res.has_value()) {
+            return std::unexpected(write_res.error());
+        } else if (write_res->bytes != frames.size()) {
+            return std::unexpected(std::make_error_code(std::errc::broken_pipe));
+        }
+    }
+
+    int stdout_fd = child_->stdout_pipe->Get();
+
+    struct {
+        int32_t code;
+        uint32_t message_length;
+    } header;
+    if (auto res = ReadExact(stdout_fd, std::as_writable_bytes(std::span(&header, 1)), deadline); !res.has_value()) {
+        return std::unexpected(res.error());
+    } else if (header.message_length > MAX_REPLY_MESSAGE_BYTES) {
+        return std::unexpected(std::make_error_code(std::errc::bad_message));
+    }
+
+    std::string message(header.message_length, '\0');
+    if (auto res = ReadExact(stdout_fd, std::as_writable_bytes(std::span(message)), deadline); !res.has_value()) {
+        return std::unexpected(res.error());
+    }
+    if (message.size() > config_.max_message_bytes) {
+        message.resize(config_.max_message_bytes);
+    }
+
+    auto result_res = ToCheckResult(header.code);
+    if (!result_res.has_value()) {
+        return std::unexpected(result_res.error());
+    }
+
+    return CheckVerdict{ .result = result_res.value(), .message = std::move(message) };
+}
+
+std::expected<void, std::error_code> ExternalChecker::StartLocked() {
+    process::Command command(config_.exec_path);
+    command.Args(config_.args)
+        .Stdin(process::Stdio::Piped())
+        .Stdout(process::Stdio::Piped())
+        .Stderr(process::Stdio::Null())
+        .Limits(config_.limits);
+
+    auto child_res = command.Spawn();
+    if (!child_res.has_value()) {
+        return std::unexpected(child_res.error());
+    }
+
+    child_.emplace(std::move(*child_res));
+    ++start_count_;
+    return {};
+}
+
+void ExternalChecker::StopLocked() {
+    if (!child_.has_value()) {
+        return;
+    }
+
+    child_->Kill();
+    (void)child_->Wait();
+    child_.reset();
+}
+
+} // namespace coj
\ No newline at end of file
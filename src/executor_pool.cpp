@@ -0,0 +1,413 @@
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "coj/executor_pool.h"
+#include "coj/telemetry.h"
+
+namespace coj {
+
+namespace {
+
+constexpr std::uint32_t REQUEST_MAGIC = 0x636f6a78;
+
+struct ExecRequest {
+    std::uint32_t magic;
+};
+
+struct ExecStarted {
+    int error;
+    pid_t pid;
+};
+
+struct ExecFinished {
+    int status;
+    ::rusage usage;
+    std::int64_t wall_time_ns;
+};
+
+constexpr size_t MAX_PASSED_FDS = 2;
+
+ssize_t SendMessage(int sock, const void* data, size_t size, const int* fds, size_t fd_count) noexcept {
+    ::iovec iov = { .iov_base = const_cast<void*>(data), .iov_len = size };
+
+    alignas(::cmsghdr) std::array<char, CMSG_SPACE(sizeof(int) * MAX_PASSED_FDS)> control;
+
+    ::msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    if (fd_count > 0) {
+        msg.msg_control = control.data();
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fd_count);
+
+        ::cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fd_count);
+        std::memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fd_count);
+    }
+
+    ssize_t sent;
+    do {
+        sent = ::sendmsg(sock, &msg, MSG_NOSIGNAL);
+    } while (sent == -1 && errno == EINTR);
+
+    return sent;
+}
+
+ssize_t ReceiveMessage(int sock, void* data, size_t size, int* fds, size_t& fd_count) noexcept {
+    ::iovec iov = { .iov_base = data, .iov_len = size };
+
+    alignas(::cmsghdr) std::array<char, CMSG_SPACE(sizeof(int) * MAX_PASSED_FDS)> control;
+
+    ::msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    ssize_t received;
+    do {
+        received = ::recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    } while (received == -1 && errno == EINTR);
+
+    size_t max_fds = fd_count;
+    fd_count = 0;
+
+    if (received <= 0) {
+        return received;
+    }
+
+    for (::cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+
+        size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const auto* received_fds = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+        for (size_t i = 0; i < count; ++i) {
+            if (fd_count < max_fds) {
+                fds[fd_count++] = received_fds[i];
+            } else {
+                ::close(received_fds[i]);
+            }
+        }
+    }
+
+    return received;
+}
+
+void CloseFdsExcept(int keep_fd) noexcept {
+    long max_fd = ::sysconf(_SC_OPEN_MAX);
+    if (max_fd < 0) {
+        max_fd = _POSIX_OPEN_MAX;
+    }
+
+#ifdef SYS_close_range
+    if ((keep_fd <= 3 || ::close_range(3, keep_fd - 1, 0) == 0) && ::close_range(keep_fd + 1, ~0U, 0) == 0) {
+        return;
+    }
+#endif
+
+    for (int fd = 3; fd < max_fd; ++fd) {
+        if (fd != keep_fd) {
+            ::close(fd);
+        }
+    }
+}
+
+// Runs in the forked server. Everything it touches was allocated before the fork, so it stays
+// safe even when the parent was multithreaded.
+[[noreturn]] void ServerMain(int sock, process::PreparedCommand& prepared) {
+    // Spawn() and Wait() carry probes; the first span would take the registry lock and allocate.
+    telemetry::SuppressCurrentThread();
+
+    CloseFdsExcept(sock);
+
+    sigset_t empty_mask;
+    ::sigemptyset(&empty_mask);
+    ::sigprocmask(SIG_SETMASK, &empty_mask, nullptr);
+
+    while (true) {
+        ExecRequest request = {};
+        std::array<int, MAX_PASSED_FDS> fds;
+        size_t fd_count = fds.size();
+
+        ssize_t received = ReceiveMessage(sock, &request, sizeof(request), fds.data(), fd_count);
+        if (received <= 0) {
+            ::_exit(0);
+        }
+
+        ExecStarted started = { .error = 0, .pid = 0 };
+
+        if (static_cast<size_t>(received) != sizeof(request) || request.magic != REQUEST_MAGIC || fd_count != MAX_PASSED_FDS) {
+            for (size_t i = 0; i < fd_count; ++i) {
+                ::close(fds[i]);
+            }
+            started.error = EBADMSG;
+            SendMessage(sock, &started, sizeof(started), nullptr, 0);
+            continue;
+        }
+
+        prepared.Stdin(process::Stdio::From(FileDescriptor(fds[0])))
+            .Stdout(process::Stdio::From(FileDescriptor(fds[1])));
+
+        auto child_res = prepared.Spawn();
+        if (!child_res.has_value()) {
+            started.error = child_res.error().value();
+            SendMessage(sock, &started, sizeof(started), nullptr, 0);
+            continue;
+        }
+
+        started.pid = child_res->GetPid();
+        int pidfd = child_res->GetPidFd();
+        if (SendMessage(sock, &started, sizeof(started), &pidfd, pidfd >= 0 ? 1 : 0) == -1) {
+            child_res->Kill();
+        }
+
+        ExecFinished finished = {};
+        auto wait_res = child_res->Wait();
+        if (wait_res.has_value()) {
+            finished.status = wait_res->GetRaw();
+            finished.usage = wait_res->GetUsage();
+            finished.wall_time_ns = wait_res->GetWallTime().count();
+        } else {
+            finished.status = -1;
+        }
+
+        SendMessage(sock, &finished, sizeof(finished), nullptr, 0);
+    }
+}
+
+std::error_code LastError() {
+    return std::error_code(errno, std::generic_category());
+}
+
+} // namespace
+
+std::expected<void, std::error_code> ExecutorPool::Start() {
+    std::lock_guard lock(mutex_);
+
+    if (is_started_) {
+        return {};
+    }
+
+    process::Command command(config_.exec_path);
+    command.Args(config_.args)
+        .Limits(config_.limits)
+        .Placement(config_.placement)
+        .Backend(process::SpawnBackend::VFork)
+        .Stderr(process::Stdio::Null());
+
+    prepared_.emplace(command.Prepare());
+    if (config_.work_dir.has_value()) {
+        prepared_->CurrentDir(config_.work_dir.value());
+    }
+
+    size_t server_count = std::max<size_t>(config_.server_count, 1);
+    servers_.resize(server_count);
+    idle_.clear();
+
+    for (size_t i = 0; i < server_count; ++i) {
+        if (auto res = StartServer(servers_[i]); !res.has_value()) {
+            for (auto& server : servers_) {
+                StopServer(server);
+            }
+            servers_.clear();
+            return std::unexpected(res.error());
+        }
+        idle_.push_back(i);
+    }
+
+    is_started_ = true;
+    return {};
+}
+
+std::expected<process::ExitStatus, std::error_code> ExecutorPool::Execute(
+    int stdin_fd,
+    int stdout_fd,
+    std::chrono::nanoseconds timeout
+) {
+    size_t index;
+    {
+        std::unique_lock lock(mutex_);
+        idle_cv_.wait(lock, [this] { return !is_started_ || !idle_.empty(); });
+
+        if (!is_started_) {
+            return std::unexpected(std::make_error_code(std::errc::operation_canceled));
+        }
+
+        index = idle_.back();
+        idle_.pop_back();
+    }
+
+    Server& server = servers_[index];
+
+    std::expected<process::ExitStatus, std::error_code> result =
+        std::unexpected(std::make_error_code(std::errc::no_child_process));
+
+    if (server.socket.IsValid() || StartServer(server).has_value()) {
+        bool is_server_broken = false;
+        result = ExecuteOn(server, stdin_fd, stdout_fd, timeout, is_server_broken);
+        if (is_server_broken) {
+            StopServer(server);
+        }
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        idle_.push_back(index);
+    }
+    idle_cv_.notify_all();
+
+    return result;
+}
+
+void ExecutorPool::Stop() {
+    std::unique_lock lock(mutex_);
+
+    if (!is_started_) {
+        return;
+    }
+    is_started_ = false;
+    idle_cv_.notify_all();
+
+    idle_cv_.wait(lock, [this] { return idle_.size() == servers_.size(); });
+
+    for (auto& server : servers_) {
+        StopServer(server);
+    }
+    servers_.clear();
+    idle_.clear();
+}
+
+size_t ExecutorPool::GetLiveServerCount() const {
+    std::lock_guard lock(mutex_);
+
+    size_t count = 0;
+    for (const auto& server : servers_) {
+        if (server.socket.IsValid()) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+std::expected<void, std::error_code> ExecutorPool::StartServer(Server& server) {
+    int sv[2];
+    if (::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) == -1) {
+        return std::unexpected(LastError());
+    }
+
+    FileDescriptor parent_socket(sv[0]);
+    FileDescriptor server_socket(sv[1]);
+
+    pid_t pid = ::fork();
+    if (pid == -1) {
+        return std::unexpected(LastError());
+    } else if (pid == 0) {
+        ServerMain(server_socket.Get(), *prepared_);
+    }
+
+    server.process.emplace(pid);
+    server.socket = std::move(parent_socket);
+
+    return {};
+}
+
+void ExecutorPool::StopServer(Server& server) {
+    server.socket.Close();
+
+    if (server.process.has_value() && server.process->IsValid()) {
+        auto wait_res = server.process->WaitWithTimeout(std::chrono::milliseconds(100));
+        (void)wait_res;
+    }
+    server.process.reset();
+}
+
+std::expected<process::ExitStatus, std::error_code> ExecutorPool::ExecuteOn(
+    Server& server,
+    int stdin_fd,
+    int stdout_fd,
+    std::chrono::nanoseconds timeout,
+    bool& is_server_broken
+) {
+    is_server_broken = true;
+
+    int sock = server.socket.Get();
+
+    ExecRequest request = { .magic = REQUEST_MAGIC };
+    std::array<int, MAX_PASSED_FDS> passed_fds = { stdin_fd, stdout_fd };
+    if (SendMessage(sock, &request, sizeof(request), passed_fds.data(), passed_fds.size()) == -1) {
+        return std::unexpected(LastError());
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    ExecStarted started = {};
+    int pidfd_raw = FileDescriptor::INVALID_FILE_DESCRIPTOR;
+    size_t fd_count = 1;
+
+    ssize_t received = ReceiveMessage(sock, &started, sizeof(started), &pidfd_raw, fd_count);
+    if (received == -1) {
+        return std::unexpected(LastError());
+    } else if (static_cast<size_t>(received) != sizeof(started)) {
+        return std::unexpected(std::make_error_code(std::errc::connection_aborted));
+    }
+
+    FileDescriptor pidfd(fd_count > 0 ? pidfd_raw : FileDescriptor::INVALID_FILE_DESCRIPTOR);
+
+    if (started.error != 0) {
+        is_server_broken = false;
+        return std::unexpected(std::error_code(started.error, std::generic_category()));
+    }
+
+    while (true) {
+        auto remaining = deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::nanoseconds::zero()) {
+            if (pidfd.IsValid()) {
+                ::syscall(SYS_pidfd_send_signal, pidfd.Get(), SIGKILL, nullptr, 0);
+            } else {
+                ::kill(started.pid, SIGKILL);
+            }
+            break;
+        }
+
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(remaining);
+        ::timespec ts = {
+            .tv_sec = static_cast<time_t>(secs.count()),
+            .tv_nsec = static_cast<long>((remaining - secs).count()),
+        };
+
+        ::pollfd pfd = { .fd = sock, .events = POLLIN, .revents = 0 };
+        int ready = ::ppoll(&pfd, 1, &ts, nullptr);
+
+        if (ready > 0) {
+            break;
+        } else if (ready == -1 && errno != EINTR) {
+            return std::unexpected(LastError());
+        }
+    }
+
+    ExecFinished finished = {};
+    fd_count = 0;
+
+    received = ReceiveMessage(sock, &finished, sizeof(finished), nullptr, fd_count);
+    if (received == -1) {
+        return std::unexpected(LastError());
+    } else if (static_cast<size_t>(received) != sizeof(finished) || finished.status == -1) {
+        return std::unexpected(std::make_error_code(std::errc::connection_aborted));
+    }
+
+    is_server_broken = false;
+    return process::ExitStatus::FromRaw(finished.status, finished.usage, std::chrono::nanoseconds(finished.wall_time_ns));
+}
+
+} // namespace coj
\ No newline at end of file
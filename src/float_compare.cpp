@@ -0,0 +1,130 @@
+#include <bit>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "coj/checker.h"
+#include "coj/float_compare.h"
+
+namespace coj {
+
+namespace {
+
+using Kernel = size_t (*)(const double*, const double*, size_t, double) noexcept;
+
+size_t ScalarKernel(const double* answer, const double* output, size_t size, double epsilon) noexcept {
+    for (size_t i = 0; i < size; ++i) {
+        if (!IsFloatEqual(answer[i], output[i], epsilon)) {
+            return i;
+        }
+    }
+    return size;
+}
+
+#if defined(__SSE2__)
+size_t Sse2Kernel(const double* answer, const double* output, size_t size, double epsilon) noexcept {
+    const __m128d sign_mask = _mm_set1_pd(-0.0);
+    const __m128d eps = _mm_set1_pd(epsilon);
+
+    size_t i = 0;
+    for (; i + 2 <= size; i += 2) {
+        __m128d a = _mm_loadu_pd(answer + i);
+        __m128d b = _mm_loadu_pd(output + i);
+
+        __m128d diff = _mm_andnot_pd(sign_mask, _mm_sub_pd(a, b));
+        __m128d max_abs = _mm_max_pd(_mm_andnot_pd(sign_mask, a), _mm_andnot_pd(sign_mask, b));
+        __m128d ok = _mm_or_pd(_mm_cmple_pd(diff, eps), _mm_cmple_pd(diff, _mm_mul_pd(eps, max_abs)));
+
+        uint32_t bad = ~static_cast<uint32_t>(_mm_movemask_pd(ok)) & 0x3u;
+        if (bad != 0) {
+            return i + std::countr_zero(bad);
+        }
+    }
+
+    return i + ScalarKernel(answer + i, output + i, size - i, epsilon);
+}
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__)
+__attribute__((target("avx2")))
+size_t Avx2Kernel(const double* answer, const double* output, size_t size, double epsilon) noexcept {
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+    const __m256d eps = _mm256_set1_pd(epsilon);
+
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m256d a = _mm256_loadu_pd(answer + i);
+        __m256d b = _mm256_loadu_pd(output + i);
+
+        __m256d diff = _mm256_andnot_pd(sign_mask, _mm256_sub_pd(a, b));
+        __m256d max_abs = _mm256_max_pd(_mm256_andnot_pd(sign_mask, a), _mm256_andnot_pd(sign_mask, b));
+        __m256d ok = _mm256_or_pd(
+            _mm256_cmp_pd(diff, eps, _CMP_LE_OQ),
+            _mm256_cmp_pd(diff, _mm256_mul_pd(eps, max_abs), _CMP_LE_OQ)
+        );
+
+        uint32_t bad = ~static_cast<uint32_t>(_mm256_movemask_pd(ok)) & 0xFu;
+        if (bad != 0) {
+            return i + std::countr_zero(bad);
+        }
+    }
+
+    return i + ScalarKernel(answer + i, output + i, size - i, epsilon);
+}
+#endif
+
+#if defined(__aarch64__)
+size_t NeonKernel(const double* answer, const double* output, size_t size, double epsilon) noexcept {
+    const float64x2_t eps = vdupq_n_f64(epsilon);
+
+    size_t i = 0;
+    for (; i + 2 <= size; i += 2) {
+        float64x2_t a = vld1q_f64(answer + i);
+        float64x2_t b = vld1q_f64(output + i);
+
+        float64x2_t diff = vabsq_f64(vsubq_f64(a, b));
+        float64x2_t max_abs = vmaxq_f64(vabsq_f64(a), vabsq_f64(b));
+        uint64x2_t ok = vorrq_u64(vcleq_f64(diff, eps), vcleq_f64(diff, vmulq_f64(eps, max_abs)));
+
+        if (vgetq_lane_u64(ok, 0) == 0) {
+            return i;
+        } else if (vgetq_lane_u64(ok, 1) == 0) {
+            return i + 1;
+        }
+    }
+
+    return i + ScalarKernel(answer + i, output + i, size - i, epsilon);
+}
+#endif
+
+Kernel SelectKernel() noexcept {
+#if defined(__x86_64__) && defined(__GNUC__)
+    if (__builtin_cpu_supports("avx2")) {
+        return Avx2Kernel;
+    }
+#endif
+#if defined(__SSE2__)
+    return Sse2Kernel;
+#elif defined(__aarch64__)
+    return NeonKernel;
+#else
+    return ScalarKernel;
+#endif
+}
+
+} // namespace
+
+size_t FindFloatMismatch(std::span<const double> answer, std::span<const double> output, double epsilon) noexcept {
+    static const Kernel kernel = SelectKernel();
+    return kernel(answer.data(), output.data(), answer.size(), epsilon);
+}
+
+size_t FindFloatMismatchScalar(std::span<const double> answer, std::span<const double> output, double epsilon) noexcept {
+    return ScalarKernel(answer.data(), output.data(), answer.size(), epsilon);
+}
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "coj/hash.h"
+
+namespace coj {
+
+namespace {
+
+constexpr std::array<std::uint32_t, 64> ROUND_CONSTANTS = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+constexpr std::array<std::uint32_t, 8> INITIAL_STATE = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+} // namespace
+
+void Sha256::Reset() noexcept {
+    state_ = INITIAL_STATE;
+    buffer_size_ = 0;
+    total_bytes_ = 0;
+}
+
+Sha256& Sha256::Update(std::span<const std::byte> data) noexcept {
+    const auto* bytes = reinterpret_cast<const std::uint8_t*>(data.data());
+    size_t remaining = data.size();
+
+    total_bytes_ += remaining;
+
+    if (buffer_size_ > 0) {
+        size_t take = std::min(remaining, BLOCK_SIZE - buffer_size_);
+        std::memcpy(buffer_.data() + buffer_size_, bytes, take);
+        buffer_size_ += take;
+        bytes += take;
+        remaining -= take;
+
+        if (buffer_size_ < BLOCK_SIZE) {
+            return *this;
+        }
+        Compress(buffer_.data());
+        buffer_size_ = 0;
+    }
+
+    while (remaining >= BLOCK_SIZE) {
+        Compress(bytes);
+        bytes += BLOCK_SIZE;
+        remaining -= BLOCK_SIZE;
+    }
+
+    std::memcpy(buffer_.data(), bytes, remaining);
+    buffer_size_ = remaining;
+
+    return *this;
+}
+
+Sha256& Sha256::UpdateField(std::string_view data) noexcept {
+    std::array<std::uint8_t, 8> length;
+    std::uint64_t size = data.size();
+    for (size_t i = 0; i < length.size(); ++i) {
+        length[i] = static_cast<std::uint8_t>(size >> (8 * i));
+    }
+
+    Update(std::as_bytes(std::span(length)));
+    return Update(data);
+}
+
+Sha256::Digest Sha256::Final() noexcept {
+    std::uint64_t total_bits = total_bytes_ * 8;
+
+    buffer_[buffer_size_++] = 0x80;
+    if (buffer_size_ > BLOCK_SIZE - 8) {
+        std::memset(buffer_.data() + buffer_size_, 0, BLOCK_SIZE - buffer_size_);
+        Compress(buffer_.data());
+        buffer_size_ = 0;
+    }
+    std::memset(buffer_.data() + buffer_size_, 0, BLOCK_SIZE - 8 - buffer_size_);
+
+    for (size_t i = 0; i < 8; ++i) {
+        buffer_[BLOCK_SIZE - 1 - i] = static_cast<std::uint8_t>(total_bits >> (8 * i));
+    }
+    Compress(buffer_.data());
+
+    Digest digest;
+    for (size_t i = 0; i < state_.size(); ++i) {
+        digest[i * 4 + 0] = static_cast<std::uint8_t>(state_[i] >> 24);
+        digest[i * 4 + 1] = static_cast<std::uint8_t>(state_[i] >> 16);
+        digest[i * 4 + 2] = static_cast<std::uint8_t>(state_[i] >> 8);
+        digest[i * 4 + 3] = static_cast<std::uint8_t>(state_[i]);
+    }
+
+    Reset();
+    return digest;
+}
+
+std::string Sha256::FinalHex() {
+    return ToHex(Final());
+}
+
+std::string Sha256::ToHex(const Digest& digest) {
+    static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+    std::string hex(digest.size() * 2, '\0');
+    for (size_t i = 0; i < digest.size(); ++i) {
+        hex[i * 2] = HEX_DIGITS[digest[i] >> 4];
+        hex[i * 2 + 1] = HEX_DIGITS[digest[i] & 0x0f];
+    }
+    return hex;
+}
+
+void Sha256::Compress(const std::uint8_t* block) noexcept {
+    std::array<std::uint32_t, 64> w;
+    for (size_t i = 0; i < 16; ++i) {
+        w[i] = (static_cast<std::uint32_t>(block[i * 4]) << 24) |
+               (static_cast<std::uint32_t>(block[i * 4 + 1]) << 16) |
+               (static_cast<std::uint32_t>(block[i * 4 + 2]) << 8) |
+               static_cast<std::uint32_t>(block[i * 4 + 3]);
+    }
+    for (size_t i = 16; i < 64; ++i) {
+        std::uint32_t s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        std::uint32_t s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    auto [a, b, c, d, e, f, g, h] = state_;
+
+    for (size_t i = 0; i < 64; ++i) {
+        std::uint32_t s1 = std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25);
+        std::uint32_t ch = (e & f) ^ (~e & g);
+        std::uint32_t t1 = h + s1 + ch + ROUND_CONSTANTS[i] + w[i];
+        std::uint32_t s0 = std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22);
+        std::uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        std::uint32_t t2 = s0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state_[0] += a;
+    state_[1] += b;
+    state_[2] += c;
+    state_[3] += d;
+    state_[4] += e;
+    state_[5] += f;
+    state_[6] += g;
+    state_[7] += h;
+}
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,343 @@
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <array>
+#include <thread>
+
+#include "coj/custom_checker.h"
+#include "coj/file_io.h"
+#include "coj/interactive.h"
+#include "coj/spsc_ring.h"
+
+namespace coj {
+
+namespace {
+
+using namespace std::chrono;
+
+constexpr size_t RELAY_CHUNK_SIZE = 64 * 1024;
+constexpr milliseconds POLL_FALLBACK_INTERVAL = milliseconds(10);
+
+// Indices into WaitBoth's children. When both have exited by the time they are checked, the
+// interactor is reaped first: its verdict usually ended the exchange, and the solution then only saw
+// EOF.
+constexpr std::array<size_t, 2> REAP_ORDER = { 1, 0 };
+
+struct Pipe {
+    FileDescriptor read_end;
+    FileDescriptor write_end;
+};
+
+std::expected<Pipe, std::error_code> CreatePipe() {
+    int p[2];
+    if (::pipe2(p, O_CLOEXEC) == -1) {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    }
+    return Pipe{ .read_end = FileDescriptor(p[0]), .write_end = FileDescriptor(p[1]) };
+}
+
+// tee(2) hands the bytes to the peer without consuming them; they are then read back out of the
+// source pipe for the transcript. Returns when either side goes away.
+void Relay(FileDescriptor in, FileDescriptor out, SpscRing& ring) {
+    SigPipeGuard guard;
+    std::array<char, RELAY_CHUNK_SIZE> buffer;
+
+    while (true) {
+        ssize_t teed = ::tee(in.Get(), out.Get(), buffer.size(), 0);
+        if (teed == -1 && errno == EINTR) {
+            continue;
+        } else if (teed <= 0) {
+            break;
+        }
+
+        size_t consumed = 0;
+        while (consumed < static_cast<size_t>(teed)) {
+            auto read_res = Read(in.Get(), std::as_writable_bytes(std::span(buffer.data() + consumed, teed - consumed)));
+            if (!read_res.has_value() || read_res->status != IoStatus::Success) {
+                break;
+            }
+            consumed += read_res->bytes;
+        }
+
+        for (size_t pushed = 0; pushed < consumed;) {
+            size_t count = ring.TryPush(std::span(buffer.data() + pushed, consumed - pushed));
+            if (count == 0) {
+                std::this_thread::yield();
+            }
+            pushed += count;
+        }
+    }
+
+    ring.Close();
+}
+
+void WriteTranscript(int fd, SpscRing& solution_ring, SpscRing& interactor_ring) {
+    struct Stream {
+        SpscRing& ring;
+        std::string_view prefix;
+        bool is_line_start = true;
+    };
+    std::array<Stream, 2> streams = { Stream{ solution_ring, "> " }, Stream{ interactor_ring, "< " } };
+
+    std::array<char, RELAY_CHUNK_SIZE> buffer;
+    std::string formatted;
+
+    while (true) {
+        bool is_idle = true;
+        bool is_done = true;
+
+        for (auto& stream : streams) {
+            // Checked before popping so the producer's last push is never missed.
+            bool is_closed = stream.ring.IsClosed();
+            size_t count = stream.ring.TryPop(buffer);
+
+            if (count > 0 || !is_closed) {
+                is_done = false;
+            }
+            if (count > 0) {
+                is_idle = false;
+            }
+
+            std::string_view chunk(buffer.data(), count);
+            while (!chunk.empty()) {
+                if (stream.is_line_start) {
+                    formatted.append(stream.prefix);
+                }
+                size_t line_end = chunk.find('\n');
+                size_t take = line_end == std::string_view::npos ? chunk.size() : line_end + 1;
+                formatted.append(chunk.substr(0, take));
+                stream.is_line_start = line_end != std::string_view::npos;
+                chunk.remove_prefix(take);
+            }
+        }
+
+        if (!formatted.empty()) {
+            (void)Write(fd, std::as_bytes(std::span(formatted.data(), formatted.size())));
+            formatted.clear();
+        }
+
+        if (is_done) {
+            break;
+        } else if (is_idle) {
+            std::this_thread::sleep_for(microseconds(100));
+        }
+    }
+}
+
+struct Reaped {
+    process::ExitStatus status;
+    steady_clock::time_point end_time;
+    bool is_killed_at_deadline = false;
+};
+
+// Reaps both children as each exits, so the exit order is known, killing each at its own deadline.
+std::expected<std::pair<Reaped, Reaped>, std::error_code> WaitBoth(
+    process::Child& solution,
+    process::Child& interactor,
+    steady_clock::time_point solution_deadline,
+    steady_clock::time_point interactor_deadline
+) {
+    std::array<process::Child*, 2> children = { &solution, &interactor };
+    std::array<steady_clock::time_point, 2> deadlines = { solution_deadline, interactor_deadline };
+    std::array<std::optional<Reaped>, 2> reaped;
+    std::array<bool, 2> is_killed = { false, false };
+
+    while (!reaped[0].has_value() || !reaped[1].has_value()) {
+        std::array<::pollfd, 2> pfds;
+        nfds_t nfds = 0;
+        bool has_pidfd = true;
+        auto next_deadline = steady_clock::time_point::max();
+
+        for (size_t i : REAP_ORDER) {
+            if (reaped[i].has_value()) {
+                continue;
+            }
+
+            auto status_res = children[i]->TryWait();
+            if (!status_res.has_value()) {
+                return std::unexpected(status_res.error());
+            } else if (status_res->has_value()) {
+                reaped[i] = Reaped{ .status = **status_res, .end_time = steady_clock::now(), .is_killed_at_deadline = is_killed[i] };
+                continue;
+            }
+
+            if (!is_killed[i] && steady_clock::now() >= deadlines[i]) {
+                children[i]->Kill();
+                is_killed[i] = true;
+            }
+            if (!is_killed[i]) {
+                next_deadline = std::min(next_deadline, deadlines[i]);
+            }
+
+            has_pidfd = has_pidfd && children[i]->GetPidFd() != FileDescriptor::INVALID_FILE_DESCRIPTOR;
+            pfds[nfds++] = { .fd = children[i]->GetPidFd(), .events = POLLIN, .revents = 0 };
+        }
+
+        if (nfds == 0) {
+            break;
+        }
+
+        auto timeout = next_deadline == steady_clock::time_point::max()
+            ? POLL_FALLBACK_INTERVAL
+            : std::max(ceil<milliseconds>(next_deadline - steady_clock::now()), milliseconds::zero());
+        if (!has_pidfd) {
+            timeout = std::min(timeout, POLL_FALLBACK_INTERVAL);
+        }
+
+        if (::poll(pfds.data(), nfds, static_cast<int>(timeout.count())) == -1 && errno != EINTR) {
+            return std::unexpected(std::error_code(errno, std::generic_category()));
+        }
+    }
+
+    return std::pair(std::move(*reaped[0]), std::move(*reaped[1]));
+}
+
+} // namespace
+
+std::expected<InteractiveResult, std::error_code> RunInteractive(const InteractiveConfig& config) {
+    RunConfig run_config{
+        .exec_path = config.exec_path,
+        .work_dir = config.work_dir,
+        .soft_limits = config.soft_limits,
+        .hard_limits = config.hard_limits,
+        .cgroup_pool = config.cgroup_pool
+    };
+
+    auto solution_out = CreatePipe();
+    auto interactor_out = CreatePipe();
+    if (!solution_out.has_value()) {
+        return std::unexpected(solution_out.error());
+    } else if (!interactor_out.has_value()) {
+        return std::unexpected(interactor_out.error());
+    }
+
+    FileDescriptor interactor_stdin = std::move(solution_out->read_end);
+    FileDescriptor solution_stdin = std::move(interactor_out->read_end);
+
+    std::optional<FileDescriptor> transcript_fd;
+    std::optional<SpscRing> solution_ring;
+    std::optional<SpscRing> interactor_ring;
+    FileDescriptor solution_relay_in;
+    FileDescriptor interactor_relay_in;
+    FileDescriptor solution_relay_out;
+    FileDescriptor interactor_relay_out;
+
+    if (config.transcript_path.has_value()) {
+        auto fd_res = Open(config.transcript_path.value(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC);
+        if (!fd_res.has_value()) {
+            return std::unexpected(fd_res.error());
+        }
+        transcript_fd = std::move(*fd_res);
+
+        auto interactor_in = CreatePipe();
+        auto solution_in = CreatePipe();
+        if (!interactor_in.has_value()) {
+            return std::unexpected(interactor_in.error());
+        } else if (!solution_in.has_value()) {
+            return std::unexpected(solution_in.error());
+        }
+
+        solution_relay_in = std::exchange(interactor_stdin, std::move(interactor_in->read_end));
+        solution_relay_out = std::move(interactor_in->write_end);
+        interactor_relay_in = std::exchange(solution_stdin, std::move(solution_in->read_end));
+        interactor_relay_out = std::move(solution_in->write_end);
+
+        solution_ring.emplace(config.transcript_buffer_bytes);
+        interactor_ring.emplace(config.transcript_buffer_bytes);
+    }
+
+    process::Command interactor_command(config.interactor_path);
+    interactor_command.Arg(config.input_path.string()).Arg(config.output_path.string());
+    if (config.answer_path.has_value()) {
+        interactor_command.Arg(config.answer_path->string());
+    }
+    interactor_command.Args(config.interactor_args)
+        .Stdin(process::Stdio::From(std::move(interactor_stdin)))
+        .Stdout(process::Stdio::From(std::move(interactor_out->write_end)))
+        .Stderr(process::Stdio::Null())
+        .Limits(config.interactor_limits);
+
+    process::Command solution_command(config.exec_path);
+    solution_command.Stdin(process::Stdio::From(std::move(solution_stdin)))
+        .Stdout(process::Stdio::From(std::move(solution_out->write_end)))
+        .Stderr(process::Stdio::Null());
+
+    auto interactor_res = interactor_command.Spawn();
+    if (!interactor_res.has_value()) {
+        return std::unexpected(interactor_res.error());
+    }
+    auto& interactor = interactor_res.value();
+
+    auto cgroup_res = AttachCgroup(solution_command, run_config);
+    if (!cgroup_res.has_value()) {
+        interactor.Kill();
+        (void)interactor.Wait();
+        return std::unexpected(cgroup_res.error());
+    }
+    auto& cgroup = cgroup_res.value();
+
+    auto solution_res = solution_command.Spawn();
+    if (!solution_res.has_value()) {
+        ReleaseCgroup(cgroup, run_config);
+        interactor.Kill();
+        (void)interactor.Wait();
+        return std::unexpected(solution_res.error());
+    }
+    auto& solution = solution_res.value();
+
+    std::vector<std::thread> threads;
+    if (transcript_fd.has_value()) {
+        threads.emplace_back(Relay, std::move(solution_relay_in), std::move(solution_relay_out), std::ref(*solution_ring));
+        threads.emplace_back(Relay, std::move(interactor_relay_in), std::move(interactor_relay_out), std::ref(*interactor_ring));
+        threads.emplace_back(WriteTranscript, transcript_fd->Get(), std::ref(*solution_ring), std::ref(*interactor_ring));
+    }
+
+    // The relays only return once both peers are gone.
+    auto join_threads = [&] {
+        solution.Kill();
+        interactor.Kill();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    };
+
+    auto deadline = steady_clock::now() + GetWallTimeout(run_config);
+    auto interactor_deadline = deadline + InteractiveConfig::INTERACTOR_GRACE;
+
+    auto wait_res = WaitBoth(solution, interactor, deadline, interactor_deadline);
+
+    join_threads();
+
+    auto cgroup_stats = ReleaseCgroup(cgroup, run_config);
+
+    if (!wait_res.has_value()) {
+        return std::unexpected(wait_res.error());
+    }
+    auto& [solution_wait, interactor_wait] = wait_res.value();
+
+    RunResult run_result{
+        .status = RunStatus::Success,
+        .exit_status = solution_wait.status,
+        .cgroup_stats = std::move(cgroup_stats),
+        .is_wall_time_exceeded = solution_wait.is_killed_at_deadline
+    };
+    run_result.status = ClassifyRun(run_result, run_config);
+
+    std::optional<CheckResult> check_result;
+    if (auto code = interactor_wait.status.Code(); code.has_value()) {
+        if (auto check_res = ToCheckResult(code.value()); check_res.has_value()) {
+            check_result = check_res.value();
+        }
+    }
+
+    return InteractiveResult{
+        .run_result = std::move(run_result),
+        .interactor_status = interactor_wait.status,
+        .check_result = check_result,
+        .is_rejected_first = check_result.has_value() && check_result != CheckResult::Accepted &&
+                             interactor_wait.end_time <= solution_wait.end_time
+    };
+}
+
+} // namespace coj
\ No newline at end of file
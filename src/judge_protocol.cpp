@@ -0,0 +1,303 @@
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "coj/judge_protocol.h"
+
+namespace coj {
+
+namespace {
+
+constexpr size_t FRAME_HEADER_BYTES = 5;
+
+std::error_code BadMessage() {
+    return std::make_error_code(std::errc::bad_message);
+}
+
+class PayloadWriter {
+public:
+    explicit PayloadWriter(FrameType type) : buffer_(FRAME_HEADER_BYTES, '\0') {
+        buffer_[4] = static_cast<char>(type);
+    }
+
+    PayloadWriter& U8(uint8_t value) { return Integer(value); }
+    PayloadWriter& U32(uint32_t value) { return Integer(value); }
+    PayloadWriter& U64(uint64_t value) { return Integer(value); }
+
+    PayloadWriter& String(std::string_view value) {
+        U32(static_cast<uint32_t>(value.size()));
+        buffer_.append(value);
+        return *this;
+    }
+
+    std::string Finish() {
+        uint32_t length = static_cast<uint32_t>(buffer_.size() - FRAME_HEADER_BYTES);
+        for (size_t i = 0; i < 4; ++i) {
+            buffer_[i] = static_cast<char>((length >> (8 * i)) & 0xff);
+        }
+        return std::move(buffer_);
+    }
+
+private:
+    template <typename T>
+    PayloadWriter& Integer(T value) {
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            buffer_.push_back(static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xff));
+        }
+        return *this;
+    }
+
+    std::string buffer_;
+};
+
+class PayloadReader {
+public:
+    explicit PayloadReader(std::string_view payload) : payload_(payload) {}
+
+    bool U8(uint8_t& value) { return Integer(value); }
+    bool U32(uint32_t& value) { return Integer(value); }
+    bool U64(uint64_t& value) { return Integer(value); }
+
+    bool I32(int32_t& value) {
+        uint32_t raw;
+        if (!Integer(raw)) {
+            return false;
+        }
+        value = static_cast<int32_t>(raw);
+        return true;
+    }
+
+    bool Bool(bool& value) {
+        uint8_t raw;
+        if (!Integer(raw) || raw > 1) {
+            return false;
+        }
+        value = raw == 1;
+        return true;
+    }
+
+    bool String(std::string& value) {
+        uint32_t length;
+        if (!U32(length) || length > payload_.size()) {
+            return false;
+        }
+        value.assign(payload_.substr(0, length));
+        payload_.remove_prefix(length);
+        return true;
+    }
+
+    // Guards count-prefixed arrays: every element takes at least min_element_bytes.
+    bool Count(uint32_t& count, size_t min_element_bytes) {
+        return U32(count) && count <= payload_.size() / min_element_bytes;
+    }
+
+    bool IsEnd() const noexcept { return payload_.empty(); }
+
+private:
+    template <typename T>
+    bool Integer(T& value) {
+        if (payload_.size() < sizeof(T)) {
+            return false;
+        }
+        uint64_t result = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            result |= static_cast<uint64_t>(static_cast<uint8_t>(payload_[i])) << (8 * i);
+        }
+        value = static_cast<T>(result);
+        payload_.remove_prefix(sizeof(T));
+        return true;
+    }
+
+    std::string_view payload_;
+};
+
+std::expected<void, std::error_code> ReadExact(int fd, char* data, size_t size, bool& is_eof) {
+    size_t total = 0;
+    while (total < size) {
+        ssize_t received = ::recv(fd, data + total, size - total, 0);
+        if (received > 0) {
+            total += static_cast<size_t>(received);
+        } else if (received == 0) {
+            is_eof = total == 0;
+            return std::unexpected(std::make_error_code(is_eof ? std::errc::connection_aborted : std::errc::bad_message));
+        } else if (errno != EINTR) {
+            return std::unexpected(std::error_code(errno, std::generic_category()));
+        }
+    }
+    return {};
+}
+
+} // namespace
+
+std::string EncodeBatch(const std::vector<Submission>& submissions) {
+    PayloadWriter writer(FrameType::Batch);
+    writer.U32(static_cast<uint32_t>(submissions.size()));
+
+    for (const auto& submission : submissions) {
+        writer.U64(submission.id)
+            .String(submission.language)
+            .String(submission.source)
+            .U32(submission.cpu_time_ms)
+            .U32(submission.memory_kb)
+            .U64(submission.output_bytes)
+            .U8(submission.is_stopped_on_first_failure ? 1 : 0)
+            .U32(static_cast<uint32_t>(submission.tests.size()));
+
+        for (const auto& test : submission.tests) {
+            writer.String(test.input_path).String(test.answer_path);
+        }
+    }
+
+    return writer.Finish();
+}
+
+std::string EncodeCompiled(const CompiledMessage& message) {
+    return PayloadWriter(FrameType::Compiled)
+        .U64(message.id)
+        .U8(message.is_successful ? 1 : 0)
+        .U8(message.is_cached ? 1 : 0)
+        .String(message.output)
+        .Finish();
+}
+
+std::string EncodeVerdict(const VerdictMessage& message) {
+    return PayloadWriter(FrameType::Verdict)
+        .U64(message.id)
+        .U32(message.test_index)
+        .U8(static_cast<uint8_t>(message.verdict))
+        .U32(message.cpu_time_ms)
+        .U64(message.memory_kb)
+        .U64(message.wall_time_us)
+        .Finish();
+}
+
+std::string EncodeDone(const DoneMessage& message) {
+    return PayloadWriter(FrameType::Done)
+        .U64(message.id)
+        .U32(message.accepted_count)
+        .U32(message.test_count)
+        .Finish();
+}
+
+std::string EncodeError(const ErrorMessage& message) {
+    return PayloadWriter(FrameType::Error)
+        .U64(message.id)
+        .U32(static_cast<uint32_t>(message.code))
+        .String(message.message)
+        .Finish();
+}
+
+std::expected<std::vector<Submission>, std::error_code> DecodeBatch(std::string_view payload) {
+    // The smallest encoded submission and test, for bounding counts before reserving.
+    constexpr size_t MIN_SUBMISSION_BYTES = 8 + 4 + 4 + 4 + 4 + 8 + 1 + 4;
+    constexpr size_t MIN_TEST_BYTES = 4 + 4;
+
+    PayloadReader reader(payload);
+
+    uint32_t submission_count;
+    if (!reader.Count(submission_count, MIN_SUBMISSION_BYTES)) {
+        return std::unexpected(BadMessage());
+    }
+
+    std::vector<Submission> submissions(submission_count);
+    for (auto& submission : submissions) {
+        uint32_t test_count;
+        if (!reader.U64(submission.id) || !reader.String(submission.language) || !reader.String(submission.source) ||
+            !reader.U32(submission.cpu_time_ms) || !reader.U32(submission.memory_kb) ||
+            !reader.U64(submission.output_bytes) || !reader.Bool(submission.is_stopped_on_first_failure) ||
+            !reader.Count(test_count, MIN_TEST_BYTES)) {
+            return std::unexpected(BadMessage());
+        }
+
+        submission.tests.resize(test_count);
+        for (auto& test : submission.tests) {
+            if (!reader.String(test.input_path) || !reader.String(test.answer_path)) {
+                return std::unexpected(BadMessage());
+            }
+        }
+    }
+
+    if (!reader.IsEnd()) {
+        return std::unexpected(BadMessage());
+    }
+    return submissions;
+}
+
+std::expected<CompiledMessage, std::error_code> DecodeCompiled(std::string_view payload) {
+    PayloadReader reader(payload);
+    CompiledMessage message;
+    if (!reader.U64(message.id) || !reader.Bool(message.is_successful) || !reader.Bool(message.is_cached) ||
+        !reader.String(message.output) || !reader.IsEnd()) {
+        return std::unexpected(BadMessage());
+    }
+    return message;
+}
+
+std::expected<VerdictMessage, std::error_code> DecodeVerdict(std::string_view payload) {
+    PayloadReader reader(payload);
+    VerdictMessage message;
+    uint8_t verdict;
+    if (!reader.U64(message.id) || !reader.U32(message.test_index) || !reader.U8(verdict) ||
+        !reader.U32(message.cpu_time_ms) || !reader.U64(message.memory_kb) || !reader.U64(message.wall_time_us) ||
+        !reader.IsEnd() || verdict > static_cast<uint8_t>(Verdict::Skipped)) {
+        return std::unexpected(BadMessage());
+    }
+    message.verdict = static_cast<Verdict>(verdict);
+    return message;
+}
+
+std::expected<DoneMessage, std::error_code> DecodeDone(std::string_view payload) {
+    PayloadReader reader(payload);
+    DoneMessage message;
+    if (!reader.U64(message.id) || !reader.U32(message.accepted_count) || !reader.U32(message.test_count) ||
+        !reader.IsEnd()) {
+        return std::unexpected(BadMessage());
+    }
+    return message;
+}
+
+std::expected<ErrorMessage, std::error_code> DecodeError(std::string_view payload) {
+    PayloadReader reader(payload);
+    ErrorMessage message;
+    if (!reader.U64(message.id) || !reader.I32(message.code) || !reader.String(message.message) || !reader.IsEnd()) {
+        return std::unexpected(BadMessage());
+    }
+    return message;
+}
+
+std::expected<Frame, std::error_code> ReadFrame(int fd) {
+    char header[FRAME_HEADER_BYTES];
+    bool is_eof = false;
+    if (auto res = ReadExact(fd, header, sizeof(header), is_eof); !res.has_value()) {
+        return std::unexpected(res.error());
+    }
+
+    uint32_t length = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        length |= static_cast<uint32_t>(static_cast<uint8_t>(header[i])) << (8 * i);
+    }
+    if (length > MAX_FRAME_PAYLOAD_BYTES) {
+        return std::unexpected(std::make_error_code(std::errc::message_size));
+    }
+
+    Frame frame{ .type = static_cast<FrameType>(header[4]), .payload = std::string(length, '\0') };
+    if (auto res = ReadExact(fd, frame.payload.data(), length, is_eof); !res.has_value()) {
+        return std::unexpected(is_eof ? BadMessage() : res.error());
+    }
+    return frame;
+}
+
+std::expected<void, std::error_code> WriteFrame(int fd, std::string_view frame) {
+    while (!frame.empty()) {
+        ssize_t sent = ::send(fd, frame.data(), frame.size(), MSG_NOSIGNAL);
+        if (sent >= 0) {
+            frame.remove_prefix(static_cast<size_t>(sent));
+        } else if (errno != EINTR) {
+            return std::unexpected(std::error_code(errno, std::generic_category()));
+        }
+    }
+    return {};
+}
+
+} // namespace coj
\ No newline at end of file
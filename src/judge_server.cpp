@@ -0,0 +1,402 @@
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <array>
+#include <cstring>
+#include <string>
+
+#include "coj/compiler_registry.h"
+#include "coj/file_io.h"
+#include "coj/judge_server.h"
+#include "coj/judger.h"
+
+namespace coj {
+
+namespace {
+
+// Without a cgroup the memory cap becomes RLIMIT_AS, which counts every reservation rather than
+// what is touched. It only stops a runaway allocation; ClassifyRun judges the limit from max RSS.
+constexpr rlim_t ADDRESS_SPACE_MULTIPLIER = 4;
+
+std::error_code LastError() {
+    return std::error_code(errno, std::generic_category());
+}
+
+Verdict ToVerdict(const CaseResult& result) {
+    if (!result.run_result.has_value()) {
+        return Verdict::Skipped;
+    }
+
+    switch (result.run_result->status) {
+        case RunStatus::Success:
+            return result.check_result == CheckResult::Accepted ? Verdict::Accepted : Verdict::WrongAnswer;
+        case RunStatus::RuntimeError:
+            return Verdict::RuntimeError;
+        case RunStatus::TimeLimit:
+            return Verdict::TimeLimit;
+        case RunStatus::MemoryLimit:
+            return Verdict::MemoryLimit;
+        case RunStatus::OutputLimit:
+            return Verdict::OutputLimit;
+    }
+    return Verdict::RuntimeError;
+}
+
+VerdictMessage ToVerdictMessage(uint64_t id, size_t index, const CaseResult& result) {
+    VerdictMessage message{
+        .id = id,
+        .test_index = static_cast<uint32_t>(index),
+        .verdict = ToVerdict(result),
+        .wall_time_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(result.wall_time).count())
+    };
+
+    if (result.run_result.has_value()) {
+        message.cpu_time_ms = static_cast<uint32_t>(result.run_result->GetCpuTime().count());
+        message.memory_kb = result.run_result->GetMaxMemoryKb();
+    }
+    return message;
+}
+
+std::string EncodeFailure(uint64_t id, std::error_code ec) {
+    return EncodeError({ .id = id, .code = ec.value(), .message = ec.message() });
+}
+
+std::expected<void, std::error_code> WriteSource(const std::filesystem::path& path, std::string_view source) {
+    auto fd_res = Open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (!fd_res.has_value()) {
+        return std::unexpected(fd_res.error());
+    }
+
+    auto write_res = Write(fd_res->Get(), std::as_bytes(std::span(source.data(), source.size())));
+    if (!write_res.has_value()) {
+        return std::unexpected(write_res.error());
+    } else if (write_res->bytes != source.size()) {
+        return std::unexpected(std::make_error_code(std::errc::io_error));
+    }
+    return {};
+}
+
+} // namespace
+
+std::expected<void, std::error_code> JudgeServer::Start() {
+    if (config_.registry == nullptr) {
+        return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    } else if (listen_socket_.IsValid()) {
+        return {};
+    }
+
+    ::sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    const auto& socket_path = config_.socket_path.native();
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        return std::unexpected(std::make_error_code(std::errc::filename_too_long));
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    FileDescriptor listen_socket(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    if (!listen_socket.IsValid()) {
+        return std::unexpected(LastError());
+    }
+
+    ::unlink(socket_path.c_str());
+    if (::bind(listen_socket.Get(), reinterpret_cast<const ::sockaddr*>(&address), sizeof(address)) == -1 ||
+        ::listen(listen_socket.Get(), SOMAXCONN) == -1) {
+        return std::unexpected(LastError());
+    }
+
+    FileDescriptor wake_fd(::eventfd(0, EFD_CLOEXEC));
+    if (!wake_fd.IsValid()) {
+        return std::unexpected(LastError());
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(config_.work_root, ec);
+    if (ec) {
+        return std::unexpected(ec);
+    }
+
+    listen_socket_ = std::move(listen_socket);
+    wake_fd_ = std::move(wake_fd);
+    is_stopping_ = false;
+    accept_thread_ = std::thread(&JudgeServer::AcceptLoop, this);
+
+    return {};
+}
+
+void JudgeServer::Stop() {
+    if (!accept_thread_.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        is_stopping_ = true;
+    }
+
+    uint64_t one = 1;
+    (void)::write(wake_fd_.Get(), &one, sizeof(one));
+    accept_thread_.join();
+
+    listen_socket_.Close();
+    wake_fd_.Close();
+    ::unlink(config_.socket_path.c_str());
+
+    std::list<Connection> connections;
+    {
+        std::lock_guard lock(mutex_);
+        for (auto& connection : connections_) {
+            if (connection.socket.IsValid()) {
+                ::shutdown(connection.socket.Get(), SHUT_RDWR);
+            }
+        }
+        connections.splice(connections.end(), connections_);
+    }
+
+    for (auto& connection : connections) {
+        connection.thread.join();
+    }
+}
+
+JudgeServerStats JudgeServer::GetStats() const {
+    return JudgeServerStats{
+        .connection_count = connection_count_.load(),
+        .submission_count = submission_count_.load(),
+        .verdict_count = verdict_count_.load()
+    };
+}
+
+void JudgeServer::AcceptLoop() {
+    std::array<::pollfd, 2> fds = {{
+        { .fd = listen_socket_.Get(), .events = POLLIN, .revents = 0 },
+        { .fd = wake_fd_.Get(), .events = POLLIN, .revents = 0 }
+    }};
+
+    while (true) {
+        if (::poll(fds.data(), fds.size(), -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        } else if (fds[1].revents != 0) {
+            return;
+        } else if (fds[0].revents == 0) {
+            continue;
+        }
+
+        FileDescriptor socket(::accept4(listen_socket_.Get(), nullptr, nullptr, SOCK_CLOEXEC));
+        if (!socket.IsValid()) {
+            if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN) {
+                continue;
+            }
+            return;
+        }
+
+        std::lock_guard lock(mutex_);
+        if (is_stopping_) {
+            return;
+        }
+
+        ReapConnectionsLocked();
+
+        auto& connection = connections_.emplace_back();
+        connection.socket = std::move(socket);
+        connection.thread = std::thread(&JudgeServer::Serve, this, std::ref(connection));
+        ++connection_count_;
+    }
+}
+
+void JudgeServer::Serve(Connection& connection) {
+    int fd = connection.socket.Get();
+
+    while (true) {
+        auto frame_res = ReadFrame(fd);
+        if (!frame_res.has_value()) {
+            if (frame_res.error() != std::make_error_code(std::errc::connection_aborted)) {
+                (void)WriteFrame(fd, EncodeFailure(0, frame_res.error()));
+            }
+            break;
+        }
+
+        if (frame_res->type != FrameType::Batch) {
+            (void)WriteFrame(fd, EncodeFailure(0, std::make_error_code(std::errc::bad_message)));
+            break;
+        }
+
+        auto batch_res = DecodeBatch(frame_res->payload);
+        if (!batch_res.has_value()) {
+            (void)WriteFrame(fd, EncodeFailure(0, batch_res.error()));
+            break;
+        }
+
+        bool is_writable = true;
+        for (const auto& submission : *batch_res) {
+            if (!JudgeSubmission(fd, submission).has_value()) {
+                is_writable = false;
+                break;
+            }
+        }
+        if (!is_writable) {
+            break;
+        }
+    }
+
+    // Closed here rather than when reaped, so the client sees the end of the stream right away.
+    std::lock_guard lock(mutex_);
+    connection.socket.Close();
+    connection.is_done = true;
+}
+
+std::expected<void, std::error_code> JudgeServer::JudgeSubmission(int fd, const Submission& submission) {
+    ++submission_count_;
+
+    auto* compiler = config_.registry->Get(submission.language);
+    if (compiler == nullptr) {
+        return WriteFrame(fd, EncodeFailure(submission.id, std::make_error_code(std::errc::invalid_argument)));
+    }
+
+    std::filesystem::path exec_dir = config_.work_root /
+        ("job-" + std::to_string(::getpid()) + "-" + std::to_string(next_job_id_++));
+
+    std::mutex write_mutex;
+    std::error_code write_error;
+
+    auto judge = [&]() -> std::expected<void, std::error_code> {
+        std::error_code ec;
+        std::filesystem::create_directories(exec_dir, ec);
+        if (ec) {
+            return std::unexpected(ec);
+        }
+
+        std::filesystem::path source_path = exec_dir / compiler->GetSpec().source_name;
+        if (auto res = WriteSource(source_path, submission.source); !res.has_value()) {
+            return res;
+        }
+
+        auto compile_res = compiler->Compile(source_path, exec_dir);
+        if (!compile_res.has_value()) {
+            return std::unexpected(compile_res.error());
+        }
+
+        auto compiled = EncodeCompiled({
+            .id = submission.id,
+            .is_successful = compile_res->is_successful,
+            .is_cached = compile_res->is_cached,
+            .output = std::move(compile_res->output)
+        });
+        if (auto res = WriteFrame(fd, compiled); !res.has_value()) {
+            write_error = res.error();
+            return res;
+        }
+
+        const auto test_count = static_cast<uint32_t>(submission.tests.size());
+        if (!compile_res->is_successful) {
+            if (auto res = WriteFrame(fd, EncodeDone({ .id = submission.id, .test_count = test_count })); !res.has_value()) {
+                write_error = res.error();
+                return res;
+            }
+            return {};
+        }
+
+        auto run_command = compiler->GetRunCommand(exec_dir);
+
+        JudgeConfig judge_config{
+            .exec_path = std::move(run_command.exec_path),
+            .args = std::move(run_command.args),
+            .work_dir = exec_dir,
+            .soft_limits = compiler->GetRunLimits({
+                .cpu_time = std::chrono::milliseconds(submission.cpu_time_ms),
+                .memory_kb = submission.memory_kb
+            }),
+            .cgroup_pool = config_.cgroup_pool,
+            .work_area_pool = config_.work_area_pool,
+            .is_output_in_memory = true,
+            .answer_cache = config_.answer_cache,
+            .worker_count = config_.worker_count,
+            .early_exit = submission.is_stopped_on_first_failure ? EarlyExitPolicy::StopOnFirstFailure : EarlyExitPolicy::RunAll,
+            .result_store = config_.result_store
+        };
+
+        if (submission.output_bytes != 0) {
+            judge_config.soft_limits.output_bytes = submission.output_bytes;
+        }
+
+        auto cpu_seconds = std::chrono::ceil<std::chrono::seconds>(judge_config.soft_limits.cpu_time).count();
+        judge_config.hard_limits.cpu_time_sec = static_cast<rlim_t>(cpu_seconds) + 1;
+
+        // soft_limits already carries the language's allowance. With a cgroup pool this becomes
+        // memory.max, so a runaway allocation is stopped at the limit rather than by the host.
+        auto memory_bytes = static_cast<rlim_t>(judge_config.soft_limits.memory_kb) * 1024;
+        judge_config.hard_limits.memory_bytes = config_.cgroup_pool != nullptr ? memory_bytes : memory_bytes * ADDRESS_SPACE_MULTIPLIER;
+
+        judge_config.test_cases.reserve(test_count);
+        for (const auto& test : submission.tests) {
+            judge_config.test_cases.push_back({ .input_path = test.input_path, .answer_path = test.answer_path });
+        }
+
+        judge_config.on_case_result = [&](size_t index, const CaseResult& result) {
+            std::lock_guard lock(write_mutex);
+            if (write_error) {
+                return;
+            }
+            if (auto res = WriteFrame(fd, EncodeVerdict(ToVerdictMessage(submission.id, index, result))); !res.has_value()) {
+                write_error = res.error();
+            }
+            ++verdict_count_;
+        };
+
+        auto judge_res = JudgeBatch(judge_config);
+        if (write_error) {
+            return std::unexpected(write_error);
+        } else if (!judge_res.has_value()) {
+            return std::unexpected(judge_res.error());
+        }
+
+        // Cases cut off by an early exit never reached the callback; every test still gets a verdict.
+        for (size_t i = 0; i < judge_res->cases.size(); ++i) {
+            if (judge_res->cases[i].IsSkipped()) {
+                if (auto res = WriteFrame(fd, EncodeVerdict(ToVerdictMessage(submission.id, i, judge_res->cases[i]))); !res.has_value()) {
+                    write_error = res.error();
+                    return res;
+                }
+            }
+        }
+
+        auto done = EncodeDone({
+            .id = submission.id,
+            .accepted_count = static_cast<uint32_t>(judge_res->accepted_count),
+            .test_count = test_count
+        });
+        if (auto res = WriteFrame(fd, done); !res.has_value()) {
+            write_error = res.error();
+            return res;
+        }
+        return {};
+    };
+
+    auto result = judge();
+
+    std::error_code ec;
+    std::filesystem::remove_all(exec_dir, ec);
+
+    if (write_error) {
+        return std::unexpected(write_error);
+    } else if (!result.has_value()) {
+        return WriteFrame(fd, EncodeFailure(submission.id, result.error()));
+    }
+    return {};
+}
+
+void JudgeServer::ReapConnectionsLocked() {
+    for (auto it = connections_.begin(); it != connections_.end();) {
+        if (it->is_done) {
+            it->thread.join();
+            it = connections_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace coj
\ No newline at end of file
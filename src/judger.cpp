@@ -0,0 +1,364 @@
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+
+#include "coj/judger.h"
+#include "coj/memory_file.h"
+#include "coj/result_store.h"
+#include "coj/streaming_checker.h"
+#include "coj/test_scheduler.h"
+#include "coj/work_area.h"
+
+namespace coj {
+
+namespace {
+
+std::vector<int> GetAllowedCpus() {
+    std::vector<int> cpus;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+
+    return cpus;
+}
+
+std::error_code PinCurrentThread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    int err = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        return std::error_code(err, std::generic_category());
+    }
+    return {};
+}
+
+std::expected<CaseResult, std::error_code> JudgeCaseIn(
+    const JudgeConfig& config,
+    size_t index,
+    const std::filesystem::path& work_dir,
+    MemoryFile* output_memory
+) {
+    const auto& test_case = config.test_cases[index];
+
+    RunConfig run_config{
+        .exec_path = config.exec_path,
+        .args = config.args,
+        .input_path = test_case.input_path,
+        .output_path = work_dir / (std::to_string(index) + ".out"),
+        .work_dir = work_dir,
+        .input_memory = test_case.input_memory,
+        .output_memory = config.checker == nullptr ? output_memory : nullptr,
+        .soft_limits = config.soft_limits,
+        .hard_limits = config.hard_limits,
+        .placement = config.placement,
+        .cgroup_pool = config.cgroup_pool
+    };
+
+    CaseResult result;
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    if (config.streaming_check && config.checker == nullptr) {
+        CheckConfig check_config{
+            .answer_path = test_case.answer_path,
+            .epsilon = config.epsilon
+        };
+
+        auto stream_res = RunAndCheck(run_config, check_config);
+        if (!stream_res.has_value()) {
+            return std::unexpected(stream_res.error());
+        }
+
+        result.run_result = std::move(stream_res->run_result);
+        result.check_result = stream_res->check_result;
+        result.wall_time = std::chrono::steady_clock::now() - start_time;
+
+        return result;
+    }
+
+    auto run_res = Run(run_config);
+    if (!run_res.has_value()) {
+        return std::unexpected(run_res.error());
+    }
+    result.run_result = std::move(*run_res);
+
+    if (result.run_result->status == RunStatus::Success && config.checker != nullptr) {
+        auto verdict_res = config.checker->Check(CheckRequest{
+            .input_path = test_case.input_path,
+            .output_path = run_config.output_path,
+            .answer_path = test_case.answer_path
+        });
+        if (!verdict_res.has_value()) {
+            return std::unexpected(verdict_res.error());
+        }
+        result.check_result = verdict_res->result;
+        result.checker_message = std::move(verdict_res->message);
+    } else if (result.run_result->status == RunStatus::Success) {
+        CheckConfig check_config{
+            .output_path = run_config.output_path,
+            .answer_path = test_case.answer_path,
+            .epsilon = config.epsilon,
+            .answer_cache = config.answer_cache
+        };
+
+        MemoryMap output_map;
+        if (run_config.output_memory != nullptr) {
+            auto map_res = run_config.output_memory->Map();
+            if (!map_res.has_value()) {
+                return std::unexpected(map_res.error());
+            }
+            output_map = std::move(*map_res);
+            check_config.output_data = output_map.View();
+        }
+
+        auto check_res = Check(check_config);
+        if (!check_res.has_value()) {
+            return std::unexpected(check_res.error());
+        }
+        result.check_result = *check_res;
+    }
+
+    result.wall_time = std::chrono::steady_clock::now() - start_time;
+
+    return result;
+}
+
+// Empty when the case cannot be memoized, e.g. its input is missing; the run then reports why.
+std::string GetResultKey(const JudgeConfig& config, const std::optional<std::string>& exec_key, size_t index) {
+    if (!exec_key.has_value()) {
+        return {};
+    }
+
+    auto key_res = GetCaseKey(*config.result_store, config, *exec_key, index);
+    return key_res.has_value() ? std::move(*key_res) : std::string();
+}
+
+std::expected<CaseResult, std::error_code> JudgeCase(const JudgeConfig& config, size_t index, MemoryFile* output_memory) {
+    if (config.work_area_pool == nullptr) {
+        return JudgeCaseIn(config, index, config.work_dir, output_memory);
+    }
+
+    auto area_res = config.work_area_pool->Acquire();
+    if (!area_res.has_value()) {
+        return std::unexpected(area_res.error());
+    }
+
+    auto result = JudgeCaseIn(config, index, area_res->GetPath(), output_memory);
+    config.work_area_pool->Release(std::move(*area_res));
+    return result;
+}
+
+} // namespace
+
+std::expected<JudgeResult, std::error_code> JudgeBatch(const JudgeConfig& config) {
+    const size_t case_count = config.test_cases.size();
+
+    size_t worker_count = config.worker_count;
+    if (worker_count == 0) {
+        worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    worker_count = std::max<size_t>(1, std::min(worker_count, case_count));
+
+    std::vector<int> cpus;
+    if (config.pin_workers) {
+        cpus = GetAllowedCpus();
+    }
+
+    std::vector<std::string> keys;
+    std::vector<size_t> order(case_count);
+    std::iota(order.begin(), order.end(), 0);
+
+    if (config.history != nullptr) {
+        keys.reserve(case_count);
+        for (const auto& test_case : config.test_cases) {
+            keys.push_back(test_case.key.empty() ? test_case.input_path.string() : test_case.key);
+        }
+        order = config.history->Schedule(keys, worker_count);
+    }
+
+    std::optional<std::string> exec_key;
+    if (config.result_store != nullptr) {
+        if (auto key_res = GetExecutableKey(*config.result_store, config); key_res.has_value()) {
+            exec_key = std::move(*key_res);
+        }
+    }
+
+    const bool is_stopped_on_failure = config.early_exit == EarlyExitPolicy::StopOnFirstFailure;
+
+    std::vector<CaseResult> cases(case_count);
+    std::atomic<size_t> next_slot = 0;
+    std::atomic<bool> is_stopped = false;
+    std::atomic<size_t> first_failed_index = case_count;
+
+    std::mutex error_mutex;
+    std::error_code first_error;
+
+    // Cases below next_report have been reported; a failure among them ends reporting.
+    const bool is_report_ordered = is_stopped_on_failure && config.is_deterministic;
+    std::mutex report_mutex;
+    std::vector<bool> is_finished(is_report_ordered ? case_count : 0);
+    size_t next_report = 0;
+
+    auto report = [&](size_t index) {
+        if (!is_report_ordered) {
+            config.on_case_result(index, cases[index]);
+            return;
+        }
+
+        std::lock_guard lock(report_mutex);
+        is_finished[index] = true;
+        while (next_report < case_count && is_finished[next_report]) {
+            const auto& case_result = cases[next_report];
+            config.on_case_result(next_report, case_result);
+            next_report = case_result.IsAccepted() ? next_report + 1 : case_count;
+        }
+    };
+
+    auto worker = [&](size_t worker_index) {
+        if (!cpus.empty()) {
+            if (auto ec = PinCurrentThread(cpus[worker_index % cpus.size()]); ec) {
+                std::lock_guard lock(error_mutex);
+                if (!first_error) {
+                    first_error = ec;
+                }
+                is_stopped = true;
+                return;
+            }
+        }
+
+        std::optional<MemoryFile> output_memory;
+        if (config.is_output_in_memory && config.checker == nullptr) {
+            auto memory_res = MemoryFile::Create("coj-output-" + std::to_string(worker_index));
+            if (!memory_res.has_value()) {
+                std::lock_guard lock(error_mutex);
+                if (!first_error) {
+                    first_error = memory_res.error();
+                }
+                is_stopped = true;
+                return;
+            }
+            output_memory = std::move(*memory_res);
+        }
+
+        while (!is_stopped.load(std::memory_order_relaxed)) {
+            size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed);
+            if (slot >= case_count) {
+                break;
+            }
+
+            size_t index = order[slot];
+            if (index > first_failed_index.load(std::memory_order_relaxed)) {
+                continue;
+            }
+
+            std::string result_key = GetResultKey(config, exec_key, index);
+
+            std::optional<CaseResult> cached;
+            if (!result_key.empty()) {
+                cached = config.result_store->Lookup(result_key);
+            }
+
+            if (cached.has_value()) {
+                cases[index] = std::move(*cached);
+            } else {
+                auto case_res = JudgeCase(config, index, output_memory.has_value() ? &*output_memory : nullptr);
+                if (!case_res.has_value()) {
+                    std::lock_guard lock(error_mutex);
+                    if (!first_error) {
+                        first_error = case_res.error();
+                    }
+                    is_stopped = true;
+                    break;
+                }
+
+                cases[index] = std::move(*case_res);
+
+                if (!result_key.empty()) {
+                    config.result_store->Store(result_key, cases[index]);
+                }
+            }
+
+            // A replayed result says nothing new about the test.
+            if (config.history != nullptr && !cases[index].is_cached) {
+                config.history->Record(keys[index], cases[index]);
+            }
+
+            if (config.on_case_result) {
+                report(index);
+            }
+
+            if (!is_stopped_on_failure || cases[index].IsAccepted()) {
+                continue;
+            } else if (!config.is_deterministic) {
+                is_stopped = true;
+                continue;
+            }
+
+            size_t failed = first_failed_index.load(std::memory_order_relaxed);
+            while (index < failed && !first_failed_index.compare_exchange_weak(failed, index, std::memory_order_relaxed)) {
+            }
+        }
+    };
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    workers.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers.emplace_back(worker, i);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    if (first_error) {
+        return std::unexpected(first_error);
+    }
+
+    if (config.is_deterministic) {
+        for (size_t i = first_failed_index.load() + 1; i < case_count; ++i) {
+            cases[i] = CaseResult{};
+        }
+    }
+
+    JudgeResult result;
+    result.wall_time = std::chrono::steady_clock::now() - start_time;
+
+    for (size_t i = 0; i < case_count; ++i) {
+        const auto& case_result = cases[i];
+
+        if (case_result.IsAccepted()) {
+            ++result.accepted_count;
+        } else if (!case_result.IsSkipped() && !result.first_failure.has_value()) {
+            result.first_failure = i;
+        }
+
+        if (case_result.run_result.has_value()) {
+            const auto& run_result = case_result.run_result.value();
+            result.total_cpu_time += run_result.GetCpuTime();
+            result.max_cpu_time = std::max(result.max_cpu_time, run_result.GetCpuTime());
+            result.max_memory_kb = std::max(result.max_memory_kb, run_result.GetMaxMemoryKb());
+        }
+    }
+
+    result.cases = std::move(cases);
+
+    return result;
+}
+
+} // namespace coj
\ No newline at end of file
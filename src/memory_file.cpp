@@ -0,0 +1,76 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <span>
+#include <string>
+
+#include "coj/file_io.h"
+#include "coj/memory_file.h"
+
+namespace coj {
+
+namespace {
+
+constexpr int READ_ONLY_SEALS = F_SEAL_WRITE | F_SEAL_GROW | F_SEAL_SHRINK | F_SEAL_SEAL;
+
+std::expected<FileDescriptor, std::error_code> CreateMemfd(std::string_view name) {
+    std::string name_str(name);
+    int fd = ::memfd_create(name_str.c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd == -1) {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    }
+    return FileDescriptor(fd);
+}
+
+} // namespace
+
+std::expected<MemoryFile, std::error_code> MemoryFile::FromData(std::string_view name, std::string_view data) {
+    auto fd_res = CreateMemfd(name);
+    if (!fd_res.has_value()) {
+        return std::unexpected(fd_res.error());
+    }
+
+    auto write_res = Write(fd_res->Get(), std::as_bytes(std::span(data.data(), data.size())));
+    if (!write_res.has_value()) {
+        return std::unexpected(write_res.error());
+    } else if (write_res->bytes != data.size()) {
+        return std::unexpected(std::make_error_code(std::errc::io_error));
+    }
+
+    if (::fcntl(fd_res->Get(), F_ADD_SEALS, READ_ONLY_SEALS) == -1) {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    }
+
+    return MemoryFile(std::move(*fd_res));
+}
+
+std::expected<MemoryFile, std::error_code> MemoryFile::Create(std::string_view name) {
+    auto fd_res = CreateMemfd(name);
+    if (!fd_res.has_value()) {
+        return std::unexpected(fd_res.error());
+    }
+    return MemoryFile(std::move(*fd_res));
+}
+
+bool MemoryFile::IsSealed() const noexcept {
+    int seals = ::fcntl(fd_.Get(), F_GET_SEALS);
+    return seals != -1 && (seals & READ_ONLY_SEALS) == READ_ONLY_SEALS;
+}
+
+std::expected<size_t, std::error_code> MemoryFile::GetSize() const {
+    struct stat st;
+    if (::fstat(fd_.Get(), &st) == -1) {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    }
+    return static_cast<size_t>(st.st_size);
+}
+
+std::expected<FileDescriptor, std::error_code> MemoryFile::Reopen(int flags) const {
+    return Open("/proc/self/fd/" + std::to_string(fd_.Get()), flags);
+}
+
+std::expected<MemoryMap, std::error_code> MemoryFile::Map() const {
+    return MemoryMap::Map(fd_.Get());
+}
+
+} // namespace coj
\ No newline at end of file
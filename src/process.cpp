@@ -1,90 +1,368 @@
 #include <dirent.h>
+#include <linux/mempolicy.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+
+#include <cstring>
+#include <thread>
 
 #include "coj/file_io.h"
 #include "coj/process.h"
+#include "coj/sandbox.h"
+#include "coj/telemetry.h"
 
 namespace coj {
 
 namespace process {
 
-std::expected<Child, std::error_code> Command::Spawn() {
-    std::optional<FileDescriptor> parent_stdin_pipe; 
-    std::optional<FileDescriptor> parent_stdout_pipe;
-    std::optional<FileDescriptor> parent_stderr_pipe;
+namespace {
 
-    FileDescriptor child_stdin_fd;
-    FileDescriptor child_stdout_fd;
-    FileDescriptor child_stderr_fd;
+struct SpawnContext {
+    const char* program;
+    char* const* argv;
+    char* const* envp;
 
-    if (stdin_cfg_.GetType() == Stdio::Type::Piped) {
-        int p[2];
-        if (::pipe2(p, O_CLOEXEC) == -1) {
-            return std::unexpected(std::error_code(errno, std::generic_category()));
+    int stdin_fd;
+    int stdout_fd;
+    int stderr_fd;
+
+    const char* cwd;
+    const ResourceLimits* limits;
+
+    int cgroup_procs_fd;
+
+    bool is_huge_page_disabled;
+    const cpu_set_t* cpu_set;
+    const int* numa_node;
+
+    const SandboxPlan* sandbox;
+
+    // Set when the child is the init of a new pid namespace and must run the program as its child.
+    int init_status_fd;
+
+    int err_fd;
+
+    const sigset_t* signal_mask;
+};
+
+constexpr size_t CLONE_STACK_SIZE = 256 * 1024;
+
+bool SetLimit(int resource, rlim_t soft, rlim_t hard) noexcept {
+    rlimit rl;
+    rl.rlim_cur = soft;
+    rl.rlim_max = hard;
+    return ::setrlimit(resource, &rl) != -1;
+}
+
+bool BindMemoryToNode(int node) noexcept {
+#ifdef SYS_set_mempolicy
+    constexpr int NODE_BITS = sizeof(unsigned long) * 8;
+    if (node < 0 || node >= NODE_BITS) {
+        errno = EINVAL;
+        return false;
+    }
+
+    // The kernel reads one bit less than maxnode.
+    unsigned long mask = 1UL << node;
+    return ::syscall(SYS_set_mempolicy, MPOL_BIND, &mask, NODE_BITS + 1) != -1;
+#else
+    errno = ENOSYS;
+    return false;
+#endif
+}
+
+// A raw fork: glibc's fork() would run atfork handlers and take locks copied from other threads.
+long ForkRaw(int flags) noexcept {
+    return ::syscall(SYS_clone, SIGCHLD | flags, nullptr, nullptr, nullptr, nullptr);
+}
+
+// The init of a pid namespace is immune to signals it has no handler for, so SIGXCPU, SIGABRT and the
+// like would not kill a program run as pid 1. It stays behind as a reaper instead and hands the
+// program's wait status to the parent; its own rusage already includes the program's.
+[[noreturn]] void RunInit(pid_t program, int status_fd, int err_fd) noexcept {
+    ::prctl(PR_SET_NAME, "coj-init", 0, 0, 0);
+    ::close(err_fd);
+    ::close(STDIN_FILENO);
+    ::close(STDOUT_FILENO);
+    ::close(STDERR_FILENO);
+
+    int status = 0;
+    while (true) {
+        int reaped_status = 0;
+        pid_t reaped = ::wait4(-1, &reaped_status, 0, nullptr);
+        if (reaped == program) {
+            status = reaped_status;
+            break;
+        } else if (reaped == -1 && errno != EINTR) {
+            ::_exit(EXIT_FAILURE);
         }
-        parent_stdin_pipe.emplace(p[1]);
-        child_stdin_fd = FileDescriptor(p[0]);
-    } else if (stdin_cfg_.GetType() == Stdio::Type::Null) {
-        auto open_result = Open("/dev/null", O_RDONLY | O_CLOEXEC);
-        if (!open_result.has_value()) {
-            return std::unexpected(open_result.error());
+    }
+
+    (void)Write(status_fd, std::as_bytes(std::span(&status, 1)));
+
+    ::_exit(WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status));
+}
+
+void CloseInheritedFds(int err_fd) noexcept {
+    bool is_closed = false;
+
+#ifdef SYS_close_range
+    int left_res = 0;
+    if (err_fd > 3) {
+        left_res = ::close_range(3, err_fd - 1, 0);
+    }
+
+    int right_res = ::close_range(err_fd + 1, ~0U, 0);
+
+    if (left_res == 0 && right_res == 0) {
+        is_closed = true;
+    }
+#endif
+
+    if (!is_closed) {
+        long max_fd = ::sysconf(_SC_OPEN_MAX);
+        if (max_fd < 0) {
+            max_fd = _POSIX_OPEN_MAX;
+        }
+        for (int fd = 3; fd < max_fd; ++fd) {
+            if (fd != err_fd) {
+                ::close(fd);
+            }
         }
-        child_stdin_fd = std::move(open_result.value());
-    } else if (stdin_cfg_.GetType() == Stdio::Type::File) {
-        child_stdin_fd = stdin_cfg_.TakeFd();
     }
+}
 
-    if (stdout_cfg_.GetType() == Stdio::Type::Piped) {
-        int p[2];
-        if (::pipe2(p, O_CLOEXEC) == -1) {
-            return std::unexpected(std::error_code(errno, std::generic_category()));
+[[noreturn]] void ExecChild(const SpawnContext& context) noexcept {
+    bool is_successful = true;
+
+    if (context.stdin_fd >= 0 && context.stdin_fd != STDIN_FILENO) {
+        if (::dup2(context.stdin_fd, STDIN_FILENO) == -1) {
+            is_successful = false;
         }
-        parent_stdout_pipe.emplace(p[0]);
-        child_stdout_fd = FileDescriptor(p[1]);
-    } else if (stdout_cfg_.GetType() == Stdio::Type::Null) {
-        auto open_result = Open("/dev/null", O_WRONLY | O_CLOEXEC);
-        if (!open_result.has_value()) {
-            return std::unexpected(open_result.error());
+    }
+    if (context.stdout_fd >= 0 && context.stdout_fd != STDOUT_FILENO) {
+        if (::dup2(context.stdout_fd, STDOUT_FILENO) == -1) {
+            is_successful = false;
         }
-        child_stdout_fd = std::move(open_result.value());
-    } else if (stdout_cfg_.GetType() == Stdio::Type::File) {
-        child_stdout_fd = stdout_cfg_.TakeFd();
     }
+    if (context.stderr_fd >= 0 && context.stderr_fd != STDERR_FILENO) {
+        if (::dup2(context.stderr_fd, STDERR_FILENO) == -1) {
+            is_successful = false;
+        }
+    }
+
+    if (context.cgroup_procs_fd >= 0) {
+        if (::write(context.cgroup_procs_fd, "0", 1) != 1) {
+            is_successful = false;
+        }
+    }
+
+    if (context.is_huge_page_disabled) {
+        if (::prctl(PR_SET_THP_DISABLE, 1, 0, 0, 0) == -1) {
+            is_successful = false;
+        }
+    }
+
+    // Set after joining the cgroup, so the mask is taken against its cpuset.
+    if (context.cpu_set != nullptr) {
+        if (::sched_setaffinity(0, sizeof(cpu_set_t), context.cpu_set) == -1) {
+            is_successful = false;
+        }
+    }
+
+    if (context.numa_node != nullptr) {
+        if (!BindMemoryToNode(*context.numa_node)) {
+            is_successful = false;
+        }
+    }
+
+    // The namespaces are entered after joining the cgroup, and the working directory is resolved
+    // inside the new root.
+    if (is_successful && context.sandbox != nullptr) {
+        if (int err = context.sandbox->Enter(); err != 0) {
+            errno = err;
+            is_successful = false;
+        }
+    }
+
+    // Only the program's process continues past this point.
+    if (is_successful && context.init_status_fd >= 0) {
+        long pid = ForkRaw(0);
+        if (pid == -1) {
+            is_successful = false;
+        } else if (pid > 0) {
+            RunInit(static_cast<pid_t>(pid), context.init_status_fd, context.err_fd);
+        }
+    }
+
+    // Set in the program's process only, so a namespace init neither counts against process_count
+    // nor shares the program's CPU and memory caps.
+    const ResourceLimits& limits = *context.limits;
+
+    if (limits.cpu_time_sec.has_value()) {
+        if (!SetLimit(RLIMIT_CPU, limits.cpu_time_sec.value(), limits.cpu_time_sec.value() + 1)) {
+            is_successful = false;
+        }
+    }
+
+    if (limits.memory_bytes.has_value()) {
+        if (!SetLimit(RLIMIT_AS, limits.memory_bytes.value(), limits.memory_bytes.value())) {
+            is_successful = false;
+        }
+    }
+
+    if (limits.file_size_bytes.has_value()) {
+        if (!SetLimit(RLIMIT_FSIZE, limits.file_size_bytes.value(), limits.file_size_bytes.value())) {
+            is_successful = false;
+        }
+    }
+
+    if (limits.process_count.has_value()) {
+        if (!SetLimit(RLIMIT_NPROC, limits.process_count.value(), limits.process_count.value())) {
+            is_successful = false;
+        }
+    }
+
+    if (is_successful && context.cwd != nullptr) {
+        if (::chdir(context.cwd) == -1) {
+            is_successful = false;
+        }
+    }
+
+    if (is_successful) {
+        CloseInheritedFds(context.err_fd);
+
+        if (context.signal_mask != nullptr) {
+            ::sigprocmask(SIG_SETMASK, context.signal_mask, nullptr);
+        }
+
+        if (context.sandbox != nullptr) {
+            if (int err = context.sandbox->Lock(); err != 0) {
+                errno = err;
+                is_successful = false;
+            }
+        }
+
+        if (is_successful) {
+            ::execvpe(context.program, context.argv, context.envp);
+        }
+    }
+
+    int err = errno;
+    (void)Write(context.err_fd, std::as_bytes(std::span(&err, 1)));
+
+    ::_exit(EXIT_FAILURE);
+}
+
+int CloneChildMain(void* arg) noexcept {
+    const auto& context = *static_cast<const SpawnContext*>(arg);
+
+    for (int sig = 1; sig < NSIG; ++sig) {
+        struct sigaction action;
+        if (::sigaction(sig, nullptr, &action) == 0 && action.sa_handler != SIG_IGN && action.sa_handler != SIG_DFL) {
+            action.sa_handler = SIG_DFL;
+            ::sigaction(sig, &action, nullptr);
+        }
+    }
+
+    ExecChild(context);
+}
+
+std::expected<pid_t, std::error_code> Fork(const SpawnContext& context) {
+    pid_t pid = ::fork();
+
+    if (pid < 0) {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    } else if (pid == 0) {
+        ExecChild(context);
+    }
+
+    return pid;
+}
+
+// Used when the child becomes a pid namespace init: it never execs, so a vfork parent would wait on it
+// forever.
+std::expected<pid_t, std::error_code> CloneFork(const SpawnContext& context, int namespace_flags) {
+    long pid = ForkRaw(namespace_flags);
+
+    if (pid < 0) {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    } else if (pid == 0) {
+        ExecChild(context);
+    }
+
+    return static_cast<pid_t>(pid);
+}
+
+std::expected<pid_t, std::error_code> CloneVFork(SpawnContext context, int namespace_flags) {
+    void* stack = ::mmap(nullptr, CLONE_STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (stack == MAP_FAILED) {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    }
+
+    sigset_t all_signals;
+    sigset_t old_mask;
+    ::sigfillset(&all_signals);
+    ::pthread_sigmask(SIG_BLOCK, &all_signals, &old_mask);
+
+    context.signal_mask = &old_mask;
+
+    pid_t pid = ::clone(CloneChildMain, static_cast<char*>(stack) + CLONE_STACK_SIZE, CLONE_VM | CLONE_VFORK | SIGCHLD | namespace_flags, &context);
+    int clone_errno = errno;
+
+    ::pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+    ::munmap(stack, CLONE_STACK_SIZE);
+
+    if (pid < 0) {
+        return std::unexpected(std::error_code(clone_errno, std::generic_category()));
+    }
+
+    return pid;
+}
 
-    if (stderr_cfg_.GetType() == Stdio::Type::Piped) {
+std::expected<void, std::error_code> OpenStdio(Stdio& cfg, bool is_input, std::optional<FileDescriptor>& parent_fd, FileDescriptor& child_fd) {
+    if (cfg.GetType() == Stdio::Type::Piped) {
         int p[2];
         if (::pipe2(p, O_CLOEXEC) == -1) {
             return std::unexpected(std::error_code(errno, std::generic_category()));
         }
-        parent_stderr_pipe.emplace(p[0]);
-        child_stderr_fd = FileDescriptor(p[1]);
-    } else if (stderr_cfg_.GetType() == Stdio::Type::Null) {
-        auto open_result = Open("/dev/null", O_WRONLY | O_CLOEXEC);
+        if (is_input) {
+            parent_fd.emplace(p[1]);
+            child_fd = FileDescriptor(p[0]);
+        } else {
+            parent_fd.emplace(p[0]);
+            child_fd = FileDescriptor(p[1]);
+        }
+    } else if (cfg.GetType() == Stdio::Type::Null) {
+        auto open_result = Open("/dev/null", (is_input ? O_RDONLY : O_WRONLY) | O_CLOEXEC);
         if (!open_result.has_value()) {
             return std::unexpected(open_result.error());
         }
-        child_stderr_fd = std::move(open_result.value());
-    } else if (stderr_cfg_.GetType() == Stdio::Type::File) {
-        child_stderr_fd = stderr_cfg_.TakeFd();
+        child_fd = std::move(open_result.value());
+    } else if (cfg.GetType() == Stdio::Type::File) {
+        child_fd = cfg.TakeFd();
     }
 
-    std::vector<char*> argv_ptrs;
-    argv_ptrs.push_back(const_cast<char*>(program_.c_str()));
-    for (const auto& arg : args_) {
-        argv_ptrs.push_back(const_cast<char*>(arg.c_str()));
-    }
-    argv_ptrs.push_back(nullptr);
+    return {};
+}
 
-    std::vector<std::string> env_strings;
+} // namespace
+
+PreparedCommand Command::Prepare() const {
     std::unordered_map<std::string, std::string> env_map;
 
     if (!is_env_cleared_ && environ != nullptr) {
         for (char **env = environ; *env != nullptr; ++env) {
-            std::string env_str(*env);
+            std::string_view env_str(*env);
             auto pos = env_str.find('=');
-            if (pos != std::string::npos) {
-                std::string key = env_str.substr(0, pos);
+            if (pos != std::string_view::npos) {
+                std::string key(env_str.substr(0, pos));
                 if (removed_envs_.find(key) == removed_envs_.end()) {
-                    env_map[key] = env_str.substr(pos + 1);
+                    env_map[std::move(key)] = env_str.substr(pos + 1);
                 }
             }
         }
@@ -94,130 +372,166 @@ std::expected<Child, std::error_code> Command::Spawn() {
         env_map[key] = value;
     }
 
-    for (const auto& [key, value] : env_map) {
-        env_strings.push_back(key + "=" + value);
-    }
-
-    std::vector<char*> env_ptrs;
-    for (const auto& env_str : env_strings) {
-        env_ptrs.push_back(const_cast<char*>(env_str.c_str()));
+    size_t arena_size = program_.native().size() + 1;
+    for (const auto& arg : args_) {
+        arena_size += arg.size() + 1;
     }
-    env_ptrs.push_back(nullptr);
-
-    int err_p[2];
-    if (::pipe2(err_p, O_CLOEXEC) == -1) {
-        return std::unexpected(std::error_code(errno, std::generic_category()));
+    for (const auto& [key, value] : env_map) {
+        arena_size += key.size() + value.size() + 2;
     }
 
-    FileDescriptor err_read(err_p[0]);
-    FileDescriptor err_write(err_p[1]);
+    PreparedCommand prepared;
+    prepared.arena_ = std::make_unique<char[]>(arena_size);
+    prepared.argv_.reserve(args_.size() + 2);
+    prepared.envp_.reserve(env_map.size() + 1);
 
-    pid_t pid = ::fork();
+    char* cursor = prepared.arena_.get();
+    auto append = [&cursor](std::string_view str) {
+        std::memcpy(cursor, str.data(), str.size());
+        cursor += str.size();
+    };
 
-    if (pid < 0) {
-        return std::unexpected(std::error_code(errno, std::generic_category()));
-    } else if (pid == 0) {
-        err_read.Close();
+    prepared.argv_.push_back(cursor);
+    append(program_.native());
+    *cursor++ = '\0';
 
-        bool is_successful = true;
+    for (const auto& arg : args_) {
+        prepared.argv_.push_back(cursor);
+        append(arg);
+        *cursor++ = '\0';
+    }
+    prepared.argv_.push_back(nullptr);
 
-        if (child_stdin_fd.IsValid() && child_stdin_fd.Get() != STDIN_FILENO) {
-            if (::dup2(child_stdin_fd.Get(), STDIN_FILENO) == -1) {
-                is_successful = false;
-            }
-        }
-        if (child_stdout_fd.IsValid() && child_stdout_fd.Get() != STDOUT_FILENO) {
-            if (::dup2(child_stdout_fd.Get(), STDOUT_FILENO) == -1) {
-                is_successful = false;
-            }
-        }
-        if (child_stderr_fd.IsValid() && child_stderr_fd.Get() != STDERR_FILENO) {
-            if (::dup2(child_stderr_fd.Get(), STDERR_FILENO) == -1) {
-                is_successful = false;
+    for (const auto& [key, value] : env_map) {
+        prepared.envp_.push_back(cursor);
+        append(key);
+        *cursor++ = '=';
+        append(value);
+        *cursor++ = '\0';
+    }
+    prepared.envp_.push_back(nullptr);
+
+    prepared.cwd_ = cwd_;
+    prepared.limits_ = limits_;
+    prepared.backend_ = backend_;
+    prepared.cgroup_procs_fd_ = cgroup_procs_fd_;
+    prepared.sandbox_ = sandbox_;
+
+    prepared.huge_pages_ = placement_.huge_pages;
+    prepared.numa_node_ = placement_.numa_node;
+
+    // Built here so the child only makes the syscall.
+    if (!placement_.cpus.empty()) {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        for (int cpu : placement_.cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &cpu_set);
             }
         }
+        prepared.cpu_set_ = cpu_set;
+    }
 
-        if (cwd_.has_value()) {
-            if (::chdir(cwd_->c_str()) == -1) {
-                is_successful = false;
-            }
-        }
+    return prepared;
+}
 
-        if (limits_.cpu_time_sec.has_value()) {
-            rlimit rl;
-            rl.rlim_cur = limits_.cpu_time_sec.value();
-            rl.rlim_max = limits_.cpu_time_sec.value() + 1;
-            if (::setrlimit(RLIMIT_CPU, &rl) == -1) {
-                is_successful = false;
-            }
-        }
+std::expected<Child, std::error_code> Command::Spawn() {
+    PreparedCommand prepared = Prepare();
+    prepared.Stdin(std::move(stdin_cfg_))
+        .Stdout(std::move(stdout_cfg_))
+        .Stderr(std::move(stderr_cfg_));
 
-        if (limits_.memory_bytes.has_value()) {
-            rlimit rl;
-            rl.rlim_cur = limits_.memory_bytes.value();
-            rl.rlim_max = limits_.memory_bytes.value();
-            if (::setrlimit(RLIMIT_AS, &rl) == -1) {
-                is_successful = false;
-            }
-        }
+    auto child_res = prepared.Spawn();
 
-        if (limits_.file_size_bytes.has_value()) {
-            rlimit rl;
-            rl.rlim_cur = limits_.file_size_bytes.value();
-            rl.rlim_max = limits_.file_size_bytes.value();
-            if (::setrlimit(RLIMIT_FSIZE, &rl) == -1) {
-                is_successful = false;
-            }
-        }
+    stdin_cfg_ = std::move(prepared.stdin_cfg_);
+    stdout_cfg_ = std::move(prepared.stdout_cfg_);
+    stderr_cfg_ = std::move(prepared.stderr_cfg_);
 
-        if (limits_.process_count.has_value()) {
-            rlimit rl;
-            rl.rlim_cur = limits_.process_count.value();
-            rl.rlim_max = limits_.process_count.value();
-            if (::setrlimit(RLIMIT_NPROC, &rl) == -1) {
-                is_successful = false;
-            }
-        }
+    return child_res;
+}
 
-        if (is_successful) {
-            int err_fd = err_write.Get();
-            bool is_closed = false;
+std::expected<Child, std::error_code> PreparedCommand::Spawn() {
+    std::optional<FileDescriptor> parent_stdin_pipe; 
+    std::optional<FileDescriptor> parent_stdout_pipe;
+    std::optional<FileDescriptor> parent_stderr_pipe;
 
-        #ifdef SYS_close_range
-            int left_res = 0;
-            if (err_fd > 3) {
-                left_res = ::close_range(3, err_fd - 1, 0);
-            }
+    FileDescriptor child_stdin_fd;
+    FileDescriptor child_stdout_fd;
+    FileDescriptor child_stderr_fd;
 
-            int right_res = ::close_range(err_fd + 1, ~0U, 0);
+    if (auto res = OpenStdio(stdin_cfg_, true, parent_stdin_pipe, child_stdin_fd); !res.has_value()) {
+        return std::unexpected(res.error());
+    }
+    if (auto res = OpenStdio(stdout_cfg_, false, parent_stdout_pipe, child_stdout_fd); !res.has_value()) {
+        return std::unexpected(res.error());
+    }
+    if (auto res = OpenStdio(stderr_cfg_, false, parent_stderr_pipe, child_stderr_fd); !res.has_value()) {
+        return std::unexpected(res.error());
+    }
 
-            if (left_res == 0 && right_res == 0) {
-                is_closed = true;
-            }
-        #endif
+    int err_p[2];
+    if (::pipe2(err_p, O_CLOEXEC) == -1) {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    }
 
-            if (!is_closed) {
-                long max_fd = ::sysconf(_SC_OPEN_MAX);
-                if (max_fd < 0) {
-                    max_fd = _POSIX_OPEN_MAX;
-                }
-                for (int fd = 3; fd < max_fd; ++fd) {
-                    if (fd != err_write.Get()) {
-                        ::close(fd);
-                    }
-                }
-            }
+    FileDescriptor err_read(err_p[0]);
+    FileDescriptor err_write(err_p[1]);
+
+    const bool is_pid_ns = sandbox_ != nullptr && (sandbox_->GetCloneFlags() & CLONE_NEWPID) != 0;
 
-            ::execvpe(program_.c_str(), argv_ptrs.data(), env_ptrs.data());
+    FileDescriptor status_read;
+    FileDescriptor status_write;
+    if (is_pid_ns) {
+        int status_p[2];
+        if (::pipe2(status_p, O_CLOEXEC | O_NONBLOCK) == -1) {
+            return std::unexpected(std::error_code(errno, std::generic_category()));
         }
+        status_read = FileDescriptor(status_p[0]);
+        status_write = FileDescriptor(status_p[1]);
+    }
 
-        int err = errno;
-        (void)Write(err_write.Get(), std::as_bytes(std::span(&err, 1)));
+    SpawnContext context = {
+        .program = argv_[0],
+        .argv = argv_.data(),
+        .envp = envp_.data(),
+        .stdin_fd = child_stdin_fd.Get(),
+        .stdout_fd = child_stdout_fd.Get(),
+        .stderr_fd = child_stderr_fd.Get(),
+        .cwd = cwd_.has_value() ? cwd_->c_str() : nullptr,
+        .limits = &limits_,
+        .cgroup_procs_fd = cgroup_procs_fd_,
+        .is_huge_page_disabled = huge_pages_ == HugePagePolicy::Disabled,
+        .cpu_set = cpu_set_.has_value() ? &*cpu_set_ : nullptr,
+        .numa_node = numa_node_.has_value() ? &*numa_node_ : nullptr,
+        .sandbox = sandbox_.get(),
+        .init_status_fd = status_write.IsValid() ? status_write.Get() : -1,
+        .err_fd = err_write.Get(),
+        .signal_mask = nullptr,
+    };
+
+    COJ_TRACE_BEGIN(fork_start);
+
+    // Namespaces can only be entered at creation time, so sandboxed children always go through clone.
+    std::expected<pid_t, std::error_code> pid_res;
+    if (is_pid_ns) {
+        pid_res = CloneFork(context, sandbox_->GetCloneFlags());
+    } else if (sandbox_ != nullptr) {
+        pid_res = CloneVFork(context, sandbox_->GetCloneFlags());
+    } else {
+        pid_res = backend_ == SpawnBackend::VFork ? CloneVFork(context, 0) : Fork(context);
+    }
+    if (!pid_res.has_value()) {
+        return std::unexpected(pid_res.error());
+    }
 
-        ::_exit(EXIT_FAILURE);
-    } 
+    pid_t pid = pid_res.value();
+
+    // The exec phase ends when the close-on-exec error pipe reports success.
+    COJ_TRACE_BEGIN(exec_start);
+    COJ_TRACE_RECORD(Fork, fork_start, exec_start);
 
     err_write.Close();
+    status_write.Close();
 
     int child_err = 0;
     auto read_result = Read(err_read.Get(), std::as_writable_bytes(std::span(&child_err, 1)));
@@ -227,7 +541,10 @@ std::expected<Child, std::error_code> Command::Spawn() {
         return std::unexpected(std::error_code(child_err, std::generic_category()));
     }
 
+    COJ_TRACE_END(Exec, exec_start);
+
     Child child(pid);
+    child.init_status_ = std::move(status_read);
     child.stdin_pipe = std::move(parent_stdin_pipe);
     child.stdout_pipe = std::move(parent_stdout_pipe);
     child.stderr_pipe = std::move(parent_stderr_pipe);
@@ -236,6 +553,11 @@ std::expected<Child, std::error_code> Command::Spawn() {
 }
 
 std::expected<ExitStatus, std::error_code> Child::Wait() {
+    COJ_TRACE_SCOPE(Wait);
+    return WaitBlocking();
+}
+
+std::expected<ExitStatus, std::error_code> Child::WaitBlocking() {
     if (!IsValid()) {
         return std::unexpected(std::error_code(ECHILD, std::generic_category()));
     }
@@ -247,7 +569,8 @@ std::expected<ExitStatus, std::error_code> Child::Wait() {
     }
 
     pid_ = INVALID_PID;
-    return ExitStatus(status, usage);
+    pidfd_.Close();
+    return ExitStatus(ResolveStatus(status), usage, std::chrono::steady_clock::now() - start_time_);
 }
 
 std::expected<std::optional<ExitStatus>, std::error_code> Child::TryWait() {
@@ -266,7 +589,136 @@ std::expected<std::optional<ExitStatus>, std::error_code> Child::TryWait() {
     }
 
     pid_ = INVALID_PID;
-    return ExitStatus(status, usage);
+    pidfd_.Close();
+    return ExitStatus(ResolveStatus(status), usage, std::chrono::steady_clock::now() - start_time_);
+}
+
+std::expected<size_t, std::error_code> Child::FeedStdin(int in_fd) {
+    if (!stdin_pipe.has_value() || !stdin_pipe->IsValid()) {
+        return std::unexpected(std::make_error_code(std::errc::bad_file_descriptor));
+    }
+
+    SigPipeGuard guard;
+    auto transfer_res = Transfer(in_fd, stdin_pipe->Get());
+    stdin_pipe->Close();
+
+    if (!transfer_res.has_value()) {
+        if (transfer_res.error() == std::errc::broken_pipe) {
+            return 0;
+        }
+        return std::unexpected(transfer_res.error());
+    }
+    return transfer_res->bytes;
+}
+
+std::expected<size_t, std::error_code> Child::DrainStdout(int out_fd) {
+    if (!stdout_pipe.has_value() || !stdout_pipe->IsValid()) {
+        return std::unexpected(std::make_error_code(std::errc::bad_file_descriptor));
+    }
+
+    auto transfer_res = Transfer(stdout_pipe->Get(), out_fd);
+    stdout_pipe->Close();
+
+    if (!transfer_res.has_value()) {
+        return std::unexpected(transfer_res.error());
+    }
+    return transfer_res->bytes;
+}
+
+int Child::ResolveStatus(int status) const noexcept {
+    if (!init_status_.IsValid()) {
+        return status;
+    }
+
+    // Nothing was written when the init itself was killed, e.g. at the deadline; its status stands.
+    int forwarded = 0;
+    auto read_res = Read(init_status_.Get(), std::as_writable_bytes(std::span(&forwarded, 1)));
+    if (read_res.has_value() && read_res->status == IoStatus::Success && read_res->bytes == sizeof(forwarded)) {
+        return forwarded;
+    }
+    return status;
+}
+
+FileDescriptor Child::OpenPidFd(pid_t pid) noexcept {
+#ifdef SYS_pidfd_open
+    if (pid > 0) {
+        long fd = ::syscall(SYS_pidfd_open, pid, 0);
+        if (fd >= 0) {
+            return FileDescriptor(static_cast<int>(fd));
+        }
+    }
+#endif
+    return FileDescriptor{};
+}
+
+std::expected<ExitStatus, std::error_code> Child::WaitFor(std::chrono::nanoseconds timeout) {
+    if (!IsValid()) {
+        return std::unexpected(std::error_code(ECHILD, std::generic_category()));
+    }
+
+    COJ_TRACE_SCOPE(Wait);
+
+    if (!pidfd_.IsValid()) {
+        return PollWaitFor(timeout);
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (true) {
+        auto remaining = deadline - std::chrono::steady_clock::now();
+
+        if (remaining <= std::chrono::nanoseconds::zero()) {
+            auto result = TryWait();
+            if (!result.has_value()) {
+                return std::unexpected(result.error());
+            } else if (result.value().has_value()) {
+                return result.value().value();
+            }
+
+            Kill();
+            return WaitBlocking();
+        }
+
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(remaining);
+        ::timespec ts = {
+            .tv_sec = static_cast<time_t>(secs.count()),
+            .tv_nsec = static_cast<long>((remaining - secs).count()),
+        };
+
+        ::pollfd pfd = { .fd = pidfd_.Get(), .events = POLLIN, .revents = 0 };
+        int ready = ::ppoll(&pfd, 1, &ts, nullptr);
+
+        if (ready > 0) {
+            return WaitBlocking();
+        } else if (ready == -1 && errno != EINTR) {
+            return std::unexpected(std::error_code(errno, std::generic_category()));
+        }
+    }
+}
+
+std::expected<ExitStatus, std::error_code> Child::PollWaitFor(std::chrono::nanoseconds timeout) {
+    auto start_time = std::chrono::steady_clock::now();
+    auto interval = std::chrono::microseconds(50);
+
+    while (true) {
+        auto result = TryWait();
+
+        if (!result.has_value()) {
+            return std::unexpected(result.error());
+        } else if (result.value().has_value()) {
+            return result.value().value();
+        }
+
+        auto now = std::chrono::steady_clock::now();
+
+        if (now - start_time > timeout) {
+            Kill();
+            return WaitBlocking();
+        }
+
+        std::this_thread::sleep_for(interval);
+        interval = std::min<std::chrono::microseconds>(interval * 2, std::chrono::milliseconds(1));
+    }
 }
 
 } // namespace process
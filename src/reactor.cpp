@@ -0,0 +1,327 @@
+#include <fcntl.h>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "coj/file_io.h"
+#include "coj/reactor.h"
+#include "coj/telemetry.h"
+
+namespace coj {
+
+namespace {
+
+constexpr size_t INITIAL_CHUNK_SIZE = 4 * 1024;
+constexpr size_t MAX_CHUNK_SIZE = 1024 * 1024;
+
+std::error_code LastError() {
+    return std::error_code(errno, std::generic_category());
+}
+
+std::expected<void, std::error_code> SetNonBlocking(int fd) {
+    int flags = ::fcntl(fd, F_GETFL);
+    if (flags == -1 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        return std::unexpected(LastError());
+    }
+    return {};
+}
+
+class OutputSink {
+public:
+    OutputSink(std::string& data, bool& is_truncated, size_t limit, CaptureBuffer* capture)
+        : data_(data), is_truncated_(is_truncated), limit_(limit), capture_(capture) {}
+
+    // Returns false once the stream reaches EOF.
+    [[nodiscard]] std::expected<bool, std::error_code> Drain(int fd) {
+        while (true) {
+            if (scratch_.size() < chunk_size_) {
+                scratch_.resize(chunk_size_);
+            }
+
+            auto read_res = Read(fd, std::as_writable_bytes(std::span(scratch_.data(), chunk_size_)));
+            if (!read_res.has_value()) {
+                return std::unexpected(read_res.error());
+            } else if (read_res->status == IoStatus::EoF) {
+                return false;
+            } else if (read_res->status != IoStatus::Success) {
+                return true;
+            }
+
+            Append(std::string_view(scratch_.data(), read_res->bytes));
+            bytes_ += read_res->bytes;
+
+            if (read_res->bytes == chunk_size_ && chunk_size_ < MAX_CHUNK_SIZE) {
+                chunk_size_ *= 2;
+            }
+        }
+    }
+
+    size_t GetBytes() const noexcept { return bytes_; }
+
+private:
+    void Append(std::string_view chunk) {
+        if (capture_ != nullptr) {
+            capture_->Append(chunk);
+            is_truncated_ = capture_->IsTruncated();
+            return;
+        }
+
+        size_t room = limit_ - std::min(limit_, data_.size());
+        if (chunk.size() > room) {
+            is_truncated_ = true;
+            chunk = chunk.substr(0, room);
+        }
+        data_.append(chunk);
+    }
+
+    std::string& data_;
+    bool& is_truncated_;
+    size_t limit_;
+    CaptureBuffer* capture_;
+
+    std::vector<char> scratch_;
+    size_t chunk_size_ = INITIAL_CHUNK_SIZE;
+    size_t bytes_ = 0;
+};
+
+} // namespace
+
+std::expected<Reactor, std::error_code> Reactor::Create() {
+    int fd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (fd == -1) {
+        return std::unexpected(LastError());
+    }
+    return Reactor(FileDescriptor(fd));
+}
+
+std::expected<void, std::error_code> Reactor::Add(int fd, std::uint32_t events, Handler handler) {
+    ::epoll_event event = { .events = events, .data = { .fd = fd } };
+    if (::epoll_ctl(epoll_fd_.Get(), EPOLL_CTL_ADD, fd, &event) == -1) {
+        return std::unexpected(LastError());
+    }
+
+    handlers_[fd] = std::make_shared<Handler>(std::move(handler));
+    return {};
+}
+
+std::expected<void, std::error_code> Reactor::Modify(int fd, std::uint32_t events) {
+    ::epoll_event event = { .events = events, .data = { .fd = fd } };
+    if (::epoll_ctl(epoll_fd_.Get(), EPOLL_CTL_MOD, fd, &event) == -1) {
+        return std::unexpected(LastError());
+    }
+    return {};
+}
+
+void Reactor::Remove(int fd) {
+    if (handlers_.erase(fd) > 0) {
+        ::epoll_ctl(epoll_fd_.Get(), EPOLL_CTL_DEL, fd, nullptr);
+    }
+}
+
+std::expected<size_t, std::error_code> Reactor::RunOnce(std::optional<std::chrono::nanoseconds> timeout) {
+    std::array<::epoll_event, MAX_EVENTS> events;
+
+    int timeout_ms = -1;
+    if (timeout.has_value()) {
+        auto clamped = std::max(timeout.value(), std::chrono::nanoseconds::zero());
+        timeout_ms = static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(clamped).count());
+    }
+
+    int ready = ::epoll_wait(epoll_fd_.Get(), events.data(), MAX_EVENTS, timeout_ms);
+    if (ready == -1) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        return std::unexpected(LastError());
+    }
+
+    size_t dispatched = 0;
+    for (int i = 0; i < ready; ++i) {
+        auto it = handlers_.find(events[i].data.fd);
+        if (it == handlers_.end()) {
+            continue;
+        }
+
+        std::shared_ptr<Handler> handler = it->second;
+        (*handler)(events[i].events);
+        ++dispatched;
+    }
+
+    return dispatched;
+}
+
+std::expected<CommunicateResult, std::error_code> Communicate(process::Child& child, const CommunicateOptions& options) {
+    auto reactor_res = Reactor::Create();
+    if (!reactor_res.has_value()) {
+        return std::unexpected(reactor_res.error());
+    }
+    auto& reactor = reactor_res.value();
+
+    std::string stdout_data;
+    std::string stderr_data;
+    bool is_stdout_truncated = false;
+    bool is_stderr_truncated = false;
+    bool is_timed_out = false;
+    std::optional<std::error_code> io_error;
+    bool is_output_seen = false;
+
+    OutputSink stdout_sink(stdout_data, is_stdout_truncated, options.stdout_limit, options.stdout_capture);
+    OutputSink stderr_sink(stderr_data, is_stderr_truncated, options.stderr_limit, options.stderr_capture);
+
+    auto watch_output = [&](std::optional<FileDescriptor>& pipe, OutputSink& sink) -> std::expected<void, std::error_code> {
+        if (!pipe.has_value() || !pipe->IsValid()) {
+            return {};
+        }
+        if (auto res = SetNonBlocking(pipe->Get()); !res.has_value()) {
+            return res;
+        }
+
+        int fd = pipe->Get();
+        return reactor.Add(fd, EPOLLIN, [&, fd](std::uint32_t) {
+            auto drain_res = sink.Drain(fd);
+            if (!is_output_seen && sink.GetBytes() > 0) {
+                COJ_TRACE_END(FirstOutput, child.GetStartTime());
+                is_output_seen = true;
+            }
+            if (!drain_res.has_value()) {
+                io_error = drain_res.error();
+            }
+            if (!drain_res.has_value() || !drain_res.value()) {
+                reactor.Remove(fd);
+                pipe->Close();
+            }
+        });
+    };
+
+    if (auto res = watch_output(child.stdout_pipe, stdout_sink); !res.has_value()) {
+        return std::unexpected(res.error());
+    }
+    if (auto res = watch_output(child.stderr_pipe, stderr_sink); !res.has_value()) {
+        return std::unexpected(res.error());
+    }
+
+    size_t stdin_offset = 0;
+    if (child.stdin_pipe.has_value() && child.stdin_pipe->IsValid()) {
+        if (options.stdin_data.empty()) {
+            child.stdin_pipe->Close();
+        } else {
+            if (auto res = SetNonBlocking(child.stdin_pipe->Get()); !res.has_value()) {
+                return std::unexpected(res.error());
+            }
+
+            int fd = child.stdin_pipe->Get();
+            auto add_res = reactor.Add(fd, EPOLLOUT, [&, fd](std::uint32_t events) {
+                bool is_done = (events & (EPOLLERR | EPOLLHUP)) != 0;
+
+                if (!is_done) {
+                    SigPipeGuard guard;
+                    auto remaining = options.stdin_data.substr(stdin_offset);
+                    auto write_res = Write(fd, std::as_bytes(std::span(remaining.data(), remaining.size())));
+                    if (!write_res.has_value()) {
+                        if (write_res.error() != std::errc::broken_pipe) {
+                            io_error = write_res.error();
+                        }
+                        is_done = true;
+                    } else {
+                        stdin_offset += write_res->bytes;
+                        is_done = stdin_offset >= options.stdin_data.size();
+                    }
+                }
+
+                if (is_done) {
+                    reactor.Remove(fd);
+                    child.stdin_pipe->Close();
+                }
+            });
+            if (!add_res.has_value()) {
+                return std::unexpected(add_res.error());
+            }
+        }
+    }
+
+    bool is_exited = false;
+    int pidfd = child.GetPidFd();
+    if (pidfd >= 0) {
+        auto add_res = reactor.Add(pidfd, EPOLLIN, [&, pidfd](std::uint32_t) {
+            is_exited = true;
+            reactor.Remove(pidfd);
+        });
+        if (!add_res.has_value()) {
+            return std::unexpected(add_res.error());
+        }
+    }
+
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    if (options.timeout.has_value()) {
+        deadline = std::chrono::steady_clock::now() + options.timeout.value();
+    }
+
+    // Once the child is gone, whatever is still buffered in the pipes is drained, but a descendant
+    // holding them open must not keep us here.
+    auto has_open_pipes = [&] {
+        return (child.stdout_pipe.has_value() && child.stdout_pipe->IsValid()) ||
+               (child.stderr_pipe.has_value() && child.stderr_pipe->IsValid());
+    };
+
+    while (!reactor.IsEmpty() && !io_error.has_value()) {
+        if (is_exited && !has_open_pipes()) {
+            break;
+        }
+
+        std::optional<std::chrono::nanoseconds> wait_time;
+        if (deadline.has_value()) {
+            wait_time = deadline.value() - std::chrono::steady_clock::now();
+            if (wait_time.value() <= std::chrono::nanoseconds::zero()) {
+                is_timed_out = true;
+                break;
+            }
+        }
+        if (is_exited) {
+            wait_time = std::chrono::nanoseconds::zero();
+        }
+
+        auto run_res = reactor.RunOnce(wait_time);
+        if (!run_res.has_value()) {
+            io_error = run_res.error();
+        } else if (is_exited && run_res.value() == 0) {
+            break;
+        }
+    }
+
+    if (is_timed_out || io_error.has_value()) {
+        child.Kill();
+    }
+
+    if (child.stdin_pipe.has_value()) {
+        child.stdin_pipe->Close();
+    }
+
+    auto wait_res = child.Wait();
+
+    if (child.stdout_pipe.has_value() && child.stdout_pipe->IsValid()) {
+        (void)stdout_sink.Drain(child.stdout_pipe->Get());
+        child.stdout_pipe->Close();
+    }
+    if (child.stderr_pipe.has_value() && child.stderr_pipe->IsValid()) {
+        (void)stderr_sink.Drain(child.stderr_pipe->Get());
+        child.stderr_pipe->Close();
+    }
+
+    if (io_error.has_value()) {
+        return std::unexpected(io_error.value());
+    } else if (!wait_res.has_value()) {
+        return std::unexpected(wait_res.error());
+    }
+
+    return CommunicateResult{
+        .exit_status = wait_res.value(),
+        .stdout_data = std::move(stdout_data),
+        .stderr_data = std::move(stderr_data),
+        .is_stdout_truncated = is_stdout_truncated,
+        .is_stderr_truncated = is_stderr_truncated,
+        .is_timed_out = is_timed_out,
+    };
+}
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,273 @@
+#include <fcntl.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "coj/file_io.h"
+#include "coj/hash.h"
+#include "coj/memory_file.h"
+#include "coj/result_store.h"
+
+namespace coj {
+
+namespace {
+
+bool IsSameVerdict(const CaseResult& lhs, const CaseResult& rhs) noexcept {
+    return lhs.run_result.has_value() == rhs.run_result.has_value() &&
+           (!lhs.run_result.has_value() || lhs.run_result->status == rhs.run_result->status) &&
+           lhs.check_result == rhs.check_result;
+}
+
+template <typename T>
+void UpdateOptional(Sha256& hasher, const std::optional<T>& value) {
+    hasher.UpdateField(value.has_value() ? std::to_string(*value) : "-");
+}
+
+// Every job gets its own work_dir, so an argument is hashed with work_dir replaced by a placeholder.
+std::string WithoutWorkDir(std::string arg, const std::filesystem::path& work_dir) {
+    const std::string& dir = work_dir.native();
+    if (dir.empty()) {
+        return arg;
+    }
+
+    for (size_t pos = arg.find(dir); pos != std::string::npos; pos = arg.find(dir, pos + 1)) {
+        arg.replace(pos, dir.size(), "{work_dir}");
+    }
+    return arg;
+}
+
+// Hashes every regular file under dir with its path relative to dir, e.g. the class files a -cp
+// argument names.
+std::expected<void, std::error_code> HashDirectory(ResultStore& store, Sha256& hasher, const std::filesystem::path& dir) {
+    std::vector<std::filesystem::path> files;
+
+    std::error_code ec;
+    for (std::filesystem::recursive_directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec)) {
+            files.push_back(it->path());
+        }
+    }
+    if (ec) {
+        return std::unexpected(ec);
+    }
+
+    std::sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        auto file_res = store.HashFile(file);
+        if (!file_res.has_value()) {
+            return std::unexpected(file_res.error());
+        }
+        hasher.UpdateField(file.lexically_relative(dir).native()).UpdateField(*file_res);
+    }
+    return {};
+}
+
+} // namespace
+
+std::optional<CaseResult> ResultStore::Lookup(const std::string& key) {
+    std::lock_guard lock(mutex_);
+
+    auto it = index_.find(key);
+    if (it == index_.end() || it->second->is_nondeterministic) {
+        ++stats_.miss_count;
+        return std::nullopt;
+    }
+
+    lru_.splice(lru_.begin(), lru_, it->second);
+
+    if (verify_every_ > 0 && (stats_.hit_count + stats_.verification_count + 1) % verify_every_ == 0) {
+        ++stats_.verification_count;
+        return std::nullopt;
+    }
+
+    ++stats_.hit_count;
+
+    CaseResult result = it->second->result;
+    result.is_cached = true;
+    return result;
+}
+
+void ResultStore::Store(const std::string& key, const CaseResult& result) {
+    if (result.IsSkipped()) {
+        return;
+    }
+
+    std::lock_guard lock(mutex_);
+
+    if (auto it = index_.find(key); it != index_.end()) {
+        auto& entry = *it->second;
+        if (!entry.is_nondeterministic && !IsSameVerdict(entry.result, result)) {
+            entry.is_nondeterministic = true;
+            ++stats_.mismatch_count;
+        }
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+
+    lru_.push_front(Entry{ .key = key, .result = result });
+    lru_.front().result.is_cached = false;
+    index_[key] = lru_.begin();
+    ++stats_.store_count;
+
+    EvictLocked();
+}
+
+std::expected<std::string, std::error_code> ResultStore::HashFile(const std::filesystem::path& path) {
+    auto identity_res = GetFileIdentity(path);
+    if (!identity_res.has_value()) {
+        return std::unexpected(identity_res.error());
+    }
+
+    std::string key = path.string();
+
+    {
+        std::lock_guard lock(mutex_);
+        if (auto it = file_hashes_.find(key); it != file_hashes_.end() && it->second.identity == *identity_res) {
+            return it->second.digest;
+        }
+    }
+
+    auto fd_res = Open(path, O_RDONLY | O_CLOEXEC);
+    if (!fd_res.has_value()) {
+        return std::unexpected(fd_res.error());
+    }
+
+    auto map_res = MemoryMap::Map(fd_res->Get());
+    if (!map_res.has_value()) {
+        return std::unexpected(map_res.error());
+    }
+
+    Sha256 hasher;
+    std::string digest = hasher.Update(map_res->Bytes()).FinalHex();
+
+    std::lock_guard lock(mutex_);
+
+    // Paths of finished jobs are never asked for again, so the table is simply dropped once it grows
+    // as large as the result index.
+    if (file_hashes_.size() >= std::max<size_t>(max_entries_, 1) && !file_hashes_.contains(key)) {
+        file_hashes_.clear();
+    }
+    file_hashes_[key] = FileHash{ .identity = *identity_res, .digest = digest };
+
+    return digest;
+}
+
+ResultStoreStats ResultStore::GetStats() const {
+    std::lock_guard lock(mutex_);
+
+    ResultStoreStats stats = stats_;
+    stats.entry_count = lru_.size();
+    return stats;
+}
+
+void ResultStore::EvictLocked() {
+    while (lru_.size() > max_entries_) {
+        index_.erase(lru_.back().key);
+        lru_.pop_back();
+        ++stats_.eviction_count;
+    }
+}
+
+std::expected<std::string, std::error_code> GetExecutableKey(ResultStore& store, const JudgeConfig& config) {
+    // Nothing identifies what a custom checker does unless the caller names it.
+    if (config.checker != nullptr && config.checker_key.empty()) {
+        return std::unexpected(std::make_error_code(std::errc::operation_not_supported));
+    }
+
+    auto exec_res = store.HashFile(config.exec_path);
+    if (!exec_res.has_value()) {
+        return std::unexpected(exec_res.error());
+    }
+
+    Sha256 hasher;
+    hasher.UpdateField(*exec_res);
+
+    for (const auto& arg : config.args) {
+        hasher.UpdateField(WithoutWorkDir(arg, config.work_dir));
+
+        // An interpreted program is an argument of its interpreter, and a class path names the
+        // directory holding the program. Relative ones resolve in work_dir, where the child starts.
+        auto arg_path = config.work_dir / arg;
+        std::error_code ec;
+        if (std::filesystem::is_regular_file(arg_path, ec)) {
+            auto arg_res = store.HashFile(arg_path);
+            if (!arg_res.has_value()) {
+                return std::unexpected(arg_res.error());
+            }
+            hasher.UpdateField(*arg_res);
+        } else if (std::filesystem::is_directory(arg_path, ec)) {
+            if (auto dir_res = HashDirectory(store, hasher, arg_path); !dir_res.has_value()) {
+                return std::unexpected(dir_res.error());
+            }
+        }
+    }
+
+    const auto& soft = config.soft_limits;
+    hasher.UpdateField(std::to_string(soft.cpu_time.count())).UpdateField(std::to_string(soft.memory_kb));
+    UpdateOptional(hasher, soft.wall_time.has_value() ? std::optional(soft.wall_time->count()) : std::nullopt);
+    UpdateOptional(hasher, soft.output_bytes);
+
+    const auto& hard = config.hard_limits;
+    UpdateOptional(hasher, hard.cpu_time_sec);
+    UpdateOptional(hasher, hard.memory_bytes);
+    UpdateOptional(hasher, hard.file_size_bytes);
+    UpdateOptional(hasher, hard.process_count);
+
+    // A cgroup enforces memory by OOM kill and a huge page policy changes peak RSS, so either can
+    // change a verdict.
+    hasher.UpdateField(config.cgroup_pool != nullptr ? "cgroup" : "rlimit");
+    hasher.UpdateField(std::to_string(static_cast<int>(config.placement.huge_pages)));
+    hasher.UpdateField(std::to_string(config.placement.cpus.size()));
+    for (int cpu : config.placement.cpus) {
+        hasher.UpdateField(std::to_string(cpu));
+    }
+    UpdateOptional(hasher, config.placement.numa_node);
+
+    // Hashed bit for bit; any change to the tolerance can change a verdict.
+    if (config.epsilon.has_value()) {
+        double epsilon = *config.epsilon;
+        hasher.UpdateField(std::string_view(reinterpret_cast<const char*>(&epsilon), sizeof(epsilon)));
+    } else {
+        hasher.UpdateField("-");
+    }
+
+    hasher.UpdateField(config.checker != nullptr ? config.checker_key : "");
+
+    return hasher.FinalHex();
+}
+
+std::expected<std::string, std::error_code> GetCaseKey(
+    ResultStore& store,
+    const JudgeConfig& config,
+    const std::string& exec_key,
+    size_t index
+) {
+    const auto& test_case = config.test_cases[index];
+
+    Sha256 hasher;
+    hasher.UpdateField(exec_key);
+
+    if (test_case.input_memory != nullptr) {
+        auto map_res = test_case.input_memory->Map();
+        if (!map_res.has_value()) {
+            return std::unexpected(map_res.error());
+        }
+        hasher.UpdateField(Sha256().Update(map_res->Bytes()).FinalHex());
+    } else {
+        auto input_res = store.HashFile(test_case.input_path);
+        if (!input_res.has_value()) {
+            return std::unexpected(input_res.error());
+        }
+        hasher.UpdateField(*input_res);
+    }
+
+    auto answer_res = store.HashFile(test_case.answer_path);
+    if (!answer_res.has_value()) {
+        return std::unexpected(answer_res.error());
+    }
+    hasher.UpdateField(*answer_res);
+
+    return hasher.FinalHex();
+}
+
+} // namespace coj
\ No newline at end of file
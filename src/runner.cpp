@@ -1,49 +1,148 @@
+#include <poll.h>
+#include <sys/stat.h>
+
+#include <array>
 #include <chrono>
 
+#include "coj/file_io.h"
+#include "coj/memory_file.h"
 #include "coj/runner.h"
+#include "coj/telemetry.h"
 
 namespace coj {
 
 using namespace std::chrono;
 
-std::expected<RunResult, std::error_code> Run(const RunConfig &config) {
-    process::Command command(config.exec_path.string());
+namespace {
 
-    auto input_fd_res = Open(config.input_path.c_str(), O_RDONLY);
-    if (!input_fd_res.has_value()) {
-        return std::unexpected(input_fd_res.error());
+// One byte of slack, so output of exactly the budget is distinguishable from an overrun.
+process::ResourceLimits GetHardLimits(const RunConfig& config) {
+    process::ResourceLimits hard_limits = config.hard_limits;
+
+    if (config.soft_limits.output_bytes.has_value() && !config.output_observer) {
+        rlim_t budget = static_cast<rlim_t>(config.soft_limits.output_bytes.value()) + 1;
+        hard_limits.file_size_bytes = std::min(hard_limits.file_size_bytes.value_or(RLIM_INFINITY), budget);
     }
+    return hard_limits;
+}
 
-    auto output_fd_res = Open(config.output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC);
-    if (!output_fd_res.has_value()) {
-        return std::unexpected(output_fd_res.error());
+std::expected<FileDescriptor, std::error_code> OpenInput(const RunConfig& config, int flags) {
+    if (config.input_memory != nullptr) {
+        return config.input_memory->Reopen(O_RDONLY | flags);
     }
+    return Open(config.input_path, O_RDONLY | flags);
+}
 
-    command.Stdin(process::Stdio::From(std::move(*input_fd_res)))
-        .Stdout(process::Stdio::From(std::move(*output_fd_res)))
-        .Stderr(process::Stdio::Null())
-        .Limits(config.hard_limits);
+std::expected<FileDescriptor, std::error_code> OpenOutput(const RunConfig& config, int flags) {
+    if (config.output_memory != nullptr) {
+        return config.output_memory->Reopen(O_WRONLY | O_TRUNC | flags);
+    }
+    return Open(config.output_path, O_WRONLY | O_CREAT | O_TRUNC | flags);
+}
 
-    auto child_res = command.Spawn();
-    if (!child_res.has_value()) {
-        return std::unexpected(child_res.error());
+struct PumpResult {
+    bool is_stopped_by_observer = false;
+    bool is_output_limit_exceeded = false;
+    size_t bytes = 0;
+};
+
+std::expected<PumpResult, std::error_code> PumpOutput(
+    process::Child& child,
+    const OutputObserver& observer,
+    std::optional<size_t> output_budget,
+    steady_clock::time_point deadline
+) {
+    std::array<char, 64 * 1024> buffer;
+    PumpResult result;
+
+    while (true) {
+        auto remaining = ceil<milliseconds>(deadline - steady_clock::now());
+        if (remaining <= milliseconds::zero()) {
+            return result;
+        }
+
+        ::pollfd pfd = { .fd = child.stdout_pipe->Get(), .events = POLLIN, .revents = 0 };
+        int ready = ::poll(&pfd, 1, static_cast<int>(remaining.count()));
+
+        if (ready == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return std::unexpected(std::error_code(errno, std::generic_category()));
+        } else if (ready == 0) {
+            continue;
+        }
+
+        auto read_res = Read(child.stdout_pipe->Get(), std::as_writable_bytes(std::span(buffer)));
+        if (!read_res.has_value()) {
+            return std::unexpected(read_res.error());
+        } else if (read_res->status == IoStatus::EoF) {
+            return result;
+        } else if (read_res->status != IoStatus::Success) {
+            continue;
+        }
+
+        if (result.bytes == 0) {
+            COJ_TRACE_END(FirstOutput, child.GetStartTime());
+        }
+        result.bytes += read_res->bytes;
+
+        // The observer never sees output past the budget.
+        if (output_budget.has_value() && result.bytes > output_budget.value()) {
+            child.Kill();
+            result.is_output_limit_exceeded = true;
+            return result;
+        }
+
+        auto observe_res = observer(std::string_view(buffer.data(), read_res->bytes));
+        if (!observe_res.has_value()) {
+            return std::unexpected(observe_res.error());
+        } else if (!observe_res.value()) {
+            child.Kill();
+            result.is_stopped_by_observer = true;
+            return result;
+        }
     }
+}
 
-    seconds timeout = ceil<seconds>(config.soft_limits.cpu_time) + 1s;
-    if (config.hard_limits.cpu_time_sec.has_value()) {
-        timeout = seconds(config.hard_limits.cpu_time_sec.value()) + 1s;
+// For file outputs the budget is enforced by RLIMIT_FSIZE; the file size tells what was produced.
+void MeasureOutput(int output_fd, const RunConfig& config, RunResult& result) {
+    struct stat st;
+    if (output_fd < 0 || ::fstat(output_fd, &st) == -1 || !S_ISREG(st.st_mode)) {
+        return;
     }
 
-    auto wait_res = child_res->WaitWithTimeout(timeout);
-    if (!wait_res.has_value()) {
-        return std::unexpected(wait_res.error());
+    result.output_bytes = static_cast<size_t>(st.st_size);
+    if (config.soft_limits.output_bytes.has_value()) {
+        result.is_output_limit_exceeded = result.output_bytes > config.soft_limits.output_bytes.value();
+    }
+}
+
+} // namespace
+
+std::chrono::nanoseconds GetWallTimeout(const RunConfig& config) {
+    if (config.soft_limits.wall_time.has_value()) {
+        return config.soft_limits.wall_time.value();
     }
 
-    const auto& exit_status = wait_res.value();
+    return config.soft_limits.cpu_time + DEFAULT_WALL_TIME_MARGIN;
+}
+
+RunStatus ClassifyRun(const RunResult& result, const RunConfig& config) {
+    const auto& exit_status = result.exit_status;
+
+    if (result.is_output_limit_exceeded) {
+        return RunStatus::OutputLimit;
+    } else if (result.cgroup_stats.has_value() && result.cgroup_stats->oom_kill_count > 0) {
+        return RunStatus::MemoryLimit;
+    } else if (result.is_wall_time_exceeded) {
+        return RunStatus::TimeLimit;
+    }
 
     RunStatus status = RunStatus::Success;
+    bool is_killed_by_observer = result.is_stopped_by_observer && exit_status.Signal() == SIGKILL;
 
-    if (!exit_status.Success()) {
+    if (!exit_status.Success() && !is_killed_by_observer) {
         if (exit_status.Signal().has_value()) {
             int sig = exit_status.Signal().value();
             if (sig == SIGKILL || sig == SIGXCPU) {
@@ -57,17 +156,206 @@ std::expected<RunResult, std::error_code> Run(const RunConfig &config) {
             status = RunStatus::RuntimeError;
         }
     } else {
-        if (exit_status.GetCpuTime() > config.soft_limits.cpu_time) {
+        if (result.GetPreciseCpuTime() > config.soft_limits.cpu_time) {
             status = RunStatus::TimeLimit;
-        } else if (exit_status.GetMaxMemoryKb() > config.soft_limits.memory_kb) {
+        } else if (result.GetMaxMemoryKb() > config.soft_limits.memory_kb) {
             status = RunStatus::MemoryLimit;
         }
     } 
 
-    return RunResult {
-        .status = status,
-        .exit_status = exit_status
+    return status;
+}
+
+std::expected<std::optional<Cgroup>, std::error_code> AttachCgroup(
+    process::Command& command,
+    const RunConfig& config
+) {
+    process::ResourceLimits hard_limits = GetHardLimits(config);
+
+    if (config.cgroup_pool == nullptr) {
+        command.Limits(hard_limits);
+        return std::nullopt;
+    }
+
+    auto cgroup_res = config.cgroup_pool->Acquire();
+    if (!cgroup_res.has_value()) {
+        return std::unexpected(cgroup_res.error());
+    }
+    auto& cgroup = cgroup_res.value();
+
+    CgroupLimits cgroup_limits;
+    if (hard_limits.memory_bytes.has_value() && cgroup.HasController("memory")) {
+        cgroup_limits.memory_bytes = hard_limits.memory_bytes;
+        hard_limits.memory_bytes.reset();
+    }
+    if (hard_limits.process_count.has_value() && cgroup.HasController("pids")) {
+        cgroup_limits.process_count = hard_limits.process_count;
+        hard_limits.process_count.reset();
+    }
+
+    if (auto res = cgroup.SetLimits(cgroup_limits); !res.has_value()) {
+        config.cgroup_pool->Release(std::move(cgroup));
+        return std::unexpected(res.error());
+    }
+
+    command.Limits(hard_limits).JoinCgroup(cgroup.GetProcsFd());
+
+    return std::optional<Cgroup>(std::move(cgroup));
+}
+
+std::optional<CgroupStats> ReleaseCgroup(std::optional<Cgroup>& cgroup, const RunConfig& config) {
+    if (!cgroup.has_value()) {
+        return std::nullopt;
+    }
+
+    (void)cgroup->Kill();
+    auto stats_res = cgroup->ReadStats();
+
+    config.cgroup_pool->Release(std::move(*cgroup));
+    cgroup.reset();
+
+    if (!stats_res.has_value()) {
+        return std::nullopt;
+    }
+    return stats_res.value();
+}
+
+namespace {
+
+bool IsServedBy(const ExecutorConfig& executor, const RunConfig& config) {
+    auto work_dir = config.work_dir.empty() ? std::nullopt : std::optional(config.work_dir);
+
+    return executor.exec_path == config.exec_path &&
+           executor.args == config.args &&
+           executor.work_dir == work_dir &&
+           executor.limits == GetHardLimits(config) &&
+           executor.placement == config.placement;
+}
+
+std::expected<RunResult, std::error_code> RunOnExecutor(const RunConfig& config) {
+    if (!IsServedBy(config.executor_pool->GetConfig(), config)) {
+        return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    }
+
+    auto input_fd_res = OpenInput(config, O_CLOEXEC);
+    if (!input_fd_res.has_value()) {
+        return std::unexpected(input_fd_res.error());
+    }
+
+    auto output_fd_res = OpenOutput(config, O_CLOEXEC);
+    if (!output_fd_res.has_value()) {
+        return std::unexpected(output_fd_res.error());
+    }
+
+    auto timeout = GetWallTimeout(config);
+
+    auto exit_res = config.executor_pool->Execute(input_fd_res->Get(), output_fd_res->Get(), timeout);
+    if (!exit_res.has_value()) {
+        return std::unexpected(exit_res.error());
+    }
+
+    RunResult result {
+        .status = RunStatus::Success,
+        .exit_status = exit_res.value(),
+        .is_wall_time_exceeded = exit_res->Signal() == SIGKILL && exit_res->GetWallTime() >= timeout
+    };
+    // The pool's limits carry the file size cap, so this only reports the size the cap allowed.
+    MeasureOutput(output_fd_res->Get(), config, result);
+    result.status = ClassifyRun(result, config);
+
+    return result;
+}
+
+} // namespace
+
+std::expected<RunResult, std::error_code> Run(const RunConfig &config) {
+    COJ_TRACE_SCOPE(Run);
+
+    if (config.executor_pool != nullptr && config.cgroup_pool == nullptr && !config.output_observer) {
+        return RunOnExecutor(config);
+    }
+
+    // The child resolves its program after changing directory, so a relative path is pinned first.
+    std::error_code ec;
+    auto exec_path = config.work_dir.empty() ? config.exec_path : std::filesystem::absolute(config.exec_path, ec);
+    if (ec) {
+        return std::unexpected(ec);
+    }
+
+    process::Command command(exec_path.string());
+    command.Args(config.args).Placement(config.placement);
+    if (!config.work_dir.empty()) {
+        command.CurrentDir(config.work_dir);
+    }
+
+    auto input_fd_res = OpenInput(config, 0);
+    if (!input_fd_res.has_value()) {
+        return std::unexpected(input_fd_res.error());
+    }
+
+    command.Stdin(process::Stdio::From(std::move(*input_fd_res)))
+        .Stderr(process::Stdio::Null());
+
+    FileDescriptor output_probe;
+    if (config.output_observer) {
+        command.Stdout(process::Stdio::Piped());
+    } else {
+        auto output_fd_res = OpenOutput(config, 0);
+        if (!output_fd_res.has_value()) {
+            return std::unexpected(output_fd_res.error());
+        }
+        output_probe = FileDescriptor(::fcntl(output_fd_res->Get(), F_DUPFD_CLOEXEC, 0));
+        command.Stdout(process::Stdio::From(std::move(*output_fd_res)));
+    }
+
+    auto cgroup_res = AttachCgroup(command, config);
+    if (!cgroup_res.has_value()) {
+        return std::unexpected(cgroup_res.error());
+    }
+    auto& cgroup = cgroup_res.value();
+
+    auto child_res = command.Spawn();
+    if (!child_res.has_value()) {
+        ReleaseCgroup(cgroup, config);
+        return std::unexpected(child_res.error());
+    }
+    auto& child = child_res.value();
+
+    auto deadline = steady_clock::now() + GetWallTimeout(config);
+
+    PumpResult pump_result;
+    if (config.output_observer) {
+        auto pump_res = PumpOutput(child, config.output_observer, config.soft_limits.output_bytes, deadline);
+        child.stdout_pipe->Close();
+
+        if (!pump_res.has_value()) {
+            child.Kill();
+            (void)child.Wait();
+            ReleaseCgroup(cgroup, config);
+            return std::unexpected(pump_res.error());
+        }
+        pump_result = pump_res.value();
+    }
+
+    auto wait_res = child.WaitWithTimeout(std::max<nanoseconds>(deadline - steady_clock::now(), nanoseconds::zero()));
+    if (!wait_res.has_value()) {
+        ReleaseCgroup(cgroup, config);
+        return std::unexpected(wait_res.error());
+    }
+
+    RunResult result {
+        .status = RunStatus::Success,
+        .exit_status = wait_res.value(),
+        .cgroup_stats = ReleaseCgroup(cgroup, config),
+        .is_stopped_by_observer = pump_result.is_stopped_by_observer,
+        .is_wall_time_exceeded = wait_res->Signal() == SIGKILL && steady_clock::now() >= deadline,
+        .is_output_limit_exceeded = pump_result.is_output_limit_exceeded,
+        .output_bytes = pump_result.bytes
     };
+    MeasureOutput(output_probe.Get(), config, result);
+    result.status = ClassifyRun(result, config);
+
+    return result;
 }
 
 } // namespace coj
\ No newline at end of file
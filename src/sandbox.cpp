@@ -0,0 +1,339 @@
+#include <fcntl.h>
+#include <linux/audit.h>
+#include <linux/seccomp.h>
+#include <sched.h>
+#include <sys/mount.h>
+#include <sys/prctl.h>
+#include <sys/statfs.h>
+#include <sys/statvfs.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+#include "coj/file_io.h"
+#include "coj/sandbox.h"
+
+namespace coj {
+
+namespace process {
+
+namespace {
+
+#if defined(__x86_64__)
+constexpr uint32_t SECCOMP_AUDIT_ARCH = AUDIT_ARCH_X86_64;
+#elif defined(__aarch64__)
+constexpr uint32_t SECCOMP_AUDIT_ARCH = AUDIT_ARCH_AARCH64;
+#else
+constexpr uint32_t SECCOMP_AUDIT_ARCH = 0;
+#endif
+
+#ifdef __x86_64__
+// x32 syscalls share the x86_64 audit arch and would otherwise slip past the allowlist.
+constexpr uint32_t X32_SYSCALL_BIT = 0x40000000;
+#endif
+
+::sock_filter Statement(uint16_t code, uint32_t k) noexcept {
+    return ::sock_filter{ code, 0, 0, k };
+}
+
+::sock_filter Jump(uint16_t code, uint32_t k, uint8_t jt, uint8_t jf) noexcept {
+    return ::sock_filter{ code, jt, jf, k };
+}
+
+int WriteFile(const char* path, std::string_view content) noexcept {
+    int fd = ::open(path, O_WRONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return errno;
+    }
+
+    auto write_res = Write(fd, std::as_bytes(std::span(content.data(), content.size())));
+    int err = !write_res.has_value() ? write_res.error().value() : (write_res->bytes != content.size() ? EIO : 0);
+    ::close(fd);
+    return err;
+}
+
+// Inside a user namespace a bind remount must keep the flags that were locked by the outer mount.
+unsigned long GetLockedFlags(const char* path) noexcept {
+    struct statfs st;
+    if (::statfs(path, &st) == -1) {
+        return 0;
+    }
+
+    unsigned long flags = 0;
+    if (st.f_flags & ST_NOSUID) {
+        flags |= MS_NOSUID;
+    }
+    if (st.f_flags & ST_NODEV) {
+        flags |= MS_NODEV;
+    }
+    if (st.f_flags & ST_NOEXEC) {
+        flags |= MS_NOEXEC;
+    }
+    if (st.f_flags & ST_NOATIME) {
+        flags |= MS_NOATIME;
+    }
+    if (st.f_flags & ST_NODIRATIME) {
+        flags |= MS_NODIRATIME;
+    }
+    if (st.f_flags & ST_RELATIME) {
+        flags |= MS_RELATIME;
+    }
+    return flags;
+}
+
+int RemountReadOnly(const char* path) noexcept {
+    unsigned long flags = MS_REMOUNT | MS_BIND | MS_RDONLY | GetLockedFlags(path);
+    if (::mount(nullptr, path, nullptr, flags, nullptr) == -1) {
+        return errno;
+    }
+    return 0;
+}
+
+} // namespace
+
+SeccompPolicy SeccompPolicy::Default() {
+    SeccompPolicy policy;
+    policy.allowed_syscalls = {
+        SYS_read,
+        SYS_write,
+        SYS_readv,
+        SYS_writev,
+        SYS_brk,
+        SYS_mmap,
+        SYS_munmap,
+        SYS_mremap,
+        SYS_mprotect,
+        SYS_madvise,
+        SYS_lseek,
+        SYS_pread64,
+        SYS_pwrite64,
+        SYS_fstat,
+        SYS_newfstatat,
+        SYS_close,
+        SYS_openat,
+        SYS_futex,
+        SYS_clock_gettime,
+        SYS_clock_getres,
+        SYS_clock_nanosleep,
+        SYS_gettimeofday,
+        SYS_nanosleep,
+        SYS_sched_yield,
+        SYS_sched_getaffinity,
+        SYS_getrusage,
+        SYS_times,
+        SYS_getpid,
+        SYS_gettid,
+        SYS_getuid,
+        SYS_geteuid,
+        SYS_getgid,
+        SYS_getegid,
+        SYS_tgkill,
+        SYS_rt_sigaction,
+        SYS_rt_sigprocmask,
+        SYS_rt_sigreturn,
+        SYS_sigaltstack,
+        SYS_ioctl,
+        SYS_fcntl,
+        SYS_dup,
+        SYS_dup3,
+        SYS_readlinkat,
+        SYS_faccessat,
+        SYS_uname,
+        SYS_getrandom,
+        SYS_prlimit64,
+        SYS_set_tid_address,
+        SYS_set_robust_list,
+        SYS_exit,
+        SYS_exit_group,
+        SYS_execve,
+#ifdef SYS_statx
+        SYS_statx,
+#endif
+#ifdef SYS_faccessat2
+        SYS_faccessat2,
+#endif
+#ifdef SYS_rseq
+        SYS_rseq,
+#endif
+#ifdef __x86_64__
+        SYS_arch_prctl,
+        SYS_open,
+        SYS_stat,
+        SYS_lstat,
+        SYS_access,
+        SYS_readlink,
+        SYS_dup2,
+        SYS_time,
+#endif
+    };
+    return policy;
+}
+
+SeccompFilter::SeccompFilter(std::vector<::sock_filter> instructions) : instructions_(std::move(instructions)) {
+    program_.len = static_cast<unsigned short>(instructions_.size());
+    program_.filter = instructions_.data();
+}
+
+std::expected<std::shared_ptr<const SeccompFilter>, std::error_code> SeccompFilter::Compile(const SeccompPolicy& policy) {
+    if (SECCOMP_AUDIT_ARCH == 0) {
+        return std::unexpected(std::make_error_code(std::errc::not_supported));
+    }
+
+    uint32_t default_action = SECCOMP_RET_KILL_PROCESS;
+    if (policy.default_action == SeccompAction::Errno) {
+        default_action = SECCOMP_RET_ERRNO | (static_cast<uint32_t>(policy.errno_value) & SECCOMP_RET_DATA);
+    }
+
+    std::vector<::sock_filter> instructions;
+    instructions.reserve(policy.allowed_syscalls.size() * 2 + 8);
+
+    instructions.push_back(Statement(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, arch)));
+    instructions.push_back(Jump(BPF_JMP | BPF_JEQ | BPF_K, SECCOMP_AUDIT_ARCH, 1, 0));
+    instructions.push_back(Statement(BPF_RET | BPF_K, SECCOMP_RET_KILL_PROCESS));
+
+    instructions.push_back(Statement(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, nr)));
+#ifdef __x86_64__
+    instructions.push_back(Jump(BPF_JMP | BPF_JGE | BPF_K, X32_SYSCALL_BIT, 0, 1));
+    instructions.push_back(Statement(BPF_RET | BPF_K, SECCOMP_RET_KILL_PROCESS));
+#endif
+
+    // Each test jumps to its own return so no offset outgrows the 8-bit jump field.
+    for (int nr : policy.allowed_syscalls) {
+        if (nr < 0) {
+            return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+        }
+        instructions.push_back(Jump(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(nr), 0, 1));
+        instructions.push_back(Statement(BPF_RET | BPF_K, SECCOMP_RET_ALLOW));
+    }
+
+    instructions.push_back(Statement(BPF_RET | BPF_K, default_action));
+
+    if (instructions.size() > BPF_MAXINSNS) {
+        return std::unexpected(std::make_error_code(std::errc::argument_list_too_long));
+    }
+
+    return std::shared_ptr<const SeccompFilter>(new SeccompFilter(std::move(instructions)));
+}
+
+std::expected<std::shared_ptr<const SandboxPlan>, std::error_code> SandboxPlan::Build(const SandboxConfig& config) {
+    bool has_mount_setup = config.rootfs.has_value() || !config.binds.empty() || config.is_proc_mounted;
+    if (has_mount_setup && (!config.is_mount_ns || !config.rootfs.has_value())) {
+        return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    } else if (config.is_proc_mounted && !config.is_pid_ns) {
+        return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    }
+
+    std::shared_ptr<SandboxPlan> plan(new SandboxPlan());
+
+    if (config.is_user_ns) {
+        plan->clone_flags_ |= CLONE_NEWUSER;
+        plan->uid_map_ = std::to_string(config.inside_uid) + " " + std::to_string(::getuid()) + " 1";
+        plan->gid_map_ = std::to_string(config.inside_gid) + " " + std::to_string(::getgid()) + " 1";
+    }
+    if (config.is_mount_ns) {
+        plan->clone_flags_ |= CLONE_NEWNS;
+    }
+    if (config.is_pid_ns) {
+        plan->clone_flags_ |= CLONE_NEWPID;
+    }
+    if (config.is_net_ns) {
+        plan->clone_flags_ |= CLONE_NEWNET;
+    }
+
+    if (config.rootfs.has_value()) {
+        std::error_code ec;
+        auto rootfs = std::filesystem::canonical(config.rootfs.value(), ec);
+        if (ec) {
+            return std::unexpected(ec);
+        }
+        plan->rootfs_ = rootfs.native();
+
+        for (const auto& bind : config.binds) {
+            auto source = std::filesystem::canonical(bind.source, ec);
+            if (ec) {
+                return std::unexpected(ec);
+            }
+            auto target = rootfs / bind.target.relative_path();
+            plan->mounts_.push_back(Mount{ source.native(), target.native(), bind.is_read_only });
+        }
+
+        if (config.is_proc_mounted) {
+            plan->proc_target_ = (rootfs / "proc").native();
+        }
+    }
+
+    plan->seccomp_ = config.seccomp;
+    return plan;
+}
+
+int SandboxPlan::Enter() const noexcept {
+    if (clone_flags_ & CLONE_NEWUSER) {
+        if (int err = WriteFile("/proc/self/setgroups", "deny"); err != 0) {
+            return err;
+        }
+        if (int err = WriteFile("/proc/self/uid_map", uid_map_); err != 0) {
+            return err;
+        }
+        if (int err = WriteFile("/proc/self/gid_map", gid_map_); err != 0) {
+            return err;
+        }
+    }
+
+    if (!rootfs_.has_value()) {
+        return 0;
+    }
+
+    const char* root = rootfs_->c_str();
+
+    // Keep our mounts from propagating back into the parent namespace.
+    if (::mount(nullptr, "/", nullptr, MS_REC | MS_PRIVATE, nullptr) == -1 ||
+        ::mount(root, root, nullptr, MS_BIND | MS_REC, nullptr) == -1) {
+        return errno;
+    }
+
+    for (const auto& mount : mounts_) {
+        if (::mount(mount.source.c_str(), mount.target.c_str(), nullptr, MS_BIND | MS_REC, nullptr) == -1) {
+            return errno;
+        }
+        if (mount.is_read_only) {
+            if (int err = RemountReadOnly(mount.target.c_str()); err != 0) {
+                return err;
+            }
+        }
+    }
+
+    if (proc_target_.has_value()) {
+        if (::mount("proc", proc_target_->c_str(), "proc", MS_NOSUID | MS_NODEV | MS_NOEXEC, nullptr) == -1) {
+            return errno;
+        }
+    }
+
+    // Stacking the old root under the new one and detaching it avoids needing a put_old directory.
+    if (::chdir(root) == -1 ||
+        ::syscall(SYS_pivot_root, ".", ".") == -1 ||
+        ::umount2(".", MNT_DETACH) == -1 ||
+        ::chdir("/") == -1) {
+        return errno;
+    }
+
+    return RemountReadOnly("/");
+}
+
+int SandboxPlan::Lock() const noexcept {
+    if (seccomp_ == nullptr) {
+        return 0;
+    }
+
+    if (::prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == -1 ||
+        ::syscall(SYS_seccomp, SECCOMP_SET_MODE_FILTER, 0, seccomp_->GetProgram()) == -1) {
+        return errno;
+    }
+    return 0;
+}
+
+} // namespace process
+
+} // namespace coj
\ No newline at end of file
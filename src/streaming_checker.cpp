@@ -0,0 +1,158 @@
+#include "coj/file_io.h"
+#include "coj/streaming_checker.h"
+
+namespace coj {
+
+std::expected<StreamingChecker, std::error_code> StreamingChecker::Create(const std::filesystem::path& answer_path, std::optional<double> epsilon) {
+    auto fd_res = Open(answer_path, O_RDONLY | O_CLOEXEC);
+    if (!fd_res.has_value()) {
+        return std::unexpected(fd_res.error());
+    }
+
+    struct stat st;
+    if (::fstat(fd_res->Get(), &st) == -1) {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    }
+
+    auto reader_res = TokenReader::FromFd(std::move(*fd_res));
+    if (!reader_res.has_value()) {
+        return std::unexpected(reader_res.error());
+    }
+
+    size_t answer_bytes = static_cast<size_t>(st.st_size);
+    return StreamingChecker(std::move(*reader_res), epsilon, answer_bytes * 2 + OUTPUT_SLACK_BYTES);
+}
+
+std::expected<bool, std::error_code> StreamingChecker::MatchToken(std::string_view token) {
+    auto answer_res = answer_reader_.Next();
+    if (!answer_res.has_value()) {
+        return std::unexpected(answer_res.error());
+    }
+
+    if (!answer_res->has_value() || !IsTokenEqual(**answer_res, token, epsilon_)) {
+        is_mismatched_ = true;
+        return false;
+    }
+
+    return true;
+}
+
+std::expected<bool, std::error_code> StreamingChecker::Feed(std::string_view chunk) {
+    if (is_mismatched_) {
+        return false;
+    }
+
+    output_bytes_ += chunk.size();
+    if (output_bytes_ > output_limit_) {
+        is_mismatched_ = true;
+        return false;
+    }
+
+    const char* cursor = chunk.data();
+    const char* end = chunk.data() + chunk.size();
+
+    if (!partial_token_.empty()) {
+        const char* token_end = FindWhitespace(cursor, end);
+        partial_token_.append(cursor, token_end);
+
+        if (token_end == end) {
+            return true;
+        }
+
+        auto match_res = MatchToken(partial_token_);
+        partial_token_.clear();
+        if (!match_res.has_value() || !match_res.value()) {
+            return match_res;
+        }
+
+        cursor = token_end;
+    }
+
+    while (true) {
+        cursor = SkipWhitespace(cursor, end);
+        if (cursor == end) {
+            return true;
+        }
+
+        const char* token_end = FindWhitespace(cursor, end);
+
+        if (token_end == end) {
+            partial_token_.assign(cursor, token_end);
+            return true;
+        }
+
+        auto match_res = MatchToken(std::string_view(cursor, static_cast<size_t>(token_end - cursor)));
+        if (!match_res.has_value() || !match_res.value()) {
+            return match_res;
+        }
+
+        cursor = token_end;
+    }
+}
+
+std::expected<CheckResult, std::error_code> StreamingChecker::Finish() {
+    if (is_mismatched_) {
+        return CheckResult::WrongAnswer;
+    }
+
+    if (!partial_token_.empty()) {
+        auto match_res = MatchToken(partial_token_);
+        partial_token_.clear();
+        if (!match_res.has_value()) {
+            return std::unexpected(match_res.error());
+        } else if (!match_res.value()) {
+            return CheckResult::WrongAnswer;
+        }
+    }
+
+    auto answer_res = answer_reader_.Next();
+    if (!answer_res.has_value()) {
+        return std::unexpected(answer_res.error());
+    }
+
+    return answer_res->has_value() ? CheckResult::WrongAnswer : CheckResult::Accepted;
+}
+
+std::expected<StreamingRunResult, std::error_code> RunAndCheck(const RunConfig& run_config, const CheckConfig& check_config) {
+    auto checker_res = StreamingChecker::Create(check_config.answer_path, check_config.epsilon);
+    if (!checker_res.has_value()) {
+        return std::unexpected(checker_res.error());
+    }
+    auto& checker = checker_res.value();
+
+    RunConfig config = run_config;
+    config.output_observer = [&checker](std::string_view chunk) {
+        return checker.Feed(chunk);
+    };
+
+    auto run_res = Run(config);
+    if (!run_res.has_value()) {
+        return std::unexpected(run_res.error());
+    }
+
+    bool is_terminated_early = run_res->is_stopped_by_observer;
+
+    StreamingRunResult result {
+        .run_result = std::move(*run_res),
+        .check_result = std::nullopt,
+        .is_terminated_early = is_terminated_early
+    };
+
+    // ClassifyRun() already discounts the SIGKILL sent on a mismatch, so a status other than Success
+    // is the solution's own doing and is reported instead, as for file-based checks.
+    if (result.run_result.status != RunStatus::Success) {
+        return result;
+    } else if (result.is_terminated_early) {
+        result.check_result = CheckResult::WrongAnswer;
+    } else {
+        auto check_res = checker.Finish();
+        if (!check_res.has_value()) {
+            return std::unexpected(check_res.error());
+        }
+        result.check_result = check_res.value();
+    }
+
+    return result;
+}
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,312 @@
+#include <pthread.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <memory>
+#include <mutex>
+#include <system_error>
+
+#include "coj/telemetry.h"
+
+namespace coj {
+
+namespace telemetry {
+
+namespace {
+
+constexpr std::array<std::string_view, PHASE_COUNT> PHASE_NAMES = {
+    "compile", "fork", "exec", "wait", "first_output", "run", "check"
+};
+
+struct PhaseMetrics {
+    std::atomic<uint64_t> count = 0;
+    std::atomic<uint64_t> sum_ns = 0;
+
+    // Per-bucket, not cumulative; the exporter sums them.
+    std::array<std::atomic<uint64_t>, HISTOGRAM_BUCKETS.size()> buckets = {};
+};
+
+std::atomic<bool> g_is_enabled = false;
+thread_local bool t_is_suppressed = false;
+std::atomic<uint64_t> g_dropped_count = 0;
+std::array<PhaseMetrics, PHASE_COUNT> g_metrics;
+
+// Single-producer (the owning thread), single-consumer (Drain, under the registry lock). Ownership
+// changes hands only under the registry lock.
+class ThreadBuffer {
+public:
+    uint32_t GetId() const noexcept { return id_; }
+
+    void SetId(uint32_t id) noexcept { id_ = id; }
+
+    bool TryPush(const Span& span) noexcept {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == THREAD_BUFFER_CAPACITY) {
+            return false;
+        }
+        slots_[head % THREAD_BUFFER_CAPACITY] = span;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    void DrainTo(std::vector<Span>& out) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            out.push_back(slots_[tail % THREAD_BUFFER_CAPACITY]);
+        }
+        tail_.store(tail, std::memory_order_release);
+    }
+
+private:
+    uint32_t id_ = 0;
+    std::array<Span, THREAD_BUFFER_CAPACITY> slots_;
+
+    alignas(64) std::atomic<size_t> head_ = 0;
+    alignas(64) std::atomic<size_t> tail_ = 0;
+};
+
+// Every ring stays in buffers for Drain(); free_buffers holds those without a live thread, which may
+// still carry spans of the thread that exited.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::vector<ThreadBuffer*> free_buffers;
+    pthread_key_t exit_key;
+    uint32_t next_id = 0;
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+// Runs at thread exit for threads that hold a ring.
+void ReleaseThreadBuffer(void* buffer) {
+    auto& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    registry.free_buffers.push_back(static_cast<ThreadBuffer*>(buffer));
+}
+
+void AllocateBuffers() {
+    auto& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    if (!registry.buffers.empty()) {
+        return;
+    }
+
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::vector<ThreadBuffer*> free_buffers;
+    buffers.reserve(MAX_THREAD_BUFFERS);
+    free_buffers.reserve(MAX_THREAD_BUFFERS);
+    for (size_t i = 0; i < MAX_THREAD_BUFFERS; ++i) {
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        free_buffers.push_back(buffers.back().get());
+    }
+
+    if (int err = ::pthread_key_create(&registry.exit_key, ReleaseThreadBuffer); err != 0) {
+        throw std::system_error(err, std::generic_category(), "pthread_key_create");
+    }
+
+    registry.buffers = std::move(buffers);
+    registry.free_buffers = std::move(free_buffers);
+}
+
+// Plain pointers, so nothing is registered for thread exit besides the key destructor.
+thread_local ThreadBuffer* t_buffer = nullptr;
+thread_local bool t_is_pool_empty = false;
+
+// Null when the pool was empty at the thread's first span; the thread then drops its spans for life
+// rather than retrying under the lock.
+ThreadBuffer* GetThreadBuffer() noexcept {
+    if (t_buffer != nullptr || t_is_pool_empty) {
+        return t_buffer;
+    }
+
+    auto& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    if (registry.free_buffers.empty() || ::pthread_setspecific(registry.exit_key, registry.free_buffers.back()) != 0) {
+        t_is_pool_empty = true;
+        return nullptr;
+    }
+
+    t_buffer = registry.free_buffers.back();
+    registry.free_buffers.pop_back();
+    t_buffer->SetId(registry.next_id++);
+    return t_buffer;
+}
+
+void AppendNumber(std::string& out, double value) {
+    std::array<char, 32> buffer;
+    auto [ptr, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    out.append(buffer.data(), ptr);
+}
+
+void AppendNumber(std::string& out, uint64_t value) {
+    std::array<char, 24> buffer;
+    auto [ptr, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    out.append(buffer.data(), ptr);
+}
+
+double ToMicroseconds(std::chrono::nanoseconds duration) {
+    return static_cast<double>(duration.count()) / 1000.0;
+}
+
+} // namespace
+
+std::string_view ToString(Phase phase) noexcept {
+    return PHASE_NAMES[static_cast<size_t>(phase)];
+}
+
+void SetEnabled(bool is_enabled) {
+    if (is_enabled) {
+        AllocateBuffers();
+    }
+    g_is_enabled.store(is_enabled, std::memory_order_relaxed);
+}
+
+bool IsEnabled() noexcept {
+    return g_is_enabled.load(std::memory_order_relaxed);
+}
+
+void SuppressCurrentThread() noexcept {
+    t_is_suppressed = true;
+}
+
+std::chrono::steady_clock::time_point Now() noexcept {
+    if (!IsEnabled() || t_is_suppressed) {
+        return {};
+    }
+    return std::chrono::steady_clock::now();
+}
+
+void Record(Phase phase, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) noexcept {
+    if (!IsEnabled() || t_is_suppressed || start == std::chrono::steady_clock::time_point{}) {
+        return;
+    }
+
+    auto duration = std::max<std::chrono::nanoseconds>(end - start, std::chrono::nanoseconds::zero());
+    auto& metrics = g_metrics[static_cast<size_t>(phase)];
+
+    metrics.count.fetch_add(1, std::memory_order_relaxed);
+    metrics.sum_ns.fetch_add(static_cast<uint64_t>(duration.count()), std::memory_order_relaxed);
+
+    double seconds = static_cast<double>(duration.count()) * 1e-9;
+    auto bucket = std::lower_bound(HISTOGRAM_BUCKETS.begin(), HISTOGRAM_BUCKETS.end(), seconds);
+    if (bucket != HISTOGRAM_BUCKETS.end()) {
+        metrics.buckets[static_cast<size_t>(bucket - HISTOGRAM_BUCKETS.begin())].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto* buffer = GetThreadBuffer();
+    if (buffer == nullptr) {
+        g_dropped_count.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Span span{ .phase = phase, .thread_id = buffer->GetId(), .start = start, .duration = duration };
+    if (!buffer->TryPush(span)) {
+        g_dropped_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::vector<Span> Drain() {
+    std::vector<Span> spans;
+
+    auto& registry = GetRegistry();
+    {
+        std::lock_guard lock(registry.mutex);
+        for (auto& buffer : registry.buffers) {
+            buffer->DrainTo(spans);
+        }
+    }
+
+    std::sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) { return a.start < b.start; });
+    return spans;
+}
+
+size_t GetDroppedCount() noexcept {
+    return g_dropped_count.load(std::memory_order_relaxed);
+}
+
+std::string ToChromeTrace(std::span<const Span> spans) {
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    uint64_t pid = static_cast<uint64_t>(::getpid());
+
+    for (size_t i = 0; i < spans.size(); ++i) {
+        const auto& span = spans[i];
+        if (i > 0) {
+            out += ',';
+        }
+        out += "{\"name\":\"";
+        out += ToString(span.phase);
+        out += "\",\"cat\":\"coj\",\"ph\":\"X\",\"ts\":";
+        AppendNumber(out, ToMicroseconds(span.start.time_since_epoch()));
+        out += ",\"dur\":";
+        AppendNumber(out, ToMicroseconds(span.duration));
+        out += ",\"pid\":";
+        AppendNumber(out, pid);
+        out += ",\"tid\":";
+        AppendNumber(out, static_cast<uint64_t>(span.thread_id));
+        out += '}';
+    }
+
+    out += "]}";
+    return out;
+}
+
+std::string ToPrometheus() {
+    std::string out;
+    out += "# HELP coj_phase_duration_seconds Time spent in each judging phase.\n";
+    out += "# TYPE coj_phase_duration_seconds histogram\n";
+
+    for (size_t phase = 0; phase < PHASE_COUNT; ++phase) {
+        const auto& metrics = g_metrics[phase];
+        std::string label = "phase=\"" + std::string(PHASE_NAMES[phase]) + "\"";
+
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < HISTOGRAM_BUCKETS.size(); ++i) {
+            cumulative += metrics.buckets[i].load(std::memory_order_relaxed);
+            out += "coj_phase_duration_seconds_bucket{" + label + ",le=\"";
+            AppendNumber(out, HISTOGRAM_BUCKETS[i]);
+            out += "\"} ";
+            AppendNumber(out, cumulative);
+            out += '\n';
+        }
+
+        uint64_t count = metrics.count.load(std::memory_order_relaxed);
+        out += "coj_phase_duration_seconds_bucket{" + label + ",le=\"+Inf\"} ";
+        AppendNumber(out, count);
+        out += "\ncoj_phase_duration_seconds_sum{" + label + "} ";
+        AppendNumber(out, static_cast<double>(metrics.sum_ns.load(std::memory_order_relaxed)) * 1e-9);
+        out += "\ncoj_phase_duration_seconds_count{" + label + "} ";
+        AppendNumber(out, count);
+        out += '\n';
+    }
+
+    out += "# HELP coj_telemetry_dropped_spans_total Spans lost to a full per-thread buffer.\n";
+    out += "# TYPE coj_telemetry_dropped_spans_total counter\n";
+    out += "coj_telemetry_dropped_spans_total ";
+    AppendNumber(out, static_cast<uint64_t>(GetDroppedCount()));
+    out += '\n';
+
+    return out;
+}
+
+void Reset() {
+    (void)Drain();
+
+    for (auto& metrics : g_metrics) {
+        metrics.count.store(0, std::memory_order_relaxed);
+        metrics.sum_ns.store(0, std::memory_order_relaxed);
+        for (auto& bucket : metrics.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+    g_dropped_count.store(0, std::memory_order_relaxed);
+}
+
+} // namespace telemetry
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+
+#include "coj/judger.h"
+#include "coj/test_scheduler.h"
+
+namespace coj {
+
+std::vector<size_t> ScheduleTests(std::span<const TestEstimate> estimates, size_t worker_count) {
+    const size_t count = estimates.size();
+    worker_count = std::max<size_t>(1, worker_count);
+
+    std::vector<double> costs(count);
+    for (size_t i = 0; i < count; ++i) {
+        costs[i] = static_cast<double>(std::max<int64_t>(1, estimates[i].cost.count()));
+    }
+
+    // A test must start by its deadline, or it alone ends after the per-worker share of the work.
+    double share = std::accumulate(costs.begin(), costs.end(), 0.0) / static_cast<double>(worker_count);
+    std::vector<double> deadlines(count);
+    for (size_t i = 0; i < count; ++i) {
+        deadlines[i] = std::max(0.0, share - costs[i]);
+    }
+
+    std::vector<size_t> by_score(count);
+    std::iota(by_score.begin(), by_score.end(), 0);
+    std::stable_sort(by_score.begin(), by_score.end(), [&](size_t a, size_t b) {
+        return estimates[a].failure_probability / costs[a] > estimates[b].failure_probability / costs[b];
+    });
+
+    std::vector<size_t> by_deadline(count);
+    std::iota(by_deadline.begin(), by_deadline.end(), 0);
+    std::stable_sort(by_deadline.begin(), by_deadline.end(), [&](size_t a, size_t b) {
+        return deadlines[a] < deadlines[b];
+    });
+
+    // Simulates the workers pulling from the shared queue to know when the next test would start.
+    std::priority_queue<double, std::vector<double>, std::greater<>> free_at;
+    for (size_t i = 0; i < worker_count; ++i) {
+        free_at.push(0.0);
+    }
+
+    std::vector<bool> is_scheduled(count, false);
+    std::vector<size_t> order;
+    order.reserve(count);
+
+    size_t score_cursor = 0;
+    size_t deadline_cursor = 0;
+
+    while (order.size() < count) {
+        double now = free_at.top();
+        free_at.pop();
+
+        while (is_scheduled[by_deadline[deadline_cursor]]) {
+            ++deadline_cursor;
+        }
+
+        size_t next = by_deadline[deadline_cursor];
+        if (deadlines[next] > now) {
+            while (is_scheduled[by_score[score_cursor]]) {
+                ++score_cursor;
+            }
+            next = by_score[score_cursor];
+        }
+
+        is_scheduled[next] = true;
+        order.push_back(next);
+        free_at.push(now + costs[next]);
+    }
+
+    return order;
+}
+
+void TestHistory::Record(std::string_view key, const CaseResult& result) {
+    if (result.IsSkipped()) {
+        return;
+    }
+
+    std::lock_guard lock(mutex_);
+
+    auto& stats = stats_[std::string(key)];
+    if (stats.run_count == 0) {
+        stats.mean_wall_time = result.wall_time;
+    } else {
+        auto mean = static_cast<double>(stats.mean_wall_time.count());
+        auto sample = static_cast<double>(result.wall_time.count());
+        stats.mean_wall_time = std::chrono::nanoseconds(static_cast<int64_t>(mean + COST_WEIGHT * (sample - mean)));
+    }
+
+    ++stats.run_count;
+    if (!result.IsAccepted()) {
+        ++stats.failure_count;
+    }
+}
+
+std::optional<TestStats> TestHistory::Get(std::string_view key) const {
+    std::lock_guard lock(mutex_);
+
+    auto it = stats_.find(std::string(key));
+    if (it == stats_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::vector<TestEstimate> TestHistory::Estimate(std::span<const std::string> keys) const {
+    std::vector<TestEstimate> estimates(keys.size());
+    std::vector<bool> is_known(keys.size(), false);
+
+    std::chrono::nanoseconds known_cost{};
+    size_t known_count = 0;
+
+    {
+        std::lock_guard lock(mutex_);
+
+        for (size_t i = 0; i < keys.size(); ++i) {
+            auto it = stats_.find(keys[i]);
+            if (it == stats_.end()) {
+                continue;
+            }
+
+            const auto& stats = it->second;
+            estimates[i].failure_probability =
+                (static_cast<double>(stats.failure_count) + 1.0) / (static_cast<double>(stats.run_count) + 2.0);
+            estimates[i].cost = stats.mean_wall_time;
+            is_known[i] = true;
+
+            known_cost += stats.mean_wall_time;
+            ++known_count;
+        }
+    }
+
+    if (known_count > 0) {
+        auto mean_cost = known_cost / static_cast<int64_t>(known_count);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (!is_known[i]) {
+                estimates[i].cost = mean_cost;
+            }
+        }
+    }
+
+    return estimates;
+}
+
+std::vector<size_t> TestHistory::Schedule(std::span<const std::string> keys, size_t worker_count) const {
+    auto estimates = Estimate(keys);
+    return ScheduleTests(estimates, worker_count);
+}
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include <sys/stat.h>
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "coj/file_io.h"
+#include "coj/tokenizer.h"
+
+namespace coj {
+
+namespace {
+
+#if defined(__SSE2__)
+constexpr size_t SIMD_WIDTH = 16;
+
+inline uint32_t WhitespaceMask(const char* ptr) noexcept {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    __m128i is_space = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' '));
+    __m128i offset = _mm_sub_epi8(chunk, _mm_set1_epi8('\t'));
+    __m128i is_control = _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(4)), offset);
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(is_space, is_control)));
+}
+#endif
+
+} // namespace
+
+const char* SkipWhitespace(const char* first, const char* last) noexcept {
+#if defined(__SSE2__)
+    while (static_cast<size_t>(last - first) >= SIMD_WIDTH) {
+        uint32_t mask = ~WhitespaceMask(first) & 0xFFFFu;
+        if (mask != 0) {
+            return first + std::countr_zero(mask);
+        }
+        first += SIMD_WIDTH;
+    }
+#endif
+
+    while (first != last && IsWhitespace(*first)) {
+        ++first;
+    }
+    return first;
+}
+
+const char* FindWhitespace(const char* first, const char* last) noexcept {
+#if defined(__SSE2__)
+    while (static_cast<size_t>(last - first) >= SIMD_WIDTH) {
+        uint32_t mask = WhitespaceMask(first);
+        if (mask != 0) {
+            return first + std::countr_zero(mask);
+        }
+        first += SIMD_WIDTH;
+    }
+#endif
+
+    while (first != last && !IsWhitespace(*first)) {
+        ++first;
+    }
+    return first;
+}
+
+std::expected<TokenReader, std::error_code> TokenReader::Open(const std::filesystem::path& path) {
+    auto fd_res = coj::Open(path, O_RDONLY | O_CLOEXEC);
+    if (!fd_res.has_value()) {
+        return std::unexpected(fd_res.error());
+    }
+
+    return FromFd(std::move(*fd_res));
+}
+
+std::expected<TokenReader, std::error_code> TokenReader::FromFd(FileDescriptor fd) {
+    TokenReader reader;
+
+    struct stat st;
+    if (::fstat(fd.Get(), &st) == -1) {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    }
+
+    if (S_ISREG(st.st_mode)) {
+        auto map_res = MemoryMap::Map(fd.Get(), static_cast<size_t>(st.st_size));
+        if (map_res.has_value()) {
+            reader.map_ = std::move(*map_res);
+            reader.cursor_ = reader.map_.View().data();
+            reader.end_ = reader.cursor_ + reader.map_.Size();
+            return reader;
+        }
+    }
+
+    reader.fd_ = std::move(fd);
+    reader.buffer_.resize(STREAM_BUFFER_SIZE);
+    reader.cursor_ = reader.buffer_.data();
+    reader.end_ = reader.buffer_.data();
+    return reader;
+}
+
+TokenReader TokenReader::FromView(std::string_view view) {
+    TokenReader reader;
+    reader.cursor_ = view.data();
+    reader.end_ = view.data() + view.size();
+    return reader;
+}
+
+std::expected<std::optional<std::string_view>, std::error_code> TokenReader::Next() {
+    while (true) {
+        cursor_ = SkipWhitespace(cursor_, end_);
+        if (cursor_ != end_) {
+            break;
+        }
+
+        if (!IsStreaming() || is_eof_) {
+            return std::nullopt;
+        }
+
+        auto refill_res = Refill();
+        if (!refill_res.has_value()) {
+            return std::unexpected(refill_res.error());
+        }
+    }
+
+    while (true) {
+        const char* token_end = FindWhitespace(cursor_, end_);
+
+        if (token_end != end_ || !IsStreaming() || is_eof_) {
+            std::string_view token(cursor_, static_cast<size_t>(token_end - cursor_));
+            cursor_ = token_end;
+            return token;
+        }
+
+        auto refill_res = Refill();
+        if (!refill_res.has_value()) {
+            return std::unexpected(refill_res.error());
+        }
+    }
+}
+
+std::expected<void, std::error_code> TokenReader::Refill() {
+    size_t pending = static_cast<size_t>(end_ - cursor_);
+    if (pending > 0 && cursor_ != buffer_.data()) {
+        std::memmove(buffer_.data(), cursor_, pending);
+    }
+
+    if (pending == buffer_.size()) {
+        buffer_.resize(buffer_.size() * 2);
+    }
+
+    char* write_ptr = buffer_.data() + pending;
+    auto read_res = Read(fd_.Get(), std::as_writable_bytes(std::span(write_ptr, buffer_.size() - pending)));
+    if (!read_res.has_value()) {
+        return std::unexpected(read_res.error());
+    }
+
+    cursor_ = buffer_.data();
+    end_ = write_ptr + read_res->bytes;
+
+    if (read_res->status == IoStatus::EoF) {
+        is_eof_ = true;
+    } else if (read_res->status == IoStatus::WouldBlock) {
+        return std::unexpected(std::make_error_code(std::errc::resource_unavailable_try_again));
+    }
+
+    return {};
+}
+
+} // namespace coj
\ No newline at end of file
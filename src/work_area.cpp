@@ -0,0 +1,219 @@
+#include <dirent.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+
+#include <cstring>
+#include <string>
+
+#include "coj/work_area.h"
+
+namespace coj {
+
+namespace {
+
+std::error_code LastError() {
+    return std::error_code(errno, std::generic_category());
+}
+
+std::expected<void, std::error_code> ClearDirectory(int dir_fd);
+
+std::expected<void, std::error_code> RemoveEntry(int dir_fd, const char* name, unsigned char type) {
+    if (type != DT_DIR && ::unlinkat(dir_fd, name, 0) == 0) {
+        return {};
+    } else if (type != DT_DIR && type != DT_UNKNOWN && errno != EISDIR) {
+        return std::unexpected(LastError());
+    }
+
+    int child_fd = ::openat(dir_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (child_fd == -1 && errno == EACCES) {
+        // The run may have locked itself out of its own subdirectory.
+        ::fchmodat(dir_fd, name, S_IRWXU, 0);
+        child_fd = ::openat(dir_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    }
+    if (child_fd == -1) {
+        return std::unexpected(LastError());
+    }
+
+    if (auto res = ClearDirectory(child_fd); !res.has_value()) {
+        ::close(child_fd);
+        return res;
+    }
+    ::close(child_fd);
+
+    if (::unlinkat(dir_fd, name, AT_REMOVEDIR) == -1) {
+        return std::unexpected(LastError());
+    }
+    return {};
+}
+
+std::expected<void, std::error_code> ClearDirectory(int dir_fd) {
+    // A fresh open file description, so listing never disturbs the offset of dir_fd itself.
+    int list_fd = ::openat(dir_fd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (list_fd == -1) {
+        return std::unexpected(LastError());
+    }
+
+    DIR* dir = ::fdopendir(list_fd);
+    if (dir == nullptr) {
+        auto err = LastError();
+        ::close(list_fd);
+        return std::unexpected(err);
+    }
+
+    std::expected<void, std::error_code> result;
+
+    while (true) {
+        errno = 0;
+        ::dirent* entry = ::readdir(dir);
+        if (entry == nullptr) {
+            if (errno != 0) {
+                result = std::unexpected(LastError());
+            }
+            break;
+        }
+
+        const char* name = entry->d_name;
+        if (std::strcmp(name, ".") == 0 || std::strcmp(name, "..") == 0) {
+            continue;
+        }
+
+        if (auto res = RemoveEntry(dir_fd, name, entry->d_type); !res.has_value()) {
+            result = res;
+            break;
+        }
+    }
+
+    ::closedir(dir);
+    return result;
+}
+
+} // namespace
+
+std::expected<void, std::error_code> MountTmpfs(const std::filesystem::path& dir, size_t size_bytes) {
+    std::string options = "size=" + std::to_string(size_bytes) + ",mode=0755";
+    if (::mount("tmpfs", dir.c_str(), "tmpfs", MS_NOSUID | MS_NODEV, options.c_str()) == -1) {
+        return std::unexpected(LastError());
+    }
+    return {};
+}
+
+std::expected<WorkArea, std::error_code> WorkArea::Create(std::filesystem::path path) {
+    if (::mkdir(path.c_str(), 0755) == -1 && errno != EEXIST) {
+        return std::unexpected(LastError());
+    }
+
+    auto fd_res = Open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (!fd_res.has_value()) {
+        return std::unexpected(fd_res.error());
+    }
+
+    WorkArea area(std::move(path), std::move(*fd_res));
+    if (auto res = area.Reset(); !res.has_value()) {
+        return std::unexpected(res.error());
+    }
+    return area;
+}
+
+WorkArea& WorkArea::operator=(WorkArea&& other) noexcept {
+    if (this != &other) {
+        (void)Remove();
+        path_ = std::move(other.path_);
+        dir_fd_ = std::move(other.dir_fd_);
+    }
+    return *this;
+}
+
+std::expected<void, std::error_code> WorkArea::Reset() {
+    if (!IsValid()) {
+        return std::unexpected(std::make_error_code(std::errc::bad_file_descriptor));
+    }
+    return ClearDirectory(dir_fd_.Get());
+}
+
+std::expected<void, std::error_code> WorkArea::Remove() {
+    if (!IsValid()) {
+        return {};
+    }
+
+    auto res = Reset();
+    dir_fd_.Close();
+
+    if (::rmdir(path_.c_str()) == -1 && errno != ENOENT) {
+        return std::unexpected(LastError());
+    }
+    return res;
+}
+
+WorkAreaPool::~WorkAreaPool() {
+    idle_.clear();
+
+    if (is_tmpfs_mounted_) {
+        ::umount2(parent_dir_.c_str(), MNT_DETACH);
+    }
+}
+
+std::expected<void, std::error_code> WorkAreaPool::MountTmpfs(size_t quota_bytes) {
+    std::lock_guard lock(mutex_);
+
+    if (is_tmpfs_mounted_) {
+        return {};
+    } else if (!idle_.empty()) {
+        return std::unexpected(std::make_error_code(std::errc::device_or_resource_busy));
+    }
+
+    if (auto res = coj::MountTmpfs(parent_dir_, quota_bytes); !res.has_value()) {
+        return res;
+    }
+    is_tmpfs_mounted_ = true;
+    return {};
+}
+
+std::expected<void, std::error_code> WorkAreaPool::Reserve() {
+    std::lock_guard lock(mutex_);
+
+    while (idle_.size() < capacity_) {
+        auto area_res = CreateArea();
+        if (!area_res.has_value()) {
+            return std::unexpected(area_res.error());
+        }
+        idle_.push_back(std::move(*area_res));
+    }
+
+    return {};
+}
+
+std::expected<WorkArea, std::error_code> WorkAreaPool::Acquire() {
+    std::lock_guard lock(mutex_);
+
+    if (!idle_.empty()) {
+        WorkArea area = std::move(idle_.back());
+        idle_.pop_back();
+        return area;
+    }
+
+    return CreateArea();
+}
+
+void WorkAreaPool::Release(WorkArea area) {
+    if (!area.Reset().has_value()) {
+        return;
+    }
+
+    std::lock_guard lock(mutex_);
+
+    if (idle_.size() < capacity_) {
+        idle_.push_back(std::move(area));
+    }
+}
+
+size_t WorkAreaPool::GetIdleCount() const {
+    std::lock_guard lock(mutex_);
+    return idle_.size();
+}
+
+std::expected<WorkArea, std::error_code> WorkAreaPool::CreateArea() {
+    auto name = prefix_ + "-" + std::to_string(::getpid()) + "-" + std::to_string(next_id_++);
+    return WorkArea::Create(parent_dir_ / name);
+}
+
+} // namespace coj
\ No newline at end of file
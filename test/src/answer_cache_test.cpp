@@ -0,0 +1,132 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "coj/answer_cache.h"
+#include "coj/checker.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+class AnswerCacheTest : public ::testing::Test {
+protected:
+    fs::path sandbox_dir_;
+
+    void SetUp() override {
+        sandbox_dir_ = fs::temp_directory_path() / ("coj_answer_cache_test_" + std::to_string(::getpid()));
+        fs::create_directories(sandbox_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(sandbox_dir_);
+    }
+
+    fs::path CreateFile(const std::string& filename, const std::string& content) {
+        fs::path file_path = sandbox_dir_ / filename;
+        std::ofstream(file_path) << content;
+        return file_path;
+    }
+};
+
+TEST_F(AnswerCacheTest, Load_WithNumbers_IndexesTokensAndParsesFloats) {
+    auto path = CreateFile("1.ans", "  1.5 abc\n\t-2e3  \n");
+
+    auto file_res = AnswerFile::Load(path, true);
+    ASSERT_TRUE(file_res.has_value());
+    const auto& file = file_res.value();
+
+    ASSERT_EQ(file.GetTokenCount(), 3);
+    EXPECT_EQ(file.GetToken(0), "1.5");
+    EXPECT_EQ(file.GetToken(1), "abc");
+    EXPECT_EQ(file.GetToken(2), "-2e3");
+
+    EXPECT_TRUE(file.HasNumbers());
+    EXPECT_EQ(file.GetNumber(0), 1.5);
+    EXPECT_FALSE(file.GetNumber(1).has_value());
+    EXPECT_EQ(file.GetNumber(2), -2000.0);
+}
+
+TEST_F(AnswerCacheTest, Get_SameFileTwice_ReturnsSharedEntry) {
+    auto path = CreateFile("1.ans", "1 2 3");
+    AnswerCache cache(1024 * 1024);
+
+    auto first = cache.Get(path, false);
+    auto second = cache.Get(path, false);
+
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(first->get(), second->get());
+
+    auto stats = cache.GetStats();
+    EXPECT_EQ(stats.miss_count, 1);
+    EXPECT_EQ(stats.hit_count, 1);
+    EXPECT_EQ(stats.entry_count, 1);
+}
+
+TEST_F(AnswerCacheTest, Get_AfterFileReplaced_ReloadsContent) {
+    auto path = CreateFile("1.ans", "old");
+    AnswerCache cache(1024 * 1024);
+
+    auto first = cache.Get(path, false);
+    ASSERT_TRUE(first.has_value());
+
+    auto replacement = CreateFile("1.ans.new", "new answer");
+    fs::rename(replacement, path);
+
+    auto second = cache.Get(path, false);
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ((*second)->GetTokenCount(), 2);
+    EXPECT_EQ((*first)->GetToken(0), "old");
+    EXPECT_EQ(cache.GetStats().invalidation_count, 1);
+}
+
+TEST_F(AnswerCacheTest, Get_OverBudget_EvictsLeastRecentlyUsed) {
+    std::string content(600, 'x');
+    auto a = CreateFile("a.ans", content);
+    auto b = CreateFile("b.ans", content);
+    AnswerCache cache(1000);
+
+    auto a_res = cache.Get(a, false);
+    ASSERT_TRUE(cache.Get(b, false).has_value());
+
+    auto stats = cache.GetStats();
+    EXPECT_EQ(stats.entry_count, 1);
+    EXPECT_EQ(stats.eviction_count, 1);
+    EXPECT_LE(stats.total_bytes, 1000);
+
+    ASSERT_TRUE(a_res.has_value());
+    EXPECT_EQ((*a_res)->GetToken(0), content);
+}
+
+TEST_F(AnswerCacheTest, Check_WithCache_MatchesUncachedVerdicts) {
+    auto answer = CreateFile("1.ans", "1.0 2.0 word\n");
+    auto close = CreateFile("close.out", "1.0000001 2 word");
+    auto far = CreateFile("far.out", "1.1 2 word");
+    auto longer = CreateFile("longer.out", "1 2 word extra");
+    AnswerCache cache(1024 * 1024);
+
+    for (const auto& output : { close, far, longer }) {
+        CheckConfig plain{ .output_path = output, .answer_path = answer, .epsilon = 1e-6 };
+        CheckConfig cached = plain;
+        cached.answer_cache = &cache;
+
+        auto plain_res = Check(plain);
+        auto cached_res = Check(cached);
+        ASSERT_TRUE(plain_res.has_value());
+        ASSERT_TRUE(cached_res.has_value());
+        EXPECT_EQ(plain_res.value(), cached_res.value()) << output;
+    }
+
+    EXPECT_EQ(cache.GetStats().miss_count, 1);
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include <array>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "coj/capture_buffer.h"
+#include "coj/file_descriptor.h"
+
+namespace coj {
+
+namespace {
+
+TEST(CaptureBufferTest, Append_WithinCapacity_KeepsEverything) {
+    CaptureBuffer capture(16);
+    capture.Append("hello ");
+    capture.Append("world");
+
+    EXPECT_EQ(capture.ToString(), "hello world");
+    EXPECT_EQ(capture.GetTotalBytes(), 11);
+    EXPECT_FALSE(capture.IsTruncated());
+}
+
+TEST(CaptureBufferTest, Append_OverCapacity_KeepsHeadAndTail) {
+    CaptureBuffer capture(8);
+    for (char c = 'a'; c <= 'z'; ++c) {
+        capture.Append(std::string_view(&c, 1));
+    }
+
+    EXPECT_EQ(capture.Head(), "abcd");
+    auto [older, newer] = capture.Tail();
+    EXPECT_EQ(std::string(older) + std::string(newer), "wxyz");
+    EXPECT_EQ(capture.GetDroppedBytes(), 18);
+    EXPECT_EQ(capture.ToString(), "abcd\n... [18 bytes omitted] ...\nwxyz");
+}
+
+TEST(CaptureBufferTest, Append_ChunkLargerThanTail_KeepsLastBytesOfChunk) {
+    CaptureBuffer capture(8);
+    capture.Append("0123456789abcdef");
+
+    EXPECT_EQ(capture.Head(), "0123");
+    auto [older, newer] = capture.Tail();
+    EXPECT_EQ(std::string(older) + std::string(newer), "cdef");
+    EXPECT_EQ(capture.GetDroppedBytes(), 8);
+}
+
+TEST(CaptureBufferTest, Clear_WithCallerStorage_ReusesBufferFromScratch) {
+    std::array<char, 6> storage;
+    CaptureBuffer capture(storage, 3);
+
+    capture.Append("abcdefghij");
+    EXPECT_TRUE(capture.IsTruncated());
+
+    capture.Clear();
+    capture.Append("xy");
+    EXPECT_EQ(capture.ToString(), "xy");
+    EXPECT_EQ(capture.GetTotalBytes(), 2);
+}
+
+TEST(CaptureBufferTest, ReadAllInto_FromPipe_DrainsPastCapacity) {
+    int p[2];
+    ASSERT_NE(::pipe(p), -1);
+    FileDescriptor read_fd(p[0]);
+    FileDescriptor write_fd(p[1]);
+
+    std::string content(50000, 'm');
+    content.front() = '<';
+    content.back() = '>';
+    ASSERT_TRUE(Write(write_fd.Get(), std::as_bytes(std::span(content.data(), content.size()))).has_value());
+    write_fd.Close();
+
+    CaptureBuffer capture(10);
+    auto read_res = ReadAllInto(read_fd.Get(), capture);
+
+    ASSERT_TRUE(read_res.has_value());
+    EXPECT_EQ(read_res.value(), content.size());
+    EXPECT_EQ(capture.Head(), "<mmmm");
+    EXPECT_EQ(capture.GetDroppedBytes(), content.size() - 10);
+    EXPECT_EQ(capture.ToString().back(), '>');
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
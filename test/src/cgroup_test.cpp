@@ -0,0 +1,215 @@
+#include <unistd.h>
+
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "coj/cgroup.h"
+#include "coj/interactive.h"
+#include "coj/process.h"
+#include "coj/runner.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+class CgroupTest : public ::testing::Test {
+protected:
+    fs::path parent_dir_;
+
+    void SetUp() override {
+        auto mount_res = FindCgroupMount();
+        if (!mount_res.has_value()) {
+            GTEST_SKIP() << "cgroup v2 is not mounted; skipping cgroup tests.";
+        }
+
+        parent_dir_ = mount_res.value() / ("coj_cgroup_test_" + std::to_string(::getpid()));
+        std::error_code ec;
+        fs::create_directory(parent_dir_, ec);
+        if (ec || !fs::exists(parent_dir_ / "cgroup.procs")) {
+            GTEST_SKIP() << "cgroup v2 hierarchy is not writable; skipping cgroup tests.";
+        }
+    }
+
+    void TearDown() override {
+        if (!parent_dir_.empty()) {
+            ::rmdir(parent_dir_.c_str());
+        }
+    }
+
+    // Released cgroups are replaced on the pool's background thread.
+    static bool WaitForIdleCount(const CgroupPool& pool, size_t count) {
+        auto deadline = std::chrono::steady_clock::now() + 5s;
+        while (pool.GetIdleCount() != count) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(1ms);
+        }
+        return true;
+    }
+};
+
+TEST_F(CgroupTest, Create_ThenRemove_CreatesAndDeletesDirectory) {
+    auto cgroup_res = Cgroup::Create(parent_dir_ / "single");
+    ASSERT_TRUE(cgroup_res.has_value()) << cgroup_res.error().message();
+
+    EXPECT_TRUE(fs::exists(parent_dir_ / "single" / "cgroup.procs"));
+    EXPECT_TRUE(cgroup_res->IsValid());
+
+    ASSERT_TRUE(cgroup_res->Remove().has_value());
+    EXPECT_FALSE(fs::exists(parent_dir_ / "single"));
+}
+
+TEST_F(CgroupTest, MoveAssign_OverLiveCgroup_RemovesOldDirectory) {
+    auto target = Cgroup::Create(parent_dir_ / "target");
+    auto source = Cgroup::Create(parent_dir_ / "source");
+    ASSERT_TRUE(target.has_value() && source.has_value());
+
+    *target = std::move(*source);
+
+    EXPECT_FALSE(fs::exists(parent_dir_ / "target"));
+    EXPECT_EQ(target->GetPath(), parent_dir_ / "source");
+    EXPECT_TRUE(target->IsValid());
+    EXPECT_FALSE(source->IsValid());
+
+    ASSERT_TRUE(target->Remove().has_value());
+    EXPECT_FALSE(fs::exists(parent_dir_ / "source"));
+}
+
+TEST_F(CgroupTest, JoinCgroup_WithBusyProcess_AccountsCpuTime) {
+    auto cgroup_res = Cgroup::Create(parent_dir_ / "cpu");
+    ASSERT_TRUE(cgroup_res.has_value());
+
+    process::Command cmd("/bin/sh");
+    cmd.Arg("-c").Arg("i=0; while [ $i -lt 100000 ]; do i=$((i+1)); done")
+       .JoinCgroup(cgroup_res->GetProcsFd());
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+    ASSERT_TRUE(child_res->Wait().has_value());
+
+    auto stats_res = cgroup_res->ReadStats();
+    ASSERT_TRUE(stats_res.has_value());
+    EXPECT_GT(stats_res->cpu_usage.count(), 0);
+    EXPECT_EQ(stats_res->oom_kill_count, 0);
+}
+
+TEST_F(CgroupTest, Kill_WithForkedDescendants_TerminatesWholeGroup) {
+    auto cgroup_res = Cgroup::Create(parent_dir_ / "kill");
+    ASSERT_TRUE(cgroup_res.has_value());
+
+    process::Command cmd("/bin/sh");
+    cmd.Arg("-c").Arg("sleep 100 & sleep 100 & wait")
+       .Backend(process::SpawnBackend::VFork)
+       .JoinCgroup(cgroup_res->GetProcsFd());
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+
+    std::this_thread::sleep_for(50ms);
+    ASSERT_TRUE(cgroup_res->Kill().has_value());
+
+    auto wait_res = child_res->WaitWithTimeout(5s);
+    ASSERT_TRUE(wait_res.has_value());
+    EXPECT_EQ(wait_res->Signal().value_or(0), SIGKILL);
+
+    EXPECT_TRUE(cgroup_res->Remove().has_value());
+}
+
+TEST_F(CgroupTest, Pool_AcquireAndRelease_KeepsPoolFilled) {
+    CgroupPool pool(parent_dir_, 2, "pooled");
+    ASSERT_TRUE(pool.Reserve().has_value());
+    EXPECT_EQ(pool.GetIdleCount(), 2);
+
+    auto first = pool.Acquire();
+    auto second = pool.Acquire();
+    auto third = pool.Acquire();
+    ASSERT_TRUE(first.has_value() && second.has_value() && third.has_value());
+    EXPECT_EQ(pool.GetIdleCount(), 0);
+
+    pool.Release(std::move(*first));
+    pool.Release(std::move(*second));
+    pool.Release(std::move(*third));
+    EXPECT_TRUE(WaitForIdleCount(pool, 2));
+}
+
+TEST_F(CgroupTest, Pool_WithCpuCores_WritesCpuMax) {
+    CgroupPool pool(parent_dir_, 1, "cpu", 1.5);
+    if (auto res = pool.Reserve(); !res.has_value()) {
+        ASSERT_EQ(res.error(), std::errc::not_supported) << res.error().message();
+        GTEST_SKIP() << "cpu controller is not available; skipping cpu.max test.";
+    }
+
+    auto cgroup_res = pool.Acquire();
+    ASSERT_TRUE(cgroup_res.has_value()) << cgroup_res.error().message();
+
+    std::string cpu_max;
+    std::getline(std::ifstream(cgroup_res->GetPath() / "cpu.max"), cpu_max);
+    EXPECT_EQ(cpu_max, "150000 100000");
+
+    pool.Release(std::move(*cgroup_res));
+}
+
+TEST_F(CgroupTest, Run_WithCgroupPool_ReportsCgroupStats) {
+    CgroupPool pool(parent_dir_, 1, "run");
+    ASSERT_TRUE(pool.Reserve().has_value());
+
+    fs::path output = fs::temp_directory_path() / ("coj_cgroup_run_" + std::to_string(::getpid()) + ".out");
+
+    RunConfig config{
+        .exec_path = "/bin/sh",
+        .input_path = "/dev/null",
+        .output_path = output,
+        .soft_limits = { .cpu_time = 1000ms, .memory_kb = 64 * 1024 },
+        .hard_limits = { .cpu_time_sec = 2, .memory_bytes = 128 * 1024 * 1024 },
+        .cgroup_pool = &pool
+    };
+
+    auto result = coj::Run(config);
+    fs::remove(output);
+
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+    EXPECT_EQ(result->status, RunStatus::Success);
+    ASSERT_TRUE(result->cgroup_stats.has_value());
+    EXPECT_TRUE(WaitForIdleCount(pool, 1));
+}
+
+TEST_F(CgroupTest, RunInteractive_WithCgroupPool_ReportsSolutionCgroupStats) {
+    CgroupPool pool(parent_dir_, 1, "interactive");
+    ASSERT_TRUE(pool.Reserve().has_value());
+
+    fs::path scratch = fs::temp_directory_path() / ("coj_cgroup_interactive_" + std::to_string(::getpid()));
+    fs::create_directories(scratch);
+    fs::path interactor = scratch / "interactor.sh";
+    std::ofstream(interactor) << "#!/bin/sh\necho 1\nread reply\n";
+    fs::permissions(interactor, fs::perms::owner_all);
+
+    auto result = RunInteractive({
+        .exec_path = "/bin/cat",
+        .soft_limits = { .cpu_time = 1000ms, .memory_kb = 64 * 1024 },
+        .hard_limits = { .memory_bytes = 128 * 1024 * 1024 },
+        .cgroup_pool = &pool,
+        .interactor_path = interactor,
+        .input_path = "/dev/null",
+        .output_path = scratch / "interactor.out"
+    });
+    fs::remove_all(scratch);
+
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+    EXPECT_EQ(result->check_result, CheckResult::Accepted);
+    ASSERT_TRUE(result->run_result.cgroup_stats.has_value());
+    EXPECT_TRUE(WaitForIdleCount(pool, 1));
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
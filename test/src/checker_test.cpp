@@ -1,6 +1,9 @@
 #include <filesystem>
 #include <fstream>
 #include <string>
+#include <thread>
+
+#include <sys/stat.h>
 
 #include <gtest/gtest.h>
 
@@ -95,6 +98,28 @@ TEST_F(CheckerTest, Check_HybridTextAndFloat_ReturnsAccepted) {
     EXPECT_EQ(Check(config).value(), CheckResult::Accepted);
 }
 
+TEST_F(CheckerTest, Check_OutputFromFifo_ReturnsAccepted) {
+    std::string content;
+    for (int i = 0; i < 50000; ++i) {
+        content += std::to_string(i) + (i % 10 == 9 ? "\n" : " ");
+    }
+    auto answer = CreateFile("10.out", content);
+
+    fs::path fifo = sandbox_dir_ / "10.user_out";
+    ASSERT_EQ(::mkfifo(fifo.c_str(), 0600), 0);
+
+    std::thread writer([&] {
+        std::ofstream(fifo) << content;
+    });
+
+    CheckConfig config{.output_path = fifo, .answer_path = answer};
+    auto result = Check(config);
+    writer.join();
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), CheckResult::Accepted);
+}
+
 TEST_F(CheckerTest, Check_MissingUserFile_ReturnsWrongAnswer) {
     auto answer = CreateFile("8.out", "1 2 3");
     fs::path missing_user = sandbox_dir_ / "missing.user_out";
@@ -117,6 +142,26 @@ TEST_F(CheckerTest, Check_MissingAnswerFile_ReturnsSystemError) {
     EXPECT_EQ(result.error(), std::errc::no_such_file_or_directory);
 }
 
+TEST_F(CheckerTest, Check_LongFloatRunWithLateMismatch_ReturnsWrongAnswer) {
+    std::string answer_content;
+    std::string close_content;
+    std::string late_bad_content;
+    for (int i = 0; i < 3000; ++i) {
+        answer_content += std::to_string(i) + ".5 ";
+        close_content += std::to_string(i) + ".5000000001 ";
+        late_bad_content += (i == 2500 ? std::string("0") : std::to_string(i) + ".5") + " ";
+    }
+    auto answer = CreateFile("10.out", answer_content + "end");
+    auto close = CreateFile("10.close", close_content + "end");
+    auto late_bad = CreateFile("10.bad", late_bad_content + "end");
+
+    CheckConfig close_config{.output_path = close, .answer_path = answer, .epsilon = 1e-6};
+    EXPECT_EQ(Check(close_config).value(), CheckResult::Accepted);
+
+    CheckConfig bad_config{.output_path = late_bad, .answer_path = answer, .epsilon = 1e-6};
+    EXPECT_EQ(Check(bad_config).value(), CheckResult::WrongAnswer);
+}
+
 } // namespace
 
 } // namespace coj
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "coj/compile_cache.h"
+#include "coj/compiler.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+class CompileCacheTest : public ::testing::Test {
+protected:
+    fs::path sandbox_dir_;
+
+    void SetUp() override {
+        sandbox_dir_ = fs::temp_directory_path() / ("coj_compile_cache_test_" + std::to_string(::getpid()));
+        fs::create_directories(sandbox_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(sandbox_dir_);
+    }
+
+    fs::path CreateSourceFile(const std::string& filename, const std::string& code) {
+        fs::path file_path = sandbox_dir_ / filename;
+        std::ofstream(file_path) << code;
+        return file_path;
+    }
+
+    fs::path CreateExecDir(const std::string& name) {
+        fs::path exec_dir = sandbox_dir_ / name;
+        fs::create_directories(exec_dir);
+        return exec_dir;
+    }
+
+    static constexpr const char* VALID_CODE = "int main() { return 0; }\n";
+};
+
+TEST_F(CompileCacheTest, Compile_SameSourceTwice_SecondIsCacheHit) {
+    CompileCache cache(sandbox_dir_ / "cache", 64 * 1024 * 1024);
+    ASSERT_TRUE(cache.Load().has_value());
+
+    CppCompiler compiler;
+    compiler.Arg("-O2").Cache(&cache);
+
+    auto source = CreateSourceFile("valid.cpp", VALID_CODE);
+
+    auto first = compiler.Compile(source, CreateExecDir("first"));
+    ASSERT_TRUE(first.has_value());
+    EXPECT_TRUE(first->is_successful);
+    EXPECT_FALSE(first->is_cached);
+
+    auto second = compiler.Compile(source, CreateExecDir("second"));
+    ASSERT_TRUE(second.has_value());
+    EXPECT_TRUE(second->is_successful);
+    EXPECT_TRUE(second->is_cached);
+    ASSERT_TRUE(second->exec_path.has_value());
+    EXPECT_TRUE(fs::exists(second->exec_path.value()));
+    EXPECT_EQ(second->exec_path.value(), sandbox_dir_ / "second" / "main");
+
+    auto stats = cache.GetStats();
+    EXPECT_EQ(stats.hit_count, 1);
+    EXPECT_EQ(stats.miss_count, 1);
+    EXPECT_EQ(stats.store_count, 1);
+    EXPECT_EQ(stats.entry_count, 1);
+}
+
+TEST_F(CompileCacheTest, GetCacheKey_DifferentArgs_ProducesDifferentKeys) {
+    auto source = CreateSourceFile("valid.cpp", VALID_CODE);
+
+    CppCompiler optimized;
+    optimized.Arg("-O2");
+    CppCompiler debug;
+    debug.Arg("-O0");
+
+    auto optimized_key = optimized.GetCacheKey(source);
+    auto debug_key = debug.GetCacheKey(source);
+    ASSERT_TRUE(optimized_key.has_value() && debug_key.has_value());
+
+    EXPECT_NE(*optimized_key, *debug_key);
+    EXPECT_EQ(*optimized_key, optimized.GetCacheKey(source).value());
+}
+
+TEST_F(CompileCacheTest, Compile_CompileError_CachesDiagnostics) {
+    CompileCache cache(sandbox_dir_ / "cache", 64 * 1024 * 1024);
+    ASSERT_TRUE(cache.Load().has_value());
+
+    CppCompiler compiler;
+    compiler.Cache(&cache);
+
+    auto source = CreateSourceFile("invalid.cpp", "int main() { return 0 }\n");
+
+    auto first = compiler.Compile(source, CreateExecDir("first"));
+    auto second = compiler.Compile(source, CreateExecDir("second"));
+    ASSERT_TRUE(first.has_value() && second.has_value());
+
+    EXPECT_FALSE(second->is_successful);
+    EXPECT_TRUE(second->is_cached);
+    EXPECT_FALSE(second->exec_path.has_value());
+    EXPECT_EQ(first->output, second->output);
+}
+
+TEST_F(CompileCacheTest, Compile_FailedUnderTightLimits_RecompilesUnderLooseLimits) {
+    CompileCache cache(sandbox_dir_ / "cache", 64 * 1024 * 1024);
+    ASSERT_TRUE(cache.Load().has_value());
+
+    CppCompiler compiler;
+    compiler.Cache(&cache);
+
+    auto source = CreateSourceFile("valid.cpp", VALID_CODE);
+
+    auto tight = compiler.Compile(source, CreateExecDir("tight"), { .memory_bytes = 16 * 1024 * 1024 });
+    ASSERT_TRUE(tight.has_value());
+    EXPECT_FALSE(tight->is_successful);
+
+    auto loose = compiler.Compile(source, CreateExecDir("loose"), { .memory_bytes = 2048ULL * 1024 * 1024 });
+    ASSERT_TRUE(loose.has_value());
+    EXPECT_TRUE(loose->is_successful) << loose->output;
+    EXPECT_FALSE(loose->is_cached);
+}
+
+TEST_F(CompileCacheTest, Store_OverBudget_EvictsLeastRecentlyUsed) {
+    CompileCache cache(sandbox_dir_ / "cache", 16);
+    ASSERT_TRUE(cache.Load().has_value());
+
+    CompileResult result{ .is_successful = false, .output = "0123456789" };
+
+    ASSERT_TRUE(cache.Store("a", result).has_value());
+    ASSERT_TRUE(cache.Store("b", result).has_value());
+
+    auto stats = cache.GetStats();
+    EXPECT_EQ(stats.entry_count, 1);
+    EXPECT_EQ(stats.eviction_count, 1);
+
+    EXPECT_FALSE(cache.Lookup("a", sandbox_dir_).value().has_value());
+    EXPECT_TRUE(cache.Lookup("b", sandbox_dir_).value().has_value());
+    EXPECT_FALSE(fs::exists(sandbox_dir_ / "cache" / "a"));
+}
+
+TEST_F(CompileCacheTest, Load_ExistingDirectory_RestoresEntries) {
+    CompileResult result{ .is_successful = false, .output = "diagnostics" };
+    {
+        CompileCache cache(sandbox_dir_ / "cache", 1024);
+        ASSERT_TRUE(cache.Load().has_value());
+        ASSERT_TRUE(cache.Store("key", result).has_value());
+    }
+
+    CompileCache reopened(sandbox_dir_ / "cache", 1024);
+    ASSERT_TRUE(reopened.Load().has_value());
+    EXPECT_EQ(reopened.GetStats().entry_count, 1);
+
+    auto lookup = reopened.Lookup("key", sandbox_dir_);
+    ASSERT_TRUE(lookup.has_value() && lookup->has_value());
+    EXPECT_EQ((*lookup)->output, "diagnostics");
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "coj/compile_service.h"
+#include "coj/compiler.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+class GatedCompiler : public Compiler {
+public:
+    explicit GatedCompiler(std::shared_future<void> gate) : gate_(std::move(gate)) {}
+
+    std::expected<CompileResult, std::error_code> Compile(
+        const fs::path& source_path,
+        const fs::path& exec_dir
+    ) override {
+        gate_.wait();
+        ++plain_count;
+        return CompileResult{ .is_successful = true, .exec_path = exec_dir / source_path.filename() };
+    }
+
+    std::expected<CompileResult, std::error_code> Compile(
+        const fs::path& source_path,
+        const fs::path& exec_dir,
+        const process::ResourceLimits& limits
+    ) override {
+        gate_.wait();
+        last_cpu_time_sec = limits.cpu_time_sec.value_or(0);
+        return CompileResult{ .is_successful = true, .exec_path = exec_dir / source_path.filename() };
+    }
+
+    std::atomic<int> plain_count = 0;
+    std::atomic<long> last_cpu_time_sec = 0;
+
+private:
+    std::shared_future<void> gate_;
+};
+
+class CompileServiceTest : public ::testing::Test {
+protected:
+    fs::path sandbox_dir_;
+
+    void SetUp() override {
+        sandbox_dir_ = fs::temp_directory_path() / ("coj_compile_service_test_" + std::to_string(::getpid()));
+        fs::create_directories(sandbox_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(sandbox_dir_);
+    }
+};
+
+TEST_F(CompileServiceTest, Submit_RealCompilerOnWorkers_CompilesAllJobs) {
+    CppCompiler compiler;
+    compiler.Arg("-O0");
+
+    CompileService service(compiler, { .worker_count = 2, .queue_capacity = 4 });
+
+    std::vector<std::future<CompileJobResult>> futures;
+    for (int i = 0; i < 3; ++i) {
+        fs::path source = sandbox_dir_ / ("main" + std::to_string(i) + ".cpp");
+        std::ofstream(source) << "int main() { return " << i << "; }\n";
+
+        fs::path exec_dir = sandbox_dir_ / ("exec" + std::to_string(i));
+        fs::create_directories(exec_dir);
+
+        futures.push_back(service.Submit(CompileJob{ .source_path = source, .exec_dir = exec_dir }));
+    }
+
+    for (auto& future : futures) {
+        auto job_result = future.get();
+        ASSERT_TRUE(job_result.result.has_value()) << job_result.result.error().message();
+        EXPECT_TRUE(job_result.result->is_successful) << job_result.result->output;
+        EXPECT_GT(job_result.run_time.count(), 0);
+    }
+
+    auto stats = service.GetStats();
+    EXPECT_EQ(stats.submitted_count, 3);
+    EXPECT_EQ(stats.completed_count, 3);
+    EXPECT_GT(stats.total_run_time.count(), 0);
+}
+
+TEST_F(CompileServiceTest, TrySubmit_QueueFull_RejectsWithTryAgain) {
+    std::promise<void> gate;
+    GatedCompiler compiler(gate.get_future().share());
+
+    CompileService service(compiler, { .worker_count = 1, .queue_capacity = 1 });
+
+    auto running = service.Submit(CompileJob{ .source_path = "a.cpp", .exec_dir = sandbox_dir_ });
+    while (service.GetStats().running_count == 0) {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    auto queued = service.TrySubmit(CompileJob{ .source_path = "b.cpp", .exec_dir = sandbox_dir_ });
+    ASSERT_TRUE(queued.has_value());
+
+    auto rejected = service.TrySubmit(CompileJob{ .source_path = "c.cpp", .exec_dir = sandbox_dir_ });
+    ASSERT_FALSE(rejected.has_value());
+    EXPECT_EQ(rejected.error(), std::errc::resource_unavailable_try_again);
+
+    std::this_thread::sleep_for(10ms);
+    gate.set_value();
+
+    EXPECT_TRUE(running.get().result.has_value());
+
+    auto queued_result = queued->get();
+    ASSERT_TRUE(queued_result.result.has_value());
+    EXPECT_GE(queued_result.queue_time, 10ms);
+
+    EXPECT_EQ(service.GetStats().rejected_count, 1);
+}
+
+TEST_F(CompileServiceTest, Submit_WithLimits_UsesLimitedOverload) {
+    std::promise<void> gate;
+    gate.set_value();
+    GatedCompiler compiler(gate.get_future().share());
+
+    CompileService service(compiler, { .worker_count = 1 });
+
+    process::ResourceLimits limits{ .cpu_time_sec = 7 };
+    auto with_limits = service.Submit(CompileJob{ .source_path = "a.cpp", .exec_dir = sandbox_dir_, .limits = limits });
+    auto without_limits = service.Submit(CompileJob{ .source_path = "b.cpp", .exec_dir = sandbox_dir_ });
+
+    ASSERT_TRUE(with_limits.get().result.has_value());
+    ASSERT_TRUE(without_limits.get().result.has_value());
+
+    EXPECT_EQ(compiler.last_cpu_time_sec, 7);
+    EXPECT_EQ(compiler.plain_count, 1);
+}
+
+TEST_F(CompileServiceTest, Submit_WithCallback_InvokesCallbackAfterShutdownDrain) {
+    std::promise<void> gate;
+    gate.set_value();
+    GatedCompiler compiler(gate.get_future().share());
+
+    std::atomic<int> callback_count = 0;
+    {
+        CompileService service(compiler, { .worker_count = 2 });
+        for (int i = 0; i < 5; ++i) {
+            service.Submit(CompileJob{ .source_path = "a.cpp", .exec_dir = sandbox_dir_ }, [&](CompileJobResult result) {
+                EXPECT_TRUE(result.result.has_value());
+                ++callback_count;
+            });
+        }
+    }
+
+    EXPECT_EQ(callback_count, 5);
+}
+
+TEST_F(CompileServiceTest, Submit_AfterShutdown_ReturnsCancelled) {
+    std::promise<void> gate;
+    gate.set_value();
+    GatedCompiler compiler(gate.get_future().share());
+
+    CompileService service(compiler, { .worker_count = 1 });
+    service.Shutdown();
+
+    auto result = service.Submit(CompileJob{ .source_path = "a.cpp", .exec_dir = sandbox_dir_ }).get();
+    ASSERT_FALSE(result.result.has_value());
+    EXPECT_EQ(result.result.error(), std::errc::operation_canceled);
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,238 @@
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "coj/compile_cache.h"
+#include "coj/compiler_registry.h"
+#include "coj/runner.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+constexpr std::string_view DESCRIPTORS = R"ini(
+# Toolchains used by the tests.
+[cpp]
+source = main.cpp
+compile = /usr/bin/g++ -O2 -std=c++23 {source} -o {exec}
+compile_cpu_sec = 30
+warmup = int main() {}
+
+[python]
+source = main.py
+run = /usr/bin/python3 {source}
+time_multiplier = 3
+memory_extra_mb = 16
+
+[python-bytecode]
+source = main.py
+compile = /usr/bin/python3 -c "import py_compile, sys; py_compile.compile(sys.argv[1], cfile=sys.argv[2], doraise=True)" {source} {exec}
+run = /usr/bin/python3 {exec}
+warmup = pass
+)ini";
+
+class CompilerRegistryTest : public ::testing::Test {
+protected:
+    fs::path sandbox_dir_;
+
+    void SetUp() override {
+        sandbox_dir_ = fs::temp_directory_path() / ("coj_compiler_registry_test_" + std::to_string(::getpid()));
+        fs::create_directories(sandbox_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(sandbox_dir_);
+    }
+
+    fs::path CreateFile(const std::string& filename, const std::string& content) {
+        fs::path file_path = sandbox_dir_ / filename;
+        std::ofstream ofs(file_path);
+        ofs << content;
+        return file_path;
+    }
+
+    std::string RunProgram(LanguageCompiler& compiler, const fs::path& exec_dir, const std::string& input) {
+        auto run_command = compiler.GetRunCommand(exec_dir);
+
+        RunConfig config{
+            .exec_path = run_command.exec_path,
+            .args = run_command.args,
+            .input_path = CreateFile("input.txt", input),
+            .output_path = sandbox_dir_ / "output.txt",
+            .soft_limits = compiler.GetRunLimits({ .cpu_time = 2000ms, .memory_kb = 256 * 1024 })
+        };
+
+        auto run_res = coj::Run(config);
+        EXPECT_TRUE(run_res.has_value());
+        if (!run_res.has_value()) {
+            return {};
+        }
+        EXPECT_EQ(run_res->status, RunStatus::Success);
+
+        std::ifstream ifs(config.output_path);
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        return ss.str();
+    }
+};
+
+TEST_F(CompilerRegistryTest, Parse_Descriptors_BuildsEveryLanguage) {
+    auto registry_res = CompilerRegistry::Parse(DESCRIPTORS);
+    ASSERT_TRUE(registry_res.has_value()) << registry_res.error().message();
+
+    EXPECT_EQ(registry_res->GetLanguageNames(), (std::vector<std::string>{ "cpp", "python", "python-bytecode" }));
+    EXPECT_EQ(registry_res->Get("java"), nullptr);
+
+    auto* cpp = registry_res->Get("cpp");
+    ASSERT_NE(cpp, nullptr);
+    EXPECT_FALSE(cpp->IsInterpreted());
+    EXPECT_EQ(cpp->GetSpec().compile_limits.cpu_time_sec, 30u);
+    EXPECT_EQ(cpp->GetRunCommand("/box").exec_path, "/box/main");
+
+    auto* python = registry_res->Get("python");
+    ASSERT_NE(python, nullptr);
+    EXPECT_TRUE(python->IsInterpreted());
+
+    auto limits = python->GetRunLimits({ .cpu_time = 1000ms, .memory_kb = 1024 });
+    EXPECT_EQ(limits.cpu_time, 3000ms);
+    EXPECT_EQ(limits.memory_kb, 1024u + 16 * 1024);
+
+    auto* bytecode = registry_res->Get("python-bytecode");
+    ASSERT_NE(bytecode, nullptr);
+    const auto& argv = bytecode->GetSpec().compile->GetArgv();
+    ASSERT_EQ(argv.size(), 5u);
+    EXPECT_EQ(argv[2].find('"'), std::string::npos);
+    EXPECT_EQ(argv[3], "{source}");
+}
+
+TEST_F(CompilerRegistryTest, Parse_MalformedDescriptors_ReturnsInvalidArgument) {
+    for (std::string_view text : {
+        "compile = /usr/bin/cc\n",
+        "[c]\nunknown = 1\n",
+        "[c]\ncompile = /usr/bin/cc \"unterminated\n",
+        "[c]\n[c]\n",
+        "[c]\ntime_multiplier = fast\n",
+        "[c\n"
+    }) {
+        auto registry_res = CompilerRegistry::Parse(text);
+        ASSERT_FALSE(registry_res.has_value()) << text;
+        EXPECT_EQ(registry_res.error(), std::make_error_code(std::errc::invalid_argument));
+    }
+}
+
+TEST_F(CompilerRegistryTest, Compile_CppDescriptor_RunsRenderedCommand) {
+    auto registry_res = CompilerRegistry::Parse(DESCRIPTORS);
+    ASSERT_TRUE(registry_res.has_value());
+    auto* cpp = registry_res->Get("cpp");
+
+    auto source = CreateFile("submission.cpp", "#include <iostream>\nint main() { int a, b; std::cin >> a >> b; std::cout << a + b; }\n");
+    fs::path exec_dir = sandbox_dir_ / "exec";
+    fs::create_directories(exec_dir);
+
+    for (int i = 0; i < 2; ++i) {
+        auto compile_res = cpp->Compile(source, exec_dir);
+        ASSERT_TRUE(compile_res.has_value()) << compile_res.error().message();
+        ASSERT_TRUE(compile_res->is_successful) << compile_res->output;
+        EXPECT_EQ(compile_res->exec_path, exec_dir / "main");
+
+        EXPECT_EQ(RunProgram(*cpp, exec_dir, "20 22"), "42");
+    }
+
+    auto broken = CreateFile("broken.cpp", "int main() { return }\n");
+    auto broken_res = cpp->Compile(broken, exec_dir);
+    ASSERT_TRUE(broken_res.has_value());
+    EXPECT_FALSE(broken_res->is_successful);
+    EXPECT_FALSE(broken_res->exec_path.has_value());
+    EXPECT_NE(broken_res->output.find("error"), std::string::npos);
+}
+
+TEST_F(CompilerRegistryTest, Compile_Interpreted_SkipsCompilation) {
+    auto registry_res = CompilerRegistry::Parse(DESCRIPTORS);
+    ASSERT_TRUE(registry_res.has_value());
+    auto* python = registry_res->Get("python");
+
+    auto source = CreateFile("submission.py", "print(int(input()) * 2)\n");
+    fs::path exec_dir = sandbox_dir_ / "exec";
+    fs::create_directories(exec_dir);
+
+    auto compile_res = python->Compile(source, exec_dir);
+    ASSERT_TRUE(compile_res.has_value());
+    EXPECT_TRUE(compile_res->is_successful);
+    EXPECT_EQ(compile_res->exec_path, exec_dir / "main.py");
+
+    EXPECT_EQ(RunProgram(*python, exec_dir, "21"), "42\n");
+}
+
+TEST_F(CompilerRegistryTest, Compile_ByteCodeWithCache_ReusesArtifact) {
+    auto registry_res = CompilerRegistry::Parse(DESCRIPTORS);
+    ASSERT_TRUE(registry_res.has_value());
+
+    CompileCache cache(sandbox_dir_ / "cache", 16 * 1024 * 1024);
+    ASSERT_TRUE(cache.Load().has_value());
+    registry_res->Cache(&cache);
+
+    auto* bytecode = registry_res->Get("python-bytecode");
+    auto source = CreateFile("submission.py", "print(int(input()) + 1)\n");
+
+    for (int i = 0; i < 2; ++i) {
+        fs::path exec_dir = sandbox_dir_ / ("exec" + std::to_string(i));
+        fs::create_directories(exec_dir);
+
+        auto compile_res = bytecode->Compile(source, exec_dir);
+        ASSERT_TRUE(compile_res.has_value());
+        ASSERT_TRUE(compile_res->is_successful) << compile_res->output;
+        EXPECT_EQ(compile_res->is_cached, i == 1);
+
+        EXPECT_EQ(RunProgram(*bytecode, exec_dir, "41"), "42\n");
+    }
+
+    EXPECT_EQ(cache.GetStats().hit_count, 1u);
+}
+
+TEST_F(CompilerRegistryTest, Compile_FailedUnderTightLimits_RecompilesUnderLooseLimits) {
+    auto registry_res = CompilerRegistry::Parse(DESCRIPTORS);
+    ASSERT_TRUE(registry_res.has_value());
+
+    CompileCache cache(sandbox_dir_ / "cache", 16 * 1024 * 1024);
+    ASSERT_TRUE(cache.Load().has_value());
+    registry_res->Cache(&cache);
+
+    auto* cpp = registry_res->Get("cpp");
+    auto source = CreateFile("submission.cpp", "int main() { return 0; }\n");
+
+    fs::path tight_dir = sandbox_dir_ / "tight";
+    fs::create_directories(tight_dir);
+    auto tight = cpp->Compile(source, tight_dir, { .memory_bytes = 16 * 1024 * 1024 });
+    ASSERT_TRUE(tight.has_value());
+    EXPECT_FALSE(tight->is_successful);
+
+    fs::path loose_dir = sandbox_dir_ / "loose";
+    fs::create_directories(loose_dir);
+    auto loose = cpp->Compile(source, loose_dir, { .memory_bytes = 2048ULL * 1024 * 1024 });
+    ASSERT_TRUE(loose.has_value());
+    EXPECT_TRUE(loose->is_successful) << loose->output;
+    EXPECT_FALSE(loose->is_cached);
+}
+
+TEST_F(CompilerRegistryTest, Warmup_CompilesAndRemovesScratch) {
+    auto registry_res = CompilerRegistry::Parse(DESCRIPTORS);
+    ASSERT_TRUE(registry_res.has_value());
+
+    auto warmup_res = registry_res->Warmup(sandbox_dir_);
+    ASSERT_TRUE(warmup_res.has_value()) << warmup_res.error().message();
+
+    EXPECT_TRUE(fs::is_empty(sandbox_dir_));
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
@@ -89,6 +89,68 @@ TEST_F(CompilerTest, Compile_InvalidCppCode_ReturnsFalseAndErrorMessage) {
         << "\n===========================\n";
 }
 
+TEST_F(CompilerTest, Compile_WithHugeDiagnostics_CapsOutputAndCountsDroppedBytes) {
+    std::string code = "int main() {\n";
+    for (int i = 0; i < 2000; ++i) {
+        code += "    undeclared_" + std::to_string(i) + " = 0;\n";
+    }
+    code += "}\n";
+    fs::path source_path = CreateSourceFile("noisy.cpp", code);
+
+    CppCompiler compiler;
+    compiler.MaxOutputBytes(4096);
+
+    auto result = compiler.Compile(source_path, sandbox_dir_);
+    ASSERT_TRUE(result.has_value());
+
+    EXPECT_FALSE(result->is_successful);
+    EXPECT_GT(result->dropped_output_bytes, 0);
+    EXPECT_LT(result->output.size(), 4096 + 64);
+    EXPECT_NE(result->output.find("undeclared_0"), std::string::npos);
+    EXPECT_NE(result->output.find("bytes omitted"), std::string::npos);
+}
+
+TEST_F(CompilerTest, Compile_WithPrecompiledHeader_UsesGeneratedGch) {
+    fs::path source_path = CreateSourceFile("pch.cpp", R"(
+        #include <vector>
+        int main() {
+            std::vector<int> v{1, 2, 3};
+            return v.size() == 3 ? 0 : 1;
+        }
+    )");
+
+    CppCompiler compiler;
+    compiler.Arg("-O2").Arg("-H").PrecompiledHeader(sandbox_dir_ / "pch", "vector");
+
+    auto pch_dir = compiler.PreparePrecompiledHeader();
+    ASSERT_TRUE(pch_dir.has_value()) << pch_dir.error().message();
+    EXPECT_TRUE(fs::exists(pch_dir.value() / "vector.gch"));
+
+    auto result = compiler.Compile(source_path, sandbox_dir_);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result->is_successful) << result->output;
+    EXPECT_NE(result->output.find("! " + (pch_dir.value() / "vector.gch").string()), std::string::npos)
+        << "Precompiled header was not used:\n" << result->output;
+}
+
+TEST_F(CompilerTest, PreparePrecompiledHeader_FlagsChanged_BuildsSeparateHeader) {
+    CppCompiler compiler;
+    compiler.Arg("-O0").PrecompiledHeader(sandbox_dir_ / "pch", "vector");
+
+    auto first = compiler.PreparePrecompiledHeader();
+    ASSERT_TRUE(first.has_value());
+
+    auto again = compiler.PreparePrecompiledHeader();
+    ASSERT_TRUE(again.has_value());
+    EXPECT_EQ(first.value(), again.value());
+
+    compiler.Arg("-DCOJ_PCH_VARIANT");
+    auto second = compiler.PreparePrecompiledHeader();
+    ASSERT_TRUE(second.has_value());
+    EXPECT_NE(first.value(), second.value());
+    EXPECT_TRUE(fs::exists(second.value() / "vector.gch"));
+}
+
 } // namespace
 
 } // namespace coj
\ No newline at end of file
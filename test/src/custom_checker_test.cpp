@@ -0,0 +1,176 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "coj/compiler.h"
+#include "coj/custom_checker.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+// Speaks the persistent protocol: accepts when output and answer are byte-identical. With an argument
+// it exits after that many replies, to exercise restarts.
+constexpr const char* PERSISTENT_CHECKER_SOURCE = R"(
+    #include <cstdint>
+    #include <cstdlib>
+    #include <fstream>
+    #include <iterator>
+    #include <string>
+    #include <unistd.h>
+
+    bool ReadExact(void* data, size_t size) {
+        char* ptr = static_cast<char*>(data);
+        while (size > 0) {
+            ssize_t n = read(0, ptr, size);
+            if (n <= 0) return false;
+            ptr += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool ReadFrame(std::string& out) {
+        uint32_t length;
+        if (!ReadExact(&length, sizeof(length))) return false;
+        out.resize(length);
+        return ReadExact(out.data(), length);
+    }
+
+    std::string Slurp(const std::string& path) {
+        std::ifstream in(path);
+        return std::string(std::istreambuf_iterator<char>(in), {});
+    }
+
+    int main(int argc, char** argv) {
+        int replies_left = argc > 1 ? std::atoi(argv[1]) : -1;
+        std::string input, output, answer;
+        while (replies_left != 0 && ReadFrame(input) && ReadFrame(output) && ReadFrame(answer)) {
+            std::string expected = Slurp(answer);
+            int32_t code = expected == "fail\n" ? 3 : (Slurp(output) == expected ? 0 : 1);
+            std::string message = code == 0 ? "ok" : "mismatch";
+            uint32_t length = static_cast<uint32_t>(message.size());
+            write(1, &code, sizeof(code));
+            write(1, &length, sizeof(length));
+            write(1, message.data(), message.size());
+            --replies_left;
+        }
+        return 0;
+    }
+)";
+
+class CustomCheckerTest : public ::testing::Test {
+protected:
+    fs::path sandbox_dir_;
+
+    void SetUp() override {
+        sandbox_dir_ = fs::temp_directory_path() / ("coj_custom_checker_test_" + std::to_string(::getpid()));
+        fs::create_directories(sandbox_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(sandbox_dir_);
+    }
+
+    fs::path CreateFile(const std::string& filename, const std::string& content) {
+        fs::path file_path = sandbox_dir_ / filename;
+        std::ofstream(file_path) << content;
+        return file_path;
+    }
+
+    fs::path CompilePersistentChecker() {
+        fs::path source_path = CreateFile("checker.cpp", PERSISTENT_CHECKER_SOURCE);
+        fs::path exec_dir = sandbox_dir_ / "checker";
+        fs::create_directories(exec_dir);
+
+        CppCompiler compiler;
+        compiler.Arg("-O2").Arg("-std=c++23");
+
+        auto result = compiler.Compile(source_path, exec_dir);
+        EXPECT_TRUE(result.has_value() && result->is_successful) << "Test setup failed: Compilation error\n" << result->output;
+        return result->exec_path.value();
+    }
+
+    CheckRequest CreateRequest(const std::string& name, const std::string& output, const std::string& answer) {
+        return CheckRequest{
+            .input_path = CreateFile(name + ".in", ""),
+            .output_path = CreateFile(name + ".out", output),
+            .answer_path = CreateFile(name + ".ans", answer)
+        };
+    }
+};
+
+TEST_F(CustomCheckerTest, ToCheckResult_TestlibCodes_MapsToVerdicts) {
+    EXPECT_EQ(ToCheckResult(0).value(), CheckResult::Accepted);
+    EXPECT_EQ(ToCheckResult(1).value(), CheckResult::WrongAnswer);
+    EXPECT_EQ(ToCheckResult(2).value(), CheckResult::WrongAnswer);
+    EXPECT_EQ(ToCheckResult(3).error(), std::errc::state_not_recoverable);
+    EXPECT_EQ(ToCheckResult(42).error(), std::errc::state_not_recoverable);
+}
+
+TEST_F(CustomCheckerTest, TokenChecker_Check_ComparesTokens) {
+    TokenChecker checker(1e-6);
+
+    auto accepted = checker.Check(CreateRequest("1", "1.0000001\n", "1.0"));
+    auto wrong = checker.Check(CreateRequest("2", "2.5", "1.0"));
+
+    ASSERT_TRUE(accepted.has_value());
+    ASSERT_TRUE(wrong.has_value());
+    EXPECT_EQ(accepted->result, CheckResult::Accepted);
+    EXPECT_EQ(wrong->result, CheckResult::WrongAnswer);
+}
+
+TEST_F(CustomCheckerTest, ExternalChecker_OneShot_UsesExitCodeAndStderr) {
+    auto script = CreateFile("check.sh", "cmp -s \"$2\" \"$3\" && exit 0\necho \"outputs differ\" >&2\nexit 1\n");
+    ExternalChecker checker({ .exec_path = "/bin/sh", .args = { script.string() } });
+
+    auto accepted = checker.Check(CreateRequest("1", "42\n", "42\n"));
+    auto wrong = checker.Check(CreateRequest("2", "41\n", "42\n"));
+
+    ASSERT_TRUE(accepted.has_value()) << accepted.error().message();
+    ASSERT_TRUE(wrong.has_value()) << wrong.error().message();
+    EXPECT_EQ(accepted->result, CheckResult::Accepted);
+    EXPECT_EQ(wrong->result, CheckResult::WrongAnswer);
+    EXPECT_EQ(wrong->message, "outputs differ\n");
+}
+
+TEST_F(CustomCheckerTest, ExternalChecker_Persistent_ReusesOneProcess) {
+    ExternalChecker checker({ .exec_path = CompilePersistentChecker(), .is_persistent = true });
+
+    for (int i = 0; i < 5; ++i) {
+        auto verdict = checker.Check(CreateRequest(std::to_string(i), "x\n", i % 2 == 0 ? "x\n" : "y\n"));
+        ASSERT_TRUE(verdict.has_value()) << verdict.error().message();
+        EXPECT_EQ(verdict->result, i % 2 == 0 ? CheckResult::Accepted : CheckResult::WrongAnswer);
+        EXPECT_EQ(verdict->message, i % 2 == 0 ? "ok" : "mismatch");
+    }
+
+    auto fail = checker.Check(CreateRequest("fail", "x\n", "fail\n"));
+    ASSERT_FALSE(fail.has_value());
+    EXPECT_EQ(fail.error(), std::errc::state_not_recoverable);
+
+    EXPECT_TRUE(checker.Check(CreateRequest("after", "z\n", "z\n")).has_value());
+    EXPECT_EQ(checker.GetStartCount(), 1);
+}
+
+TEST_F(CustomCheckerTest, ExternalChecker_PersistentProcessExits_RestartsTransparently) {
+    ExternalChecker checker({ .exec_path = CompilePersistentChecker(), .args = { "1" }, .is_persistent = true });
+
+    for (int i = 0; i < 3; ++i) {
+        auto verdict = checker.Check(CreateRequest(std::to_string(i), "x\n", "x\n"));
+        ASSERT_TRUE(verdict.has_value()) << verdict.error().message();
+        EXPECT_EQ(verdict->result, CheckResult::Accepted);
+    }
+
+    EXPECT_EQ(checker.GetStartCount(), 3);
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
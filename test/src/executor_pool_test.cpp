@@ -0,0 +1,204 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "coj/executor_pool.h"
+#include "coj/runner.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+class ExecutorPoolTest : public ::testing::Test {
+protected:
+    fs::path sandbox_dir_;
+
+    void SetUp() override {
+        sandbox_dir_ = fs::temp_directory_path() / ("coj_executor_pool_test_" + std::to_string(::getpid()));
+        fs::create_directories(sandbox_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(sandbox_dir_);
+    }
+
+    fs::path CreateFile(const std::string& filename, const std::string& content) {
+        fs::path file_path = sandbox_dir_ / filename;
+        std::ofstream(file_path) << content;
+        return file_path;
+    }
+
+    static std::string ReadFile(const fs::path& path) {
+        std::ifstream ifs(path);
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        return ss.str();
+    }
+};
+
+TEST_F(ExecutorPoolTest, Execute_ManyRuns_EachRunGetsItsOwnStdio) {
+    ExecutorPool pool({ .exec_path = "/bin/cat" });
+    ASSERT_TRUE(pool.Start().has_value());
+
+    for (int i = 0; i < 20; ++i) {
+        auto input = CreateFile("in" + std::to_string(i), "case " + std::to_string(i));
+        fs::path output = sandbox_dir_ / ("out" + std::to_string(i));
+
+        auto in_fd = Open(input, O_RDONLY | O_CLOEXEC);
+        auto out_fd = Open(output, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC);
+        ASSERT_TRUE(in_fd.has_value() && out_fd.has_value());
+
+        auto status = pool.Execute(in_fd->Get(), out_fd->Get(), 5s);
+        ASSERT_TRUE(status.has_value()) << status.error().message();
+        EXPECT_TRUE(status->Success());
+
+        EXPECT_EQ(ReadFile(output), "case " + std::to_string(i));
+    }
+
+    EXPECT_EQ(pool.GetLiveServerCount(), 1);
+}
+
+TEST_F(ExecutorPoolTest, Execute_ExceedsTimeout_KillsChild) {
+    ExecutorPool pool({ .exec_path = "/bin/sleep", .args = { "10" } });
+    ASSERT_TRUE(pool.Start().has_value());
+
+    auto in_fd = Open("/dev/null", O_RDONLY | O_CLOEXEC);
+    auto out_fd = Open("/dev/null", O_WRONLY | O_CLOEXEC);
+
+    auto start = std::chrono::steady_clock::now();
+    auto status = pool.Execute(in_fd->Get(), out_fd->Get(), 100ms);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_TRUE(status.has_value());
+    EXPECT_EQ(status->Signal().value_or(0), SIGKILL);
+    EXPECT_LT(elapsed, 2s);
+}
+
+TEST_F(ExecutorPoolTest, Execute_MissingBinary_ReturnsErrorAndKeepsServer) {
+    ExecutorPool pool({ .exec_path = "/non/existent/binary" });
+    ASSERT_TRUE(pool.Start().has_value());
+
+    auto in_fd = Open("/dev/null", O_RDONLY | O_CLOEXEC);
+    auto out_fd = Open("/dev/null", O_WRONLY | O_CLOEXEC);
+
+    auto status = pool.Execute(in_fd->Get(), out_fd->Get(), 1s);
+    ASSERT_FALSE(status.has_value());
+    EXPECT_EQ(status.error(), std::errc::no_such_file_or_directory);
+    EXPECT_EQ(pool.GetLiveServerCount(), 1);
+}
+
+TEST_F(ExecutorPoolTest, Execute_ConcurrentCallers_ShareServers) {
+    ExecutorPool pool({ .exec_path = "/bin/cat", .server_count = 2 });
+    ASSERT_TRUE(pool.Start().has_value());
+
+    std::vector<std::thread> threads;
+    std::vector<int> successes(4, 0);
+
+    for (int t = 0; t < 4; ++t) {
+        auto input = CreateFile("in" + std::to_string(t), std::string(1000, 'a' + t));
+        threads.emplace_back([&, t, input] {
+            for (int i = 0; i < 5; ++i) {
+                fs::path output = sandbox_dir_ / ("out" + std::to_string(t) + "_" + std::to_string(i));
+                auto in_fd = Open(input, O_RDONLY | O_CLOEXEC);
+                auto out_fd = Open(output, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC);
+                auto status = pool.Execute(in_fd->Get(), out_fd->Get(), 5s);
+                if (status.has_value() && status->Success() && ReadFile(output) == std::string(1000, 'a' + t)) {
+                    ++successes[t];
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int count : successes) {
+        EXPECT_EQ(count, 5);
+    }
+}
+
+TEST_F(ExecutorPoolTest, Run_WithExecutorPool_ClassifiesExitStatus) {
+    ExecutorPool pool({ .exec_path = "/bin/cat" });
+    ASSERT_TRUE(pool.Start().has_value());
+
+    RunConfig config{
+        .exec_path = "/bin/cat",
+        .input_path = CreateFile("input.txt", "1 2 3"),
+        .output_path = sandbox_dir_ / "output.txt",
+        .soft_limits = { .cpu_time = 1000ms, .memory_kb = 64 * 1024 },
+        .executor_pool = &pool
+    };
+
+    auto result = coj::Run(config);
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+    EXPECT_EQ(result->status, RunStatus::Success);
+    EXPECT_EQ(ReadFile(sandbox_dir_ / "output.txt"), "1 2 3");
+}
+
+TEST_F(ExecutorPoolTest, Run_WithMismatchedExecutorPool_ReturnsInvalidArgument) {
+    ExecutorPool pool({ .exec_path = "/bin/cat", .limits = { .cpu_time_sec = 2 } });
+    ASSERT_TRUE(pool.Start().has_value());
+
+    RunConfig config{
+        .exec_path = "/bin/cat",
+        .input_path = CreateFile("input.txt", "1 2 3"),
+        .output_path = sandbox_dir_ / "output.txt",
+        .soft_limits = { .cpu_time = 1000ms, .memory_kb = 64 * 1024 },
+        .hard_limits = { .cpu_time_sec = 2 },
+        .executor_pool = &pool
+    };
+    ASSERT_TRUE(coj::Run(config).has_value());
+
+    auto mismatched = config;
+    mismatched.args = { "-n" };
+    EXPECT_EQ(coj::Run(mismatched).error(), std::errc::invalid_argument);
+
+    mismatched = config;
+    mismatched.work_dir = sandbox_dir_;
+    EXPECT_EQ(coj::Run(mismatched).error(), std::errc::invalid_argument);
+
+    mismatched = config;
+    mismatched.hard_limits.memory_bytes = 64 * 1024 * 1024;
+    EXPECT_EQ(coj::Run(mismatched).error(), std::errc::invalid_argument);
+
+    mismatched = config;
+    mismatched.placement.huge_pages = process::HugePagePolicy::Disabled;
+    EXPECT_EQ(coj::Run(mismatched).error(), std::errc::invalid_argument);
+}
+
+TEST_F(ExecutorPoolTest, Run_WithOutputLimit_RequiresFileSizeCap) {
+    RunConfig config{
+        .exec_path = "/bin/cat",
+        .input_path = CreateFile("input.txt", std::string(100, 'x')),
+        .output_path = sandbox_dir_ / "output.txt",
+        .soft_limits = { .cpu_time = 1000ms, .memory_kb = 64 * 1024, .output_bytes = 10 }
+    };
+
+    ExecutorPool uncapped({ .exec_path = "/bin/cat" });
+    ASSERT_TRUE(uncapped.Start().has_value());
+    config.executor_pool = &uncapped;
+    EXPECT_EQ(coj::Run(config).error(), std::errc::invalid_argument);
+
+    ExecutorPool capped({ .exec_path = "/bin/cat", .limits = { .file_size_bytes = 11 } });
+    ASSERT_TRUE(capped.Start().has_value());
+    config.executor_pool = &capped;
+
+    auto result = coj::Run(config);
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+    EXPECT_EQ(result->status, RunStatus::OutputLimit);
+    EXPECT_LE(fs::file_size(config.output_path), 11u);
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <fcntl.h>
 #include <string>
+#include <thread>
 #include <unistd.h>
 #include <vector>
 
@@ -92,6 +93,70 @@ TEST(FileIoTest, Read_OnEmptyNonBlockingPipe_ReturnsWouldBlock) {
     EXPECT_EQ(result->bytes, 0);
 }
 
+FileDescriptor CreateTempFile(const std::string& content) {
+    char path[] = "/tmp/coj_file_io_test_XXXXXX";
+    int fd = ::mkstemp(path);
+    EXPECT_NE(fd, -1);
+    ::unlink(path);
+
+    FileDescriptor file(fd);
+    auto write_res = Write(file.Get(), std::as_bytes(std::span(content.data(), content.size())));
+    EXPECT_TRUE(write_res.has_value());
+    ::lseek(file.Get(), 0, SEEK_SET);
+    return file;
+}
+
+std::string ReadWholeFd(int fd) {
+    ::lseek(fd, 0, SEEK_SET);
+    auto content = ReadAll(fd);
+    EXPECT_TRUE(content.has_value());
+    return std::string(reinterpret_cast<const char*>(content->data()), content->size());
+}
+
+TEST(FileIoTest, ReadAll_LargerThanInitialChunk_ReturnsEverything) {
+    std::string content(100000, 'r');
+    auto file = CreateTempFile(content);
+
+    EXPECT_EQ(ReadWholeFd(file.Get()), content);
+}
+
+TEST(FileIoTest, Transfer_FileToPipeAndBack_MovesAllBytes) {
+    std::string content(200000, 's');
+    auto source = CreateTempFile(content);
+    auto sink = CreateTempFile("");
+
+    FileDescriptor read_fd, write_fd;
+    OpenPipe(read_fd, write_fd);
+
+    std::thread writer([&] {
+        auto res = Transfer(source.Get(), write_fd.Get());
+        EXPECT_TRUE(res.has_value());
+        EXPECT_EQ(res->status, IoStatus::EoF);
+        EXPECT_EQ(res->bytes, content.size());
+        write_fd.Close();
+    });
+
+    auto res = Transfer(read_fd.Get(), sink.Get());
+    writer.join();
+
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res->status, IoStatus::EoF);
+    EXPECT_EQ(res->bytes, content.size());
+    EXPECT_EQ(ReadWholeFd(sink.Get()), content);
+}
+
+TEST(FileIoTest, Transfer_FileToFileWithLimit_StopsAtMaxBytes) {
+    auto source = CreateTempFile("0123456789");
+    auto sink = CreateTempFile("");
+
+    auto res = Transfer(source.Get(), sink.Get(), 4);
+
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res->status, IoStatus::Success);
+    EXPECT_EQ(res->bytes, 4);
+    EXPECT_EQ(ReadWholeFd(sink.Get()), "0123");
+}
+
 } // namespace 
 
 } // namespace coj
\ No newline at end of file
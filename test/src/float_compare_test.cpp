@@ -0,0 +1,79 @@
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "coj/float_compare.h"
+
+namespace coj {
+
+namespace {
+
+TEST(FloatCompareTest, FindFloatMismatch_AllWithinTolerance_ReturnsSize) {
+    std::vector<double> answer = { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0 };
+    std::vector<double> output = { 1.0, 2.0 + 1e-9, 3.0, 4.0 - 1e-9, 5.0, 6.0, 7.0 + 1e-9 };
+
+    EXPECT_EQ(FindFloatMismatch(answer, output, 1e-6), answer.size());
+}
+
+TEST(FloatCompareTest, FindFloatMismatch_EveryPosition_ReportsFirstIndex) {
+    for (size_t size = 1; size <= 19; ++size) {
+        for (size_t bad = 0; bad < size; ++bad) {
+            std::vector<double> answer(size, 1.0);
+            std::vector<double> output(size, 1.0);
+            output[bad] = 2.0;
+            if (bad + 1 < size) {
+                output[size - 1] = -5.0;
+            }
+
+            EXPECT_EQ(FindFloatMismatch(answer, output, 1e-6), bad) << "size=" << size;
+        }
+    }
+}
+
+TEST(FloatCompareTest, FindFloatMismatch_SpecialValues_MatchesScalar) {
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+    std::vector<double> values = { 0.0, -0.0, 1.0, -1.0, 1e300, -1e300, 1e-300, inf, -inf, nan };
+
+    for (double a : values) {
+        for (double b : values) {
+            std::vector<double> answer = { 0.0, 0.0, 0.0, 0.0, a };
+            std::vector<double> output = { 0.0, 0.0, 0.0, 0.0, b };
+            for (size_t lane = 0; lane < 4; ++lane) {
+                answer[lane] = a;
+                output[lane] = b;
+
+                EXPECT_EQ(FindFloatMismatch(answer, output, 1e-9), FindFloatMismatchScalar(answer, output, 1e-9))
+                    << a << " vs " << b << " lane " << lane;
+
+                answer[lane] = 0.0;
+                output[lane] = 0.0;
+            }
+        }
+    }
+}
+
+TEST(FloatCompareTest, FindFloatMismatch_RandomNearBoundary_MatchesScalar) {
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> value(-1e6, 1e6);
+    std::uniform_real_distribution<double> noise(-2e-6, 2e-6);
+
+    for (int round = 0; round < 200; ++round) {
+        std::vector<double> answer(257);
+        std::vector<double> output(257);
+        for (size_t i = 0; i < answer.size(); ++i) {
+            answer[i] = value(rng);
+            output[i] = answer[i] * (1.0 + noise(rng));
+        }
+
+        EXPECT_EQ(FindFloatMismatch(answer, output, 1e-6), FindFloatMismatchScalar(answer, output, 1e-6));
+    }
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "coj/hash.h"
+
+namespace coj {
+
+namespace {
+
+TEST(HashTest, Sha256_EmptyInput_MatchesKnownDigest) {
+    Sha256 hasher;
+    EXPECT_EQ(hasher.FinalHex(), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+}
+
+TEST(HashTest, Sha256_Abc_MatchesKnownDigest) {
+    Sha256 hasher;
+    hasher.Update("abc");
+    EXPECT_EQ(hasher.FinalHex(), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+}
+
+TEST(HashTest, Sha256_TwoBlockMessage_MatchesKnownDigest) {
+    Sha256 hasher;
+    hasher.Update("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq");
+    EXPECT_EQ(hasher.FinalHex(), "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+}
+
+TEST(HashTest, Sha256_IncrementalUpdates_MatchOneShot) {
+    std::string data(1000, 'a');
+
+    Sha256 one_shot;
+    one_shot.Update(data);
+
+    Sha256 incremental;
+    for (size_t i = 0; i < data.size(); i += 7) {
+        incremental.Update(std::string_view(data).substr(i, 7));
+    }
+
+    EXPECT_EQ(one_shot.FinalHex(), incremental.FinalHex());
+}
+
+TEST(HashTest, Sha256_UpdateField_SeparatesFieldBoundaries) {
+    Sha256 lhs;
+    lhs.UpdateField("ab").UpdateField("c");
+
+    Sha256 rhs;
+    rhs.UpdateField("a").UpdateField("bc");
+
+    EXPECT_NE(lhs.FinalHex(), rhs.FinalHex());
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
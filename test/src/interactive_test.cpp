@@ -0,0 +1,215 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "coj/compiler.h"
+#include "coj/interactive.h"
+#include "coj/spsc_ring.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+constexpr const char* GUESS_INTERACTOR_SOURCE = R"(
+    #include <fstream>
+    #include <iostream>
+    int main(int argc, char** argv) {
+        std::ifstream input(argv[1]);
+        int secret;
+        input >> secret;
+        for (int round = 0; round < 20; ++round) {
+            int guess;
+            if (!(std::cin >> guess)) return 1;
+            if (guess == secret) {
+                std::cout << "=" << std::endl;
+                std::ofstream(argv[2]) << round + 1 << "\n";
+                return 0;
+            }
+            std::cout << (guess < secret ? "<" : ">") << std::endl;
+        }
+        return 1;
+    }
+)";
+
+constexpr const char* BINARY_SEARCH_SOURCE = R"(
+    #include <iostream>
+    #include <string>
+    int main() {
+        int lo = 1, hi = 1000;
+        while (lo <= hi) {
+            int mid = (lo + hi) / 2;
+            std::cout << mid << std::endl;
+            std::string reply;
+            if (!(std::cin >> reply) || reply == "=") return 0;
+            if (reply == "<") lo = mid + 1; else hi = mid - 1;
+        }
+        return 0;
+    }
+)";
+
+class InteractiveTest : public ::testing::Test {
+protected:
+    fs::path sandbox_dir_;
+    CppCompiler compiler_;
+
+    void SetUp() override {
+        sandbox_dir_ = fs::temp_directory_path() / ("coj_interactive_test_" + std::to_string(::getpid()));
+        fs::create_directories(sandbox_dir_);
+        compiler_.Arg("-O2").Arg("-std=c++23");
+    }
+
+    void TearDown() override {
+        fs::remove_all(sandbox_dir_);
+    }
+
+    fs::path CreateAndCompile(const std::string& name, const std::string& code) {
+        fs::path source_path = sandbox_dir_ / (name + ".cpp");
+        std::ofstream(source_path) << code;
+
+        fs::path output_dir = sandbox_dir_ / name;
+        fs::create_directories(output_dir);
+
+        auto result = compiler_.Compile(source_path, output_dir);
+        EXPECT_TRUE(result.has_value() && result->is_successful) << "Test setup failed: Compilation error\n" << result->output;
+
+        return result->exec_path.value();
+    }
+
+    InteractiveConfig GetBaseConfig(const fs::path& exec, int secret) {
+        fs::path input_path = sandbox_dir_ / "secret.in";
+        std::ofstream(input_path) << secret << "\n";
+
+        return InteractiveConfig{
+            .exec_path = exec,
+            .work_dir = sandbox_dir_,
+            .soft_limits = { .cpu_time = 1000ms, .memory_kb = 256 * 1024, .wall_time = 2000ms },
+            .interactor_path = CreateAndCompile("interactor", GUESS_INTERACTOR_SOURCE),
+            .input_path = input_path,
+            .output_path = sandbox_dir_ / "interactor.out"
+        };
+    }
+};
+
+TEST(SpscRingTest, PushPop_AcrossWrapAround_PreservesOrder) {
+    SpscRing ring(8);
+    std::string popped;
+    std::array<char, 5> out;
+
+    for (std::string_view chunk : { "abcde", "fghij", "klmno" }) {
+        EXPECT_EQ(ring.TryPush(chunk), chunk.size());
+        size_t count = ring.TryPop(out);
+        popped.append(out.data(), count);
+    }
+
+    EXPECT_EQ(popped, "abcdefghijklmno");
+    EXPECT_TRUE(ring.IsEmpty());
+}
+
+TEST(SpscRingTest, TryPush_WhenFull_AcceptsOnlyFreeSpace) {
+    SpscRing ring(4);
+    EXPECT_EQ(ring.TryPush(std::string_view("abcdef")), 4);
+    EXPECT_EQ(ring.TryPush(std::string_view("x")), 0);
+}
+
+TEST_F(InteractiveTest, RunInteractive_BinarySearch_ReturnsAccepted) {
+    auto exec = CreateAndCompile("solution", BINARY_SEARCH_SOURCE);
+    auto config = GetBaseConfig(exec, 737);
+
+    auto result = RunInteractive(config);
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+
+    EXPECT_TRUE(result->IsAccepted());
+    EXPECT_EQ(result->check_result, CheckResult::Accepted);
+    EXPECT_FALSE(result->is_rejected_first);
+
+    std::ifstream interactor_out(config.output_path);
+    int rounds = 0;
+    interactor_out >> rounds;
+    EXPECT_GT(rounds, 0);
+    EXPECT_LE(rounds, 10);
+}
+
+TEST_F(InteractiveTest, RunInteractive_WrongStrategy_ReportsRejection) {
+    auto exec = CreateAndCompile("stubborn", R"(
+        #include <iostream>
+        #include <string>
+        int main() {
+            std::string reply;
+            do { std::cout << 1 << std::endl; } while (std::cin >> reply);
+            return 0;
+        }
+    )");
+    auto config = GetBaseConfig(exec, 500);
+
+    auto result = RunInteractive(config);
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+
+    EXPECT_FALSE(result->IsAccepted());
+    EXPECT_EQ(result->check_result, CheckResult::WrongAnswer);
+    EXPECT_TRUE(result->is_rejected_first);
+}
+
+TEST_F(InteractiveTest, RunInteractive_SilentSolution_HitsWallDeadline) {
+    auto exec = CreateAndCompile("silent", R"(
+        #include <unistd.h>
+        int main() { while (true) pause(); }
+    )");
+    auto config = GetBaseConfig(exec, 500);
+    config.soft_limits.wall_time = 300ms;
+
+    auto result = RunInteractive(config);
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+
+    EXPECT_EQ(result->run_result.status, RunStatus::TimeLimit);
+    EXPECT_TRUE(result->run_result.is_wall_time_exceeded);
+    EXPECT_EQ(result->check_result, CheckResult::WrongAnswer);
+}
+
+TEST_F(InteractiveTest, RunInteractive_FailingInteractor_KeepsSolutionResult) {
+    auto exec = CreateAndCompile("solution", BINARY_SEARCH_SOURCE);
+    auto config = GetBaseConfig(exec, 500);
+    config.interactor_path = CreateAndCompile("broken", R"(
+        #include <iostream>
+        int main() { int guess; std::cin >> guess; std::cout << "=" << std::endl; return 3; }
+    )");
+
+    auto result = RunInteractive(config);
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+
+    EXPECT_FALSE(result->check_result.has_value());
+    EXPECT_FALSE(result->IsAccepted());
+    EXPECT_FALSE(result->is_rejected_first);
+    EXPECT_EQ(result->interactor_status.Code().value_or(-1), 3);
+    EXPECT_EQ(result->run_result.status, RunStatus::Success);
+}
+
+TEST_F(InteractiveTest, RunInteractive_WithTranscript_LogsBothDirections) {
+    auto exec = CreateAndCompile("solution", BINARY_SEARCH_SOURCE);
+    auto config = GetBaseConfig(exec, 250);
+    config.transcript_path = sandbox_dir_ / "transcript.txt";
+
+    auto result = RunInteractive(config);
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+    EXPECT_TRUE(result->IsAccepted());
+
+    std::ifstream transcript(config.transcript_path.value());
+    std::string content((std::istreambuf_iterator<char>(transcript)), {});
+
+    EXPECT_EQ(content.find("> 500\n"), 0) << content;
+    EXPECT_NE(content.find("< >\n"), std::string::npos) << content;
+    EXPECT_NE(content.find("> 250\n"), std::string::npos) << content;
+    EXPECT_NE(content.find("< =\n"), std::string::npos) << content;
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
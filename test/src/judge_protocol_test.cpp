@@ -0,0 +1,136 @@
+#include <sys/socket.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "coj/file_descriptor.h"
+#include "coj/judge_protocol.h"
+
+namespace coj {
+
+namespace {
+
+std::string_view Payload(const std::string& frame) {
+    return std::string_view(frame).substr(5);
+}
+
+TEST(JudgeProtocolTest, Batch_RoundTrip_PreservesSubmissions) {
+    std::vector<Submission> submissions = {
+        {
+            .id = 7,
+            .language = "cpp",
+            .source = std::string("int main() {}\0binary", 20),
+            .cpu_time_ms = 1500,
+            .memory_kb = 65536,
+            .output_bytes = 1 << 20,
+            .is_stopped_on_first_failure = true,
+            .tests = { { "/data/1.in", "/data/1.ans" }, { "/data/2.in", "/data/2.ans" } }
+        },
+        { .id = 8, .language = "python", .source = "print(1)" }
+    };
+
+    auto frame = EncodeBatch(submissions);
+    EXPECT_EQ(static_cast<FrameType>(frame[4]), FrameType::Batch);
+
+    auto decoded = DecodeBatch(Payload(frame));
+    ASSERT_TRUE(decoded.has_value());
+    ASSERT_EQ(decoded->size(), 2u);
+
+    const auto& first = decoded->at(0);
+    EXPECT_EQ(first.id, 7u);
+    EXPECT_EQ(first.language, "cpp");
+    EXPECT_EQ(first.source, submissions[0].source);
+    EXPECT_EQ(first.cpu_time_ms, 1500u);
+    EXPECT_EQ(first.memory_kb, 65536u);
+    EXPECT_EQ(first.output_bytes, 1u << 20);
+    EXPECT_TRUE(first.is_stopped_on_first_failure);
+    ASSERT_EQ(first.tests.size(), 2u);
+    EXPECT_EQ(first.tests[1].answer_path, "/data/2.ans");
+
+    EXPECT_EQ(decoded->at(1).source, "print(1)");
+    EXPECT_TRUE(decoded->at(1).tests.empty());
+}
+
+TEST(JudgeProtocolTest, Responses_RoundTrip) {
+    auto compiled = DecodeCompiled(Payload(EncodeCompiled({ .id = 1, .is_successful = true, .output = "warning" })));
+    ASSERT_TRUE(compiled.has_value());
+    EXPECT_TRUE(compiled->is_successful);
+    EXPECT_FALSE(compiled->is_cached);
+    EXPECT_EQ(compiled->output, "warning");
+
+    auto verdict = DecodeVerdict(Payload(EncodeVerdict({
+        .id = 2, .test_index = 3, .verdict = Verdict::TimeLimit, .cpu_time_ms = 1001, .memory_kb = 4096, .wall_time_us = 1500000
+    })));
+    ASSERT_TRUE(verdict.has_value());
+    EXPECT_EQ(verdict->test_index, 3u);
+    EXPECT_EQ(verdict->verdict, Verdict::TimeLimit);
+    EXPECT_EQ(verdict->wall_time_us, 1500000u);
+
+    auto done = DecodeDone(Payload(EncodeDone({ .id = 2, .accepted_count = 4, .test_count = 5 })));
+    ASSERT_TRUE(done.has_value());
+    EXPECT_EQ(done->accepted_count, 4u);
+
+    auto error = DecodeError(Payload(EncodeError({ .id = 9, .code = -5, .message = "broken" })));
+    ASSERT_TRUE(error.has_value());
+    EXPECT_EQ(error->code, -5);
+    EXPECT_EQ(error->message, "broken");
+}
+
+TEST(JudgeProtocolTest, Decode_MalformedPayload_ReturnsBadMessage) {
+    auto frame = EncodeBatch({ { .id = 1, .language = "cpp", .source = "x", .tests = { { "a", "b" } } } });
+    auto payload = Payload(frame);
+
+    for (size_t length = 0; length < payload.size(); ++length) {
+        EXPECT_EQ(DecodeBatch(payload.substr(0, length)).error(), std::make_error_code(std::errc::bad_message));
+    }
+    EXPECT_FALSE(DecodeBatch(std::string(payload) + "x").has_value());
+
+    // A count far beyond what the payload could hold must not be trusted for allocation.
+    EXPECT_FALSE(DecodeBatch(std::string("\xff\xff\xff\xff", 4)).has_value());
+
+    auto verdict = EncodeVerdict({ .id = 1 });
+    verdict[5 + 8 + 4] = 100;
+    EXPECT_FALSE(DecodeVerdict(Payload(verdict)).has_value());
+}
+
+TEST(JudgeProtocolTest, Frames_OverSocket) {
+    int sv[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv), 0);
+    FileDescriptor client(sv[0]);
+    FileDescriptor server(sv[1]);
+
+    std::string big_output(256 * 1024, 'e');
+    ASSERT_TRUE(WriteFrame(client.Get(), EncodeDone({ .id = 1 })).has_value());
+
+    std::thread writer([&] {
+        (void)WriteFrame(client.Get(), EncodeCompiled({ .id = 2, .output = big_output }));
+        (void)WriteFrame(client.Get(), std::string("\xff\xff\xff\x7f\x01", 5));
+    });
+
+    auto done = ReadFrame(server.Get());
+    ASSERT_TRUE(done.has_value());
+    EXPECT_EQ(done->type, FrameType::Done);
+    EXPECT_EQ(DecodeDone(done->payload)->id, 1u);
+
+    auto compiled = ReadFrame(server.Get());
+    ASSERT_TRUE(compiled.has_value());
+    EXPECT_EQ(DecodeCompiled(compiled->payload)->output.size(), big_output.size());
+
+    auto oversized = ReadFrame(server.Get());
+    ASSERT_FALSE(oversized.has_value());
+    EXPECT_EQ(oversized.error(), std::make_error_code(std::errc::message_size));
+
+    writer.join();
+    client.Close();
+
+    auto eof = ReadFrame(server.Get());
+    ASSERT_FALSE(eof.has_value());
+    EXPECT_EQ(eof.error(), std::make_error_code(std::errc::connection_aborted));
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "coj/answer_cache.h"
+#include "coj/compiler_registry.h"
+#include "coj/file_descriptor.h"
+#include "coj/judge_server.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr std::string_view LANGUAGES = R"ini(
+[cpp]
+source = main.cpp
+compile = /usr/bin/g++ -O2 -std=c++23 {source} -o {exec}
+)ini";
+
+constexpr std::string_view ADDER = R"(
+#include <iostream>
+int main() { long long a, b; std::cin >> a >> b; std::cout << a + b << "\n"; }
+)";
+
+class JudgeServerTest : public ::testing::Test {
+protected:
+    fs::path sandbox_dir_;
+    std::optional<CompilerRegistry> registry_;
+    AnswerCache answer_cache_{ 1024 * 1024 };
+    std::unique_ptr<JudgeServer> server_;
+
+    void SetUp() override {
+        sandbox_dir_ = fs::temp_directory_path() / ("coj_judge_server_test_" + std::to_string(::getpid()));
+        fs::create_directories(sandbox_dir_);
+
+        auto registry_res = CompilerRegistry::Parse(LANGUAGES);
+        ASSERT_TRUE(registry_res.has_value());
+        registry_ = std::move(*registry_res);
+
+        server_ = std::make_unique<JudgeServer>(JudgeServerConfig{
+            .socket_path = sandbox_dir_ / "judged.sock",
+            .work_root = sandbox_dir_ / "jobs",
+            .registry = &*registry_,
+            .answer_cache = &answer_cache_,
+            .worker_count = 2
+        });
+        ASSERT_TRUE(server_->Start().has_value());
+    }
+
+    void TearDown() override {
+        server_.reset();
+        fs::remove_all(sandbox_dir_);
+    }
+
+    fs::path CreateFile(const std::string& filename, const std::string& content) {
+        fs::path file_path = sandbox_dir_ / filename;
+        std::ofstream(file_path) << content;
+        return file_path;
+    }
+
+    FileDescriptor Connect() {
+        FileDescriptor socket(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+
+        ::sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, (sandbox_dir_ / "judged.sock").c_str());
+        EXPECT_EQ(::connect(socket.Get(), reinterpret_cast<const ::sockaddr*>(&address), sizeof(address)), 0);
+
+        return socket;
+    }
+
+    // Reads frames until the submission's Done or Error frame arrives.
+    std::vector<Frame> ReadUntilFinished(int fd) {
+        std::vector<Frame> frames;
+        while (true) {
+            auto frame_res = ReadFrame(fd);
+            EXPECT_TRUE(frame_res.has_value());
+            if (!frame_res.has_value()) {
+                return frames;
+            }
+            frames.push_back(std::move(*frame_res));
+            if (frames.back().type == FrameType::Done || frames.back().type == FrameType::Error) {
+                return frames;
+            }
+        }
+    }
+};
+
+TEST_F(JudgeServerTest, Batch_StreamsVerdictsPerSubmission) {
+    std::vector<SubmissionTest> tests;
+    for (int i = 0; i < 3; ++i) {
+        tests.push_back({
+            .input_path = CreateFile(std::to_string(i) + ".in", std::to_string(i) + " 10\n"),
+            .answer_path = CreateFile(std::to_string(i) + ".ans", i == 1 ? "0\n" : std::to_string(i + 10) + "\n")
+        });
+    }
+
+    auto socket = Connect();
+    auto batch = EncodeBatch({
+        { .id = 1, .language = "cpp", .source = std::string(ADDER), .tests = tests },
+        { .id = 2, .language = "cpp", .source = "int main() { return }", .tests = tests },
+        { .id = 3, .language = "cobol", .source = "", .tests = tests }
+    });
+    ASSERT_TRUE(WriteFrame(socket.Get(), batch).has_value());
+
+    auto frames = ReadUntilFinished(socket.Get());
+    ASSERT_EQ(frames.size(), 5u);
+
+    auto compiled = DecodeCompiled(frames[0].payload);
+    ASSERT_TRUE(compiled.has_value());
+    EXPECT_TRUE(compiled->is_successful) << compiled->output;
+
+    std::vector<Verdict> verdicts(3, Verdict::Skipped);
+    for (size_t i = 1; i < 4; ++i) {
+        auto verdict = DecodeVerdict(frames[i].payload);
+        ASSERT_TRUE(verdict.has_value());
+        EXPECT_EQ(verdict->id, 1u);
+        verdicts.at(verdict->test_index) = verdict->verdict;
+    }
+    EXPECT_EQ(verdicts, (std::vector<Verdict>{ Verdict::Accepted, Verdict::WrongAnswer, Verdict::Accepted }));
+
+    auto done = DecodeDone(frames[4].payload);
+    ASSERT_TRUE(done.has_value());
+    EXPECT_EQ(done->accepted_count, 2u);
+    EXPECT_EQ(done->test_count, 3u);
+
+    frames = ReadUntilFinished(socket.Get());
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_FALSE(DecodeCompiled(frames[0].payload)->is_successful);
+    EXPECT_EQ(DecodeDone(frames[1].payload)->accepted_count, 0u);
+
+    frames = ReadUntilFinished(socket.Get());
+    ASSERT_EQ(frames.size(), 1u);
+    auto error = DecodeError(frames[0].payload);
+    ASSERT_TRUE(error.has_value());
+    EXPECT_EQ(error->id, 3u);
+    EXPECT_EQ(error->code, EINVAL);
+
+    EXPECT_EQ(server_->GetStats().submission_count, 3u);
+    EXPECT_TRUE(fs::is_empty(sandbox_dir_ / "jobs"));
+}
+
+TEST_F(JudgeServerTest, Batch_WithRunawayAllocation_StopsAtMemoryLimit) {
+    constexpr std::string_view HOG = R"(
+#include <cstring>
+#include <vector>
+int main() { std::vector<char> bytes(1u << 30); std::memset(bytes.data(), 1, bytes.size()); return bytes[12345]; }
+)";
+
+    auto input = CreateFile("hog.in", "");
+    auto answer = CreateFile("hog.ans", "");
+
+    auto socket = Connect();
+    auto batch = EncodeBatch({
+        { .id = 1, .language = "cpp", .source = std::string(HOG), .cpu_time_ms = 5000, .memory_kb = 64 * 1024, .tests = { { input, answer } } }
+    });
+    ASSERT_TRUE(WriteFrame(socket.Get(), batch).has_value());
+
+    auto frames = ReadUntilFinished(socket.Get());
+    ASSERT_EQ(frames.size(), 3u);
+
+    auto verdict = DecodeVerdict(frames[1].payload);
+    ASSERT_TRUE(verdict.has_value());
+    EXPECT_NE(verdict->verdict, Verdict::Accepted);
+    EXPECT_LT(verdict->memory_kb, 256u * 1024);
+}
+
+TEST_F(JudgeServerTest, Batch_OverMemoryLimit_ReportsMemoryLimit) {
+    constexpr std::string_view HOG = R"(
+#include <cstring>
+#include <vector>
+int main() { std::vector<char> bytes(100u << 20); std::memset(bytes.data(), 1, bytes.size()); return bytes[12345] - 1; }
+)";
+
+    auto input = CreateFile("hog.in", "");
+    auto answer = CreateFile("hog.ans", "");
+
+    auto socket = Connect();
+    auto batch = EncodeBatch({
+        { .id = 1, .language = "cpp", .source = std::string(HOG), .cpu_time_ms = 5000, .memory_kb = 64 * 1024, .tests = { { input, answer } } }
+    });
+    ASSERT_TRUE(WriteFrame(socket.Get(), batch).has_value());
+
+    auto frames = ReadUntilFinished(socket.Get());
+    ASSERT_EQ(frames.size(), 3u);
+
+    auto verdict = DecodeVerdict(frames[1].payload);
+    ASSERT_TRUE(verdict.has_value());
+    EXPECT_EQ(verdict->verdict, Verdict::MemoryLimit);
+}
+
+TEST_F(JudgeServerTest, Connection_KeptAcrossBatches) {
+    auto input = CreateFile("a.in", "1 2\n");
+    auto answer = CreateFile("a.ans", "3\n");
+
+    auto socket = Connect();
+    for (uint64_t id = 1; id <= 2; ++id) {
+        auto batch = EncodeBatch({ { .id = id, .language = "cpp", .source = std::string(ADDER), .tests = { { input, answer } } } });
+        ASSERT_TRUE(WriteFrame(socket.Get(), batch).has_value());
+
+        auto frames = ReadUntilFinished(socket.Get());
+        ASSERT_EQ(frames.size(), 3u);
+        EXPECT_EQ(DecodeVerdict(frames[1].payload)->verdict, Verdict::Accepted);
+        EXPECT_EQ(DecodeDone(frames[2].payload)->id, id);
+    }
+
+    // The second job finds the answer file already mapped.
+    EXPECT_EQ(answer_cache_.GetStats().miss_count, 1u);
+    EXPECT_EQ(answer_cache_.GetStats().hit_count, 1u);
+    EXPECT_EQ(server_->GetStats().connection_count, 1u);
+}
+
+TEST_F(JudgeServerTest, MalformedFrame_ReturnsErrorAndCloses) {
+    auto socket = Connect();
+    ASSERT_TRUE(WriteFrame(socket.Get(), EncodeDone({ .id = 1 })).has_value());
+
+    auto frame_res = ReadFrame(socket.Get());
+    ASSERT_TRUE(frame_res.has_value());
+    ASSERT_EQ(frame_res->type, FrameType::Error);
+    EXPECT_EQ(DecodeError(frame_res->payload)->code, EBADMSG);
+
+    auto eof = ReadFrame(socket.Get());
+    ASSERT_FALSE(eof.has_value());
+    EXPECT_EQ(eof.error(), std::make_error_code(std::errc::connection_aborted));
+}
+
+TEST_F(JudgeServerTest, Stop_CutsIdleConnections) {
+    auto socket = Connect();
+    ASSERT_TRUE(WriteFrame(socket.Get(), EncodeBatch({})).has_value());
+
+    server_->Stop();
+
+    EXPECT_FALSE(ReadFrame(socket.Get()).has_value());
+    EXPECT_FALSE(fs::exists(sandbox_dir_ / "judged.sock"));
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,367 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "coj/compiler.h"
+#include "coj/judger.h"
+#include "coj/memory_file.h"
+#include "coj/result_store.h"
+#include "coj/test_scheduler.h"
+#include "coj/work_area.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+class JudgerTest : public ::testing::Test {
+protected:
+    fs::path sandbox_dir_;
+    CppCompiler compiler_;
+
+    void SetUp() override {
+        sandbox_dir_ = fs::temp_directory_path() / ("coj_judger_test_" + std::to_string(std::time(nullptr)));
+        fs::create_directories(sandbox_dir_);
+        compiler_.Arg("-O2").Arg("-std=c++23");
+    }
+
+    void TearDown() override {
+        fs::remove_all(sandbox_dir_);
+    }
+
+    fs::path CreateAndCompile(const std::string& name, const std::string& code) {
+        fs::path source_path = sandbox_dir_ / (name + ".cpp");
+        std::ofstream(source_path) << code;
+
+        fs::path output_dir = sandbox_dir_ / name;
+        fs::create_directories(output_dir);
+
+        auto result = compiler_.Compile(source_path, output_dir);
+        EXPECT_TRUE(result.has_value() && result->is_successful) << "Test setup failed: Compilation error\n" << result->output;
+
+        return result->exec_path.value();
+    }
+
+    fs::path CreateFile(const std::string& filename, const std::string& content) {
+        fs::path file_path = sandbox_dir_ / filename;
+        std::ofstream(file_path) << content;
+        return file_path;
+    }
+
+    fs::path CreateAdder() {
+        return CreateAndCompile("adder", R"(
+            #include <iostream>
+            int main() {
+                long long a, b;
+                std::cin >> a >> b;
+                std::cout << a + b << "\n";
+                return 0;
+            }
+        )");
+    }
+
+    std::vector<TestCase> CreateAdditionCases(const std::vector<std::pair<std::string, std::string>>& cases) {
+        std::vector<TestCase> test_cases;
+        for (size_t i = 0; i < cases.size(); ++i) {
+            test_cases.push_back(TestCase{
+                .input_path = CreateFile(std::to_string(i) + ".in", cases[i].first),
+                .answer_path = CreateFile(std::to_string(i) + ".ans", cases[i].second),
+            });
+        }
+        return test_cases;
+    }
+
+    JudgeConfig GetBaseConfig(const fs::path& exec, std::vector<TestCase> test_cases) {
+        fs::path work_dir = sandbox_dir_ / "work";
+        fs::create_directories(work_dir);
+
+        return JudgeConfig{
+            .exec_path = exec,
+            .test_cases = std::move(test_cases),
+            .work_dir = work_dir,
+            .soft_limits = {
+                .cpu_time = 1000ms,
+                .memory_kb = 64 * 1024
+            },
+            .hard_limits = {
+                .cpu_time_sec = 2,
+                .memory_bytes = 128 * 1024 * 1024,
+                .file_size_bytes = 1 * 1024 * 1024
+            }
+        };
+    }
+};
+
+TEST_F(JudgerTest, JudgeBatch_AllCorrectWithWorkerPool_ReturnsAllAccepted) {
+    auto exec = CreateAdder();
+    auto config = GetBaseConfig(exec, CreateAdditionCases({
+        {"1 2", "3"}, {"10 20", "30"}, {"-5 5", "0"}, {"100 1", "101"}, {"7 8", "15"}, {"0 0", "0"},
+    }));
+    config.worker_count = 3;
+    config.pin_workers = true;
+
+    auto result = JudgeBatch(config);
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+
+    EXPECT_TRUE(result->IsAccepted());
+    EXPECT_EQ(result->cases.size(), 6);
+    EXPECT_EQ(result->accepted_count, 6);
+    EXPECT_FALSE(result->first_failure.has_value());
+    EXPECT_GT(result->wall_time.count(), 0);
+}
+
+TEST_F(JudgerTest, JudgeBatch_RunAllWithWrongCase_ReportsFirstFailureAndRunsEverything) {
+    auto exec = CreateAdder();
+    auto config = GetBaseConfig(exec, CreateAdditionCases({
+        {"1 2", "3"}, {"10 20", "31"}, {"-5 5", "0"}, {"100 1", "100"},
+    }));
+    config.worker_count = 2;
+
+    auto result = JudgeBatch(config);
+    ASSERT_TRUE(result.has_value());
+
+    EXPECT_FALSE(result->IsAccepted());
+    EXPECT_EQ(result->accepted_count, 2);
+    EXPECT_EQ(result->first_failure.value_or(0), 1);
+
+    for (const auto& case_result : result->cases) {
+        EXPECT_FALSE(case_result.IsSkipped());
+    }
+    EXPECT_EQ(result->cases[1].check_result, CheckResult::WrongAnswer);
+    EXPECT_EQ(result->cases[3].check_result, CheckResult::WrongAnswer);
+}
+
+TEST_F(JudgerTest, JudgeBatch_StreamingCheck_MatchesFileBasedVerdicts) {
+    auto exec = CreateAdder();
+    auto config = GetBaseConfig(exec, CreateAdditionCases({
+        {"1 2", "3"}, {"10 20", "31"}, {"-5 5", "0"},
+    }));
+    config.worker_count = 2;
+    config.streaming_check = true;
+
+    auto result = JudgeBatch(config);
+    ASSERT_TRUE(result.has_value());
+
+    EXPECT_EQ(result->accepted_count, 2);
+    EXPECT_EQ(result->first_failure.value_or(0), 1);
+    EXPECT_EQ(result->cases[1].check_result, CheckResult::WrongAnswer);
+}
+
+TEST_F(JudgerTest, JudgeBatch_StopOnFirstFailure_SkipsRemainingCases) {
+    auto exec = CreateAdder();
+    auto config = GetBaseConfig(exec, CreateAdditionCases({
+        {"1 2", "3"}, {"10 20", "31"}, {"-5 5", "0"}, {"100 1", "101"},
+    }));
+    config.worker_count = 1;
+    config.early_exit = EarlyExitPolicy::StopOnFirstFailure;
+
+    auto result = JudgeBatch(config);
+    ASSERT_TRUE(result.has_value());
+
+    EXPECT_EQ(result->first_failure.value_or(0), 1);
+    EXPECT_TRUE(result->cases[0].IsAccepted());
+    EXPECT_TRUE(result->cases[2].IsSkipped());
+    EXPECT_TRUE(result->cases[3].IsSkipped());
+}
+
+TEST_F(JudgerTest, JudgeBatch_RuntimeError_SkipsCheckForFailedRun) {
+    auto exec = CreateAndCompile("rte", R"(
+        #include <stdlib.h>
+        int main() {
+            exit(1);
+        }
+    )");
+    auto config = GetBaseConfig(exec, CreateAdditionCases({{"1 2", "3"}}));
+
+    auto result = JudgeBatch(config);
+    ASSERT_TRUE(result.has_value());
+
+    ASSERT_EQ(result->cases.size(), 1);
+    ASSERT_TRUE(result->cases[0].run_result.has_value());
+    EXPECT_EQ(result->cases[0].run_result->status, RunStatus::RuntimeError);
+    EXPECT_FALSE(result->cases[0].check_result.has_value());
+    EXPECT_EQ(result->first_failure.value_or(1), 0);
+}
+
+TEST_F(JudgerTest, JudgeBatch_WithCustomChecker_UsesCheckerVerdictAndMessage) {
+    auto exec = CreateAdder();
+    auto config = GetBaseConfig(exec, CreateAdditionCases({
+        {"1 2", "3"}, {"2 2", "5"},
+    }));
+
+    auto script = CreateFile("check.sh", "cmp -s \"$2\" \"$3\" && exit 0\necho \"differs\" >&2\nexit 2\n");
+    ExternalChecker checker({ .exec_path = "/bin/sh", .args = { script.string() } });
+    config.checker = &checker;
+
+    for (auto& test_case : config.test_cases) {
+        std::ofstream(test_case.answer_path, std::ios::app) << "\n";
+    }
+
+    auto result = JudgeBatch(config);
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+
+    EXPECT_TRUE(result->cases[0].IsAccepted());
+    EXPECT_FALSE(result->cases[1].IsAccepted());
+    EXPECT_EQ(result->cases[1].checker_message, "differs\n");
+}
+
+TEST_F(JudgerTest, JudgeBatch_WithWorkAreaPool_RecyclesEmptyAreas) {
+    auto exec = CreateAdder();
+    auto config = GetBaseConfig(exec, CreateAdditionCases({
+        {"1 2", "3"}, {"10 20", "30"}, {"-5 5", "1"}, {"7 8", "15"},
+    }));
+
+    fs::path areas_dir = sandbox_dir_ / "areas";
+    fs::create_directories(areas_dir);
+    WorkAreaPool pool(areas_dir, 2);
+    ASSERT_TRUE(pool.Reserve().has_value());
+
+    config.work_area_pool = &pool;
+    config.worker_count = 2;
+
+    auto result = JudgeBatch(config);
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+
+    EXPECT_EQ(result->accepted_count, 3);
+    EXPECT_EQ(result->cases[2].check_result, CheckResult::WrongAnswer);
+    EXPECT_EQ(pool.GetIdleCount(), 2);
+    EXPECT_TRUE(fs::is_empty(config.work_dir));
+    for (const auto& entry : fs::directory_iterator(areas_dir)) {
+        EXPECT_TRUE(fs::is_empty(entry.path()));
+    }
+}
+
+TEST_F(JudgerTest, JudgeBatch_WithMemoryInputsAndOutputs_ChecksMappedOutput) {
+    auto exec = CreateAdder();
+
+    auto shared_res = MemoryFile::FromData("input", "40 2\n");
+    ASSERT_TRUE(shared_res.has_value());
+
+    std::vector<TestCase> test_cases;
+    for (const char* answer : { "42", "42", "41" }) {
+        test_cases.push_back(TestCase{
+            .answer_path = CreateFile(std::string("memory_") + std::to_string(test_cases.size()) + ".ans", answer),
+            .input_memory = &shared_res.value(),
+        });
+    }
+
+    auto config = GetBaseConfig(exec, std::move(test_cases));
+    config.is_output_in_memory = true;
+    config.worker_count = 2;
+
+    auto result = JudgeBatch(config);
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+
+    EXPECT_EQ(result->accepted_count, 2);
+    EXPECT_EQ(result->cases[2].check_result, CheckResult::WrongAnswer);
+    EXPECT_TRUE(fs::is_empty(config.work_dir));
+}
+
+TEST_F(JudgerTest, JudgeBatch_History_RunsLikelyFailureFirst) {
+    auto exec = CreateAdder();
+    auto config = GetBaseConfig(exec, CreateAdditionCases({
+        {"1 2", "3"}, {"10 20", "30"}, {"-5 5", "1"}, {"100 1", "101"},
+    }));
+    config.worker_count = 1;
+    config.early_exit = EarlyExitPolicy::StopOnFirstFailure;
+
+    TestHistory history;
+    config.history = &history;
+
+    auto first = JudgeBatch(config);
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first->first_failure.value_or(0), 2);
+    EXPECT_TRUE(first->cases[3].IsSkipped());
+
+    auto stats = history.Get(config.test_cases[2].input_path.string());
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->failure_count, 1u);
+
+    // The known failure now runs first and ends the batch on its own.
+    auto second = JudgeBatch(config);
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second->first_failure.value_or(0), 2);
+    EXPECT_TRUE(second->cases[0].IsSkipped());
+    EXPECT_TRUE(second->cases[1].IsSkipped());
+}
+
+TEST_F(JudgerTest, JudgeBatch_Deterministic_ReportsFileOrderFailure) {
+    auto exec = CreateAdder();
+    auto config = GetBaseConfig(exec, CreateAdditionCases({
+        {"1 2", "3"}, {"10 20", "31"}, {"-5 5", "0"}, {"100 1", "100"}, {"7 8", "15"},
+    }));
+    config.worker_count = 1;
+    config.early_exit = EarlyExitPolicy::StopOnFirstFailure;
+    config.is_deterministic = true;
+
+    // Teach the history that case 3 always fails, so it is scheduled ahead of case 1.
+    TestHistory history;
+    for (int i = 0; i < 3; ++i) {
+        history.Record(config.test_cases[3].input_path.string(), CaseResult{
+            .run_result = RunResult{ .status = RunStatus::Success, .exit_status = process::ExitStatus::FromRaw(0, ::rusage{}) },
+            .check_result = CheckResult::WrongAnswer,
+            .wall_time = 1ms
+        });
+    }
+    config.history = &history;
+
+    // Case 3 runs first but is cleared once case 1 fails, so it must never be reported.
+    std::vector<size_t> reported;
+    config.on_case_result = [&reported](size_t index, const CaseResult&) { reported.push_back(index); };
+
+    auto result = JudgeBatch(config);
+    ASSERT_TRUE(result.has_value());
+
+    EXPECT_EQ(result->first_failure.value_or(0), 1);
+    EXPECT_TRUE(result->cases[0].IsAccepted());
+    EXPECT_EQ(result->cases[1].check_result, CheckResult::WrongAnswer);
+    for (size_t i = 2; i < result->cases.size(); ++i) {
+        EXPECT_TRUE(result->cases[i].IsSkipped()) << i;
+    }
+    EXPECT_EQ(reported, (std::vector<size_t>{ 0, 1 }));
+}
+
+TEST_F(JudgerTest, JudgeBatch_ResultStore_RerunsOnlyChangedCases) {
+    auto exec = CreateAdder();
+    auto config = GetBaseConfig(exec, CreateAdditionCases({
+        {"1 2", "3"}, {"10 20", "30"}, {"-5 5", "0"},
+    }));
+    config.worker_count = 2;
+
+    ResultStore store(16);
+    config.result_store = &store;
+
+    auto first = JudgeBatch(config);
+    ASSERT_TRUE(first.has_value());
+    EXPECT_TRUE(first->IsAccepted());
+    EXPECT_EQ(store.GetStats().store_count, 3u);
+
+    CreateFile("1.in", "10 21");
+    CreateFile("1.ans", "31");
+
+    auto second = JudgeBatch(config);
+    ASSERT_TRUE(second.has_value());
+    EXPECT_TRUE(second->IsAccepted());
+    EXPECT_TRUE(second->cases[0].is_cached);
+    EXPECT_FALSE(second->cases[1].is_cached);
+    EXPECT_TRUE(second->cases[2].is_cached);
+
+    // Tighter limits are a different key.
+    config.soft_limits.cpu_time = 500ms;
+    auto third = JudgeBatch(config);
+    ASSERT_TRUE(third.has_value());
+    EXPECT_FALSE(third->cases[0].is_cached);
+
+    auto stats = store.GetStats();
+    EXPECT_EQ(stats.hit_count, 2u);
+    EXPECT_EQ(stats.store_count, 7u);
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "coj/file_io.h"
+#include "coj/memory_file.h"
+
+namespace coj {
+
+namespace {
+
+std::string ReadChunk(int fd, size_t size) {
+    std::string data(size, '\0');
+    auto read_res = Read(fd, std::as_writable_bytes(std::span(data)));
+    EXPECT_TRUE(read_res.has_value());
+    data.resize(read_res.has_value() ? read_res->bytes : 0);
+    return data;
+}
+
+TEST(MemoryFileTest, FromData_SealsContentsAgainstWrites) {
+    auto file_res = MemoryFile::FromData("input", "1 2\n");
+    ASSERT_TRUE(file_res.has_value()) << file_res.error().message();
+
+    EXPECT_TRUE(file_res->IsSealed());
+    EXPECT_EQ(file_res->GetSize().value(), 4);
+
+    auto write_res = Write(file_res->GetFd(), std::as_bytes(std::span("x", 1)));
+    ASSERT_FALSE(write_res.has_value());
+    EXPECT_EQ(write_res.error(), std::errc::operation_not_permitted);
+    EXPECT_EQ(::ftruncate(file_res->GetFd(), 0), -1);
+}
+
+TEST(MemoryFileTest, Reopen_GivesEachReaderItsOwnOffset) {
+    auto file_res = MemoryFile::FromData("input", "abcdef");
+    ASSERT_TRUE(file_res.has_value());
+
+    auto first_res = file_res->Reopen(O_RDONLY | O_CLOEXEC);
+    auto second_res = file_res->Reopen(O_RDONLY | O_CLOEXEC);
+    ASSERT_TRUE(first_res.has_value() && second_res.has_value());
+
+    EXPECT_EQ(ReadChunk(first_res->Get(), 3), "abc");
+    EXPECT_EQ(ReadChunk(second_res->Get(), 6), "abcdef");
+    EXPECT_EQ(ReadChunk(first_res->Get(), 6), "def");
+}
+
+TEST(MemoryFileTest, Create_WrittenThroughReopen_IsVisibleInMap) {
+    auto file_res = MemoryFile::Create("output");
+    ASSERT_TRUE(file_res.has_value());
+    EXPECT_FALSE(file_res->IsSealed());
+
+    auto empty_res = file_res->Map();
+    ASSERT_TRUE(empty_res.has_value());
+    EXPECT_TRUE(empty_res->View().empty());
+
+    for (std::string_view text : { "first run, longer\n", "3\n" }) {
+        auto writer_res = file_res->Reopen(O_WRONLY | O_TRUNC | O_CLOEXEC);
+        ASSERT_TRUE(writer_res.has_value());
+        ASSERT_TRUE(Write(writer_res->Get(), std::as_bytes(std::span(text.data(), text.size()))).has_value());
+    }
+
+    auto map_res = file_res->Map();
+    ASSERT_TRUE(map_res.has_value());
+    EXPECT_EQ(map_res->View(), "3\n");
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
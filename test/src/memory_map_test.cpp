@@ -0,0 +1,70 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "coj/file_descriptor.h"
+#include "coj/memory_map.h"
+
+namespace coj {
+
+namespace {
+
+FileDescriptor CreateTempFile(const std::string& content) {
+    char tmp_template[] = "/tmp/coj_mmap_XXXXXX";
+    int fd = ::mkstemp(tmp_template);
+    ::unlink(tmp_template);
+    if (fd >= 0 && !content.empty()) {
+        (void)::write(fd, content.data(), content.size());
+    }
+    return FileDescriptor(fd);
+}
+
+TEST(MemoryMapTest, Map_WithRegularFile_ExposesFileContent) {
+    auto fd = CreateTempFile("mapped content");
+    ASSERT_TRUE(fd.IsValid());
+
+    auto map_res = MemoryMap::Map(fd.Get());
+
+    ASSERT_TRUE(map_res.has_value());
+    EXPECT_EQ(map_res->View(), "mapped content");
+    EXPECT_EQ(map_res->Size(), 14);
+}
+
+TEST(MemoryMapTest, Map_WithEmptyFile_ReturnsEmptyMap) {
+    auto fd = CreateTempFile("");
+    ASSERT_TRUE(fd.IsValid());
+
+    auto map_res = MemoryMap::Map(fd.Get());
+
+    ASSERT_TRUE(map_res.has_value());
+    EXPECT_EQ(map_res->Size(), 0);
+    EXPECT_TRUE(map_res->View().empty());
+}
+
+TEST(MemoryMapTest, Map_WithPipe_ReturnsInvalidArgument) {
+    int p[2];
+    ASSERT_NE(::pipe(p), -1);
+    FileDescriptor read_fd(p[0]);
+    FileDescriptor write_fd(p[1]);
+
+    auto map_res = MemoryMap::Map(read_fd.Get());
+
+    ASSERT_FALSE(map_res.has_value());
+    EXPECT_EQ(map_res.error(), std::errc::invalid_argument);
+}
+
+TEST(MemoryMapTest, MoveAssign_TransfersOwnership) {
+    auto fd = CreateTempFile("abc");
+    auto map_res = MemoryMap::Map(fd.Get());
+    ASSERT_TRUE(map_res.has_value());
+
+    MemoryMap map;
+    map = std::move(*map_res);
+
+    EXPECT_EQ(map.View(), "abc");
+    EXPECT_EQ(map_res->Size(), 0);
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
@@ -109,6 +109,219 @@ TEST(ProcessTest, Spawn_WithEnvClearAndSet_OutputsOnlySetVariables) {
     EXPECT_EQ(output, "COJ_MAGIC_KEY=777\n");
 }
 
+TEST(ProcessTest, Spawn_WithVForkBackendAndPipedIo_EchoesInputToOutput) {
+    Command cmd("/bin/cat");
+    cmd.Backend(SpawnBackend::VFork)
+       .Stdin(Stdio::Piped())
+       .Stdout(Stdio::Piped());
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+    auto& child = child_res.value();
+
+    std::string input_data = "Input Data For VFork Cat";
+    (void)Write(child.stdin_pipe->Get(), std::as_bytes(std::span(input_data)));
+    child.stdin_pipe->Close();
+
+    std::string output = ReadAllAsString(child.stdout_pipe->Get()).value();
+    auto wait_res = child.Wait();
+
+    ASSERT_TRUE(wait_res.has_value());
+    EXPECT_TRUE(wait_res.value().Success());
+    EXPECT_EQ(output, input_data);
+}
+
+TEST(ProcessTest, Spawn_WithVForkBackendAndNonExistentProgram_FailsAndReturnsEnoent) {
+    Command cmd("/path/to/absolutely/non_existent_binary");
+    cmd.Backend(SpawnBackend::VFork);
+
+    auto child_res = cmd.Spawn();
+
+    ASSERT_FALSE(child_res.has_value());
+    EXPECT_EQ(child_res.error().value(), ENOENT);
+}
+
+TEST(ProcessTest, Spawn_WithVForkBackendAndCurrentDir_RunsInGivenDirectory) {
+    Command cmd("/bin/pwd");
+    cmd.Backend(SpawnBackend::VFork)
+       .CurrentDir("/tmp")
+       .Stdout(Stdio::Piped());
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+    auto& child = child_res.value();
+
+    std::string output = ReadAllAsString(child.stdout_pipe->Get()).value();
+    (void)child.Wait();
+
+    EXPECT_EQ(output, "/tmp\n");
+}
+
+TEST(ProcessTest, Spawn_WithVForkBackendAndCpuLimit_KillsProcessWithSigXcpuOrSigkill) {
+    Command cmd("/bin/sh");
+    cmd.Arg("-c").Arg("while true; do :; done")
+       .Backend(SpawnBackend::VFork);
+
+    ResourceLimits limits;
+    limits.cpu_time_sec = 1;
+    cmd.Limits(limits);
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+
+    auto wait_res = child_res.value().Wait();
+
+    ASSERT_TRUE(wait_res.has_value());
+    auto sig = wait_res.value().Signal();
+    ASSERT_TRUE(sig.has_value());
+    EXPECT_TRUE(sig.value() == SIGXCPU || sig.value() == SIGKILL)
+        << "Expected SIGXCPU or SIGKILL, but got: " << sig.value();
+}
+
+TEST(ProcessTest, Spawn_WithPlacement_AppliesAffinityAndThpToChild) {
+    cpu_set_t allowed;
+    ASSERT_EQ(::sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+
+    int cpu = 0;
+    while (!CPU_ISSET(cpu, &allowed)) {
+        ++cpu;
+    }
+
+    for (auto backend : { SpawnBackend::Fork, SpawnBackend::VFork }) {
+        Command cmd("/bin/cat");
+        cmd.Arg("/proc/self/status")
+           .Backend(backend)
+           .Placement({ .huge_pages = HugePagePolicy::Disabled, .cpus = { cpu } })
+           .Stdout(Stdio::Piped());
+
+        auto child_res = cmd.Spawn();
+        ASSERT_TRUE(child_res.has_value());
+        auto& child = child_res.value();
+
+        std::string status = ReadAllAsString(child.stdout_pipe->Get()).value();
+        (void)child.Wait();
+
+        EXPECT_NE(status.find("Cpus_allowed_list:\t" + std::to_string(cpu) + "\n"), std::string::npos);
+        EXPECT_NE(status.find("THP_enabled:\t0\n"), std::string::npos);
+    }
+}
+
+TEST(ProcessTest, Spawn_WithOutOfRangeNumaNode_FailsAndReturnsEinval) {
+    Command cmd("/bin/true");
+    cmd.Placement({ .numa_node = 4096 });
+
+    auto child_res = cmd.Spawn();
+
+    ASSERT_FALSE(child_res.has_value());
+    EXPECT_EQ(child_res.error().value(), EINVAL);
+}
+
+TEST(ProcessTest, Prepare_SpawnedRepeatedly_ReusesArgsAndEnvironment) {
+    Command cmd("/bin/sh");
+    cmd.Arg("-c").Arg("echo \"$COJ_MAGIC_KEY $0\"").Arg("coj")
+       .EnvClear()
+       .Env("COJ_MAGIC_KEY", "777");
+
+    auto prepared = cmd.Prepare();
+    prepared.Stdout(Stdio::Piped());
+
+    for (int i = 0; i < 3; ++i) {
+        auto child_res = prepared.Spawn();
+        ASSERT_TRUE(child_res.has_value());
+        auto& child = child_res.value();
+
+        ASSERT_TRUE(child.stdout_pipe.has_value());
+        std::string output = ReadAllAsString(child.stdout_pipe->Get()).value();
+        (void)child.Wait();
+
+        EXPECT_EQ(output, "777 coj\n");
+    }
+}
+
+TEST(ProcessTest, Prepare_WithPerSpawnStdinAndCurrentDir_UsesLatestConfiguration) {
+    Command cmd("/bin/sh");
+    cmd.Arg("-c").Arg("pwd; cat");
+
+    auto prepared = cmd.Prepare();
+    prepared.Stdout(Stdio::Piped());
+
+    for (const std::string dir : {"/tmp", "/"}) {
+        int p[2];
+        ASSERT_NE(::pipe(p), -1);
+        FileDescriptor read_end(p[0]);
+        FileDescriptor write_end(p[1]);
+
+        std::string input_data = "input for " + dir;
+        (void)Write(write_end.Get(), std::as_bytes(std::span(input_data)));
+        write_end.Close();
+
+        prepared.Stdin(Stdio::From(std::move(read_end))).CurrentDir(dir);
+
+        auto child_res = prepared.Spawn();
+        ASSERT_TRUE(child_res.has_value());
+        auto& child = child_res.value();
+
+        std::string output = ReadAllAsString(child.stdout_pipe->Get()).value();
+        (void)child.Wait();
+
+        EXPECT_EQ(output, dir + "\n" + input_data);
+    }
+}
+
+TEST(ProcessTest, FeedStdinAndDrainStdout_WithCat_SplicesDataThroughChild) {
+    char in_path[] = "/tmp/coj_process_feed_in_XXXXXX";
+    char out_path[] = "/tmp/coj_process_feed_out_XXXXXX";
+    FileDescriptor input(::mkstemp(in_path));
+    FileDescriptor output(::mkstemp(out_path));
+    ::unlink(in_path);
+    ::unlink(out_path);
+    ASSERT_TRUE(input.IsValid() && output.IsValid());
+
+    std::string content(300000, 'f');
+    ASSERT_TRUE(Write(input.Get(), std::as_bytes(std::span(content.data(), content.size()))).has_value());
+    ::lseek(input.Get(), 0, SEEK_SET);
+
+    Command cmd("/bin/cat");
+    cmd.Stdin(Stdio::Piped()).Stdout(Stdio::Piped());
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+    auto& child = child_res.value();
+
+    std::expected<size_t, std::error_code> drained = 0;
+    std::thread drainer([&] { drained = child.DrainStdout(output.Get()); });
+
+    auto fed = child.FeedStdin(input.Get());
+    drainer.join();
+
+    ASSERT_TRUE(fed.has_value() && drained.has_value());
+    EXPECT_EQ(fed.value(), content.size());
+    EXPECT_EQ(drained.value(), content.size());
+
+    ASSERT_TRUE(child.Wait().has_value());
+    EXPECT_EQ(::lseek(output.Get(), 0, SEEK_END), static_cast<off_t>(content.size()));
+}
+
+TEST(ProcessTest, FeedStdin_ChildExitsEarly_ReturnsWithoutSigpipe) {
+    char in_path[] = "/tmp/coj_process_feed_in_XXXXXX";
+    FileDescriptor input(::mkstemp(in_path));
+    ::unlink(in_path);
+
+    std::string content(1 << 20, 'e');
+    ASSERT_TRUE(Write(input.Get(), std::as_bytes(std::span(content.data(), content.size()))).has_value());
+    ::lseek(input.Get(), 0, SEEK_SET);
+
+    Command cmd("/bin/true");
+    cmd.Stdin(Stdio::Piped());
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+
+    auto fed = child_res->FeedStdin(input.Get());
+    EXPECT_TRUE(fed.has_value());
+    ASSERT_TRUE(child_res->Wait().has_value());
+}
+
 TEST(ProcessTest, WaitWithTimeout_OnHangingProcess_KillsProcessAndReturnsSigkill) {
     Command cmd("/bin/sleep");
     cmd.Arg("10");
@@ -125,6 +338,73 @@ TEST(ProcessTest, WaitWithTimeout_OnHangingProcess_KillsProcessAndReturnsSigkill
     EXPECT_EQ(wait_res.value().Signal().value_or(0), SIGKILL);
 }
 
+TEST(ProcessTest, WaitWithTimeout_OnExitingProcess_ReturnsWithoutWaitingForTimeout) {
+    Command cmd("/bin/sh");
+    cmd.Arg("-c").Arg("exit 3");
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+    auto& child = child_res.value();
+
+    auto start_time = std::chrono::steady_clock::now();
+    auto wait_res = child.WaitWithTimeout(10s);
+    auto elapsed = std::chrono::steady_clock::now() - start_time;
+
+    ASSERT_TRUE(wait_res.has_value());
+    EXPECT_EQ(wait_res.value().Code().value_or(-1), 3);
+    EXPECT_LT(elapsed, 5s);
+    EXPECT_FALSE(child.IsValid());
+}
+
+TEST(ProcessTest, Wait_OnSleepingProcess_ReportsWallTimeAndContextSwitches) {
+    Command cmd("/bin/sleep");
+    cmd.Arg("0.2");
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+
+    auto wait_res = child_res->Wait();
+    ASSERT_TRUE(wait_res.has_value());
+
+    EXPECT_GE(wait_res->GetWallTime(), 200ms);
+    EXPECT_LT(wait_res->GetWallTime(), 5s);
+    EXPECT_GE(wait_res->GetVoluntaryContextSwitches(), 1);
+    EXPECT_GT(wait_res->GetMinorPageFaults(), 0);
+    EXPECT_LT(wait_res->GetPreciseCpuTime(), wait_res->GetWallTime());
+}
+
+TEST(ProcessTest, Wait_OnBusyProcess_ReportsSubMillisecondCpuTime) {
+    Command cmd("/bin/sh");
+    cmd.Arg("-c").Arg("i=0; while [ $i -lt 20000 ]; do i=$((i+1)); done");
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+
+    auto wait_res = child_res->Wait();
+    ASSERT_TRUE(wait_res.has_value());
+
+    auto precise = wait_res->GetPreciseCpuTime();
+    EXPECT_GT(precise.count(), 0);
+    EXPECT_EQ(precise, wait_res->GetUserTime() + wait_res->GetSystemTime());
+    EXPECT_GE(precise, std::chrono::nanoseconds(wait_res->GetCpuTime()));
+    EXPECT_LT(precise - std::chrono::nanoseconds(wait_res->GetCpuTime()), 1ms);
+}
+
+TEST(ProcessTest, WaitWithTimeout_AfterWait_ReturnsEchild) {
+    Command cmd("/bin/true");
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+    auto& child = child_res.value();
+
+    ASSERT_TRUE(child.Wait().has_value());
+
+    auto wait_res = child.WaitWithTimeout(100ms);
+
+    ASSERT_FALSE(wait_res.has_value());
+    EXPECT_EQ(wait_res.error().value(), ECHILD);
+}
+
 TEST(ProcessTest, Spawn_WithCpuLimit_KillsProcessWithSigXcpuOrSigkill) {
     Command cmd("/bin/sh");
     cmd.Arg("-c").Arg("while true; do :; done");
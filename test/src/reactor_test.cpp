@@ -0,0 +1,125 @@
+#include <chrono>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "coj/file_io.h"
+#include "coj/process.h"
+#include "coj/reactor.h"
+
+namespace coj {
+
+namespace {
+
+using namespace std::chrono_literals;
+
+TEST(ReactorTest, RunOnce_WithReadablePipe_DispatchesHandler) {
+    int p[2];
+    ASSERT_NE(::pipe2(p, O_CLOEXEC), -1);
+    FileDescriptor read_fd(p[0]);
+    FileDescriptor write_fd(p[1]);
+
+    auto reactor_res = Reactor::Create();
+    ASSERT_TRUE(reactor_res.has_value());
+    auto& reactor = reactor_res.value();
+
+    int call_count = 0;
+    ASSERT_TRUE(reactor.Add(read_fd.Get(), EPOLLIN, [&](std::uint32_t events) {
+        EXPECT_TRUE(events & EPOLLIN);
+        ++call_count;
+        reactor.Remove(read_fd.Get());
+    }).has_value());
+
+    auto idle_res = reactor.RunOnce(10ms);
+    ASSERT_TRUE(idle_res.has_value());
+    EXPECT_EQ(idle_res.value(), 0);
+
+    std::string data = "x";
+    ASSERT_TRUE(Write(write_fd.Get(), std::as_bytes(std::span(data))).has_value());
+
+    auto run_res = reactor.RunOnce(1s);
+    ASSERT_TRUE(run_res.has_value());
+    EXPECT_EQ(run_res.value(), 1);
+    EXPECT_EQ(call_count, 1);
+    EXPECT_TRUE(reactor.IsEmpty());
+}
+
+TEST(ReactorTest, Communicate_BothStreamsLargerThanPipeBuffer_DoesNotDeadlock) {
+    process::Command cmd("/bin/sh");
+    cmd.Arg("-c").Arg("head -c 300000 /dev/zero; head -c 300000 /dev/zero >&2; head -c 300000 /dev/zero")
+       .Stdout(process::Stdio::Piped())
+       .Stderr(process::Stdio::Piped());
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+
+    auto result = Communicate(child_res.value(), { .timeout = 10s });
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+
+    EXPECT_TRUE(result->exit_status.Success());
+    EXPECT_EQ(result->stdout_data.size(), 600000);
+    EXPECT_EQ(result->stderr_data.size(), 300000);
+    EXPECT_FALSE(result->is_timed_out);
+}
+
+TEST(ReactorTest, Communicate_WithStdinData_FeedsAndCollectsEcho) {
+    process::Command cmd("/bin/cat");
+    cmd.Stdin(process::Stdio::Piped()).Stdout(process::Stdio::Piped());
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+
+    std::string input(500000, 'q');
+    auto result = Communicate(child_res.value(), { .stdin_data = input, .timeout = 10s });
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+
+    EXPECT_TRUE(result->exit_status.Success());
+    EXPECT_EQ(result->stdout_data, input);
+}
+
+TEST(ReactorTest, Communicate_OutputOverCap_TruncatesButDrains) {
+    process::Command cmd("/bin/sh");
+    cmd.Arg("-c").Arg("head -c 1000000 /dev/zero")
+       .Stdout(process::Stdio::Piped());
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+
+    auto result = Communicate(child_res.value(), { .stdout_limit = 1000, .timeout = 10s });
+    ASSERT_TRUE(result.has_value());
+
+    EXPECT_TRUE(result->exit_status.Success());
+    EXPECT_EQ(result->stdout_data.size(), 1000);
+    EXPECT_TRUE(result->is_stdout_truncated);
+}
+
+TEST(ReactorTest, Communicate_ChildIgnoresStdin_ReportsNoErrorOnBrokenPipe) {
+    process::Command cmd("/bin/true");
+    cmd.Stdin(process::Stdio::Piped());
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+
+    std::string input(1 << 20, 'z');
+    auto result = Communicate(child_res.value(), { .stdin_data = input, .timeout = 10s });
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+    EXPECT_TRUE(result->exit_status.Success());
+}
+
+TEST(ReactorTest, Communicate_HangingChild_TimesOutAndKills) {
+    process::Command cmd("/bin/sleep");
+    cmd.Arg("10").Stdout(process::Stdio::Piped());
+
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+
+    auto result = Communicate(child_res.value(), { .timeout = 100ms });
+    ASSERT_TRUE(result.has_value());
+
+    EXPECT_TRUE(result->is_timed_out);
+    EXPECT_EQ(result->exit_status.Signal().value_or(0), SIGKILL);
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
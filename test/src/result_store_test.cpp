@@ -0,0 +1,161 @@
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "coj/result_store.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+CaseResult MakeResult(RunStatus status, std::optional<CheckResult> check_result) {
+    CaseResult result;
+    result.run_result = RunResult{ .status = status, .exit_status = process::ExitStatus::FromRaw(0, ::rusage{}) };
+    result.check_result = check_result;
+    result.wall_time = 5ms;
+    return result;
+}
+
+class ResultStoreTest : public ::testing::Test {
+protected:
+    fs::path sandbox_dir_;
+
+    void SetUp() override {
+        sandbox_dir_ = fs::temp_directory_path() / ("coj_result_store_test_" + std::to_string(::getpid()));
+        fs::create_directories(sandbox_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(sandbox_dir_);
+    }
+
+    fs::path CreateFile(const std::string& filename, const std::string& content) {
+        fs::path file_path = sandbox_dir_ / filename;
+        std::ofstream(file_path) << content;
+        return file_path;
+    }
+};
+
+TEST_F(ResultStoreTest, Lookup_AfterStore_ReturnsCachedResult) {
+    ResultStore store(4);
+
+    EXPECT_FALSE(store.Lookup("k").has_value());
+
+    store.Store("k", MakeResult(RunStatus::Success, CheckResult::WrongAnswer));
+    store.Store("skipped", CaseResult{});
+
+    auto result = store.Lookup("k");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result->is_cached);
+    EXPECT_EQ(result->check_result, CheckResult::WrongAnswer);
+    EXPECT_EQ(result->wall_time, 5ms);
+
+    EXPECT_FALSE(store.Lookup("skipped").has_value());
+
+    auto stats = store.GetStats();
+    EXPECT_EQ(stats.hit_count, 1u);
+    EXPECT_EQ(stats.miss_count, 2u);
+    EXPECT_EQ(stats.entry_count, 1u);
+}
+
+TEST_F(ResultStoreTest, Store_OverCapacity_EvictsLeastRecentlyUsed) {
+    ResultStore store(2);
+
+    store.Store("a", MakeResult(RunStatus::Success, CheckResult::Accepted));
+    store.Store("b", MakeResult(RunStatus::Success, CheckResult::Accepted));
+    ASSERT_TRUE(store.Lookup("a").has_value());
+    store.Store("c", MakeResult(RunStatus::Success, CheckResult::Accepted));
+
+    EXPECT_TRUE(store.Lookup("a").has_value());
+    EXPECT_FALSE(store.Lookup("b").has_value());
+    EXPECT_TRUE(store.Lookup("c").has_value());
+    EXPECT_EQ(store.GetStats().eviction_count, 1u);
+}
+
+TEST_F(ResultStoreTest, Lookup_WithVerifyEvery_RerunsAndDropsDisagreeingKey) {
+    ResultStore store(4, 2);
+
+    store.Store("stable", MakeResult(RunStatus::Success, CheckResult::Accepted));
+    store.Store("flaky", MakeResult(RunStatus::Success, CheckResult::Accepted));
+
+    // The second hit is sampled and handed back as a miss.
+    EXPECT_TRUE(store.Lookup("stable").has_value());
+    EXPECT_FALSE(store.Lookup("stable").has_value());
+    store.Store("stable", MakeResult(RunStatus::Success, CheckResult::Accepted));
+
+    EXPECT_TRUE(store.Lookup("flaky").has_value());
+    EXPECT_FALSE(store.Lookup("flaky").has_value());
+    store.Store("flaky", MakeResult(RunStatus::TimeLimit, std::nullopt));
+
+    auto stats = store.GetStats();
+    EXPECT_EQ(stats.verification_count, 2u);
+    EXPECT_EQ(stats.mismatch_count, 1u);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_FALSE(store.Lookup("flaky").has_value());
+    }
+}
+
+TEST_F(ResultStoreTest, HashFile_AfterRewrite_ReturnsNewDigest) {
+    ResultStore store(4);
+    auto path = CreateFile("input.txt", "1 2");
+
+    auto first = store.HashFile(path);
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(store.HashFile(path).value_or(""), *first);
+
+    CreateFile("input.txt", "1 2 3");
+    auto second = store.HashFile(path);
+    ASSERT_TRUE(second.has_value());
+    EXPECT_NE(*second, *first);
+
+    auto copy = CreateFile("copy.txt", "1 2 3");
+    EXPECT_EQ(store.HashFile(copy).value_or(""), *second);
+
+    EXPECT_FALSE(store.HashFile(sandbox_dir_ / "missing.txt").has_value());
+}
+
+TEST_F(ResultStoreTest, GetExecutableKey_SameArtifactsInOtherJobDir_ProducesSameKey) {
+    ResultStore store(4);
+
+    auto make_config = [&](const std::string& job, const std::string& class_file) {
+        fs::path exec_dir = sandbox_dir_ / job;
+        fs::create_directories(exec_dir / "pkg");
+        std::ofstream(exec_dir / "pkg" / "Main.class") << class_file;
+        return JudgeConfig{
+            .exec_path = "/bin/sh",
+            .args = { "-cp", exec_dir.string(), "pkg.Main" },
+            .work_dir = exec_dir,
+            .soft_limits = { .cpu_time = 1000ms, .memory_kb = 64 * 1024 }
+        };
+    };
+
+    auto first = GetExecutableKey(store, make_config("job-1", "v1"));
+    auto second = GetExecutableKey(store, make_config("job-2", "v1"));
+    auto changed = GetExecutableKey(store, make_config("job-3", "v2"));
+    ASSERT_TRUE(first.has_value() && second.has_value() && changed.has_value());
+
+    EXPECT_EQ(*first, *second);
+    EXPECT_NE(*first, *changed);
+
+    CgroupPool pool(sandbox_dir_, 1);
+    auto enforced = make_config("job-1", "v1");
+    enforced.cgroup_pool = &pool;
+    EXPECT_NE(GetExecutableKey(store, enforced).value_or(""), *first);
+
+    auto placed = make_config("job-1", "v1");
+    placed.placement.huge_pages = process::HugePagePolicy::Disabled;
+    EXPECT_NE(GetExecutableKey(store, placed).value_or(""), *first);
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <gtest/gtest.h>
 
 #include "coj/compiler.h"
+#include "coj/memory_file.h"
 #include "coj/runner.h"
 
 namespace coj {
@@ -173,6 +174,175 @@ TEST_F(RunnerTest, Run_LargeAllocation_ReturnsMLE) {
     EXPECT_EQ(result->status, RunStatus::MemoryLimit);
 }
 
+TEST_F(RunnerTest, Run_SleepWithWallLimit_KillsAtSubSecondDeadline) {
+    std::string code = R"(
+        #include <unistd.h>
+        int main() {
+            sleep(3);
+            return 0;
+        }
+    )";
+    auto exec = CreateAndCompile("tle_wall_precise", code);
+    auto input = CreateInputFile("tle_wall_precise", "");
+
+    auto config = GetBaseConfig(exec, input);
+    config.soft_limits.wall_time = 300ms;
+
+    auto start_time = std::chrono::steady_clock::now();
+    auto result = coj::Run(config);
+    auto elapsed = std::chrono::steady_clock::now() - start_time;
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->status, RunStatus::TimeLimit);
+    EXPECT_TRUE(result->is_wall_time_exceeded);
+    EXPECT_GE(result->exit_status.GetWallTime(), 300ms);
+    EXPECT_LT(elapsed, 1s);
+}
+
+TEST_F(RunnerTest, GetWallTimeout_WithoutWallLimit_AddsMarginToCpuTime) {
+    auto config = GetBaseConfig("/bin/true", "/dev/null");
+    config.soft_limits.cpu_time = 1500ms;
+
+    EXPECT_EQ(GetWallTimeout(config), 1500ms + DEFAULT_WALL_TIME_MARGIN);
+
+    config.soft_limits.wall_time = 300ms;
+    EXPECT_EQ(GetWallTimeout(config), 300ms);
+}
+
+TEST_F(RunnerTest, Run_WithWorkDir_UsesItAsCurrentDirectory) {
+    std::string code = R"(
+        #include <fstream>
+        int main() {
+            std::ofstream("scratch.txt") << "temp";
+            return 0;
+        }
+    )";
+    auto exec = CreateAndCompile("scratch", code);
+    auto input = CreateInputFile("scratch", "");
+
+    fs::path work_dir = sandbox_dir_ / "work";
+    fs::create_directories(work_dir);
+
+    auto config = GetBaseConfig(exec, input);
+    config.work_dir = work_dir;
+
+    auto result = coj::Run(config);
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->status, RunStatus::Success);
+    EXPECT_TRUE(fs::exists(work_dir / "scratch.txt"));
+}
+
+
+TEST_F(RunnerTest, Run_WithMemoryFiles_NeverTouchesPaths) {
+    std::string code = R"(
+        #include <iostream>
+        int main() {
+            int a, b;
+            std::cin >> a >> b;
+            std::cout << a + b << std::endl;
+            return 0;
+        }
+    )";
+    auto exec = CreateAndCompile("memory_sum", code);
+
+    auto input_res = MemoryFile::FromData("input", "20 22\n");
+    auto output_res = MemoryFile::Create("output");
+    ASSERT_TRUE(input_res.has_value() && output_res.has_value());
+
+    auto config = GetBaseConfig(exec, sandbox_dir_ / "missing.in");
+    config.input_memory = &input_res.value();
+    config.output_memory = &output_res.value();
+
+    for (int i = 0; i < 2; ++i) {
+        auto result = coj::Run(config);
+        ASSERT_TRUE(result.has_value()) << result.error().message();
+        EXPECT_EQ(result->status, RunStatus::Success);
+    }
+
+    auto map_res = output_res->Map();
+    ASSERT_TRUE(map_res.has_value());
+    EXPECT_EQ(map_res->View(), "42\n");
+    EXPECT_FALSE(fs::exists(config.output_path));
+}
+
+TEST_F(RunnerTest, Run_PrintLoopIntoFile_KilledAtOutputBudget) {
+    std::string code = R"(
+        #include <cstdio>
+        int main() {
+            while (true) {
+                std::fputs("spam\n", stdout);
+            }
+        }
+    )";
+    auto exec = CreateAndCompile("spam_file", code);
+    auto input = CreateInputFile("spam_file", "");
+
+    auto config = GetBaseConfig(exec, input);
+    config.soft_limits.output_bytes = 4096;
+
+    auto result = coj::Run(config);
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->status, RunStatus::OutputLimit);
+    EXPECT_TRUE(result->is_output_limit_exceeded);
+    EXPECT_GT(result->output_bytes, 4096);
+    EXPECT_LT(result->exit_status.GetWallTime(), 500ms);
+}
+
+TEST_F(RunnerTest, Run_PrintLoopIntoPipe_KilledAtOutputBudget) {
+    std::string code = R"(
+        #include <cstdio>
+        int main() {
+            while (true) {
+                std::fputs("spam\n", stdout);
+            }
+        }
+    )";
+    auto exec = CreateAndCompile("spam_pipe", code);
+    auto input = CreateInputFile("spam_pipe", "");
+
+    size_t observed_bytes = 0;
+    auto config = GetBaseConfig(exec, input);
+    config.soft_limits.output_bytes = 64 * 1024;
+    config.output_observer = [&](std::string_view chunk) -> std::expected<bool, std::error_code> {
+        observed_bytes += chunk.size();
+        return true;
+    };
+
+    auto result = coj::Run(config);
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->status, RunStatus::OutputLimit);
+    EXPECT_TRUE(result->is_output_limit_exceeded);
+    EXPECT_GT(result->output_bytes, 64 * 1024);
+    EXPECT_LE(observed_bytes, 64 * 1024);
+    EXPECT_LT(result->exit_status.GetWallTime(), 500ms);
+}
+
+TEST_F(RunnerTest, Run_OutputExactlyAtBudget_ReturnsSuccess) {
+    std::string code = R"(
+        #include <string>
+        #include <cstdio>
+        int main() {
+            std::string line(999, 'x');
+            std::puts(line.c_str());
+            return 0;
+        }
+    )";
+    auto exec = CreateAndCompile("exact_budget", code);
+    auto input = CreateInputFile("exact_budget", "");
+
+    auto config = GetBaseConfig(exec, input);
+    config.soft_limits.output_bytes = 1000;
+
+    auto result = coj::Run(config);
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->status, RunStatus::Success);
+    EXPECT_EQ(result->output_bytes, 1000);
+}
+
 } // namespace
 
 } // namespace coj
\ No newline at end of file
@@ -0,0 +1,260 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "coj/compiler.h"
+#include "coj/process.h"
+#include "coj/reactor.h"
+#include "coj/sandbox.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr const char* SOCKET_SOURCE = R"(
+    #include <cstdio>
+    #include <sys/socket.h>
+    int main(int argc, char**) {
+        std::puts("started");
+        std::fflush(stdout);
+        if (argc > 1) {
+            return socket(AF_INET, SOCK_STREAM, 0) == -1 ? 3 : 0;
+        }
+        return 0;
+    }
+)";
+
+class SandboxTest : public ::testing::Test {
+protected:
+    fs::path sandbox_dir_;
+
+    void SetUp() override {
+        sandbox_dir_ = fs::temp_directory_path() / ("coj_sandbox_test_" + std::to_string(::getpid()));
+        fs::create_directories(sandbox_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(sandbox_dir_);
+    }
+
+    fs::path CreateAndCompile(const std::string& name, const std::string& code) {
+        fs::path source_path = sandbox_dir_ / (name + ".cpp");
+        std::ofstream(source_path) << code;
+
+        fs::path exec_dir = sandbox_dir_ / name;
+        fs::create_directories(exec_dir);
+
+        CppCompiler compiler;
+        compiler.Arg("-O2").Arg("-std=c++23");
+
+        auto result = compiler.Compile(source_path, exec_dir);
+        EXPECT_TRUE(result.has_value() && result->is_successful) << "Test setup failed: Compilation error\n" << result->output;
+        return result->exec_path.value();
+    }
+
+    // Mirrors the host's /usr and its merged-usr symlinks, plus a writable /work.
+    fs::path CreateRootfs(process::SandboxConfig& config) {
+        fs::path rootfs = sandbox_dir_ / "rootfs";
+        fs::create_directories(rootfs / "usr");
+        fs::create_directories(rootfs / "work");
+        fs::create_directories(rootfs / "proc");
+        fs::create_directories(sandbox_dir_ / "work");
+
+        for (const char* name : { "bin", "lib", "lib64", "sbin" }) {
+            fs::path host = fs::path("/") / name;
+            std::error_code ec;
+            if (fs::is_symlink(host, ec)) {
+                fs::create_symlink(fs::read_symlink(host), rootfs / name);
+            } else if (fs::is_directory(host, ec)) {
+                fs::create_directories(rootfs / name);
+                config.binds.push_back({ .source = host, .target = name, .is_read_only = true });
+            }
+        }
+
+        config.rootfs = rootfs;
+        config.binds.push_back({ .source = "/usr", .target = "usr", .is_read_only = true });
+        config.binds.push_back({ .source = sandbox_dir_ / "work", .target = "work", .is_read_only = false });
+        return rootfs;
+    }
+
+    struct Outcome {
+        process::ExitStatus exit_status;
+        std::string output;
+    };
+
+    // Returns nullopt after marking the test skipped when the kernel refuses the namespaces.
+    std::optional<Outcome> RunSandboxed(const process::SandboxConfig& config, process::Command command) {
+        auto plan_res = process::SandboxPlan::Build(config);
+        EXPECT_TRUE(plan_res.has_value()) << plan_res.error().message();
+        if (!plan_res.has_value()) {
+            return std::nullopt;
+        }
+
+        command.Sandbox(plan_res.value())
+            .Stdin(process::Stdio::Null())
+            .Stdout(process::Stdio::Piped())
+            .Stderr(process::Stdio::Null());
+
+        auto child_res = command.Spawn();
+        if (!child_res.has_value()) {
+            auto err = child_res.error();
+            if (err == std::errc::operation_not_permitted || err == std::errc::invalid_argument || err == std::errc::function_not_supported) {
+                is_unsupported_ = true;
+                return std::nullopt;
+            }
+            ADD_FAILURE() << "Spawn failed: " << err.message();
+            return std::nullopt;
+        }
+
+        auto communicate_res = Communicate(child_res.value());
+        EXPECT_TRUE(communicate_res.has_value());
+        if (!communicate_res.has_value()) {
+            return std::nullopt;
+        }
+        return Outcome{ communicate_res->exit_status, std::move(communicate_res->stdout_data) };
+    }
+
+    bool is_unsupported_ = false;
+};
+
+#define SKIP_IF_UNSUPPORTED()                                              \
+    if (is_unsupported_) {                                                 \
+        GTEST_SKIP() << "Namespaces are unavailable; skipping sandbox test."; \
+    }
+
+TEST_F(SandboxTest, SeccompFilter_Compile_EmitsTwoInstructionsPerSyscall) {
+    process::SeccompPolicy policy;
+    policy.allowed_syscalls = { 0, 1, 60 };
+
+    auto filter_res = process::SeccompFilter::Compile(policy);
+    ASSERT_TRUE(filter_res.has_value());
+
+    const auto& filter = *filter_res.value();
+    EXPECT_EQ(filter.GetProgram()->len, filter.GetInstructionCount());
+    EXPECT_GE(filter.GetInstructionCount(), 3u * 2 + 5);
+
+    policy.allowed_syscalls.push_back(-1);
+    EXPECT_EQ(process::SeccompFilter::Compile(policy).error(), std::errc::invalid_argument);
+}
+
+TEST_F(SandboxTest, Build_RootfsWithoutMountNamespace_Fails) {
+    process::SandboxConfig config;
+    config.is_mount_ns = false;
+    config.rootfs = sandbox_dir_;
+
+    EXPECT_EQ(process::SandboxPlan::Build(config).error(), std::errc::invalid_argument);
+}
+
+TEST_F(SandboxTest, Spawn_PidAndNetNamespaces_IsolatesChild) {
+    process::SandboxConfig config;
+
+    process::Command command("/bin/sh");
+    command.Arg("-c").Arg("echo $$; wc -l < /proc/net/dev");
+
+    auto outcome = RunSandboxed(config, std::move(command));
+    SKIP_IF_UNSUPPORTED();
+    ASSERT_TRUE(outcome.has_value());
+
+    EXPECT_TRUE(outcome->exit_status.Success());
+    // Pid 1 is the reaper the program runs under. Two header lines plus the loopback device.
+    EXPECT_EQ(outcome->output, "2\n3\n");
+}
+
+TEST_F(SandboxTest, Spawn_WithRootfs_ExposesOnlyWritableBinds) {
+    process::SandboxConfig config;
+    config.is_proc_mounted = true;
+    CreateRootfs(config);
+
+    process::Command command("/bin/sh");
+    command.Arg("-c")
+        .Arg("touch /escape 2>/dev/null || echo ro; touch /work/ok && echo rw; cat /proc/1/comm /proc/2/comm")
+        .CurrentDir("/work");
+
+    auto outcome = RunSandboxed(config, std::move(command));
+    SKIP_IF_UNSUPPORTED();
+    ASSERT_TRUE(outcome.has_value());
+
+    EXPECT_TRUE(outcome->exit_status.Success());
+    EXPECT_EQ(outcome->output, "ro\nrw\ncoj-init\nsh\n");
+    EXPECT_TRUE(fs::exists(sandbox_dir_ / "work" / "ok"));
+    EXPECT_FALSE(fs::exists(sandbox_dir_ / "rootfs" / "escape"));
+}
+
+TEST_F(SandboxTest, Spawn_PidNamespace_KeepsDefaultSignalVerdicts) {
+    fs::path exec_path = CreateAndCompile("crash", R"(
+        #include <cstdlib>
+        int main(int argc, char**) {
+            if (argc > 1) {
+                volatile unsigned long spin = 0;
+                while (true) {
+                    spin = spin + 1;
+                }
+            }
+            std::abort();
+        }
+    )");
+
+    process::SandboxConfig config;
+
+    auto aborted = RunSandboxed(config, process::Command(exec_path));
+    SKIP_IF_UNSUPPORTED();
+    ASSERT_TRUE(aborted.has_value());
+    EXPECT_EQ(aborted->exit_status.Signal(), SIGABRT);
+
+    process::Command command(exec_path);
+    command.Arg("spin").Limits({ .cpu_time_sec = 1 });
+
+    auto spun = RunSandboxed(config, std::move(command));
+    ASSERT_TRUE(spun.has_value());
+    EXPECT_EQ(spun->exit_status.Signal(), SIGXCPU);
+    EXPECT_LT(spun->exit_status.GetCpuTime(), std::chrono::milliseconds(1900));
+}
+
+TEST_F(SandboxTest, Spawn_PidNamespaceWithSingleProcess_DoesNotCountInit) {
+    process::SandboxConfig config;
+
+    process::Command command("/bin/sh");
+    command.Arg("-c").Arg("echo ok").Limits({ .process_count = 1 });
+
+    auto outcome = RunSandboxed(config, std::move(command));
+    SKIP_IF_UNSUPPORTED();
+    ASSERT_TRUE(outcome.has_value());
+
+    EXPECT_TRUE(outcome->exit_status.Success());
+    EXPECT_EQ(outcome->output, "ok\n");
+}
+
+TEST_F(SandboxTest, Spawn_WithSeccomp_KillsOnDisallowedSyscall) {
+    fs::path exec_path = CreateAndCompile("socket", SOCKET_SOURCE);
+
+    auto filter_res = process::SeccompFilter::Compile(process::SeccompPolicy::Default());
+    ASSERT_TRUE(filter_res.has_value());
+
+    process::SandboxConfig config;
+    config.seccomp = filter_res.value();
+
+    auto allowed = RunSandboxed(config, process::Command(exec_path));
+    SKIP_IF_UNSUPPORTED();
+    ASSERT_TRUE(allowed.has_value());
+    EXPECT_TRUE(allowed->exit_status.Success());
+    EXPECT_EQ(allowed->output, "started\n");
+
+    process::Command command(exec_path);
+    command.Arg("socket");
+
+    auto killed = RunSandboxed(config, std::move(command));
+    ASSERT_TRUE(killed.has_value());
+    EXPECT_EQ(killed->exit_status.Signal(), SIGSYS);
+    EXPECT_EQ(killed->output, "started\n");
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
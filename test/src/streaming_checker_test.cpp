@@ -0,0 +1,255 @@
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "coj/compiler.h"
+#include "coj/streaming_checker.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+class StreamingCheckerTest : public ::testing::Test {
+protected:
+    fs::path sandbox_dir_;
+    CppCompiler compiler_;
+
+    void SetUp() override {
+        sandbox_dir_ = fs::temp_directory_path() / ("coj_streaming_checker_test_" + std::to_string(std::time(nullptr)));
+        fs::create_directories(sandbox_dir_);
+        compiler_.Arg("-O2").Arg("-std=c++23");
+    }
+
+    void TearDown() override {
+        fs::remove_all(sandbox_dir_);
+    }
+
+    fs::path CreateFile(const std::string& filename, const std::string& content) {
+        fs::path file_path = sandbox_dir_ / filename;
+        std::ofstream(file_path) << content;
+        return file_path;
+    }
+
+    fs::path CreateAndCompile(const std::string& name, const std::string& code) {
+        fs::path source_path = CreateFile(name + ".cpp", code);
+
+        fs::path output_dir = sandbox_dir_ / name;
+        fs::create_directories(output_dir);
+
+        auto result = compiler_.Compile(source_path, output_dir);
+        EXPECT_TRUE(result.has_value() && result->is_successful) << "Test setup failed: Compilation error\n" << result->output;
+
+        return result->exec_path.value();
+    }
+
+    RunConfig GetBaseConfig(const fs::path& exec, const fs::path& input) {
+        return RunConfig{
+            .exec_path = exec,
+            .input_path = input,
+            .work_dir = sandbox_dir_,
+            .soft_limits = {
+                .cpu_time = 1000ms,
+                .memory_kb = 64 * 1024
+            },
+            .hard_limits = {
+                .cpu_time_sec = 2,
+                .memory_bytes = 128 * 1024 * 1024
+            }
+        };
+    }
+};
+
+TEST_F(StreamingCheckerTest, Feed_TokensSplitAcrossChunks_ReturnsAccepted) {
+    auto answer = CreateFile("1.ans", "12345 hello\n6789");
+
+    auto checker = StreamingChecker::Create(answer, std::nullopt);
+    ASSERT_TRUE(checker.has_value());
+
+    for (std::string_view chunk : {"12", "345 ", " hel", "lo", "\n", "67", "89\n"}) {
+        auto feed_res = checker->Feed(chunk);
+        ASSERT_TRUE(feed_res.has_value());
+        EXPECT_TRUE(feed_res.value()) << "Mismatch on chunk: " << chunk;
+    }
+
+    EXPECT_EQ(checker->Finish().value(), CheckResult::Accepted);
+}
+
+TEST_F(StreamingCheckerTest, Feed_MismatchingToken_ReturnsFalseImmediately) {
+    auto answer = CreateFile("2.ans", "1 2 3");
+
+    auto checker = StreamingChecker::Create(answer, std::nullopt);
+    ASSERT_TRUE(checker.has_value());
+
+    EXPECT_TRUE(checker->Feed("1 ").value());
+    EXPECT_FALSE(checker->Feed("5 ").value());
+    EXPECT_EQ(checker->Finish().value(), CheckResult::WrongAnswer);
+}
+
+TEST_F(StreamingCheckerTest, Feed_ExtraTokenAfterAnswer_ReturnsFalse) {
+    auto answer = CreateFile("3.ans", "1 2");
+
+    auto checker = StreamingChecker::Create(answer, std::nullopt);
+    ASSERT_TRUE(checker.has_value());
+
+    EXPECT_FALSE(checker->Feed("1 2 3 ").value());
+}
+
+TEST_F(StreamingCheckerTest, Finish_WithMissingTrailingToken_ReturnsWrongAnswer) {
+    auto answer = CreateFile("4.ans", "1 2 3");
+
+    auto checker = StreamingChecker::Create(answer, std::nullopt);
+    ASSERT_TRUE(checker.has_value());
+
+    EXPECT_TRUE(checker->Feed("1 2").value());
+    EXPECT_EQ(checker->Finish().value(), CheckResult::WrongAnswer);
+}
+
+TEST_F(StreamingCheckerTest, Feed_FloatWithinEpsilon_ReturnsAccepted) {
+    auto answer = CreateFile("5.ans", "The answer is 1.000 !");
+
+    auto checker = StreamingChecker::Create(answer, 1e-6);
+    ASSERT_TRUE(checker.has_value());
+
+    EXPECT_TRUE(checker->Feed("The answer \n is 1.00").value());
+    EXPECT_TRUE(checker->Feed("00001 ! \n").value());
+    EXPECT_EQ(checker->Finish().value(), CheckResult::Accepted);
+}
+
+TEST_F(StreamingCheckerTest, RunAndCheck_CorrectSolution_ReturnsAccepted) {
+    auto exec = CreateAndCompile("doubler", R"(
+        #include <iostream>
+        int main() {
+            int n;
+            std::cin >> n;
+            for (int i = 0; i < n; ++i) {
+                std::cout << i * 2 << '\n';
+            }
+            return 0;
+        }
+    )");
+
+    std::string expected;
+    for (int i = 0; i < 100000; ++i) {
+        expected += std::to_string(i * 2) + "\n";
+    }
+    auto input = CreateFile("doubler.in", "100000");
+    auto answer = CreateFile("doubler.ans", expected);
+
+    auto result = RunAndCheck(GetBaseConfig(exec, input), CheckConfig{.answer_path = answer});
+
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+    EXPECT_EQ(result->run_result.status, RunStatus::Success);
+    EXPECT_EQ(result->check_result, CheckResult::Accepted);
+    EXPECT_FALSE(result->is_terminated_early);
+}
+
+TEST_F(StreamingCheckerTest, RunAndCheck_EndlessWrongOutput_KillsSolutionEarly) {
+    auto exec = CreateAndCompile("garbage", R"(
+        #include <cstdio>
+        int main() {
+            while (true) {
+                std::printf("garbage\n");
+            }
+        }
+    )");
+    auto input = CreateFile("garbage.in", "");
+    auto answer = CreateFile("garbage.ans", "42\n");
+
+    auto start_time = std::chrono::steady_clock::now();
+    auto result = RunAndCheck(GetBaseConfig(exec, input), CheckConfig{.answer_path = answer});
+    auto elapsed = std::chrono::steady_clock::now() - start_time;
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result->is_terminated_early);
+    EXPECT_TRUE(result->run_result.is_stopped_by_observer);
+    EXPECT_EQ(result->run_result.exit_status.Signal().value_or(0), SIGKILL);
+    EXPECT_EQ(result->run_result.status, RunStatus::Success);
+    EXPECT_EQ(result->check_result, CheckResult::WrongAnswer);
+    EXPECT_LT(elapsed, 1s);
+}
+
+TEST_F(StreamingCheckerTest, RunAndCheck_SlowWrongOutput_KeepsTimeLimit) {
+    auto exec = CreateAndCompile("slow_garbage", R"(
+        #include <cstdio>
+        #include <ctime>
+        int main() {
+            while (std::clock() < CLOCKS_PER_SEC / 2) {}
+            while (true) {
+                std::printf("garbage\n");
+            }
+        }
+    )");
+    auto input = CreateFile("slow_garbage.in", "");
+    auto answer = CreateFile("slow_garbage.ans", "42\n");
+
+    auto config = GetBaseConfig(exec, input);
+    config.soft_limits.cpu_time = 200ms;
+    config.hard_limits.cpu_time_sec = 2;
+
+    auto result = RunAndCheck(config, CheckConfig{.answer_path = answer});
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result->is_terminated_early);
+    EXPECT_EQ(result->run_result.exit_status.Signal().value_or(0), SIGKILL);
+    EXPECT_EQ(result->run_result.status, RunStatus::TimeLimit);
+    EXPECT_FALSE(result->check_result.has_value());
+}
+
+TEST_F(StreamingCheckerTest, RunAndCheck_SilentInfiniteLoop_ReturnsTLE) {
+    auto exec = CreateAndCompile("tle", R"(
+        int main() {
+            volatile int i = 0;
+            while (true) { i++; }
+        }
+    )");
+    auto input = CreateFile("tle.in", "");
+    auto answer = CreateFile("tle.ans", "42\n");
+
+    auto config = GetBaseConfig(exec, input);
+    config.soft_limits.cpu_time = 200ms;
+    config.hard_limits.cpu_time_sec = 1;
+
+    auto result = RunAndCheck(config, CheckConfig{.answer_path = answer});
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->run_result.status, RunStatus::TimeLimit);
+    EXPECT_FALSE(result->check_result.has_value());
+}
+
+TEST_F(StreamingCheckerTest, RunAndCheck_EndlessWhitespace_StopsAtOutputBudget) {
+    auto exec = CreateAndCompile("whitespace", R"(
+        #include <cstdio>
+        int main() {
+            std::printf("42");
+            while (true) {
+                std::printf("        ");
+            }
+        }
+    )");
+    auto input = CreateFile("whitespace.in", "");
+    auto answer = CreateFile("whitespace.ans", "42\n");
+
+    auto config = GetBaseConfig(exec, input);
+    config.soft_limits.output_bytes = 1024 * 1024;
+
+    auto start_time = std::chrono::steady_clock::now();
+    auto result = RunAndCheck(config, CheckConfig{.answer_path = answer});
+    auto elapsed = std::chrono::steady_clock::now() - start_time;
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->run_result.status, RunStatus::OutputLimit);
+    EXPECT_GT(result->run_result.output_bytes, 1024 * 1024);
+    EXPECT_FALSE(result->check_result.has_value());
+    EXPECT_LT(elapsed, 1s);
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "coj/process.h"
+#include "coj/telemetry.h"
+
+namespace coj {
+
+namespace telemetry {
+
+namespace {
+
+using namespace std::chrono_literals;
+
+class TelemetryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Reset();
+        SetEnabled(true);
+    }
+
+    void TearDown() override {
+        SetEnabled(false);
+        Reset();
+    }
+
+    static bool HasPhase(const std::vector<Span>& spans, Phase phase) {
+        return std::any_of(spans.begin(), spans.end(), [phase](const Span& span) { return span.phase == phase; });
+    }
+};
+
+TEST_F(TelemetryTest, Record_FromExitedThread_IsDrained) {
+    std::thread([] {
+        auto start = std::chrono::steady_clock::now();
+        Record(Phase::Check, start, start + 2ms);
+    }).join();
+
+    auto spans = Drain();
+    ASSERT_EQ(spans.size(), 1);
+    EXPECT_EQ(spans[0].phase, Phase::Check);
+    EXPECT_EQ(spans[0].duration, 2ms);
+    EXPECT_TRUE(Drain().empty());
+}
+
+TEST_F(TelemetryTest, Record_FromManyExitedThreads_RecyclesBuffers) {
+    constexpr size_t THREAD_COUNT = MAX_THREAD_BUFFERS * 2;
+    for (size_t i = 0; i < THREAD_COUNT; ++i) {
+        std::thread([] {
+            auto start = std::chrono::steady_clock::now();
+            Record(Phase::Run, start, start + 1ms);
+        }).join();
+    }
+
+    EXPECT_EQ(Drain().size(), THREAD_COUNT);
+    EXPECT_EQ(GetDroppedCount(), 0);
+}
+
+TEST_F(TelemetryTest, Record_WhenDisabled_KeepsNothing) {
+    SetEnabled(false);
+
+    EXPECT_EQ(Now(), std::chrono::steady_clock::time_point{});
+    Record(Phase::Run, std::chrono::steady_clock::now(), std::chrono::steady_clock::now());
+
+    EXPECT_TRUE(Drain().empty());
+    EXPECT_NE(ToPrometheus().find("coj_phase_duration_seconds_count{phase=\"run\"} 0\n"), std::string::npos);
+}
+
+TEST_F(TelemetryTest, Record_OnSuppressedThread_KeepsNothing) {
+    std::thread([] {
+        SuppressCurrentThread();
+        EXPECT_EQ(Now(), std::chrono::steady_clock::time_point{});
+
+        auto start = std::chrono::steady_clock::now();
+        Record(Phase::Run, start, start + 1ms);
+    }).join();
+
+    auto start = std::chrono::steady_clock::now();
+    Record(Phase::Check, start, start + 1ms);
+
+    auto spans = Drain();
+    ASSERT_EQ(spans.size(), 1);
+    EXPECT_EQ(spans[0].phase, Phase::Check);
+    EXPECT_NE(ToPrometheus().find("coj_phase_duration_seconds_count{phase=\"run\"} 0\n"), std::string::npos);
+}
+
+TEST_F(TelemetryTest, ToPrometheus_AfterRecords_ExportsCumulativeBuckets) {
+    auto start = std::chrono::steady_clock::now();
+    Record(Phase::Compile, start, start + 20us);
+    Record(Phase::Compile, start, start + 2ms);
+
+    auto text = ToPrometheus();
+    EXPECT_NE(text.find("# TYPE coj_phase_duration_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(text.find("coj_phase_duration_seconds_bucket{phase=\"compile\",le=\"1e-05\"} 0\n"), std::string::npos);
+    EXPECT_NE(text.find("coj_phase_duration_seconds_bucket{phase=\"compile\",le=\"5e-05\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("coj_phase_duration_seconds_bucket{phase=\"compile\",le=\"0.005\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("coj_phase_duration_seconds_count{phase=\"compile\"} 2\n"), std::string::npos);
+}
+
+TEST_F(TelemetryTest, ToChromeTrace_WithSpans_EmitsCompleteEvents) {
+    auto start = std::chrono::steady_clock::now();
+    Record(Phase::Wait, start, start + 1500ns);
+
+    auto trace = ToChromeTrace(Drain());
+    EXPECT_TRUE(trace.starts_with("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[{\"name\":\"wait\""));
+    EXPECT_NE(trace.find("\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(trace.find("\"dur\":1.5,"), std::string::npos);
+    EXPECT_TRUE(trace.ends_with("}]}"));
+}
+
+TEST_F(TelemetryTest, Spawn_WithProbes_RecordsForkExecAndWait) {
+#if COJ_ENABLE_TELEMETRY
+    process::Command cmd("/bin/true");
+    auto child_res = cmd.Spawn();
+    ASSERT_TRUE(child_res.has_value());
+    ASSERT_TRUE(child_res->WaitWithTimeout(5s).has_value());
+
+    auto spans = Drain();
+    EXPECT_TRUE(HasPhase(spans, Phase::Fork));
+    EXPECT_TRUE(HasPhase(spans, Phase::Exec));
+    EXPECT_TRUE(HasPhase(spans, Phase::Wait));
+    EXPECT_EQ(std::count_if(spans.begin(), spans.end(), [](const Span& span) { return span.phase == Phase::Wait; }), 1);
+#else
+    GTEST_SKIP() << "probes compiled out (COJ_ENABLE_TELEMETRY=OFF)";
+#endif
+}
+
+} // namespace
+
+} // namespace telemetry
+
+} // namespace coj
\ No newline at end of file
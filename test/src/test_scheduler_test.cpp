@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "coj/judger.h"
+#include "coj/test_scheduler.h"
+
+namespace coj {
+
+namespace {
+
+using namespace std::chrono_literals;
+
+CaseResult MakeResult(bool is_accepted, std::chrono::nanoseconds wall_time) {
+    CaseResult result;
+    result.run_result = RunResult{ .status = RunStatus::Success, .exit_status = process::ExitStatus::FromRaw(0, ::rusage{}) };
+    result.check_result = is_accepted ? CheckResult::Accepted : CheckResult::WrongAnswer;
+    result.wall_time = wall_time;
+    return result;
+}
+
+TEST(TestSchedulerTest, ScheduleTests_EqualEstimates_KeepsFileOrder) {
+    std::vector<TestEstimate> estimates(7);
+
+    for (size_t workers : { 1, 3 }) {
+        EXPECT_EQ(ScheduleTests(estimates, workers), (std::vector<size_t>{ 0, 1, 2, 3, 4, 5, 6 }));
+    }
+}
+
+TEST(TestSchedulerTest, ScheduleTests_SingleWorker_FailsFast) {
+    std::vector<TestEstimate> estimates = {
+        { .failure_probability = 0.1, .cost = 10ms },
+        { .failure_probability = 0.9, .cost = 10ms },
+        { .failure_probability = 0.1, .cost = 1ms },
+        { .failure_probability = 0.5, .cost = 100ms }
+    };
+
+    EXPECT_EQ(ScheduleTests(estimates, 1), (std::vector<size_t>{ 2, 1, 0, 3 }));
+}
+
+TEST(TestSchedulerTest, ScheduleTests_LongTestStartsInFirstWave) {
+    // The long test is the least likely to fail, but starting it last would leave one worker busy
+    // for 100ms after the others finish.
+    std::vector<TestEstimate> estimates(9, TestEstimate{ .failure_probability = 0.5, .cost = 10ms });
+    estimates.push_back({ .failure_probability = 0.01, .cost = 100ms });
+
+    auto order = ScheduleTests(estimates, 2);
+    ASSERT_EQ(order.size(), estimates.size());
+
+    auto position = std::find(order.begin(), order.end(), 9) - order.begin();
+    EXPECT_LT(position, 2);
+
+    auto sorted = order;
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(sorted, (std::vector<size_t>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+}
+
+TEST(TestSchedulerTest, History_RecordsFailuresAndCost) {
+    TestHistory history;
+
+    history.Record("a", MakeResult(true, 10ms));
+    history.Record("a", MakeResult(false, 20ms));
+    history.Record("b", CaseResult{});
+
+    auto stats = history.Get("a");
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->run_count, 2u);
+    EXPECT_EQ(stats->failure_count, 1u);
+    EXPECT_EQ(stats->mean_wall_time, 13ms);
+
+    EXPECT_FALSE(history.Get("b").has_value());
+
+    std::vector<std::string> keys = { "a", "new" };
+    auto estimates = history.Estimate(keys);
+    EXPECT_DOUBLE_EQ(estimates[0].failure_probability, 0.5);
+    EXPECT_DOUBLE_EQ(estimates[1].failure_probability, 0.5);
+    EXPECT_EQ(estimates[1].cost, estimates[0].cost);
+}
+
+TEST(TestSchedulerTest, History_Schedule_PutsHistoricalFailureFirst) {
+    TestHistory history;
+    std::vector<std::string> keys = { "t0", "t1", "t2", "t3" };
+
+    for (int i = 0; i < 5; ++i) {
+        for (const auto& key : keys) {
+            history.Record(key, MakeResult(key != "t2", 5ms));
+        }
+    }
+
+    EXPECT_EQ(history.Schedule(keys, 1).front(), 2u);
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
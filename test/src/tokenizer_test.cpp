@@ -0,0 +1,99 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "coj/file_io.h"
+#include "coj/tokenizer.h"
+
+namespace coj {
+
+namespace {
+
+std::vector<std::string> CollectTokens(TokenReader& reader) {
+    std::vector<std::string> tokens;
+    while (true) {
+        auto token = reader.Next();
+        EXPECT_TRUE(token.has_value());
+        if (!token.has_value() || !token->has_value()) {
+            break;
+        }
+        tokens.emplace_back(**token);
+    }
+    return tokens;
+}
+
+TEST(TokenizerTest, SkipWhitespace_OverLongWhitespaceRun_StopsAtFirstToken) {
+    std::string text = std::string(37, ' ') + "\t\n\v\f\r" + "token";
+
+    const char* result = SkipWhitespace(text.data(), text.data() + text.size());
+
+    EXPECT_EQ(std::string_view(result), "token");
+}
+
+TEST(TokenizerTest, FindWhitespace_OverLongToken_StopsAtFirstWhitespace) {
+    std::string text = std::string(41, 'x') + "\ny";
+
+    const char* result = FindWhitespace(text.data(), text.data() + text.size());
+
+    EXPECT_EQ(result - text.data(), 41);
+}
+
+TEST(TokenizerTest, FindWhitespace_WithoutWhitespace_ReturnsLast) {
+    std::string text(50, '7');
+
+    const char* result = FindWhitespace(text.data(), text.data() + text.size());
+
+    EXPECT_EQ(result, text.data() + text.size());
+}
+
+TEST(TokenizerTest, Next_OnView_MatchesStreamExtraction) {
+    auto reader = TokenReader::FromView("  1 \t 2 \n\n 3 4  5 \n\n\x01x ");
+
+    auto tokens = CollectTokens(reader);
+
+    EXPECT_EQ(tokens, (std::vector<std::string>{"1", "2", "3", "4", "5", "\x01x"}));
+}
+
+TEST(TokenizerTest, Next_OnPipe_ReassemblesTokensAcrossBufferRefills) {
+    int p[2];
+    ASSERT_NE(::pipe(p), -1);
+    FileDescriptor read_fd(p[0]);
+    FileDescriptor write_fd(p[1]);
+
+    std::string long_token(TokenReader::STREAM_BUFFER_SIZE * 2 + 3, 'a');
+    std::string content = "first " + long_token + "\n";
+    for (int i = 0; i < 20000; ++i) {
+        content += std::to_string(i) + " ";
+    }
+
+    std::thread writer([&] {
+        (void)Write(write_fd.Get(), std::as_bytes(std::span(content)));
+        write_fd.Close();
+    });
+
+    auto reader_res = TokenReader::FromFd(std::move(read_fd));
+    ASSERT_TRUE(reader_res.has_value());
+    EXPECT_TRUE(reader_res->IsStreaming());
+
+    auto tokens = CollectTokens(*reader_res);
+    writer.join();
+
+    ASSERT_EQ(tokens.size(), 20002);
+    EXPECT_EQ(tokens[0], "first");
+    EXPECT_EQ(tokens[1], long_token);
+    EXPECT_EQ(tokens[2], "0");
+    EXPECT_EQ(tokens.back(), "19999");
+}
+
+TEST(TokenizerTest, Open_WithMissingFile_ReturnsEnoent) {
+    auto reader_res = TokenReader::Open("/path/to/absolutely/missing_file");
+
+    ASSERT_FALSE(reader_res.has_value());
+    EXPECT_EQ(reader_res.error(), std::errc::no_such_file_or_directory);
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <unistd.h>
+
+#include <linux/magic.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "coj/work_area.h"
+
+namespace coj {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+class WorkAreaTest : public ::testing::Test {
+protected:
+    fs::path sandbox_dir_;
+
+    void SetUp() override {
+        sandbox_dir_ = fs::temp_directory_path() / ("coj_work_area_test_" + std::to_string(::getpid()));
+        fs::create_directories(sandbox_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(sandbox_dir_);
+    }
+};
+
+TEST_F(WorkAreaTest, Reset_NestedEntries_EmptiesDirectoryInPlace) {
+    auto area_res = WorkArea::Create(sandbox_dir_ / "area");
+    ASSERT_TRUE(area_res.has_value()) << area_res.error().message();
+    auto& area = area_res.value();
+
+    fs::create_directories(area.GetPath() / "a" / "b");
+    std::ofstream(area.GetPath() / "out.txt") << "output";
+    std::ofstream(area.GetPath() / "a" / "b" / "deep.txt") << "deep";
+    fs::create_symlink("/etc", area.GetPath() / "link");
+    ::chmod((area.GetPath() / "a").c_str(), 0);
+
+    struct stat before;
+    ASSERT_EQ(::stat(area.GetPath().c_str(), &before), 0);
+
+    ASSERT_TRUE(area.Reset().has_value());
+
+    struct stat after;
+    ASSERT_EQ(::stat(area.GetPath().c_str(), &after), 0);
+    EXPECT_EQ(before.st_ino, after.st_ino);
+    EXPECT_TRUE(fs::is_empty(area.GetPath()));
+    EXPECT_TRUE(fs::exists("/etc"));
+}
+
+TEST_F(WorkAreaTest, MoveAssign_OverLiveArea_RemovesOldDirectory) {
+    auto target = WorkArea::Create(sandbox_dir_ / "target");
+    auto source = WorkArea::Create(sandbox_dir_ / "source");
+    ASSERT_TRUE(target.has_value() && source.has_value());
+    std::ofstream(target->GetPath() / "out.txt") << "output";
+
+    *target = std::move(*source);
+
+    EXPECT_FALSE(fs::exists(sandbox_dir_ / "target"));
+    EXPECT_EQ(target->GetPath(), sandbox_dir_ / "source");
+    EXPECT_TRUE(target->IsValid());
+    EXPECT_FALSE(source->IsValid());
+
+    ASSERT_TRUE(target->Remove().has_value());
+    EXPECT_FALSE(fs::exists(sandbox_dir_ / "source"));
+}
+
+TEST_F(WorkAreaTest, Release_ThenAcquire_ReusesResetArea) {
+    WorkAreaPool pool(sandbox_dir_, 1);
+    ASSERT_TRUE(pool.Reserve().has_value());
+    EXPECT_EQ(pool.GetIdleCount(), 1);
+
+    auto first_res = pool.Acquire();
+    ASSERT_TRUE(first_res.has_value());
+    fs::path path = first_res->GetPath();
+    std::ofstream(path / "0.out") << "3\n";
+
+    pool.Release(std::move(*first_res));
+    EXPECT_EQ(pool.GetIdleCount(), 1);
+
+    auto second_res = pool.Acquire();
+    ASSERT_TRUE(second_res.has_value());
+    EXPECT_EQ(second_res->GetPath(), path);
+    EXPECT_TRUE(fs::is_empty(path));
+}
+
+TEST_F(WorkAreaTest, Release_OverCapacity_RemovesArea) {
+    WorkAreaPool pool(sandbox_dir_, 1);
+
+    auto first_res = pool.Acquire();
+    auto second_res = pool.Acquire();
+    ASSERT_TRUE(first_res.has_value() && second_res.has_value());
+    fs::path second_path = second_res->GetPath();
+
+    pool.Release(std::move(*first_res));
+    pool.Release(std::move(*second_res));
+
+    EXPECT_EQ(pool.GetIdleCount(), 1);
+    EXPECT_FALSE(fs::exists(second_path));
+}
+
+TEST_F(WorkAreaTest, MountTmpfs_WithQuota_RejectsWritesPastLimit) {
+    fs::path parent_dir = sandbox_dir_ / "tmpfs";
+    fs::create_directories(parent_dir);
+
+    {
+        WorkAreaPool pool(parent_dir, 1);
+        auto mount_res = pool.MountTmpfs(1024 * 1024);
+        if (!mount_res.has_value()) {
+            GTEST_SKIP() << "tmpfs cannot be mounted here: " << mount_res.error().message();
+        }
+        ASSERT_TRUE(pool.Reserve().has_value());
+
+        struct statfs st;
+        ASSERT_EQ(::statfs(parent_dir.c_str(), &st), 0);
+        EXPECT_EQ(st.f_type, TMPFS_MAGIC);
+
+        auto area_res = pool.Acquire();
+        ASSERT_TRUE(area_res.has_value());
+
+        std::string chunk(64 * 1024, 'x');
+        std::ofstream out(area_res->GetPath() / "big.out");
+        for (int i = 0; i < 32 && out; ++i) {
+            out << chunk << std::flush;
+        }
+        EXPECT_FALSE(out.good());
+        out.close();
+
+        pool.Release(std::move(*area_res));
+        EXPECT_EQ(pool.GetIdleCount(), 1);
+    }
+
+    struct statfs st;
+    ASSERT_EQ(::statfs(parent_dir.c_str(), &st), 0);
+    EXPECT_NE(st.f_type, TMPFS_MAGIC);
+}
+
+} // namespace
+
+} // namespace coj
\ No newline at end of file